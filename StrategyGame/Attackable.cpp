@@ -66,17 +66,42 @@ std::string Attackable::serialize() const {
     return str + "-Buttons-";
 }
 
-std::list<std::pair<std::string, std::string> > Attackable::deserializeButtons(std::string str) {
-    str.erase(0, 8); //Erases "Buttons:"
+std::list<std::pair<std::string, std::string> > Attackable::deserializeButtons(const std::string& str) {
+    TextReader reader(str);
+    return Attackable::deserializeButtons(reader);
+}
+
+std::list<std::pair<std::string, std::string> > Attackable::deserializeButtons(TextReader& reader) {
+    reader.expect("Buttons:");
+    
+    std::list<std::pair<std::string, std::string> > buttonInfo;
+    
+    while (reader.skip("<")) {
+        std::string action = reader.readString(',');
+        std::string text = reader.readString('>');
+        buttonInfo.push_back({action, text});
+    }
+    
+    reader.skip("-Buttons-");
     
+    return buttonInfo;
+}
+
+void Attackable::encodeButtons(ByteWriter& writer) const {
+    writer.writeVarint((uint32_t)this->buttonInfo.size());
+    for (auto a = this->buttonInfo.begin(); a != this->buttonInfo.end(); a++) {
+        writer.writeString(a->first);
+        writer.writeString(a->second);
+    }
+}
+
+std::list<std::pair<std::string, std::string> > Attackable::decodeButtons(ByteReader& reader) {
     std::list<std::pair<std::string, std::string> > buttonInfo;
     
-    while (str.find(">") != std::string::npos) {
-        str.erase(0, 1); //Erases "<"
-        std::string action = str.substr(0, str.find_first_of(','));
-        str = str.substr(str.find_first_of(',') + 1);
-        std::string text = str.substr(0, str.find_first_of('>'));
-        str = str.substr(str.find_first_of('>') + 1);
+    uint32_t numButtons = reader.readVarint();
+    for (uint32_t a = 0; a < numButtons; a++) {
+        std::string action = reader.readString();
+        std::string text = reader.readString();
         buttonInfo.push_back({action, text});
     }
     
@@ -12,6 +12,9 @@
 #include <list>
 #include <string>
 
+#include "ByteStream.hpp"
+#include "TextReader.hpp"
+
 class Attackable {
 public:
     
@@ -98,7 +101,32 @@ public:
      *
      * @return A vector containing the button info.
      */
-    static std::list<std::pair<std::string, std::string> > deserializeButtons(std::string str);
+    static std::list<std::pair<std::string, std::string> > deserializeButtons(const std::string& str);
+    
+    /*!
+     * Get information about the buttons from a serialized string, as part of a longer message.
+     *
+     * @param reader The TextReader to read from. It is moved past the buttons.
+     *
+     * @return A vector containing the button info.
+     */
+    static std::list<std::pair<std::string, std::string> > deserializeButtons(TextReader& reader);
+    
+    /*!
+     * Write the buttons of this object in the binary format. See ByteStream.hpp.
+     *
+     * @param writer The ByteWriter to write to.
+     */
+    void encodeButtons(ByteWriter& writer) const;
+    
+    /*!
+     * Read buttons written by encodeButtons().
+     *
+     * @param reader The ByteReader to read from.
+     *
+     * @return A list containing the button info.
+     */
+    static std::list<std::pair<std::string, std::string> > decodeButtons(ByteReader& reader);
     
 protected:
     //Protected properties
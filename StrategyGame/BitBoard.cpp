@@ -0,0 +1,137 @@
+//
+//  BitBoard.cpp
+//  Strategy Game
+//
+
+#include "BitBoard.hpp"
+
+//Constructors
+
+BitBoard::BitBoard(unsigned int width, unsigned int height) : boardWidth(width), boardHeight(height), words(((width * height) + 63) / 64, 0) {}
+
+//Public member functions
+
+void BitBoard::setRegion(int minX, int minY, int maxX, int maxY) {
+    minX = std::max(minX, 0);
+    minY = std::max(minY, 0);
+    maxX = std::min(maxX, (int)this->boardWidth - 1);
+    maxY = std::min(maxY, (int)this->boardHeight - 1);
+    
+    for (int x = minX; x <= maxX; x++) {
+        for (int y = minY; y <= maxY; y++) {
+            this->set(x, y);
+        }
+    }
+}
+
+void BitBoard::clear() {
+    for (int a = 0; a < this->words.size(); a++) {
+        this->words[a] = 0;
+    }
+}
+
+BitBoard& BitBoard::operator|=(const BitBoard& other) {
+    if (other.boardWidth != this->boardWidth || other.boardHeight != this->boardHeight)
+        throw std::length_error("BitBoard sizes do not match");
+    
+    for (int a = 0; a < this->words.size(); a++) {
+        this->words[a] |= other.words[a];
+    }
+    return *this;
+}
+
+BitBoard& BitBoard::operator&=(const BitBoard& other) {
+    if (other.boardWidth != this->boardWidth || other.boardHeight != this->boardHeight)
+        throw std::length_error("BitBoard sizes do not match");
+    
+    for (int a = 0; a < this->words.size(); a++) {
+        this->words[a] &= other.words[a];
+    }
+    return *this;
+}
+
+BitBoard& BitBoard::subtract(const BitBoard& other) {
+    if (other.boardWidth != this->boardWidth || other.boardHeight != this->boardHeight)
+        throw std::length_error("BitBoard sizes do not match");
+    
+    for (int a = 0; a < this->words.size(); a++) {
+        this->words[a] &= ~other.words[a];
+    }
+    return *this;
+}
+
+BitBoard BitBoard::operator|(const BitBoard& other) const {
+    BitBoard result = *this;
+    return result |= other;
+}
+
+BitBoard BitBoard::operator&(const BitBoard& other) const {
+    BitBoard result = *this;
+    return result &= other;
+}
+
+bool BitBoard::operator==(const BitBoard& other) const {
+    return this->boardWidth == other.boardWidth && this->boardHeight == other.boardHeight && this->words == other.words;
+}
+
+bool BitBoard::operator!=(const BitBoard& other) const {
+    return !(*this == other);
+}
+
+//Public get functions
+
+unsigned int BitBoard::count() const {
+    unsigned int total = 0;
+    for (int a = 0; a < this->words.size(); a++) {
+        total += __builtin_popcountll(this->words[a]);
+    }
+    return total;
+}
+
+bool BitBoard::empty() const {
+    for (int a = 0; a < this->words.size(); a++) {
+        if (this->words[a] != 0)
+            return false;
+    }
+    return true;
+}
+
+bool BitBoard::intersects(const BitBoard& other) const {
+    if (other.boardWidth != this->boardWidth || other.boardHeight != this->boardHeight)
+        throw std::length_error("BitBoard sizes do not match");
+    
+    for (int a = 0; a < this->words.size(); a++) {
+        if ((this->words[a] & other.words[a]) != 0)
+            return true;
+    }
+    return false;
+}
+
+std::vector<glm::ivec2> BitBoard::tiles() const {
+    std::vector<glm::ivec2> positions;
+    
+    for (unsigned int a = 0; a < this->words.size(); a++) {
+        uint64_t word = this->words[a];
+        
+        //Take the lowest set bit each time, until none are left
+        while (word != 0) {
+            unsigned int bit = (a * 64) + __builtin_ctzll(word);
+            positions.push_back(glm::ivec2(bit / this->boardHeight, bit % this->boardHeight));
+            word &= word - 1;
+        }
+    }
+    
+    return positions;
+}
+
+unsigned int BitBoard::width() const {
+    return this->boardWidth;
+}
+
+unsigned int BitBoard::height() const {
+    return this->boardHeight;
+}
+
+const std::vector<uint64_t>& BitBoard::data() const {
+    return this->words;
+}
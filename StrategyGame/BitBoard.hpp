@@ -0,0 +1,175 @@
+//
+//  BitBoard.hpp
+//  Strategy Game
+//
+
+#ifndef BitBoard_hpp
+#define BitBoard_hpp
+
+#include <vector>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <stdint.h>
+
+//GLM: OpenGL mathematics for rotations, translations, dilations
+#include <GLM/glm.hpp>
+
+/*!
+ * A set of board tiles stored as one bit per tile, in the same order as the board's tile arrays (x * height + y). Membership tests are a single bit lookup, and a whole board fits in a few cache lines.
+ */
+class BitBoard {
+public:
+    //Constructors
+    
+    /*!
+     * Creates an empty set.
+     *
+     * @param width The x-side width of the board.
+     * @param height The y-side height of the board.
+     */
+    BitBoard(unsigned int width = 0, unsigned int height = 0);
+    
+    //Public member functions
+    
+    /*!
+     * Add a tile to the set. No bounds checking is done.
+     *
+     * @param x The x index of the coordinate in the board.
+     * @param y The y index of the coordinate in the board.
+     */
+    inline void set(unsigned int x, unsigned int y) { unsigned int bit = x * this->boardHeight + y; this->words[bit >> 6] |= (uint64_t)1 << (bit & 63); }
+    
+    /*!
+     * Remove a tile from the set. No bounds checking is done.
+     *
+     * @param x The x index of the coordinate in the board.
+     * @param y The y index of the coordinate in the board.
+     */
+    inline void reset(unsigned int x, unsigned int y) { unsigned int bit = x * this->boardHeight + y; this->words[bit >> 6] &= ~((uint64_t)1 << (bit & 63)); }
+    
+    /*!
+     * Add a tile to the set by its index in the board's tile arrays. No bounds checking is done.
+     *
+     * @param index The index of the tile, x * height + y.
+     */
+    inline void setIndex(unsigned int index) { this->words[index >> 6] |= (uint64_t)1 << (index & 63); }
+    
+    /*!
+     * Remove a tile from the set by its index in the board's tile arrays. No bounds checking is done.
+     *
+     * @param index The index of the tile, x * height + y.
+     */
+    inline void resetIndex(unsigned int index) { this->words[index >> 6] &= ~((uint64_t)1 << (index & 63)); }
+    
+    /*!
+     * Add every tile in a rectangle to the set. The rectangle is clipped to the board, so it may extend past the edges.
+     *
+     * @param minX The x index of the first column, inclusive.
+     * @param minY The y index of the first row, inclusive.
+     * @param maxX The x index of the last column, inclusive.
+     * @param maxY The y index of the last row, inclusive.
+     */
+    void setRegion(int minX, int minY, int maxX, int maxY);
+    
+    /*!
+     * Remove all tiles from the set.
+     */
+    void clear();
+    
+    /*!
+     * Add all tiles of another set to this one. A length_error is thrown if the sets are for boards of different sizes.
+     *
+     * @param other The set to add.
+     */
+    BitBoard& operator|=(const BitBoard& other);
+    
+    /*!
+     * Remove all tiles from this set that are not in another one. A length_error is thrown if the sets are for boards of different sizes.
+     *
+     * @param other The set to intersect with.
+     */
+    BitBoard& operator&=(const BitBoard& other);
+    
+    /*!
+     * Remove all tiles of another set from this one. A length_error is thrown if the sets are for boards of different sizes.
+     *
+     * @param other The set to remove.
+     */
+    BitBoard& subtract(const BitBoard& other);
+    
+    BitBoard operator|(const BitBoard& other) const;
+    BitBoard operator&(const BitBoard& other) const;
+    
+    bool operator==(const BitBoard& other) const;
+    bool operator!=(const BitBoard& other) const;
+    
+    //Public get functions
+    
+    /*!
+     * Check if a tile is in the set. Tiles off of the board are never in the set.
+     *
+     * @param x The x index of the coordinate in the board.
+     * @param y The y index of the coordinate in the board.
+     *
+     * @return Whether the tile is in the set.
+     */
+    inline bool test(int x, int y) const {
+        if (x < 0 || y < 0 || x >= this->boardWidth || y >= this->boardHeight)
+            return false;
+        unsigned int bit = x * this->boardHeight + y;
+        return (this->words[bit >> 6] >> (bit & 63)) & 1;
+    }
+    
+    /*!
+     * @return The number of tiles in the set.
+     */
+    unsigned int count() const;
+    
+    /*!
+     * @return Whether the set has no tiles.
+     */
+    bool empty() const;
+    
+    /*!
+     * Check if two sets share any tile, without building their intersection. A length_error is thrown if the sets are for boards of different sizes.
+     *
+     * @param other The set to compare with.
+     *
+     * @return Whether any tile is in both sets.
+     */
+    bool intersects(const BitBoard& other) const;
+    
+    /*!
+     * Get the coordinates of every tile in the set. Only the words with tiles in them are looked at.
+     *
+     * @return An std::vector of the board coordinates of the tiles, in the order of the board's tile arrays.
+     */
+    std::vector<glm::ivec2> tiles() const;
+    
+    /*!
+     * @return The x-side width of the board.
+     */
+    unsigned int width() const;
+    
+    /*!
+     * @return The y-side height of the board.
+     */
+    unsigned int height() const;
+    
+    /*!
+     * @return The words holding the bits, 64 tiles each. Bit n of word w is tile 64 * w + n.
+     */
+    const std::vector<uint64_t>& data() const;
+    
+private:
+    //Private properties
+    
+    int boardWidth;
+    int boardHeight;
+    
+    std::vector<uint64_t> words;
+};
+
+#endif /* BitBoard_hpp */
@@ -8,141 +8,124 @@
 
 #include "Board.hpp"
 
+const unsigned int Board::noVersion; //Defined here as well, so that it can be passed by reference
+const unsigned int Board::noPosition; //Defined here as well, so that it can be passed by reference
+const int Board::anyViewer, Board::noViewer; //Defined here as well, so that they can be passed by reference
+
 //Constructors
 
-Board::Board(std::vector<std::vector<Tile> > board) : gameBoard(board) {}
+Board::Board(std::vector<std::vector<Tile> > board) {
+    this->boardWidth = (unsigned int)board.size();
+    this->boardHeight = this->boardWidth > 0 ? (unsigned int)board[0].size() : 0;
+    
+    unsigned int numberOfTiles = this->boardWidth * this->boardHeight;
+    
+    this->tileTerrain.reserve(numberOfTiles);
+    this->tileCreatures.reserve(numberOfTiles);
+    this->tileBuildings.reserve(numberOfTiles);
+    this->tileDamage.reserve(numberOfTiles);
+    this->tileDamageTime.reserve(numberOfTiles);
+    
+    //Flatten the columns into the tile arrays, so that tile (x, y) is stored at index x * height + y
+    for (unsigned int x = 0; x < this->boardWidth; x++) {
+        if (board[x].size() != this->boardHeight)
+            throw std::invalid_argument("Column " + std::to_string(x) + " has height " + std::to_string(board[x].size()) + ", expected " + std::to_string(this->boardHeight));
+        
+        for (unsigned int y = 0; y < this->boardHeight; y++) {
+            this->tileTerrain.push_back((unsigned char)board[x][y].terrain());
+            this->tileCreatures.push_back(SlotMap<Creature>::null);
+            this->tileBuildings.push_back(SlotMap<Building>::null);
+            this->tileDamage.push_back(board[x][y].damage());
+            this->tileDamageTime.push_back(board[x][y].timeOfDamage());
+        }
+    }
+    
+    this->noVisibility = Visibility(this->boardWidth, this->boardHeight);
+    
+    //Copy any creatures and buildings on the tiles into the board's own storage. They are placed using their own coordinates
+    for (unsigned int x = 0; x < this->boardWidth; x++) {
+        for (unsigned int y = 0; y < this->boardHeight; y++) {
+            if (board[x][y].creature() != nullptr)
+                this->setCreature(*board[x][y].creature());
+            if (board[x][y].building() != nullptr)
+                this->setBuilding(*board[x][y].building());
+        }
+    }
+}
 
 void Board::regenerateEnergy() {
-    for (auto listIter = this->creatures.begin(); listIter != this->creatures.end(); listIter++) {
-        listIter->incrementEnergy(1);
+    //Only the creatures that gained energy are marked, so that an upkeep where everyone is already full changes nothing
+    for (auto creature = this->creatures.begin(); creature != this->creatures.end(); creature++) {
+        float energy = creature->energy();
+        creature->incrementEnergy(1);
+        if (creature->energy() != energy)
+            this->markDirty(creature->x(), creature->y(), creature->x(), creature->y());
     }
 }
 
 //Public member functions
 bool Board::moveCreatureByDirection(unsigned int x, unsigned int y, unsigned int direction) {
-    
-    /* Note:
-     * The following sections contain for loop that iterates through the list of board tiles with creatures until it finds the designated one, and it deletes it.
-     * It is known that this is incredibly inefficient.
-     * However, currently there are not too many board spaces that will have creatures for testing purposes.
-     
-     Ways to fix this in the future:
-     * Make a sort function to get the list sorted in a way that is easy to go through to find the right spot.
-     * Use std::optional<Creature> instead of Creature* in Tile.hpp
-     std::optional (or std::experimental::optional) may not have come out yet, which is a slight problem.
-     There were issues getting it to work on 2013 MacBook Pro in Xcode 7, without much trying
-     * Download and add the boost library optional functionality
-     */
-    
-    
-    if (x >= this->gameBoard.size())
+    if (x >= this->boardWidth)
         throw std::range_error("X out of range: " + std::to_string(x));
-    if (y >= this->gameBoard[x].size())
+    if (y >= this->boardHeight)
         throw std::range_error("Y out of range: " + std::to_string(y));
     
+    unsigned int destinationX = x, destinationY = y;
+    
     if (direction == NORTH) {
-        if (y > 0 && !this->gameBoard[x][y - 1].occupied()) {
-            //Add the creature to the new tile
-            this->gameBoard[x][y - 1].setCreature((Creature*)this->gameBoard[x][y].creature());
-            
-            //Remove the creature from the old tile
-            this->gameBoard[x][y].setCreature(nullptr);
-            
-            //Decrement the creature's energy by the terrain cost
-            this->gameBoard[x][y - 1].creature()->decrementEnergy(getTerrainMovementCost(this->gameBoard[x][y], this->gameBoard[x][y - 1]));
-            
-            //Find the creature, and update its location on the board
-            for (auto listIter = this->creatures.begin(); listIter != this->creatures.end(); listIter++) {
-                if (listIter->x() == x && listIter->y() == y) {
-                    listIter->move(NORTH); //Moves the creature north a tile. y can't be 0 because that is checked above
-                    break;
-                }
-            }
-            
-        } else { //Can't move to the tile
-            return false;
-        }
+        if (y == 0) return false;
+        destinationY = y - 1;
     } else if (direction == EAST) {
-        if (x > 0 && !this->gameBoard[x - 1][y].occupied()) {
-            //Add the creature to the new tile
-            this->gameBoard[x - 1][y].setCreature(this->gameBoard[x][y].creature());
-            
-            //Remove the creature from the old tile
-            this->gameBoard[x][y].setCreature(nullptr);
-            
-            //Decrement the creature's energy by the terrain cost
-            this->gameBoard[x - 1][y].creature()->decrementEnergy(getTerrainMovementCost(this->gameBoard[x][y], this->gameBoard[x - 1][y]));
-            
-            //Find the creature, and update its location on the board
-            for (auto listIter = this->creatures.begin(); listIter != this->creatures.end(); listIter++) {
-                if (listIter->x() == x && listIter->y() == y) {
-                    listIter->move(EAST); //Moves the creature west a tile. x can't be 0 because that is checked above
-                    break;
-                }
-            }
-            
-        } else {
-            return false;
-        }
+        if (x == 0) return false;
+        destinationX = x - 1;
     } else if (direction == SOUTH) {
-        if (y < this->gameBoard[x].size() - 1 && !this->gameBoard[x][y + 1].occupied()) {
-            //Add the creature to the new tile
-            this->gameBoard[x][y + 1].setCreature(this->gameBoard[x][y].creature());
-            
-            //Remove the creature from the old tile
-            this->gameBoard[x][y].setCreature(nullptr);
-            
-            //Decrement the creature's energy by the terrain cost
-            this->gameBoard[x][y + 1].creature()->decrementEnergy(getTerrainMovementCost(this->gameBoard[x][y], this->gameBoard[x][y + 1]));
-            
-            //Find the creature, and update its location on the board
-            for (auto listIter = this->creatures.begin(); listIter != this->creatures.end(); listIter++) {
-                if (listIter->x() == x && listIter->y() == y) {
-                    listIter->move(SOUTH); //Moves the creature south a tile. y can't be the maximum because that is checked above
-                    break;
-                }
-            }
-            
-        } else {
-            return false;
-        }
+        if (y >= this->boardHeight - 1) return false;
+        destinationY = y + 1;
     } else if (direction == WEST) {
-        if (x < this->gameBoard.size() - 1 && !this->gameBoard[x + 1][y].occupied()) {
-            //Add the creature to the new tile
-            this->gameBoard[x + 1][y].setCreature(this->gameBoard[x][y].creature());
-            
-            //Remove the creature from the old tile
-            this->gameBoard[x][y].setCreature(nullptr);
-            
-            //Decrement the creature's energy by the terrain cost
-            this->gameBoard[x + 1][y].creature()->decrementEnergy(getTerrainMovementCost(this->gameBoard[x][y], this->gameBoard[x + 1][y]));
-            
-            //Find the creature, and update its location on the board
-            for (auto listIter = this->creatures.begin(); listIter != this->creatures.end(); listIter++) {
-                if (listIter->x() == x && listIter->y() == y) {
-                    listIter->move(WEST); //Moves the creature south a tile. x can't be the maximum because that is checked above
-                    break;
-                }
-            }
-            
-        } else {
-            return false;
-        }
+        if (x >= this->boardWidth - 1) return false;
+        destinationX = x + 1;
+    } else {
+        return true; //Invalid directions do nothing
     }
+    
+    unsigned int origin = this->index(x, y);
+    unsigned int destination = this->index(destinationX, destinationY);
+    
+    if (this->viewUnchecked(destinationX, destinationY).occupied()) //Can't move to an occupied tile
+        return false;
+    
+    Creature* creature = this->creatures.get(this->tileCreatures[origin]);
+    
+    //Add the creature to the new tile and remove it from the old tile
+    this->tileCreatures[destination] = this->tileCreatures[origin];
+    this->tileCreatures[origin] = SlotMap<Creature>::null;
+    
+    this->markDirty(std::min(x, destinationX), std::min(y, destinationY), std::max(x, destinationX), std::max(y, destinationY));
+    
+    if (creature != nullptr) {
+        //Decrement the creature's energy by the terrain cost, using the moving creature so that its race is taken into account
+        creature->decrementEnergy(this->terrainMovementCost(creature, this->tileTerrain[destination]));
+        
+        //The tile points directly at the creature, so its location can be updated without searching the list
+        creature->move(direction);
+        
+        this->updateVision(this->tileCreatures[destination]);
+    }
+    
     return true;
 }
 
 bool Board::moveCreatureByLocation(unsigned int x, unsigned int y, unsigned int destinationX, unsigned int destinationY) {
-    if (x >= this->gameBoard.size()) //is this protection really necessary?
+    if (x >= this->boardWidth) //is this protection really necessary?
         throw std::range_error("Initial x out of range");
-    if (y >= this->gameBoard[x].size())
+    if (y >= this->boardHeight)
         throw std::range_error("Initial y out of range");
-    if (destinationX >= this->gameBoard.size())
+    if (destinationX >= this->boardWidth)
         throw std::range_error("Destination x out of range");
-    if (destinationY >= this->gameBoard[destinationX].size())
+    if (destinationY >= this->boardHeight)
         throw std::range_error("Destination y out of range");
     
-    Creature* creature = this->gameBoard[x][y].creature();
+    Creature* creature = this->creatures.get(this->tileCreatures[this->index(x, y)]);
     
     if (creature == nullptr) //If there is no creature at the specified location, no moving happens
         return false;
@@ -150,56 +133,58 @@ bool Board::moveCreatureByLocation(unsigned int x, unsigned int y, unsigned int
     if (destinationX == x && destinationY == y) //If the creature is at the destination, no moving happens
         return false;
     
-    if (this->gameBoard[destinationX][destinationY].occupied()) //If the destination is occupied, no moving happens
+    if (this->viewUnchecked(destinationX, destinationY).occupied()) //If the destination is occupied, no moving happens
         return false;
     
     unsigned int distance = this->tileDistances(x, y, destinationX, destinationY);
     
-    if (this->tileDistances(x, y, destinationX, destinationY) > creature->energy()) //If the creature doesn't have enough energy to travel the indicated distance, no moving happens
+    if (distance > creature->energy()) //If the creature doesn't have enough energy to travel the indicated distance, no moving happens
         return false;
     
     //If none of the above errors stop the creature from moving, move the creature
     
     //Add the creature to the new tile
-    this->gameBoard[destinationX][destinationY].setCreature(creature);
+    this->tileCreatures[this->index(destinationX, destinationY)] = this->tileCreatures[this->index(x, y)];
     
     //Remove the creature from the old tile
-    this->gameBoard[x][y].setCreature(nullptr);
+    this->tileCreatures[this->index(x, y)] = SlotMap<Creature>::null;
+    
+    //The two tiles can be far apart, so they are recorded separately
+    this->markDirty(x, y, x, y);
+    this->markDirty(destinationX, destinationY, destinationX, destinationY);
     
     //Decrement the creature's energy by 1
     creature->decrementEnergy(distance);
     
-    //Find the creature, and update its location on the board
-    for (auto listIter = this->creatures.begin(); listIter != this->creatures.end(); listIter++) {
-        if (listIter->x() == x && listIter->y() == y) {
-            //Moves the creature in the list to that spot
-            listIter->setLocation(destinationX, destinationY);
-            break;
-        }
-    }
+    //Update the location stored in the creature itself
+    creature->setLocation(destinationX, destinationY);
+    
+    this->updateVision(this->tileCreatures[this->index(destinationX, destinationY)]);
     
     return true;
 }
 
 std::vector<std::pair<std::string, int> > Board::initiateCombat(unsigned int attackerX, unsigned int attackerY, unsigned int defenderX, unsigned int defenderY, int* attackDamage, int* defendDamage, unsigned char flags) {
-    if (attackerX >= this->gameBoard.size()) {
+    if (attackerX >= this->boardWidth) {
         throw std::range_error("Attacker x out of range");
     }
-    if (attackerY >= this->gameBoard[attackerX].size()) {
+    if (attackerY >= this->boardHeight) {
         throw std::range_error("Attacker y out of range");
     }
-    if (defenderX >= this->gameBoard.size()) {
+    if (defenderX >= this->boardWidth) {
         throw std::range_error("Defender x out of range");
     }
-    if (defenderY >= this->gameBoard[defenderX].size()) {
+    if (defenderY >= this->boardHeight) {
         throw std::range_error("Defender y out of range");
     }
     
     std::vector<std::pair<std::string, int> > actions;
     
-    //Using pointers to get tiles by reference
-    Tile* attacker = &this->gameBoard[attackerX][attackerY];
-    Tile* defender = &this->gameBoard[defenderX][defenderY];
+    //The tiles are copies, but the creatures and buildings they point to are the ones stored in the board
+    Tile attackerTile = this->get(attackerX, attackerY);
+    Tile defenderTile = this->get(defenderX, defenderY);
+    Tile* attacker = &attackerTile;
+    Tile* defender = &defenderTile;
     
     //Calculate Combat Modifiers
     float attackerCombatModifier = 1.00;
@@ -211,7 +196,7 @@ std::vector<std::pair<std::string, int> > Board::initiateCombat(unsigned int att
             unsigned int distanceBetweenTiles;
             distanceBetweenTiles = tileDistances(attackerX, attackerY, defenderX, defenderY); //An error is only thrown if arguments are out of range, but that is checked above
             
-            if (distanceBetweenTiles > this->gameBoard[attackerX][attackerY].creature()->range() && !(flags & IGNORE_RANGE)) {
+            if (distanceBetweenTiles > attacker->creature()->range() && !(flags & IGNORE_RANGE)) {
                 //No combat occurs
                 std::cout << "No combat, defender out of range" << std::endl;
             } else { //if its not melee its ranged. or terrain ignoring.
@@ -238,6 +223,7 @@ std::vector<std::pair<std::string, int> > Board::initiateCombat(unsigned int att
                 bool defenderDied = defender->creature()->takeDamage(damageDealtByAttacker);
                 
                 attacker->creature()->useAllEnergy();
+                this->markDirty(attackerX, attackerY, attackerX, attackerY);
                 
                 if (attackDamage != nullptr)
                     *attackDamage = damageDealtByAttacker;
@@ -269,13 +255,14 @@ std::vector<std::pair<std::string, int> > Board::initiateCombat(unsigned int att
                     if (defendDamage != nullptr)
                         *defendDamage = damageDealtByDefender;
                     
+                    //Read the controller before deleting anything, since deleting a creature moves other creatures in the board's storage
+                    unsigned int controller = defender->creature()->controller();
+                    
                     if (attackerDied) {
-                        unsigned int controller = defender->creature()->controller();
                         actions.push_back({this->deleteCreature(attacker->x(), attacker->y()), controller}); //Remove the dead creature, records its death action
                     }
                     
                     if (defenderDied) {
-                        unsigned int controller = defender->creature()->controller();
                         actions.push_back({this->deleteCreature(defender->x(), defender->y()), controller}); //Remove the dead creature, records its death action
                     }
                 } else if (defenderDied) {
@@ -294,7 +281,7 @@ std::vector<std::pair<std::string, int> > Board::initiateCombat(unsigned int att
             unsigned int distanceBetweenTiles;
             distanceBetweenTiles = tileDistances(attackerX, attackerY, defenderX, defenderY); //An error is only thrown if arguments are out of range, but that is checked above
             
-            if (distanceBetweenTiles > this->gameBoard[attackerX][attackerY].creature()->range()) {
+            if (distanceBetweenTiles > attacker->creature()->range()) {
                 //No combat occurs
             } else {
                 
@@ -302,6 +289,7 @@ std::vector<std::pair<std::string, int> > Board::initiateCombat(unsigned int att
                 
                 bool defenderDied = defender->building()->takeDamage(damageDealtByAttacker);
                 attacker->creature()->useAllEnergy();
+                this->markDirty(attackerX, attackerY, attackerX, attackerY);
                 
                 if (attackDamage != nullptr)
                     *attackDamage = damageDealtByAttacker;
@@ -317,6 +305,7 @@ std::vector<std::pair<std::string, int> > Board::initiateCombat(unsigned int att
             
             bool defenderDied = defender->building()->takeDamage(damageDealtByAttacker);
             attacker->creature()->useAllEnergy();
+            this->markDirty(attackerX, attackerY, attackerX, attackerY);
             
             if (attackDamage != nullptr)
                 *attackDamage = damageDealtByAttacker;
@@ -331,158 +320,248 @@ std::vector<std::pair<std::string, int> > Board::initiateCombat(unsigned int att
     return actions;
 }
 
+bool Board::queueDirections(unsigned int x, unsigned int y, const std::vector<unsigned int>& directions) {
+    if (x >= this->boardWidth) {
+        throw std::range_error("X out of range: " + std::to_string(x));
+    }
+    if (y >= this->boardHeight) {
+        throw std::range_error("Y out of range: " + std::to_string(y));
+    }
+    
+    SlotMap<Creature>::Handle handle = this->tileCreatures[this->index(x, y)];
+    Creature* creature = this->creatures.get(handle);
+    
+    if (creature == nullptr)
+        return false;
+    
+    for (int a = 0; a < directions.size(); a++) {
+        creature->directions.push(directions[a]);
+        if (a == 0)
+            this->setDirection(x, y, directions[a]);
+    }
+    
+    Board::addHandle(this->animating, this->animatingPositions, handle);
+    Board::addHandle(this->controlledAnimating[creature->controller()], this->controlledAnimatingPositions, handle);
+    
+    return true;
+}
+
+void Board::stopAnimating(SlotMap<Creature>::Handle handle) {
+    Creature* creature = this->creatures.get(handle);
+    
+    if (creature == nullptr)
+        return;
+    
+    Board::removeHandle(this->animating, this->animatingPositions, handle);
+    Board::removeHandle(this->controlledAnimating[creature->controller()], this->controlledAnimatingPositions, handle);
+}
+
+bool Board::updateCreature(SlotMap<Creature>::Handle handle, float deltaTime, glm::ivec2* arrival) {
+    Creature* creature = this->creatures.get(handle);
+    
+    if (creature == nullptr)
+        return false;
+    
+    bool arrived = false;
+    
+    if (creature->incrementOffset(deltaTime)) {
+        //The offset is back to 0, which clients could not work out if they had not seen the step start
+        this->markChanged(creature->x(), creature->y());
+        
+        //North and east stay on their tile until they reach the next one, so they are moved now. South and west were moved when they started
+        if (creature->direction() == NORTH || creature->direction() == EAST)
+            arrived = this->moveCreatureByDirection(creature->x(), creature->y(), creature->direction());
+        else
+            arrived = true;
+        
+        if (arrived && arrival != nullptr)
+            *arrival = glm::ivec2(creature->x(), creature->y());
+    }
+    
+    if (creature->directions.size() > 0 && creature->offset() == 0.0) {
+        //Get the new direction that the creature will be travelling in, and get rid of it from the directions left
+        unsigned int direction = creature->directions.front();
+        creature->directions.pop();
+        
+        this->startStep(handle, direction, deltaTime);
+    }
+    
+    //Once the creature has stopped and has nowhere left to go, it no longer needs updating
+    if (creature->directions.size() == 0 && creature->offset() == 0.0)
+        this->stopAnimating(handle);
+    
+    return arrived;
+}
+
 void Board::resetEnergy(unsigned int player) {
-    for (auto creature = this->creatures.begin(); creature != this->creatures.end(); creature++) {
-        if (creature->controller() == player) {
-            creature->resetEnergy();
-        }
+    if (player >= this->controlledCreatures.size())
+        return;
+    
+    for (auto handle = this->controlledCreatures[player].begin(); handle != this->controlledCreatures[player].end(); handle++) {
+        Creature* creature = this->creatures.get(*handle);
+        creature->resetEnergy();
+        this->markDirty(creature->x(), creature->y(), creature->x(), creature->y());
     }
 }
 
-void Board::setCreature(const Creature& creature) {
+SlotMap<Creature>::Handle Board::setCreature(const Creature& creature) {
     unsigned int x = creature.x();
     unsigned int y = creature.y();
-    if (x >= this->gameBoard.size()) {
+    if (x >= this->boardWidth) {
         throw std::range_error("X out of range: " + std::to_string(x));
     }
-    if (y >= this->gameBoard[x].size()) {
+    if (y >= this->boardHeight) {
         throw std::range_error("Y out of range: " + std::to_string(y));
     }
     
-    this->creatures.push_back(creature);
+    //A creature already at this location is replaced
+    this->deleteCreature(x, y);
+    
+    SlotMap<Creature>::Handle handle = this->creatures.insert(creature);
+    this->tileCreatures[this->index(x, y)] = handle;
+    this->markDirty(x, y, x, y);
+    
+    if (creature.controller() >= this->controlledCreatures.size()) {
+        this->controlledCreatures.resize(creature.controller() + 1);
+        this->controlledAnimating.resize(creature.controller() + 1);
+    }
+    Board::addHandle(this->controlledCreatures[creature.controller()], this->controlledCreaturePositions, handle);
+    
+    if (creature.directions.size() > 0 || creature.offset() != 0.0) {
+        Board::addHandle(this->animating, this->animatingPositions, handle);
+        Board::addHandle(this->controlledAnimating[creature.controller()], this->controlledAnimatingPositions, handle);
+    }
+    
+    if (creature.controller() >= this->playerVisibility.size())
+        this->playerVisibility.resize(creature.controller() + 1, Visibility(this->boardWidth, this->boardHeight));
+    this->updateVision(handle);
     
-    this->gameBoard[x][y].setCreature(&this->creatures.back());
+    return handle;
 }
 
 std::string Board::deleteCreature(unsigned int x, unsigned int y) {
-    if (x >= this->gameBoard.size()) {
+    if (x >= this->boardWidth) {
         throw std::range_error("X out of range: " + std::to_string(x));
     }
-    if (y >= this->gameBoard[x].size()) {
+    if (y >= this->boardHeight) {
         throw std::range_error("Y out of range: " + std::to_string(y));
     }
     
-    /* Note:
-     * The following for loop iterates through the list of board tiles with creatures until it finds the designated one, and it deletes it.
-     * It is known that this is incredibly inefficient.
-     * However, currently there are not too many board spaces that will have creatures for testing purposes.
-     
-     Ways to fix this in the future:
-     * Make a sort function to get the list sorted in a way that is easy to go through to find the right spot.
-     * Use std::optional<Creature> instead of Creature* in Tile.hpp
-        std::optional (or std::experimental::optional) may not have come out yet, which is a slight problem.
-        There were issues getting it to work on 2013 MacBook Pro in Xcode 7, without much trying
-     * Download and add the boost library optional functionality
-     */
+    //The tile holds the creature's handle, so the creature can be found and removed directly
+    SlotMap<Creature>::Handle handle = this->tileCreatures[this->index(x, y)];
+    Creature* creature = this->creatures.get(handle);
     
-    std::string deathAction;
+    if (creature == nullptr) //If there is no creature at that point, nothing needs to be deleted
+        return "";
     
-    for (auto listIter = this->creatures.begin(); listIter != this->creatures.end(); listIter++) {
-        if (listIter->x() == x && listIter->y() == y) {
-            this->gameBoard[x][y].setCreature(nullptr);
-            deathAction = listIter->deathAction;
-            this->creatures.erase(listIter); //Delete the creature from the list if it is the specified creature.
-            break;
-        }
-    }
+    std::string deathAction = creature->deathAction;
     
-    return deathAction;
+    Board::removeHandle(this->controlledCreatures[creature->controller()], this->controlledCreaturePositions, handle);
+    this->stopAnimating(handle);
+    this->removeVision(handle, creature->controller());
+    
+    this->tileCreatures[this->index(x, y)] = SlotMap<Creature>::null;
+    this->creatures.erase(handle);
+    this->markDirty(x, y, x, y);
     
-    //If no creature is deleted in the loop, then there was no creature at that point, which is also fine.
+    return deathAction;
 }
 
-void Board::setBuilding(const Building& building) {
+SlotMap<Building>::Handle Board::setBuilding(const Building& building) {
     unsigned int x = building.x();
     unsigned int y = building.y();
-    if (x >= this->gameBoard.size()) {
+    if (x >= this->boardWidth) {
         throw std::range_error("X out of range: " + std::to_string(x));
     }
-    if (y >= this->gameBoard[x].size()) {
+    if (y >= this->boardHeight) {
         throw std::range_error("Y out of range: " + std::to_string(y));
     }
     
-    this->buildings.push_back(building);
+    //A building already at this location is replaced
+    this->deleteBuilding(x, y);
+    
+    SlotMap<Building>::Handle handle = this->buildings.insert(building);
+    this->tileBuildings[this->index(x, y)] = handle;
+    this->markDirty(x, y, x, y);
     
-    this->gameBoard[x][y].setBuilding(&this->buildings.back());
+    if (building.controller() >= this->controlledBuildings.size())
+        this->controlledBuildings.resize(building.controller() + 1);
+    Board::addHandle(this->controlledBuildings[building.controller()], this->controlledBuildingPositions, handle);
+    
+    return handle;
 }
 
 std::string Board::deleteBuilding(unsigned int x, unsigned int y) {
-    if (x >= this->gameBoard.size()) {
+    if (x >= this->boardWidth) {
         throw std::range_error("X out of range: " + std::to_string(x));
     }
-    if (y >= this->gameBoard[x].size()) {
+    if (y >= this->boardHeight) {
         throw std::range_error("Y out of range: " + std::to_string(y));
     }
     
-    /* Note:
-     * The following for loop iterates through the list of board tiles with buildings until it finds the designated one, and it deletes it.
-     * It is known that this is incredibly inefficient.
-     * However, currently there are not too many board spaces that will have buildings for testing purposes.
-     
-     Ways to fix this in the future:
-     * Make a sort function to get the list sorted in a way that is easy to go through to find the right spot.
-     * Use std::optional<Building> instead of Building* in Tile.hpp
-     std::optional (or std::experimental::optional) may not have come out yet, which is a slight problem.
-     There were issues getting it to work on 2013 MacBook Pro in Xcode 7, without much trying
-     * Download and add the boost library optional functionality
-     */
+    //The tile holds the building's handle, so the building can be found and removed directly
+    SlotMap<Building>::Handle handle = this->tileBuildings[this->index(x, y)];
+    Building* building = this->buildings.get(handle);
     
-    std::string deathAction;
+    if (building == nullptr) //If there is no building at that location, nothing needs to be deleted
+        return "";
     
-    for (auto listIter = this->buildings.begin(); listIter != this->buildings.end(); listIter++) {
-        if (listIter->x() == x && listIter->y() == y) {
-            this->gameBoard[x][y].setBuilding(nullptr);
-            deathAction = listIter->deathAction;
-            this->buildings.erase(listIter); //Delete the building from the list if it is the specified creature.
-            break;
-        }
-    }
+    std::string deathAction = building->deathAction;
     
-    return deathAction;
+    Board::removeHandle(this->controlledBuildings[building->controller()], this->controlledBuildingPositions, handle);
+    
+    this->tileBuildings[this->index(x, y)] = SlotMap<Building>::null;
+    this->buildings.erase(handle);
+    this->markDirty(x, y, x, y);
     
-    //If no building is deleted in the loop, then there was no creature at that location, which is also fine.
+    return deathAction;
 }
 
 bool Board::setDirection(unsigned int x, unsigned int y, unsigned int direction) {
-    if (x >= this->gameBoard.size()) {
+    if (x >= this->boardWidth) {
         throw std::range_error("X out of range: " + std::to_string(x));
     }
-    if (y >= this->gameBoard[x].size()) {
+    if (y >= this->boardHeight) {
         throw std::range_error("Y out of range: " + std::to_string(y));
     }
     
-    if (this->gameBoard[x][y].creature() == nullptr)
+    Creature* creature = this->creatures.get(this->tileCreatures[this->index(x, y)]);
+    
+    if (creature == nullptr)
         return false;
     
     if (direction > 3)
         return false;
     
-    this->gameBoard[x][y].setDirection(direction);
+    creature->setDirection(direction);
+    this->markDirty(x, y, x, y, false);
     return true;
 }
 
 void Board::setDamage(unsigned int x, unsigned int y, unsigned int damage, float time) {
-    if (x >= this->gameBoard.size()) {
+    if (x >= this->boardWidth) {
         throw std::range_error("X out of range: " + std::to_string(x));
     }
-    if (y >= this->gameBoard[x].size()) {
+    if (y >= this->boardHeight) {
         throw std::range_error("Y out of range: " + std::to_string(y));
     }
     
-    this->gameBoard[x][y].setDamage(damage, time);
+    this->tileDamage[this->index(x, y)] = damage;
+    this->tileDamageTime[this->index(x, y)] = time;
+    this->markDirty(x, y, x, y, false);
 }
 
 unsigned int Board::tileDistances(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) const {
-    if (x1 >= this->gameBoard.size()) {
+    if (x1 >= this->boardWidth) {
         throw std::range_error("X1 out of range");
     }
-    if (y1 >= this->gameBoard[x1].size()) {
+    if (y1 >= this->boardHeight) {
         throw std::range_error("Y1 out of range");
     }
-    if (x2 >= this->gameBoard.size()) {
+    if (x2 >= this->boardWidth) {
         throw std::range_error("X2 out of range");
     }
-    if (y2 >= this->gameBoard[x2].size()) {
+    if (y2 >= this->boardHeight) {
         throw std::range_error("Y2 out of range");
     }
     
@@ -498,45 +577,40 @@ unsigned int Board::tileDistances(unsigned int x1, unsigned int y1, unsigned int
 }
 
 float Board::getTerrainMovementCost(const Tile& origin, const Tile& destination) const {
+    return this->terrainMovementCost(origin.creature(), destination.terrain());
+}
+
+float Board::getTerrainMovementCost(const TileView& origin, const TileView& destination) const {
+    return this->terrainMovementCost(origin.creature(), destination.terrain());
+}
+
+//The cost is in range, it deducts cost from range.
+float Board::getTerrainAttackCost (const Tile& origin, const Tile& destination) const {
+    return this->terrainAttackCost(origin.creature(), origin.terrain(), destination.terrain());
+}
+
+float Board::getTerrainAttackCost (const TileView& origin, const TileView& destination) const {
+    return this->terrainAttackCost(origin.creature(), origin.terrain(), destination.terrain());
+}
+
+//The cost is in range, it deducts cost from range.
+float Board::getTerrainVisionCost (const Tile& origin, const Tile& destination) const {
+    return this->terrainVisionCost(origin.creature(), origin.terrain(), destination.terrain());
+}
+
+float Board::getTerrainVisionCost (const TileView& origin, const TileView& destination) const {
+    return this->terrainVisionCost(origin.creature(), origin.terrain(), destination.terrain());
+}
+
+//The terrain costs themselves, shared by the Tile and TileView overloads above. Each is a single lookup in the board's terrain rules
+float Board::terrainMovementCost(const Creature* creature, unsigned int destinationTerrain) const {
     
-    /*if (origin.creature().characteristics().find(TerrainIgnoring) != std::string::npos) {
+    /*if (creature.characteristics().find(TerrainIgnoring) != std::string::npos) {
      return 1;
      }*/
     
-    if (destination.terrain() == OPEN_TERRAIN) {
-        return 1.0; //no creature currently requires more or less than one movement point
-    } else if (destination.terrain() == MOUNTAIN_TERRAIN) {
-        if (origin.creature()->race() != Dwarf) {
-            return 999.0;
-        } else return 2.0;
-    } else if (destination.terrain() == WATER_TERRAIN) {
-        /*if (origin.creature().find(Amphibious) != std::string::npos) {
-         return 999;
-         }
-         if (origin.creature().characteristics().find(Flying) != std::string::npos) {
-         return 999;
-         }
-         */
-        
-        //promotions and characteristics have not yet been implemented
-    } else if (destination.terrain() == FOREST_TERRAIN) {
-        if (origin.creature() != nullptr) {
-            if (origin.creature()->race() == Elf /* || origin.creature()->characteristics contains terrain ignoring, perhaps in array of bools?*/) {
-                return 1;
-            }
-        }
-        return 2.0;
-    } else if (destination.terrain() == HILL_TERRAIN) {
-        return 2.0; //no creature currently requires more or less than two movement points
-        
-    } else if (destination.terrain() == SWAMP_TERRAIN) {
-        return 3.0; //no creature currently requires more or less than two movement points
-        
-    } else if (destination.terrain() == ROAD_TERRAIN) {
-        return 0.5;
-    }
-    
-    return 1.0;
+    //Costs without a creature are the same as for humans, who have no terrain bonuses
+    return this->rules.movementCost(destinationTerrain, creature != nullptr ? creature->race() : Human);
 }
 
 
@@ -578,32 +652,13 @@ float Board::getTerrainMovementCost(const Tile& origin, const Tile& destination)
 
 
 //The cost is in range, it deducts cost from range.
-float Board::getTerrainAttackCost (const Tile& origin, const Tile& destination) const {
-    
-    if (origin.terrain() == HILL_TERRAIN && destination.terrain() != MOUNTAIN_TERRAIN) {
-        return 1;
-    }
-    else if (destination.terrain() == MOUNTAIN_TERRAIN) {
-        return INT_MAX;
-    }
-    else if (destination.terrain() == FOREST_TERRAIN || destination.terrain() == HILL_TERRAIN) {
-        return 2;
-    }
-    else return 1;
+float Board::terrainAttackCost(const Creature* creature, unsigned int originTerrain, unsigned int destinationTerrain) const {
+    return this->rules.attackCost(originTerrain, destinationTerrain, creature != nullptr ? creature->attackStyle() : Melee);
 }
 
 //The cost is in range, it deducts cost from range.
-float Board::getTerrainVisionCost (const Tile& origin, const Tile& destination) const {
-    if (origin.terrain() == HILL_TERRAIN && destination.terrain() != MOUNTAIN_TERRAIN) {
-        return 1;
-    }
-    else if (destination.terrain() == MOUNTAIN_TERRAIN) {
-        return INT_MAX;
-    }
-    else if (destination.terrain() == FOREST_TERRAIN || destination.terrain() == HILL_TERRAIN) {
-        return 2;
-    }
-    else return 1;
+float Board::terrainVisionCost(const Creature*, unsigned int originTerrain, unsigned int destinationTerrain) const {
+    return this->rules.visionCost(originTerrain, destinationTerrain);
 }
 
 
@@ -666,39 +721,61 @@ float Board::calculateFlankingBonus(const Tile& attacker, const Tile& defender)
 
 //Calculate terrain modifier for combat
 float Board::calculateTerrainModifier(const Tile& defender) const {
-    if (defender.terrain() ==  OPEN_TERRAIN) {
-        return 0.00;
-    }
-    if (defender.terrain() ==  FOREST_TERRAIN) {
-        return 0.20;
-    }
-    if (defender.terrain() ==  SWAMP_TERRAIN) {
-        return -0.20;
-    }
-    if (defender.terrain() ==  HILL_TERRAIN) {
-        return 0.25;
-    }
-    if (defender.terrain() ==  ROAD_TERRAIN) {
-        return 0.00;
-    }
-    if (defender.terrain() ==  WATER_TERRAIN) {
-        return 0.00;
-    }
-    if (defender.terrain() ==  MOUNTAIN_TERRAIN) {
-        return 0.50;
-    }
-    return 0.00;
+    return this->rules.defenseModifier(defender.terrain());
 };
 
 Tile Board::get(unsigned int x, unsigned int y) const {
-    if (x >= this->gameBoard.size()) {
+    if (x >= this->boardWidth) {
+        throw std::range_error("X out of range: " + std::to_string(x));
+    }
+    if (y >= this->boardHeight) {
+        throw std::range_error("Y out of range: " + std::to_string(y));
+    }
+    
+    //Assemble the tile from the tile arrays
+    return this->viewUnchecked(x, y).tile();
+}
+
+Creature* Board::creature(SlotMap<Creature>::Handle handle) {
+    return this->creatures.get(handle);
+}
+
+Building* Board::building(SlotMap<Building>::Handle handle) {
+    return this->buildings.get(handle);
+}
+
+const std::vector<SlotMap<Creature>::Handle>& Board::creaturesControlledBy(unsigned int controller) const {
+    static const std::vector<SlotMap<Creature>::Handle> noCreatures;
+    return controller < this->controlledCreatures.size() ? this->controlledCreatures[controller] : noCreatures;
+}
+
+const std::vector<SlotMap<Building>::Handle>& Board::buildingsControlledBy(unsigned int controller) const {
+    static const std::vector<SlotMap<Building>::Handle> noBuildings;
+    return controller < this->controlledBuildings.size() ? this->controlledBuildings[controller] : noBuildings;
+}
+
+const std::vector<SlotMap<Creature>::Handle>& Board::animatingCreatures(unsigned int controller) const {
+    static const std::vector<SlotMap<Creature>::Handle> noCreatures;
+    return controller < this->controlledAnimating.size() ? this->controlledAnimating[controller] : noCreatures;
+}
+
+const std::vector<SlotMap<Creature>::Handle>& Board::animatingCreatures() const {
+    return this->animating;
+}
+
+const Visibility& Board::visibility(unsigned int player) const {
+    return player < this->playerVisibility.size() ? this->playerVisibility[player] : this->noVisibility;
+}
+
+TileView Board::view(unsigned int x, unsigned int y) const {
+    if (x >= this->boardWidth) {
         throw std::range_error("X out of range: " + std::to_string(x));
     }
-    if (y >= this->gameBoard[x].size()) {
+    if (y >= this->boardHeight) {
         throw std::range_error("Y out of range: " + std::to_string(y));
     }
     
-    return this->gameBoard[x][y];
+    return TileView(this, x, y);
 }
 
 bool Board::destinationInRange(glm::ivec2 destination, glm::ivec2 currentLoc) const {
@@ -708,24 +785,15 @@ bool Board::destinationInRange(glm::ivec2 destination, glm::ivec2 currentLoc) co
         throw std::range_error("Invalid currentLoc");
     }
     
-    Creature *creature = this->get(currentLoc.x, currentLoc.y).creature();
+    Creature *creature = this->viewUnchecked(currentLoc.x, currentLoc.y).creature();
     
     if (creature == nullptr) {
         throw std::invalid_argument("No creature at currentLoc");
-    } else if (!this->get(destination.x, destination.y).passableByCreature(*creature)) {
+    } else if (!this->viewUnchecked(destination.x, destination.y).passableByCreature(*creature)) {
         throw std::invalid_argument("Destination not passable by creature");
     }
     
-    std::vector<Tile> tiles = this->getReachableTiles(this->get(currentLoc.x, currentLoc.y));
-    
-    for (int a = 0; a < tiles.size(); a++) {
-        if (destination.x == tiles[a].x() && destination.y == tiles[a].y()) { //If the destination is within the reachable tiles, return true
-            return true;
-        }
-    }
-    
-    //If it could not be found, return false
-    return false;
+    return this->getTacticalMap(currentLoc.x, currentLoc.y).reachable.test(destination.x, destination.y);
 }
 
 bool Board::attackInRange(glm::ivec2 destination, glm::ivec2 currentLoc) const {
@@ -735,86 +803,193 @@ bool Board::attackInRange(glm::ivec2 destination, glm::ivec2 currentLoc) const {
         throw std::range_error("Invalid currentLoc");
     }
     
-    Creature *creature = this->get(currentLoc.x, currentLoc.y).creature();
+    Creature *creature = this->viewUnchecked(currentLoc.x, currentLoc.y).creature();
     
     if (creature == nullptr) {
         throw std::invalid_argument("No creature at currentLoc");
-    } else if (this->get(destination.x, destination.y).creature() == nullptr && this->get(destination.x, destination.y).building() == nullptr) {
+    } else if (!this->viewUnchecked(destination.x, destination.y).occupied()) {
         throw std::invalid_argument("No creature or building at attack location");
     }
     
-    std::vector<Tile> tiles = this->getAttackableTiles(this->get(currentLoc.x, currentLoc.y));
+    return this->getTacticalMap(currentLoc.x, currentLoc.y).attackable.test(destination.x, destination.y);
+}
+
+std::vector<Tile> Board::getReachableTiles(const Tile& creatureTile) const {
+    std::vector<std::pair<TileView, float> > reachedTiles = this->getReachableTilesWithEnergy(creatureTile.x(), creatureTile.y());
+    
+    //Now turn the reached tile vector of pairs into a vector of just tiles
+    std::vector<Tile> reachedTileReturnVector;
+    reachedTileReturnVector.reserve(reachedTiles.size());
     
-    for (int a = 0; a < tiles.size(); a++) {
-        if (destination.x == tiles[a].x() && destination.y == tiles[a].y()) { //If the destination is within the reachable tiles, return true
-            return true;
-        }
+    for (int tileIterator = 0; tileIterator < reachedTiles.size(); tileIterator++) {
+        reachedTileReturnVector.push_back(reachedTiles[tileIterator].first.tile());
     }
     
-    //If it could not be found, return false
-    return false;
+    return reachedTileReturnVector;
 }
 
-std::vector<Tile> Board::getReachableTiles(const Tile& creatureTile) const {
-    //Set the selected tile as the one inputted
-    //    glm::ivec2 currentTile = glm::ivec2(creatureTile.x(), creatureTile.y());
+std::vector<std::pair<TileView, float> > Board::getReachableTilesWithEnergy(unsigned int x, unsigned int y) const {
+    std::vector<std::pair<TileView, float> > reachedTiles;
     
-    if (creatureTile.creature() == nullptr) {
-        std::vector<Tile> emptyTileVector;
-        return emptyTileVector;
-    } else {
-        Creature *creature = creatureTile.creature();
-        
-        std::vector<std::pair<Tile, int> > reachedTiles; //This is a vector containing the tiles found so far, along with the energy the creature has at that tile
-        
-        //Gets the tiles that are reachable by the creature
-        reachedTiles.push_back(std::pair<Tile, int>(creatureTile, creatureTile.creature()->energy()));
-        
-        //Keep pushing the vector back with new tiles, that the for loop will eventually go through
-        for (int tileIterator = 0; tileIterator < reachedTiles.size(); tileIterator++) {
-            if (reachedTiles[tileIterator].second > 0) { //If a creature at this spot would be able to continue to move further, expand in the four directions from that tile.
-                
-                Tile tile = reachedTiles[tileIterator].first;
+    Creature* creature = this->view(x, y).creature();
+    
+    if (creature == nullptr)
+        return reachedTiles;
+    
+    //All costs are in fixed point, so that fractional terrain costs (roads) add up exactly. See Board::movementCostScale
+    unsigned int budget = (unsigned int)creature->energy() * Board::movementCostScale;
+    
+    this->resetSearch();
+    if (this->searchBuckets.size() < budget + 1)
+        this->searchBuckets.resize(budget + 1);
+    
+    unsigned int origin = this->index(x, y);
+    this->searchCost[origin] = 0;
+    this->searchTouched.push_back(origin);
+    this->searchBuckets[0].push_back(origin);
+    
+    //Go through the buckets in order of energy spent. Every cost is at least one unit, so a tile is final once its bucket is reached
+    for (unsigned int spent = 0; spent <= budget; spent++) {
+        for (int a = 0; a < this->searchBuckets[spent].size(); a++) {
+            unsigned int tileIndex = this->searchBuckets[spent][a];
+            
+            if (this->searchCost[tileIndex] != spent) //A cheaper way to this tile was already expanded
+                continue;
+            
+            unsigned int tileX = tileIndex / this->boardHeight;
+            unsigned int tileY = tileIndex % this->boardHeight;
+            
+            reachedTiles.push_back(std::pair<TileView, float>(this->viewUnchecked(tileX, tileY), (float)(budget - spent) / Board::movementCostScale));
+            
+            //North, east, south and west
+            glm::ivec2 neighbors[4] = {glm::ivec2(tileX, (int)tileY - 1), glm::ivec2((int)tileX - 1, tileY), glm::ivec2(tileX, tileY + 1), glm::ivec2(tileX + 1, tileY)};
+            
+            for (int b = 0; b < 4; b++) {
+                if (!this->validTile(neighbors[b]))
+                    continue;
                 
-                //North
-                if (tile.y() > 0) {
-                    if (this->get(tile.x(), tile.y() - 1).passableByCreature(*creature) && reachedTiles[tileIterator].second >= this->getTerrainMovementCost(this->get(tile.x(), tile.y()), this->get(tile.x(), tile.y() - 1))) {
-                        reachedTiles.push_back(std::pair<Tile, int>(this->get(tile.x(), tile.y() - 1), reachedTiles[tileIterator].second - this->getTerrainMovementCost(this->get(tile.x(), tile.y()), this->get(tile.x(), tile.y() - 1)))); //Add the found tile to the reached tiles, along with the value of the energy the creature would have - 1.
-                    }
-                }
+                TileView neighbor = this->viewUnchecked(neighbors[b].x, neighbors[b].y);
                 
-                //East
-                if (tile.x() > 0) {
-                    if (this->get(tile.x() - 1, tile.y()).passableByCreature(*creature) && reachedTiles[tileIterator].second >= this->getTerrainMovementCost(this->get(tile.x(), tile.y()), this->get(tile.x() - 1, tile.y()))) {
-                        reachedTiles.push_back(std::pair<Tile, int>(this->get(tile.x() - 1, tile.y()), reachedTiles[tileIterator].second - this->getTerrainMovementCost(this->get(tile.x(), tile.y()), this->get(tile.x() - 1, tile.y())))); //Add the found tile to the reached tiles, along with the value of the energy the creature would have - 1.
-                    }
-                }
+                if (!neighbor.passableByCreature(*creature))
+                    continue;
                 
-                //South
-                if (tile.y() < this->height(tile.x()) - 1) {
-                    if (this->get(tile.x(), tile.y() + 1).passableByCreature(*creature) && reachedTiles[tileIterator].second >= this->getTerrainMovementCost(this->get(tile.x(), tile.y()), this->get(tile.x(), tile.y() + 1))) {
-                        reachedTiles.push_back(std::pair<Tile, int>(this->get(tile.x(), tile.y() + 1), reachedTiles[tileIterator].second - this->getTerrainMovementCost(this->get(tile.x(), tile.y()), this->get(tile.x(), tile.y() + 1)))); //Add the found tile to the reached tiles, along with the value of the energy the creature would have - 1.
-                    }
-                }
+                //The moving creature is used for every step, so that race bonuses apply along the whole path
+                unsigned int cost = spent + (unsigned int)round(this->terrainMovementCost(creature, neighbor.terrain()) * Board::movementCostScale);
+                unsigned int neighborIndex = this->index(neighbors[b].x, neighbors[b].y);
                 
-                //West
-                if (tile.x() < this->width() - 1) {
-                    if (this->get(tile.x() + 1, tile.y()).passableByCreature(*creature) && reachedTiles[tileIterator].second >= this->getTerrainMovementCost(this->get(tile.x(), tile.y()), this->get(tile.x() + 1, tile.y()))) {
-                        reachedTiles.push_back(std::pair<Tile, int>(this->get(tile.x() + 1, tile.y()), reachedTiles[tileIterator].second - this->getTerrainMovementCost(this->get(tile.x(), tile.y()), this->get(tile.x() + 1, tile.y())))); //Add the found tile to the reached tiles, along with the value of the energy the creature would have - 1.
-                    }
+                if (cost <= budget && cost < this->searchCost[neighborIndex]) {
+                    if (this->searchCost[neighborIndex] == UINT_MAX)
+                        this->searchTouched.push_back(neighborIndex);
+                    this->searchCost[neighborIndex] = cost;
+                    this->searchBuckets[cost].push_back(neighborIndex);
                 }
             }
         }
+        this->searchBuckets[spent].clear();
+    }
+    
+    return reachedTiles;
+}
+
+std::vector<unsigned int> Board::getPath(unsigned int x, unsigned int y, unsigned int destinationX, unsigned int destinationY) const {
+    std::vector<unsigned int> directions;
+    
+    if (!this->validTile(glm::ivec2(x, y)) || !this->validTile(glm::ivec2(destinationX, destinationY)))
+        return directions;
+    
+    Creature* creature = this->viewUnchecked(x, y).creature();
+    
+    if (creature == nullptr || !this->viewUnchecked(destinationX, destinationY).passableByCreature(*creature))
+        return directions;
+    
+    unsigned int budget = (unsigned int)creature->energy() * Board::movementCostScale;
+    unsigned int origin = this->index(x, y);
+    unsigned int destination = this->index(destinationX, destinationY);
+    
+    //The heuristic is the taxicab distance times the cheapest step the creature's race can take on any terrain, so it never overestimates
+    unsigned int cheapestStep = (unsigned int)round(this->rules.cheapestMovementCost(creature->race()) * Board::movementCostScale);
+    
+    this->resetSearch();
+    this->searchOpen.clear();
+    
+    this->searchCost[origin] = 0;
+    this->searchParent[origin] = origin;
+    this->searchTouched.push_back(origin);
+    this->searchOpen.push_back(std::pair<unsigned int, unsigned int>(this->tileDistances(x, y, destinationX, destinationY) * cheapestStep, origin));
+    
+    //The open set is a min-heap of (estimated total cost, tile index). Entries are not removed when a tile gets cheaper, so outdated ones are skipped when popped
+    std::greater<std::pair<unsigned int, unsigned int> > heapOrder;
+    
+    bool found = false;
+    
+    while (this->searchOpen.size() > 0) {
+        std::pop_heap(this->searchOpen.begin(), this->searchOpen.end(), heapOrder);
+        std::pair<unsigned int, unsigned int> current = this->searchOpen.back();
+        this->searchOpen.pop_back();
+        
+        unsigned int tileIndex = current.second;
+        unsigned int tileX = tileIndex / this->boardHeight;
+        unsigned int tileY = tileIndex % this->boardHeight;
+        
+        if (current.first != this->searchCost[tileIndex] + this->tileDistances(tileX, tileY, destinationX, destinationY) * cheapestStep)
+            continue; //Outdated entry, the tile has already been expanded with a lower cost
+        
+        if (tileIndex == destination) {
+            found = true;
+            break;
+        }
         
-        //Now turn the reached tile vector of pairs into a vector of just tiles
-        std::vector<Tile> reachedTileReturnVector;
+        //North, east, south and west
+        glm::ivec2 neighbors[4] = {glm::ivec2(tileX, (int)tileY - 1), glm::ivec2((int)tileX - 1, tileY), glm::ivec2(tileX, tileY + 1), glm::ivec2(tileX + 1, tileY)};
         
-        for (int tileIterator = 0; tileIterator < reachedTiles.size(); tileIterator++) {
-            reachedTileReturnVector.push_back(reachedTiles[tileIterator].first);
+        for (int b = 0; b < 4; b++) {
+            if (!this->validTile(neighbors[b]))
+                continue;
+            
+            TileView neighbor = this->viewUnchecked(neighbors[b].x, neighbors[b].y);
+            
+            if (!neighbor.passableByCreature(*creature))
+                continue;
+            
+            unsigned int cost = this->searchCost[tileIndex] + (unsigned int)round(this->terrainMovementCost(creature, neighbor.terrain()) * Board::movementCostScale);
+            unsigned int neighborIndex = this->index(neighbors[b].x, neighbors[b].y);
+            
+            if (cost <= budget && cost < this->searchCost[neighborIndex]) {
+                if (this->searchCost[neighborIndex] == UINT_MAX)
+                    this->searchTouched.push_back(neighborIndex);
+                this->searchCost[neighborIndex] = cost;
+                this->searchParent[neighborIndex] = tileIndex;
+                
+                this->searchOpen.push_back(std::pair<unsigned int, unsigned int>(cost + this->tileDistances(neighbors[b].x, neighbors[b].y, destinationX, destinationY) * cheapestStep, neighborIndex));
+                std::push_heap(this->searchOpen.begin(), this->searchOpen.end(), heapOrder);
+            }
         }
+    }
+    
+    if (!found)
+        return directions;
+    
+    //Follow the parents back from the destination, then reverse to get the directions from the origin
+    for (unsigned int tileIndex = destination; tileIndex != origin; tileIndex = this->searchParent[tileIndex]) {
+        unsigned int parent = this->searchParent[tileIndex];
+        
+        //Compared by coordinates, since on a board one tile high a step in x and a step in y change the index by the same amount
+        unsigned int tileX = tileIndex / this->boardHeight, tileY = tileIndex % this->boardHeight;
+        unsigned int parentX = parent / this->boardHeight, parentY = parent % this->boardHeight;
         
-        return reachedTileReturnVector;
+        if (tileY + 1 == parentY) {
+            directions.push_back(NORTH);
+        } else if (tileX + 1 == parentX) {
+            directions.push_back(EAST);
+        } else if (tileY == parentY + 1) {
+            directions.push_back(SOUTH);
+        } else {
+            directions.push_back(WEST);
+        }
     }
+    std::reverse(directions.begin(), directions.end());
+    
+    return directions;
 }
 
 /*
@@ -826,94 +1001,17 @@ std::vector<Tile> Board::getReachableTiles(const Tile& creatureTile) const {
 
 //This function needs to be reworked for longer ranges. Perhaps, for each tile, check if there is a blocking obstacle in the way. Draw a line from origin to attack point, if it intersects with the boundaries of an obstacle the attack is not possible. Currently, projectiles can navigate around obstacles.
 std::vector<Tile> Board::getAttackableTiles(const Tile& creatureTile) const {
-    if (creatureTile.creature() == nullptr) {
-        std::vector<Tile> emptyTileVector;
-        return emptyTileVector;
-    } else {
-        
-        bool tileChecked[this->gameBoard.size()][this->gameBoard[0].size()];
-        for (int x = 0; x < this->gameBoard.size(); x++) {
-            for (int y = 0; y < this->gameBoard[0].size(); y++) {
-                tileChecked[x][y] = false;
-            }
-        }
-        
-        Creature *creature = creatureTile.creature();
-        
-        if (creature->energy() <= 0) {
-            std::vector<Tile> emptyTileVector;
-            return emptyTileVector;
-        }
-        
-        std::vector<std::pair<Tile, int> > reachedTiles; //This is a vector containing the tiles found so far, along with the remaining range the attack has at that tile
-        
-        std::vector<Tile> attackableTiles; //A vector of the tiles that can be attacked
-        
-        reachedTiles.push_back(std::pair<Tile, int>(creatureTile, creatureTile.creature()->range()));
-        
-        //Keep pushing the vector back with new tiles, that the for loop will eventually go through
-        for (int tileIterator = 0; tileIterator < reachedTiles.size(); tileIterator++) {
-            if (reachedTiles[tileIterator].second > 0) { //If an attack at this spot would be able to continue to move further, expand in the four directions from that tile.
-                
-                Tile tile = reachedTiles[tileIterator].first;
-                
-                //North
-                if (tile.y() > 0) {
-                    if (this->get(tile.x(), tile.y() - 1).passableByAttackStyle(*creature) && !tileChecked[tile.x()][tile.y() - 1]) {
-                        reachedTiles.push_back(std::pair<Tile, int>(this->get(tile.x(), tile.y() - 1), reachedTiles[tileIterator].second - this->getTerrainAttackCost(this->get(tile.x(), tile.y()), this->get(tile.x(), tile.y() - 1)))); //Add the found tile to the reached tiles, along with the remaining range the creature would have - 1.
-                        tileChecked[tile.x()][tile.y() - 1] = true;
-                    }
-                    if (this->get(tile.x(), tile.y() - 1).occupied() && !tileChecked[tile.x()][tile.y() - 1]) {
-                        attackableTiles.push_back(this->get(tile.x(), tile.y() - 1)); //Add the found tile to the vector of attackable tiles
-                        tileChecked[tile.x()][tile.y() - 1] = true;
-                    }
-                }
-                
-                //East
-                if (tile.x() > 0) {
-                    if (this->get(tile.x() - 1, tile.y()).passableByAttackStyle(*creature) && !tileChecked[tile.x() - 1][tile.y()]) {
-                        reachedTiles.push_back(std::pair<Tile, int>(this->get(tile.x() - 1, tile.y()), reachedTiles[tileIterator].second - this->getTerrainAttackCost(this->get(tile.x(), tile.y()), this->get(tile.x() - 1, tile.y())))); //Add the found tile to the reached tiles, along with the remaining range the creature would have - 1.
-                        tileChecked[tile.x() - 1][tile.y()] = true;
-                    }
-                    if (this->get(tile.x() - 1, tile.y()).occupied() && !tileChecked[tile.x() - 1][tile.y()]) {
-                        attackableTiles.push_back(this->get(tile.x() - 1, tile.y())); //Add the found tile to the vector of attackable tiles
-                        tileChecked[tile.x() - 1][tile.y()] = true;
-                    }
-                }
-                
-                //South
-                if (tile.y() < this->height(tile.x()) - 1) {
-                    if (this->get(tile.x(), tile.y() + 1).passableByAttackStyle(*creature) && !tileChecked[tile.x()][tile.y() + 1]) {
-                        reachedTiles.push_back(std::pair<Tile, int>(this->get(tile.x(), tile.y() + 1), reachedTiles[tileIterator].second - this->getTerrainAttackCost(this->get(tile.x(), tile.y()), this->get(tile.x(), tile.y() + 1)))); //Add the found tile to the reached tiles, along with the remaining range the creature would have - 1.
-                        tileChecked[tile.x()][tile.y() + 1] = true;
-                    }
-                    if (this->get(tile.x(), tile.y() + 1).occupied() && !tileChecked[tile.x()][tile.y() + 1]) {
-                        attackableTiles.push_back(this->get(tile.x(), tile.y() + 1)); //Add the found tile to the vector of attackable tiles
-                        tileChecked[tile.x()][tile.y() + 1] = true;
-                    }
-                }
-                
-                //West
-                if (tile.x() < this->width() - 1) {
-                    if (this->get(tile.x() + 1, tile.y()).passableByAttackStyle(*creature) && !tileChecked[tile.x() + 1][tile.y()]) {
-                        reachedTiles.push_back(std::pair<Tile, int>(this->get(tile.x() + 1, tile.y()), reachedTiles[tileIterator].second - this->getTerrainAttackCost(this->get(tile.x(), tile.y()), this->get(tile.x() + 1, tile.y())))); //Add the found tile to the reached tiles, along with the remaining range the creature would have - 1.
-                        tileChecked[tile.x() + 1][tile.y()] = true;
-                    }
-                    if (this->get(tile.x() + 1, tile.y()).occupied() && !tileChecked[tile.x() + 1][tile.y()]) {
-                        attackableTiles.push_back(this->get(tile.x() + 1, tile.y())); //Add the found tile to the vector of attackable tiles
-                        tileChecked[tile.x() + 1][tile.y()] = true;
-                    }
-                }
-            }
-        }
-        
-        for (int tileIterator = 0; tileIterator < reachedTiles.size(); tileIterator++) {
-            attackableTiles.push_back(reachedTiles[tileIterator].first);
-        }
-        
-        return attackableTiles;
+    std::vector<glm::ivec2> positions = this->getTacticalMap(creatureTile.x(), creatureTile.y()).attackable.tiles();
+    
+    std::vector<Tile> attackableTiles;
+    attackableTiles.reserve(positions.size());
+    
+    for (int a = 0; a < positions.size(); a++) {
+        attackableTiles.push_back(this->viewUnchecked(positions[a].x, positions[a].y).tile());
     }
     
+    return attackableTiles;
+    
     /*if (creatureTile.creature() == nullptr) {
      std::vector<Tile> emptyTileVector;
      return emptyTileVector;
@@ -985,83 +1083,183 @@ std::vector<Tile> Board::getAttackableTiles(const Tile& creatureTile) const {
 }
 
 std::vector<Tile> Board::getVisibleTiles(const Tile& creatureTile) const {
-    if (creatureTile.creature() == nullptr) {
-        std::vector<Tile> emptyTileVector;
-        return emptyTileVector;
-    } else {
-        Creature *creature = creatureTile.creature();
+    std::vector<glm::ivec2> positions = this->getTacticalMap(creatureTile.x(), creatureTile.y()).visible.tiles();
+    
+    std::vector<Tile> visibleTiles;
+    visibleTiles.reserve(positions.size());
+    
+    for (int a = 0; a < positions.size(); a++) {
+        visibleTiles.push_back(this->viewUnchecked(positions[a].x, positions[a].y).tile());
+    }
+    
+    return visibleTiles;
+}
+
+TacticalMap Board::getTacticalMap(unsigned int x, unsigned int y) const {
+    TacticalMap map(this->boardWidth, this->boardHeight);
+    
+    SlotMap<Creature>::Handle handle = this->view(x, y).creatureHandle();
+    Creature* creature = this->view(x, y).creature();
+    
+    if (creature == nullptr)
+        return map;
+    
+    unsigned int origin = this->index(x, y);
+    
+    //Reuse the creature's cached map if nothing has changed near it since it was found
+    int cacheEntry = -1;
+    for (int a = 0; a < this->tacticalMapCache.size(); a++) {
+        if (this->tacticalMapCache[a].creature == handle) {
+            if (this->tacticalMapCache[a].origin == origin && !this->changedSince(this->tacticalMapCache[a].map.version, this->tacticalMapCache[a].footprint))
+                return this->tacticalMapCache[a].map;
+            
+            cacheEntry = a;
+            break;
+        }
+    }
+    
+    //Movement is in fixed point like the other movement searches. Attacks and vision count down whole tiles of range
+    unsigned int budget = (unsigned int)creature->energy() * Board::movementCostScale;
+    
+    this->resetSearch();
+    
+    this->searchCost[origin] = 0;
+    this->searchAttack[origin] = creature->energy() > 0 ? creature->range() : -1; //Creatures without energy cannot attack
+    this->searchVision[origin] = creature->vision();
+    this->searchTouched.push_back(origin);
+    
+    //Each tile keeps the best value of all three searches, and is put back in the queue whenever one of them improves, until nothing changes
+    this->searchQueue.clear();
+    this->searchQueue.push_back(origin);
+    this->searchQueued[origin] = true;
+    
+    for (int queueIterator = 0; queueIterator < this->searchQueue.size(); queueIterator++) {
+        unsigned int tileIndex = this->searchQueue[queueIterator];
+        this->searchQueued[tileIndex] = false;
         
-        std::vector<std::pair<Tile, int> > reachedTiles; //This is a vector containing the tiles found so far, along with the remaining range the attack has at that tile
+        unsigned int tileX = tileIndex / this->boardHeight;
+        unsigned int tileY = tileIndex % this->boardHeight;
+        unsigned int terrain = this->tileTerrain[tileIndex];
         
-        std::vector<Tile> visibleTiles; //A vector of the tiles that can be attacked
+        unsigned int cost = this->searchCost[tileIndex];
+        int attackRange = this->searchAttack[tileIndex];
+        int visionRange = this->searchVision[tileIndex];
         
-        reachedTiles.push_back(std::pair<Tile, int>(creatureTile, creatureTile.creature()->range()));
+        //North, east, south and west
+        glm::ivec2 neighbors[4] = {glm::ivec2(tileX, (int)tileY - 1), glm::ivec2((int)tileX - 1, tileY), glm::ivec2(tileX, tileY + 1), glm::ivec2(tileX + 1, tileY)};
         
-        //Keep pushing the vector back with new tiles, that the for loop will eventually go through
-        for (int tileIterator = 0; tileIterator < reachedTiles.size(); tileIterator++) {
-            if (reachedTiles[tileIterator].second > 0) { //If an attack at this spot would be able to continue to move further, expand in the four directions from that tile.
-                
-                Tile tile = reachedTiles[tileIterator].first;
-                
-                //North
-                if (tile.y() > 0) {
-                    if (this->get(tile.x(), tile.y() - 1).passableByVision(*creature)) {
-                        reachedTiles.push_back(std::pair<Tile, int>(this->get(tile.x(), tile.y() - 1), reachedTiles[tileIterator].second - this->getTerrainVisionCost(this->get(tile.x(), tile.y()), this->get(tile.x(), tile.y() - 1)))); //Add the found tile to the reached tiles, along with the remaining range the creature would have - 1.
-                    }
-                    if (this->get(tile.x(), tile.y() - 1).occupied()) {
-                        visibleTiles.push_back(this->get(tile.x(), tile.y() - 1)); //Add the found tile to the vector of attackable tiles
-                    }
-                }
+        for (int b = 0; b < 4; b++) {
+            if (!this->validTile(neighbors[b]))
+                continue;
+            
+            TileView neighbor = this->viewUnchecked(neighbors[b].x, neighbors[b].y);
+            unsigned int neighborIndex = this->index(neighbors[b].x, neighbors[b].y);
+            
+            bool untouched = this->searchCost[neighborIndex] == UINT_MAX && this->searchAttack[neighborIndex] < 0 && this->searchVision[neighborIndex] < 0;
+            bool improved = false;
+            
+            //Movement: the creature needs enough energy for the whole path
+            if (cost < budget && neighbor.passableByCreature(*creature)) {
+                unsigned int newCost = cost + (unsigned int)round(this->terrainMovementCost(creature, neighbor.terrain()) * Board::movementCostScale);
                 
-                //East
-                if (tile.x() > 0) {
-                    if (this->get(tile.x() - 1, tile.y()).passableByVision(*creature)) {
-                        reachedTiles.push_back(std::pair<Tile, int>(this->get(tile.x() - 1, tile.y()), reachedTiles[tileIterator].second - this->getTerrainVisionCost(this->get(tile.x(), tile.y()), this->get(tile.x() - 1, tile.y())))); //Add the found tile to the reached tiles, along with the remaining range the creature would have - 1.
-                    }
-                    if (this->get(tile.x() - 1, tile.y()).occupied()) {
-                        visibleTiles.push_back(this->get(tile.x() - 1, tile.y())); //Add the found tile to the vector of attackable tiles
-                    }
+                if (newCost <= budget && newCost < this->searchCost[neighborIndex]) {
+                    this->searchCost[neighborIndex] = newCost;
+                    improved = true;
                 }
-                
-                //South
-                if (tile.y() < this->height(tile.x()) - 1) {
-                    if (this->get(tile.x(), tile.y() + 1).passableByVision(*creature)) {
-                        reachedTiles.push_back(std::pair<Tile, int>(this->get(tile.x(), tile.y() + 1), reachedTiles[tileIterator].second - this->getTerrainVisionCost(this->get(tile.x(), tile.y()), this->get(tile.x(), tile.y() + 1)))); //Add the found tile to the reached tiles, along with the remaining range the creature would have - 1.
-                    }
-                    if (this->get(tile.x(), tile.y() + 1).occupied()) {
-                        visibleTiles.push_back(this->get(tile.x(), tile.y() + 1)); //Add the found tile to the vector of attackable tiles
+            }
+            
+            //Attack: an attack with range left reaches the tile. It only continues through terrain the attack style can pass, but creatures and buildings behind other terrain can still be hit
+            if (attackRange > 0) {
+                if (neighbor.passableByAttackStyle(*creature)) {
+                    float attackCost = this->terrainAttackCost(creature, terrain, neighbor.terrain());
+                    int newRange = attackCost >= attackRange ? 0 : attackRange - (int)attackCost;
+                    
+                    if (newRange > this->searchAttack[neighborIndex]) {
+                        this->searchAttack[neighborIndex] = newRange;
+                        improved = true;
                     }
+                } else if (neighbor.occupied() && this->searchAttack[neighborIndex] < 0) {
+                    this->searchAttack[neighborIndex] = 0;
                 }
+            }
+            
+            //Vision
+            if (visionRange > 0 && neighbor.passableByVision(*creature)) {
+                float visionCost = this->terrainVisionCost(creature, terrain, neighbor.terrain());
+                int newRange = visionCost >= visionRange ? 0 : visionRange - (int)visionCost;
                 
-                //West
-                if (tile.x() < this->width() - 1) {
-                    if (this->get(tile.x() + 1, tile.y()).passableByVision(*creature)) {
-                        reachedTiles.push_back(std::pair<Tile, int>(this->get(tile.x() + 1, tile.y()), reachedTiles[tileIterator].second - this->getTerrainVisionCost(this->get(tile.x(), tile.y()), this->get(tile.x() + 1, tile.y())))); //Add the found tile to the reached tiles, along with the remaining range the creature would have - 1.
-                    }
-                    if (this->get(tile.x() + 1, tile.y()).occupied()) {
-                        visibleTiles.push_back(this->get(tile.x() + 1, tile.y())); //Add the found tile to the vector of attackable tiles
-                    }
+                if (newRange > this->searchVision[neighborIndex]) {
+                    this->searchVision[neighborIndex] = newRange;
+                    improved = true;
                 }
             }
+            
+            if (untouched && (this->searchCost[neighborIndex] != UINT_MAX || this->searchAttack[neighborIndex] >= 0 || this->searchVision[neighborIndex] >= 0))
+                this->searchTouched.push_back(neighborIndex);
+            
+            if (improved && !this->searchQueued[neighborIndex]) {
+                this->searchQueue.push_back(neighborIndex);
+                this->searchQueued[neighborIndex] = true;
+            }
         }
+    }
+    
+    //Only the touched tiles can be in any of the sets
+    Region footprint = {x, y, x, y};
+    
+    for (int a = 0; a < this->searchTouched.size(); a++) {
+        unsigned int tileIndex = this->searchTouched[a];
+        unsigned int tileX = tileIndex / this->boardHeight;
+        unsigned int tileY = tileIndex % this->boardHeight;
+        
+        if (this->searchCost[tileIndex] != UINT_MAX)
+            map.reachable.set(tileX, tileY);
+        if (this->searchAttack[tileIndex] >= 0)
+            map.attackable.set(tileX, tileY);
+        if (this->searchVision[tileIndex] >= 0)
+            map.visible.set(tileX, tileY);
         
-        return visibleTiles;
+        footprint.minX = std::min(footprint.minX, tileX);
+        footprint.minY = std::min(footprint.minY, tileY);
+        footprint.maxX = std::max(footprint.maxX, tileX);
+        footprint.maxY = std::max(footprint.maxY, tileY);
     }
     
+    //The search also looked at the neighbors of the tiles it touched, so changes there can change the map too
+    footprint.minX = footprint.minX > 0 ? footprint.minX - 1 : 0;
+    footprint.minY = footprint.minY > 0 ? footprint.minY - 1 : 0;
+    footprint.maxX = std::min(footprint.maxX + 1, this->boardWidth - 1);
+    footprint.maxY = std::min(footprint.maxY + 1, this->boardHeight - 1);
+    
+    map.version = this->boardVersion;
+    
+    //Replace the creature's old entry, or else the oldest entry once the cache is full
+    CachedTacticalMap entry = {handle, origin, footprint, map};
+    if (cacheEntry >= 0) {
+        this->tacticalMapCache[cacheEntry] = entry;
+    } else if (this->tacticalMapCache.size() < Board::tacticalMapCacheLength) {
+        this->tacticalMapCache.push_back(entry);
+    } else {
+        this->tacticalMapCache[this->nextCacheEntry] = entry;
+        this->nextCacheEntry = (this->nextCacheEntry + 1) % Board::tacticalMapCacheLength;
+    }
+    
+    return map;
 }
 
-/*std::vector<Tile> Player::getAllVisibleTiles() {
- 
- for (auto creature = board->creatures.begin(); creature != this->board->creatures.end(); creature++) {
- if (creature->controller() == playerNum) {
- 
- //not done, but for each tile in getVisibleTiles, it gets pushed back to big vector. Then at the end all repeat tiles are removed.
- getVisibleTiles(this->&board[creature->x()][creature->y()]);
- }
- }
- 
- 
- }*/
+std::vector<Tile> Board::getAllVisibleTiles(unsigned int player) const {
+    //The visible set already combines every creature's vision, so each tile is in it once
+    std::vector<glm::ivec2> positions = this->visibility(player).visible().tiles();
+    
+    std::vector<Tile> visibleTiles;
+    visibleTiles.reserve(positions.size());
+    
+    for (int a = 0; a < positions.size(); a++) {
+        visibleTiles.push_back(this->viewUnchecked(positions[a].x, positions[a].y).tile());
+    }
+    
+    return visibleTiles;
+}
 
 bool Board::validTile(glm::ivec2 tilePos) const {
     if (tilePos.x >= 0 && tilePos.x < this->width() && tilePos.y >= 0 && tilePos.y < this->height(tilePos.x))
@@ -1070,20 +1268,65 @@ bool Board::validTile(glm::ivec2 tilePos) const {
         return false;
 }
 
+const TerrainRules& Board::terrainRules() const {
+    return this->rules;
+}
+
+void Board::setTerrainRules(const TerrainRules& rules) {
+    this->rules = rules;
+    
+    //Every cost may have changed, so nothing cached is valid anymore
+    if (this->boardWidth > 0 && this->boardHeight > 0)
+        this->markDirty(0, 0, this->boardWidth - 1, this->boardHeight - 1);
+    
+    for (unsigned int a = 0; a < this->creatures.size(); a++) {
+        this->updateVision(this->creatures.handleAt(a));
+    }
+}
+
+unsigned int Board::version() const {
+    return this->boardVersion;
+}
+
+void Board::markChanged(unsigned int x, unsigned int y) {
+    if (x >= this->boardWidth) {
+        throw std::range_error("X out of range: " + std::to_string(x));
+    }
+    if (y >= this->boardHeight) {
+        throw std::range_error("Y out of range: " + std::to_string(y));
+    }
+    
+    this->markDirty(x, y, x, y, false);
+}
+
+bool Board::changedTilesSince(unsigned int version, BitBoard& tiles, BitBoard* terrainTiles) const {
+    if (version < this->changeLogStart || version > this->boardVersion)
+        return false;
+    
+    //Only the changes after the version are needed, and they are at the end of the log
+    for (int a = (int)this->changeLog.size() - 1; a >= 0 && this->changeLog[a].version > version; a--) {
+        const Region& region = this->changeLog[a].region;
+        tiles.setRegion(region.minX, region.minY, region.maxX, region.maxY);
+        if (terrainTiles != nullptr && this->changeLog[a].terrain)
+            terrainTiles->setRegion(region.minX, region.minY, region.maxX, region.maxY);
+    }
+    return true;
+}
+
 unsigned int Board::width() const {
-    return (unsigned int)this->gameBoard.size();
+    return this->boardWidth;
 }
 
 unsigned int Board::height(unsigned int x) const {
-    return (unsigned int)this->gameBoard[x].size();
+    return this->boardHeight;
 }
 
 std::string Board::serialize() const {
-    std::string str = "Board:" + std::to_string(this->gameBoard.size()) + ",";
-    for (int x = 0; x < this->gameBoard.size(); x++) {
-        str += std::to_string(this->gameBoard[x].size()) + ",";
-        for (int y = 0; y < this->gameBoard[x].size(); y++) {
-            str += this->gameBoard[x][y].serialize();
+    std::string str = "Board:" + std::to_string(this->boardWidth) + ",";
+    for (int x = 0; x < this->boardWidth; x++) {
+        str += std::to_string(this->boardHeight) + ",";
+        for (int y = 0; y < this->boardHeight; y++) {
+            str += this->viewUnchecked(x, y).tile().serialize();
         }
     }
     str += "creatures=" + std::to_string(this->creatures.size()) + ",";
@@ -1094,44 +1337,533 @@ std::string Board::serialize() const {
     for (auto a = this->buildings.begin(); a != this->buildings.end(); a++) {
         str += a->serialize();
     }
+    
+    //The rules go with the board, so that a client searches with the same rules as its host
+    str += this->rules.serialize();
+    
     return str + "-Board-";
 }
 
-Board Board::deserialize(std::string str) {
-    str.erase(0, 6); //To erase "Board:"
-    int width = std::stoi(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
+Board Board::deserialize(const std::string& str) {
+    TextReader reader(str);
+    return Board::deserialize(reader);
+}
+
+Board Board::deserialize(TextReader& reader) {
+    reader.expect("Board:");
+    int width = reader.readInt(',');
+    if (width < 0)
+        throw std::invalid_argument("Serialized board has a negative width");
+    
     std::vector<std::vector<Tile> > tiles (width);
     for (int x = 0; x < width; x++) {
-        int height = std::stoi(str.substr(0, str.find_first_of(',')));
-        str = str.substr(str.find_first_of(',') + 1);
+        int height = reader.readInt(',');
+        if (height < 0)
+            throw std::invalid_argument("Serialized board has a negative height");
+        
+        tiles[x].reserve(height);
         for (int y = 0; y < height; y++) {
-            tiles[x].push_back(Tile::deserialize(str.substr(0, str.find("-Tile-"))));
-            str = str.substr(str.find("-Tile-") + 6);
+            tiles[x].push_back(Tile::deserialize(reader));
         }
     }
     
     Board board(tiles);
     
-    str.erase(0, 10); //To erase "creatures="
-    std::list<Creature> creatures;
-    int numCreatures = std::stoi(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
+    reader.expect("creatures=");
+    int numCreatures = reader.readInt(',');
     for (int a = 0; a < numCreatures; a++) {
-        Creature c = Creature::deserialize(str.substr(0, str.find("-Creature-")));
-        board.setCreature(c);
-        str = str.substr(str.find("-Creature-") + 10);
+        board.setCreature(Creature::deserialize(reader));
     }
     
-    str.erase(0, 10); //To erase "buildings="
-    std::list<Building> buildings;
-    int numBuildings = std::stoi(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
+    reader.expect("buildings=");
+    int numBuildings = reader.readInt(',');
     for (int a = 0; a < numBuildings; a++) {
-        Building b = Building::deserialize(str.substr(0, str.find("-Building")));
-        board.setBuilding(b);
-        str = str.substr(str.find("-Building-") + 10);
+        board.setBuilding(Building::deserialize(reader));
     }
     
+    if (reader.startsWith("TerrainRules:"))
+        board.setTerrainRules(TerrainRules::deserialize(reader));
+    
+    reader.skip("-Board-");
+    
     return board;
 }
+
+void Board::encode(ByteWriter& writer, bool runLengthTerrain, const BitBoard* interest, int viewer) const {
+    writer.writeByte(Board::encodingTag);
+    writer.writeByte(Board::encodingVersion);
+    writer.writeByte(runLengthTerrain ? Board::runLengthTerrainFlag : 0);
+    
+    writer.writeVarint(this->boardWidth);
+    writer.writeVarint(this->boardHeight);
+    
+    //Terrain is written as the tile array itself, or as its runs
+    if (runLengthTerrain)
+        Compressor::runLengthEncode(this->tileTerrain.data(), this->tileTerrain.size(), writer);
+    else if (!this->tileTerrain.empty())
+        writer.writeBytes((const char*)&this->tileTerrain[0], this->tileTerrain.size());
+    
+    auto interesting = [interest](unsigned int x, unsigned int y) {
+        return interest == nullptr || interest->test(x, y);
+    };
+    
+    //Most tiles have no damage, so only the damaged ones are written
+    unsigned int numDamaged = 0;
+    for (int a = 0; a < this->tileDamage.size(); a++) {
+        if ((this->tileDamage[a] != 0 || this->tileDamageTime[a] != 0) && interesting(a / this->boardHeight, a % this->boardHeight))
+            numDamaged++;
+    }
+    writer.writeVarint(numDamaged);
+    for (unsigned int a = 0; a < this->tileDamage.size(); a++) {
+        if ((this->tileDamage[a] != 0 || this->tileDamageTime[a] != 0) && interesting(a / this->boardHeight, a % this->boardHeight)) {
+            writer.writeVarint(a);
+            writer.writeVarint(this->tileDamage[a]);
+            writer.writeFloat(this->tileDamageTime[a]);
+        }
+    }
+    
+    unsigned int numCreatures = 0;
+    for (auto a = this->creatures.begin(); a != this->creatures.end(); a++) {
+        if (interesting(a->x(), a->y()))
+            numCreatures++;
+    }
+    writer.writeVarint(numCreatures);
+    for (auto a = this->creatures.begin(); a != this->creatures.end(); a++) {
+        if (interesting(a->x(), a->y()))
+            a->encode(writer, viewer == Board::anyViewer || (int)a->controller() == viewer);
+    }
+    
+    unsigned int numBuildings = 0;
+    for (auto a = this->buildings.begin(); a != this->buildings.end(); a++) {
+        if (interesting(a->x(), a->y()))
+            numBuildings++;
+    }
+    writer.writeVarint(numBuildings);
+    for (auto a = this->buildings.begin(); a != this->buildings.end(); a++) {
+        if (interesting(a->x(), a->y()))
+            a->encode(writer);
+    }
+}
+
+void Board::decode(ByteReader& reader) {
+    this->clearEntities();
+    
+    if (reader.readByte() != Board::encodingTag)
+        throw std::invalid_argument("Not an encoded board");
+    if (reader.readByte() != Board::encodingVersion)
+        throw std::invalid_argument("Encoded board has an unsupported version");
+    
+    bool runLengthTerrain = reader.readByte() & Board::runLengthTerrainFlag;
+    
+    unsigned int width = reader.readVarint();
+    unsigned int height = reader.readVarint();
+    
+    //Check the size against the bytes left, so that a corrupt size cannot cause a huge allocation. Runs of terrain can be far smaller than the board, so those are only checked against the largest board that could be sent without them
+    uint64_t maximumTiles = runLengthTerrain ? MAXIMUM_SOCKET_MESSAGE_SIZE : reader.remaining();
+    if ((uint64_t)width * height > maximumTiles)
+        throw std::range_error("Encoded board is larger than its data");
+    
+    //Only reallocate if the size changed. Visibility and cached searches are for the old size, so they are reset too
+    if (width != this->boardWidth || height != this->boardHeight) {
+        this->boardWidth = width;
+        this->boardHeight = height;
+        
+        unsigned int numberOfTiles = width * height;
+        this->tileTerrain.assign(numberOfTiles, OPEN_TERRAIN);
+        this->tileCreatures.assign(numberOfTiles, SlotMap<Creature>::null);
+        this->tileBuildings.assign(numberOfTiles, SlotMap<Building>::null);
+        this->tileDamage.assign(numberOfTiles, 0);
+        this->tileDamageTime.assign(numberOfTiles, 0);
+        
+        this->playerVisibility.clear();
+        this->noVisibility = Visibility(width, height);
+        this->tacticalMapCache.clear();
+    }
+    
+    unsigned int numberOfTiles = width * height;
+    if (runLengthTerrain)
+        Compressor::runLengthDecode(reader, this->tileTerrain.data(), numberOfTiles);
+    else if (numberOfTiles > 0)
+        memcpy(&this->tileTerrain[0], reader.readBytes(numberOfTiles), numberOfTiles);
+    
+    std::fill(this->tileDamage.begin(), this->tileDamage.end(), 0);
+    std::fill(this->tileDamageTime.begin(), this->tileDamageTime.end(), 0);
+    
+    uint32_t numDamaged = reader.readVarint();
+    for (uint32_t a = 0; a < numDamaged; a++) {
+        uint32_t tileIndex = reader.readVarint();
+        unsigned int damage = reader.readVarint();
+        float time = reader.readFloat();
+        
+        if (tileIndex >= numberOfTiles)
+            throw std::invalid_argument("Encoded damage is off of the board");
+        
+        this->tileDamage[tileIndex] = damage;
+        this->tileDamageTime[tileIndex] = time;
+    }
+    
+    if (width > 0 && height > 0)
+        this->markDirty(0, 0, width - 1, height - 1, true, true);
+    
+    //Creatures and buildings are checked to be on the board by setCreature() and setBuilding(). If one is not, the board is emptied so that it is not left half decoded
+    try {
+        uint32_t numCreatures = reader.readVarint();
+        for (uint32_t a = 0; a < numCreatures; a++) {
+            this->setCreature(Creature::decode(reader));
+        }
+        
+        uint32_t numBuildings = reader.readVarint();
+        for (uint32_t a = 0; a < numBuildings; a++) {
+            this->setBuilding(Building::decode(reader));
+        }
+    } catch (std::exception& e) {
+        this->clearEntities();
+        throw;
+    }
+}
+
+void Board::encodeTiles(const BitBoard& tiles, ByteWriter& writer) const {
+    std::vector<glm::ivec2> changed = tiles.tiles();
+    
+    writer.writeVarint((uint32_t)changed.size());
+    for (int a = 0; a < changed.size(); a++) {
+        this->encodeTile(changed[a].x, changed[a].y, true, writer);
+    }
+}
+
+void Board::encodeTile(unsigned int x, unsigned int y, bool occupants, ByteWriter& writer, int viewer) const {
+    TileView tile = this->view(x, y);
+    
+    if (!occupants) {
+        Tile(tile.terrain(), x, y).encode(writer);
+        writer.writeByte(0);
+        return;
+    }
+    
+    tile.tile().encode(writer);
+    
+    //Whether there is a creature and a building on the tile, as the low two bits
+    writer.writeByte((tile.creature() != nullptr ? 1 : 0) | (tile.building() != nullptr ? 2 : 0));
+    if (tile.creature() != nullptr)
+        tile.creature()->encode(writer, viewer == Board::anyViewer || (int)tile.creature()->controller() == viewer);
+    if (tile.building() != nullptr)
+        tile.building()->encode(writer);
+}
+
+void Board::decodeTiles(ByteReader& reader, BitBoard* decodedTiles) {
+    uint32_t numTiles = reader.readVarint();
+    
+    for (uint32_t a = 0; a < numTiles; a++) {
+        Tile tile = Tile::decode(reader);
+        unsigned int x = tile.x();
+        unsigned int y = tile.y();
+        
+        if (x >= this->boardWidth) {
+            throw std::range_error("X out of range: " + std::to_string(x));
+        }
+        if (y >= this->boardHeight) {
+            throw std::range_error("Y out of range: " + std::to_string(y));
+        }
+        
+        if (decodedTiles != nullptr)
+            decodedTiles->set(x, y);
+        
+        unsigned int tileIndex = this->index(x, y);
+        if (this->tileTerrain[tileIndex] != tile.terrain()) {
+            this->tileTerrain[tileIndex] = tile.terrain();
+            this->markDirty(x, y, x, y, true, true);
+            this->refreshVision(x, y);
+        }
+        this->setDamage(x, y, tile.damage(), tile.timeOfDamage());
+        
+        //Replace whatever was on the tile. If a creature moved, both of its tiles are sent, so it is removed from one and added to the other
+        if (this->tileCreatures[tileIndex] != SlotMap<Creature>::null)
+            this->deleteCreature(x, y);
+        if (this->tileBuildings[tileIndex] != SlotMap<Building>::null)
+            this->deleteBuilding(x, y);
+        
+        uint8_t occupants = reader.readByte();
+        if (occupants & 1) {
+            Creature creature = Creature::decode(reader);
+            if (creature.x() != x || creature.y() != y)
+                throw std::invalid_argument("Encoded creature is not on its tile");
+            this->setCreature(creature);
+        }
+        if (occupants & 2) {
+            Building building = Building::decode(reader);
+            if (building.x() != x || building.y() != y)
+                throw std::invalid_argument("Encoded building is not on its tile");
+            this->setBuilding(building);
+        }
+    }
+}
+
+//Private member functions
+
+void Board::clearEntities() {
+    //Take each creature's vision away, so that what has been explored is kept
+    for (unsigned int a = 0; a < this->creatures.size(); a++) {
+        SlotMap<Creature>::Handle handle = this->creatures.handleAt(a);
+        this->removeVision(handle, this->creatures.get(handle)->controller());
+    }
+    
+    this->creatures.clear();
+    this->buildings.clear();
+    std::fill(this->tileCreatures.begin(), this->tileCreatures.end(), SlotMap<Creature>::null);
+    std::fill(this->tileBuildings.begin(), this->tileBuildings.end(), SlotMap<Building>::null);
+    
+    for (int a = 0; a < this->controlledCreatures.size(); a++) {
+        this->controlledCreatures[a].clear();
+    }
+    for (int a = 0; a < this->controlledBuildings.size(); a++) {
+        this->controlledBuildings[a].clear();
+    }
+    for (int a = 0; a < this->controlledAnimating.size(); a++) {
+        this->controlledAnimating[a].clear();
+    }
+    this->animating.clear();
+    
+    this->controlledCreaturePositions.clear();
+    this->controlledBuildingPositions.clear();
+    this->controlledAnimatingPositions.clear();
+    this->animatingPositions.clear();
+    
+    if (this->boardWidth > 0 && this->boardHeight > 0)
+        this->markDirty(0, 0, this->boardWidth - 1, this->boardHeight - 1);
+}
+
+void Board::markDirty(unsigned int minX, unsigned int minY, unsigned int maxX, unsigned int maxY, bool affectsSearches, bool changesTerrain) {
+    this->boardVersion++;
+    
+    DirtyRegion change = {this->boardVersion, {minX, minY, maxX, maxY}, changesTerrain};
+    
+    if (affectsSearches) {
+        this->dirtyLog.push_back(change);
+        
+        //Drop the older half of the log once it is full. Cached maps older than what is left are searched again
+        if (this->dirtyLog.size() > Board::dirtyLogLength) {
+            unsigned int dropped = Board::dirtyLogLength / 2;
+            this->dirtyLogStart = this->dirtyLog[dropped - 1].version;
+            this->dirtyLog.erase(this->dirtyLog.begin(), this->dirtyLog.begin() + dropped);
+        }
+    }
+    
+    this->changeLog.push_back(change);
+    
+    //Clients older than what is left are sent the whole board
+    if (this->changeLog.size() > Board::changeLogLength) {
+        unsigned int dropped = Board::changeLogLength / 2;
+        this->changeLogStart = this->changeLog[dropped - 1].version;
+        this->changeLog.erase(this->changeLog.begin(), this->changeLog.begin() + dropped);
+    }
+}
+
+bool Board::changedSince(unsigned int version, const Region& region) const {
+    if (version < this->dirtyLogStart)
+        return true;
+    
+    //Only the changes after the version need checking, and they are at the end of the log
+    for (int a = (int)this->dirtyLog.size() - 1; a >= 0 && this->dirtyLog[a].version > version; a--) {
+        if (this->dirtyLog[a].region.overlaps(region))
+            return true;
+    }
+    return false;
+}
+
+void Board::updateVision(SlotMap<Creature>::Handle handle) {
+    const Creature* creature = this->creatures.get(handle);
+    
+    if (creature == nullptr)
+        return;
+    
+    unsigned int slot = SlotMap<Creature>::slot(handle);
+    if (slot >= this->creatureVision.size()) {
+        this->creatureVision.resize(slot + 1);
+        this->creatureVisionBounds.resize(slot + 1);
+    }
+    
+    //Add the new footprint before removing the old one, so tiles seen from both places never drop out of the visible set
+    std::vector<unsigned int> footprint;
+    this->findVisionFootprint(creature->x(), creature->y(), *creature, footprint);
+    
+    Visibility& visibility = this->playerVisibility[creature->controller()];
+    visibility.addFootprint(footprint);
+    visibility.removeFootprint(this->creatureVision[slot]);
+    
+    //The footprint always has the creature's own tile. The bounds reach one tile further, since a tile that blocks vision is not in the footprint but still limits it
+    Region bounds = {creature->x(), creature->y(), creature->x(), creature->y()};
+    for (int a = 0; a < footprint.size(); a++) {
+        unsigned int tileX = footprint[a] / this->boardHeight;
+        unsigned int tileY = footprint[a] % this->boardHeight;
+        
+        bounds.minX = std::min(bounds.minX, tileX);
+        bounds.minY = std::min(bounds.minY, tileY);
+        bounds.maxX = std::max(bounds.maxX, tileX);
+        bounds.maxY = std::max(bounds.maxY, tileY);
+    }
+    bounds.minX = bounds.minX > 0 ? bounds.minX - 1 : 0;
+    bounds.minY = bounds.minY > 0 ? bounds.minY - 1 : 0;
+    bounds.maxX = std::min(bounds.maxX + 1, this->boardWidth - 1);
+    bounds.maxY = std::min(bounds.maxY + 1, this->boardHeight - 1);
+    
+    this->creatureVision[slot].swap(footprint);
+    this->creatureVisionBounds[slot] = bounds;
+}
+
+void Board::removeVision(SlotMap<Creature>::Handle handle, unsigned int controller) {
+    unsigned int slot = SlotMap<Creature>::slot(handle);
+    
+    if (slot >= this->creatureVision.size() || controller >= this->playerVisibility.size())
+        return;
+    
+    this->playerVisibility[controller].removeFootprint(this->creatureVision[slot]);
+    this->creatureVision[slot].clear();
+}
+
+void Board::refreshVision(unsigned int x, unsigned int y) {
+    Region changed = {x, y, x, y};
+    
+    for (unsigned int a = 0; a < this->creatures.size(); a++) {
+        SlotMap<Creature>::Handle handle = this->creatures.handleAt(a);
+        unsigned int slot = SlotMap<Creature>::slot(handle);
+        
+        if (slot < this->creatureVisionBounds.size() && this->creatureVisionBounds[slot].overlaps(changed))
+            this->updateVision(handle);
+    }
+}
+
+bool Board::startStep(SlotMap<Creature>::Handle handle, unsigned int direction, float deltaTime) {
+    Creature* creature = this->creatures.get(handle);
+    
+    unsigned int x = creature->x();
+    unsigned int y = creature->y();
+    int destinationX = x, destinationY = y;
+    
+    if (direction == NORTH)
+        destinationY--;
+    else if (direction == EAST)
+        destinationX--;
+    else if (direction == SOUTH)
+        destinationY++;
+    else if (direction == WEST)
+        destinationX++;
+    else
+        return false;
+    
+    if (destinationX < 0 || destinationY < 0 || destinationX >= this->boardWidth || destinationY >= this->boardHeight)
+        return false;
+    
+    if (!this->viewUnchecked(destinationX, destinationY).passableByCreature(*creature))
+        return false;
+    
+    //Marks the tile as changed, which also sends the new offset
+    this->setDirection(x, y, direction);
+    creature->initiateMovementOffset(deltaTime);
+    
+    //Going down, the creature is moved to the next tile first, and the offset then brings it there from the old one. This keeps it from being drawn under the tile it is going to
+    if (direction == SOUTH || direction == WEST)
+        this->moveCreatureByDirection(x, y, direction);
+    
+    return true;
+}
+
+void Board::findVisionFootprint(unsigned int x, unsigned int y, const Creature& creature, std::vector<unsigned int>& footprint) const {
+    this->resetSearch();
+    
+    unsigned int origin = this->index(x, y);
+    this->searchVision[origin] = creature.vision();
+    this->searchTouched.push_back(origin);
+    
+    //Like getTacticalMap(), a tile is searched again whenever more vision range reaches it
+    this->searchQueue.clear();
+    this->searchQueue.push_back(origin);
+    this->searchQueued[origin] = true;
+    
+    for (int queueIterator = 0; queueIterator < this->searchQueue.size(); queueIterator++) {
+        unsigned int tileIndex = this->searchQueue[queueIterator];
+        this->searchQueued[tileIndex] = false;
+        
+        unsigned int tileX = tileIndex / this->boardHeight;
+        unsigned int tileY = tileIndex % this->boardHeight;
+        int visionRange = this->searchVision[tileIndex];
+        
+        if (visionRange <= 0)
+            continue;
+        
+        //North, east, south and west
+        glm::ivec2 neighbors[4] = {glm::ivec2(tileX, (int)tileY - 1), glm::ivec2((int)tileX - 1, tileY), glm::ivec2(tileX, tileY + 1), glm::ivec2(tileX + 1, tileY)};
+        
+        for (int b = 0; b < 4; b++) {
+            if (!this->validTile(neighbors[b]))
+                continue;
+            
+            unsigned int neighborIndex = this->index(neighbors[b].x, neighbors[b].y);
+            unsigned int neighborTerrain = this->tileTerrain[neighborIndex];
+            
+            if (!this->rules.passableByVision(neighborTerrain))
+                continue;
+            
+            float visionCost = this->terrainVisionCost(&creature, this->tileTerrain[tileIndex], neighborTerrain);
+            int newRange = visionCost >= visionRange ? 0 : visionRange - (int)visionCost;
+            
+            if (newRange > this->searchVision[neighborIndex]) {
+                if (this->searchVision[neighborIndex] < 0)
+                    this->searchTouched.push_back(neighborIndex);
+                
+                this->searchVision[neighborIndex] = newRange;
+                
+                if (!this->searchQueued[neighborIndex]) {
+                    this->searchQueue.push_back(neighborIndex);
+                    this->searchQueued[neighborIndex] = true;
+                }
+            }
+        }
+    }
+    
+    //Every touched tile was seen
+    footprint.assign(this->searchTouched.begin(), this->searchTouched.end());
+}
+
+void Board::resetSearch() const {
+    //Sizes only change if the board is a different size than the last search
+    if (this->searchCost.size() != this->tileTerrain.size()) {
+        this->searchCost.assign(this->tileTerrain.size(), UINT_MAX);
+        this->searchAttack.assign(this->tileTerrain.size(), -1);
+        this->searchVision.assign(this->tileTerrain.size(), -1);
+        this->searchQueued.assign(this->tileTerrain.size(), false);
+        this->searchParent.resize(this->tileTerrain.size());
+    }
+    
+    for (int a = 0; a < this->searchTouched.size(); a++) {
+        this->searchCost[this->searchTouched[a]] = UINT_MAX;
+        this->searchAttack[this->searchTouched[a]] = -1;
+        this->searchVision[this->searchTouched[a]] = -1;
+    }
+    this->searchTouched.clear();
+}
+
+void Board::addHandle(std::vector<unsigned int>& handles, std::vector<unsigned int>& positions, unsigned int handle) {
+    unsigned int slot = SlotMap<Creature>::slot(handle);
+    
+    if (slot >= positions.size())
+        positions.resize(slot + 1, Board::noPosition);
+    else if (positions[slot] != Board::noPosition)
+        return;
+    
+    positions[slot] = (unsigned int)handles.size();
+    handles.push_back(handle);
+}
+
+void Board::removeHandle(std::vector<unsigned int>& handles, std::vector<unsigned int>& positions, unsigned int handle) {
+    unsigned int slot = SlotMap<Creature>::slot(handle);
+    
+    if (slot >= positions.size() || positions[slot] == Board::noPosition || handles[positions[slot]] != handle)
+        return;
+    
+    //Move the last handle into the removed one's position, as SlotMap does with its values
+    unsigned int position = positions[slot];
+    handles[position] = handles.back();
+    positions[SlotMap<Creature>::slot(handles[position])] = position;
+    handles.pop_back();
+    positions[slot] = Board::noPosition;
+}
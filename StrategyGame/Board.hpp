@@ -14,18 +14,158 @@
 #include <math.h>
 #include <vector>
 #include <list>
+#include <algorithm>
+#include <functional>
+#include <climits>
 #include <exception>
 
 #include "Creature.hpp"
 #include "Building.hpp"
 #include "Tile.hpp"
+#include "SlotMap.hpp"
+#include "BitBoard.hpp"
+#include "Visibility.hpp"
+#include "TerrainRules.hpp"
+#include "Compressor.hpp"
 
 //FLAGS FOR COMBAT
 #define NO_STRIKE_BACKS 1
 #define IGNORE_RANGE 2
 
 //How creatures are stored:
-//Creatures will be put into a std::list and then tiles will have pointers to the list elements. Each creature will have a unique position on the board, so the x and y coordinates are a unique combination for each creature, and can be used as a identifier for finding and deleting that creature.
+//Creatures and buildings are kept in slot maps (see SlotMap.hpp), and each tile stores the handle of the creature or building on it. Finding, moving and deleting the creature at a location is then a direct lookup. Since the slot maps move creatures around to stay packed, pointers to creatures are only valid until the next creature is added or deleted; keep locations or handles instead.
+
+//How fog of war is kept:
+//Each player has a Visibility, and the board keeps the list of tiles each creature can see (its vision footprint). When a creature is set, moved or deleted, only that creature's footprint is searched again and the difference applied to its controller's Visibility, so a player's visible tiles are always current without searching from every creature.
+
+//How cached searches are invalidated:
+//Every change to terrain, to what occupies a tile, or to a creature's energy increases the board's version and records the rectangle of tiles it changed in a short log. Board::getTacticalMap() caches the maps it finds by creature, along with the rectangle of tiles its search looked at (one tile wider than the tiles it reached, since a neighbor becoming free can open a new path). A cached map is reused until a change recorded after it overlaps that rectangle, so a creature's map does not need to be searched again while nothing near it happens.
+
+//How tiles are stored:
+//The board does not store Tile objects. Each property of a tile is kept in its own contiguous array (terrain, occupants, damage and damage time), all indexed by x * height + y. Scanning the board column by column is then a linear pass through memory. Tile objects are only assembled when Board::get() is called.
+
+class Board;
+
+/*!
+ * The tiles that a creature can move to, attack and see from where it is, all found in one traversal. See Board::getTacticalMap().
+ */
+struct TacticalMap {
+    TacticalMap(unsigned int width, unsigned int height) : reachable(width, height), attackable(width, height), visible(width, height) {}
+    
+    unsigned int version = 0; //The Board::version() the map was found at. A map with the same version as another one for the same creature is the same map
+    
+    BitBoard reachable; //Tiles the creature has enough energy to move to, including its own tile
+    BitBoard attackable; //Tiles the creature's attack reaches, including its own tile. Empty and friendly tiles are included, so check what is on a tile before attacking it
+    BitBoard visible; //Tiles the creature can see
+};
+
+/*!
+ * A lightweight, read-only handle to one tile of a board. It stores only the board and the tile's position, and reads every property straight from the board's tile arrays, so creating one copies nothing. Get one from Board::view() or Board::viewUnchecked().
+ * A view is only valid while the board it came from is alive, and always reflects the current state of the tile.
+ */
+class TileView {
+public:
+    //Constructor
+    
+    /*!
+     * @param board The board on which the tile is located.
+     * @param x The x index of the coordinate in the board. Must be on the board; no bounds checking is done.
+     * @param y The y index of the coordinate in the board. Must be on the board; no bounds checking is done.
+     */
+    TileView(const Board* board, unsigned int x, unsigned int y);
+    
+    //Public member functions
+    
+    /*!
+     * @return The x coordinate of this tile.
+     */
+    unsigned int x() const;
+    
+    /*!
+     * @return The y coordinate of this tile.
+     */
+    unsigned int y() const;
+    
+    /*!
+     * @return A pointer to the creature located at this tile, or nullptr if there is none. The pointer is only valid until the next creature is added to or deleted from the board.
+     */
+    Creature* creature() const;
+    
+    /*!
+     * @return The handle of the creature located at this tile, or SlotMap::null if there is none.
+     */
+    SlotMap<Creature>::Handle creatureHandle() const;
+    
+    /*!
+     * @return The handle of the building located at this tile, or SlotMap::null if there is none.
+     */
+    SlotMap<Building>::Handle buildingHandle() const;
+    
+    /*!
+     * @return A pointer to the building located at this tile, or nullptr if there is none. The pointer is only valid until the next building is added to or deleted from the board.
+     */
+    Building* building() const;
+    
+    /*!
+     * @return The terrain of this tile.
+     */
+    unsigned int terrain() const;
+    
+    /*!
+     * @return Whether there is a creature or building at this tile.
+     */
+    bool occupied() const;
+    
+    /*!
+     * @return The type of the creature at this tile. See Tile::creatureType().
+     */
+    unsigned int creatureType() const;
+    
+    /*!
+     * @return The type of the building at this tile. See Tile::buildingType().
+     */
+    unsigned int buildingType() const;
+    
+    /*!
+     * @return Whether the creature would be able to go through this tile. See Tile::passableByCreature().
+     */
+    bool passableByCreature(const Creature& creature) const;
+    
+    /*!
+     * @return Whether the creature's attack would be able to go through this tile. See Tile::passableByAttackStyle().
+     */
+    bool passableByAttackStyle(const Creature& creature) const;
+    
+    /*!
+     * @return Whether the creature could see through this tile. See Tile::passableByVision().
+     */
+    bool passableByVision(const Creature& creature) const;
+    
+    /*!
+     * @return The damage amount at this tile.
+     */
+    unsigned int damage() const;
+    
+    /*!
+     * @return The time of the damage, as set by glfwGetTime().
+     */
+    float timeOfDamage() const;
+    
+    /*!
+     * Copy this tile out of the board. Only use this when an independent Tile object is actually needed.
+     *
+     * @return A Tile object with the current properties of this tile.
+     */
+    Tile tile() const;
+    
+private:
+    //Private properties
+    
+    const Board* board;
+    unsigned int tileIndex; //Index into the board's tile arrays. See Board::index()
+    unsigned int tileX;
+    unsigned int tileY;
+};
 
 class Board {
 public:
@@ -33,8 +173,9 @@ public:
     
     /*!
      * A board class representing a 2D vector of the board.
+     * An invalid_argument exception is thrown if the columns are not all the same height.
      *
-     * @param board A 2D vector of Tiles representing the game board.
+     * @param board A 2D vector of Tiles representing the game board. The tiles, along with any creatures or buildings they point to, are copied into the board's own storage.
      */
     Board(std::vector<std::vector<Tile> > board);
     
@@ -43,6 +184,17 @@ public:
     
     //Public properties
     
+    /*!
+     * A version that no board has, for when a client has not received a board yet.
+     */
+    static const unsigned int noVersion = UINT_MAX;
+    
+    /*!
+     * Viewers for encode() and encodeTile(). With anyViewer, every creature is written with the directions it is about to move in, and with noViewer, none are, as for a spectator.
+     */
+    static const int anyViewer = -1;
+    static const int noViewer = -2;
+    
     //Public member functions
     
     /*!
@@ -95,6 +247,36 @@ public:
      */
     std::vector<std::pair<std::string, int> > initiateCombat(unsigned int attackerX, unsigned int attackerY, unsigned int defenderX, unsigned int defenderY, int* attackDamage, int* defendDamage, unsigned char flags = 0);
     
+    /*!
+     * Add directions for the creature at the designated spot to move in, and face it in the first one. The creature is added to the animating creatures until it has finished moving.
+     * Possible errors include if the coordinates are outside of the range of the board.
+     *
+     * @param x The x index of the coordinate in the board.
+     * @param y The y index of the coordinate in the board.
+     * @param directions The directions to move in, in order. Possible direction types include NORTH, EAST, SOUTH, and WEST.
+     *
+     * @return Whether there was a creature to give the directions to.
+     */
+    bool queueDirections(unsigned int x, unsigned int y, const std::vector<unsigned int>& directions);
+    
+    /*!
+     * Stop tracking a creature as animating. This should be done once it has no directions left and has no offset. Nothing happens if the creature is not animating.
+     *
+     * @param handle The handle of the creature.
+     */
+    void stopAnimating(SlotMap<Creature>::Handle handle);
+    
+    /*!
+     * Move an animating creature on by a frame: its offset is moved towards the next tile, it is moved once it gets there, and then it starts towards the tile of its next direction. It stops animating once it has nowhere left to go. The creature's tile is marked as changed only when a step starts or ends, since anything with the same creature can work out the offset in between. The host and clients both use this, so they move creatures the same way.
+     *
+     * @param handle The handle of the creature, from Board::animatingCreatures().
+     * @param deltaTime The time to move the creature on by, in seconds.
+     * @param arrival Set to the tile the creature reached, if it reached one. Use nullptr if it is not needed.
+     *
+     * @return Whether the creature reached a new tile.
+     */
+    bool updateCreature(SlotMap<Creature>::Handle handle, float deltaTime, glm::ivec2* arrival = nullptr);
+    
     /*!
      * Resets all energy values of creatures controlled by a certain player.
      *
@@ -106,9 +288,11 @@ public:
      * Set a creature in the designated spot on the board.
      * Possible errors include if the coordinates that are part of the creature are outside of the range of the board.
      *
-     * @param creature A creature object to be set in the board at the location based on its coordinates.
+     * @param creature A creature object to be set in the board at the location based on its coordinates. If there is already a creature at that location, it is replaced.
+     *
+     * @return The handle of the creature in the board.
      */
-    void setCreature(const Creature& creature);
+    SlotMap<Creature>::Handle setCreature(const Creature& creature);
     
     /*!
      * Delete the creature in the designated spot on the board.
@@ -125,9 +309,11 @@ public:
      * Set a building in the designated spot on the board.
      * Possible errors include if the coordinates that are part of the creature are outside of the range of the board.
      *
-     * @param creature A creature object to be set in the board at the location based on its coordinates.
+     * @param building A building object to be set in the board at the location based on its coordinates. If there is already a building at that location, it is replaced.
+     *
+     * @return The handle of the building in the board.
      */
-    void setBuilding(const Building& building);
+    SlotMap<Building>::Handle setBuilding(const Building& building);
     
     /*!
      * Delete the building in the designated spot on the board.
@@ -180,12 +366,15 @@ public:
     
     //Terrain Costs of Movement
     float getTerrainMovementCost(const Tile& origin, const Tile& destination) const;
+    float getTerrainMovementCost(const TileView& origin, const TileView& destination) const;
     
     //Terrain Costs of Attack
     float getTerrainAttackCost (const Tile& origin, const Tile& destination) const;
+    float getTerrainAttackCost (const TileView& origin, const TileView& destination) const;
     
     //Terrain Costs of Vision
     float getTerrainVisionCost (const Tile& origin, const Tile& destination) const;
+    float getTerrainVisionCost (const TileView& origin, const TileView& destination) const;
     
     //Calculate missing HP debuff for combat
     float calculateWeaknessDebuff(const Tile& combatTile) const;
@@ -207,6 +396,86 @@ public:
      */
     Tile get(unsigned int x, unsigned int y) const;
     
+    /*!
+     * Get a creature by its handle.
+     *
+     * @param handle The handle of the creature, as returned by Board::setCreature() or TileView::creatureHandle().
+     *
+     * @return A pointer to the creature, or nullptr if it has been deleted. The pointer is only valid until the next creature is added or deleted.
+     */
+    Creature* creature(SlotMap<Creature>::Handle handle);
+    
+    /*!
+     * Get a building by its handle.
+     *
+     * @param handle The handle of the building, as returned by Board::setBuilding() or TileView::buildingHandle().
+     *
+     * @return A pointer to the building, or nullptr if it has been deleted. The pointer is only valid until the next building is added or deleted.
+     */
+    Building* building(SlotMap<Building>::Handle handle);
+    
+    /*!
+     * Get the creatures controlled by a player. This costs nothing to call, so per-player sweeps only go through that player's creatures instead of the whole board.
+     *
+     * @param controller The number associated with the player.
+     *
+     * @return The handles of the creatures controlled by that player. The reference is invalidated if a creature is added or deleted, so copy it before doing either.
+     */
+    const std::vector<SlotMap<Creature>::Handle>& creaturesControlledBy(unsigned int controller) const;
+    
+    /*!
+     * Get the buildings controlled by a player.
+     *
+     * @param controller The number associated with the player.
+     *
+     * @return The handles of the buildings controlled by that player. The reference is invalidated if a building is added or deleted, so copy it before doing either.
+     */
+    const std::vector<SlotMap<Building>::Handle>& buildingsControlledBy(unsigned int controller) const;
+    
+    /*!
+     * Get the creatures controlled by a player that are currently moving or have directions left. See Board::queueDirections().
+     *
+     * @param controller The number associated with the player.
+     *
+     * @return The handles of the animating creatures controlled by that player. Board::updateCreature() only ever removes the creature it updates, by moving the last handle into its place, so loop over this from the back while updating. The reference is invalidated if a creature is added or deleted.
+     */
+    const std::vector<SlotMap<Creature>::Handle>& animatingCreatures(unsigned int controller) const;
+    
+    /*!
+     * @return The handles of every creature that is currently moving or has directions left, whoever controls it. It changes in the same way as Board::animatingCreatures(unsigned int).
+     */
+    const std::vector<SlotMap<Creature>::Handle>& animatingCreatures() const;
+    
+    /*!
+     * Get the fog of war of a player. It is kept up to date as creatures are set, moved and deleted, so reading it costs nothing. Combine the visible sets of several players with BitBoard::operator| and BitBoard::operator& for shared vision.
+     *
+     * @param player The number associated with the player.
+     *
+     * @return The visibility of the player's creatures. Nothing is visible or explored if the player has never had a creature. The reference is invalidated if a creature of a new player is added, so copy it before doing so.
+     */
+    const Visibility& visibility(unsigned int player) const;
+    
+    /*!
+     * Get a view of the tile at the spot (x,y) on the board, without copying it.
+     * Possible errors include if the x or y coordinates are greater than or equal to the size of the board.
+     *
+     * @param x The x index of the coordinate in the board.
+     * @param y The y index of the coordinate in the board.
+     *
+     * @return A TileView of the tile at this location in the board.
+     */
+    TileView view(unsigned int x, unsigned int y) const;
+    
+    /*!
+     * Get a view of the tile at the spot (x,y) on the board, without copying it or checking the coordinates. Meant for inner loops where the coordinates are already known to be on the board.
+     *
+     * @param x The x index of the coordinate in the board. Must be less than Board::width().
+     * @param y The y index of the coordinate in the board. Must be less than Board::height().
+     *
+     * @return A TileView of the tile at this location in the board.
+     */
+    inline TileView viewUnchecked(unsigned int x, unsigned int y) const { return TileView(this, x, y); }
+    
     /*!
      * A function to check the validity of tile coordinates.
      *
@@ -216,6 +485,42 @@ public:
      */
     bool validTile(glm::ivec2 tilePos) const;
     
+    /*!
+     * @return The terrain rules used by this board's searches and combat.
+     */
+    const TerrainRules& terrainRules() const;
+    
+    /*!
+     * Replace the terrain rules used by this board's searches and combat, for instance with ones loaded from a mod. Every cached search and vision footprint is found again.
+     *
+     * @param rules The new terrain rules.
+     */
+    void setTerrainRules(const TerrainRules& rules);
+    
+    /*!
+     * @return A number that increases every time anything on the board changes.
+     */
+    unsigned int version() const;
+    
+    /*!
+     * Record that a tile changed in a way the board cannot see, such as the offset of a moving creature, so that the change is sent to clients. Cached searches are not affected. Possible errors include if the coordinates are off of the board.
+     *
+     * @param x The x coordinate of the tile.
+     * @param y The y coordinate of the tile.
+     */
+    void markChanged(unsigned int x, unsigned int y);
+    
+    /*!
+     * Find every tile that changed after a version of the board, so that only they need to be sent to a client that has that version.
+     *
+     * @param version The board version the client has.
+     * @param tiles A BitBoard the size of the board. The changed tiles are added to it.
+     * @param terrainTiles Optionally, a BitBoard the size of the board. The tiles whose terrain changed are added to it.
+     *
+     * @return Whether all of the changes were known. False if the version is older than the changes the board keeps, in which case the whole board should be sent instead.
+     */
+    bool changedTilesSince(unsigned int version, BitBoard& tiles, BitBoard* terrainTiles = nullptr) const;
+    
     /*!
      * @return The x-side width of the board.
      */
@@ -253,10 +558,33 @@ public:
      *
      * @param creature The tile containing the specified creature that is going to be moving.
      *
-     * @return An std::vector of Tile objects containing all of the tiles that can be reached.
+     * @return An std::vector of Tile objects containing all of the tiles that can be reached, each once, in order of increasing cost. See Board::getReachableTilesWithEnergy().
      */
     std::vector<Tile> getReachableTiles(const Tile& creatureTile) const;
     
+    /*!
+     * A function that gets all of the tiles that a creature can reach, along with the energy it would have left there after taking the cheapest path. The search is a Dijkstra flood fill over terrain costs, using a bucket queue kept by the board, so each tile is returned once.
+     * Possible errors include if the coordinates are outside of the range of the board.
+     *
+     * @param x The x index of the creature in the board.
+     * @param y The y index of the creature in the board.
+     *
+     * @return An std::vector of std::pairs of TileViews and the remaining energy at each, in order of increasing cost. It starts with the creature's own tile. Empty if there is no creature.
+     */
+    std::vector<std::pair<TileView, float> > getReachableTilesWithEnergy(unsigned int x, unsigned int y) const;
+    
+    /*!
+     * A function that finds the cheapest path for a creature to a destination, using A* over terrain movement costs. Only paths the creature has enough energy for are considered.
+     *
+     * @param x The x index of the creature in the board.
+     * @param y The y index of the creature in the board.
+     * @param destinationX The x index of the destination in the board.
+     * @param destinationY The y index of the destination in the board.
+     *
+     * @return An std::vector of the directions to move in, in order. Possible direction types include NORTH, EAST, SOUTH, and WEST. Empty if there is no creature, either location is off of the board, or the destination cannot be reached.
+     */
+    std::vector<unsigned int> getPath(unsigned int x, unsigned int y, unsigned int destinationX, unsigned int destinationY) const;
+    
     /*!
      * A function that gets all of the tiles that a creature can attack.
      *
@@ -271,20 +599,32 @@ public:
      *
      * @param creature The tile containing the specified creature that is seeing.
      *
-     * @return An std::vector of Tile objects containing all of the tiles that can be seen.
+     * @return An std::vector of Tile objects containing all of the tiles that can be seen. The search starts with the creature's vision.
      */
-    
     std::vector<Tile> getVisibleTiles(const Tile& creatureTile) const;
     
     /*!
-     * A function that gets all of the tiles that a player can see
+     * A function that finds the tiles a creature can move to, attack and see, in a single traversal. Use this instead of calling getReachableTiles(), getAttackableTiles() and getVisibleTiles() separately, and test membership directly on the returned sets.
+     * Possible errors include if the coordinates are outside of the range of the board.
+     *
+     * @param x The x index of the creature in the board.
+     * @param y The y index of the creature in the board.
+     *
+     * @return The TacticalMap of the creature. All of its sets are empty if there is no creature. A cached map is returned if nothing has changed inside the area its search looked at, in which case its version is unchanged too.
+     */
+    TacticalMap getTacticalMap(unsigned int x, unsigned int y) const;
+    
+    /*!
+     * A function that gets all of the tiles that a player can see with any of their creatures. No search is done; the tiles are read from the player's Visibility.
+     *
+     * @param player The number associated with the player.
      *
-     * @return An std::vector of Tile objects containing all of the tiles that can be seen.
+     * @return An std::vector of Tile objects containing all of the tiles that can be seen, each once.
      */
-    std::vector<Tile> getAllVisibleTiles() const;
+    std::vector<Tile> getAllVisibleTiles(unsigned int player) const;
     
     /*!
-     * Serialize this object as a string that can be sent through sockets.
+     * Serialize this object as a string that can be sent through sockets. The terrain rules are included, so a board deserialized from it uses the same rules.
      *
      * @return The serialized string.
      */
@@ -297,15 +637,357 @@ public:
      *
      * @return The object created.
      */
-    static Board deserialize(std::string str);
+    static Board deserialize(const std::string& str);
+    
+    /*!
+     * Create an object from a serialized string, as part of a longer message.
+     *
+     * @param reader The TextReader to read from. It is moved past the object.
+     *
+     * @return The object created.
+     */
+    static Board deserialize(TextReader& reader);
+    
+    /*!
+     * Write the whole board in the binary format, which is a fraction of the size of serialize() and is read in linear time. Terrain is one byte per tile, or runs of the same terrain, damage is only written for damaged tiles, and creatures and buildings follow. See ByteStream.hpp.
+     *
+     * @param writer The ByteWriter to write to.
+     * @param runLengthTerrain An optional bool indicating whether to write the terrain as runs, see Compressor::runLengthEncode(). Smaller for almost every board, but slower to write, so only used for clients that asked for compression. Autoinitialized as false.
+     * @param interest An optional pointer to the tiles whose damage, creature and building are written. The rest are written with only their terrain, so that a client is not sent what it cannot see. If unset, everything is written.
+     * @param viewer The player the board is written for. Only their creatures are written with the directions they are about to move in, see Creature::encode(). Autoinitialized as Board::anyViewer.
+     */
+    void encode(ByteWriter& writer, bool runLengthTerrain = false, const BitBoard* interest = nullptr, int viewer = Board::anyViewer) const;
+    
+    /*!
+     * Replace the contents of this board with a board written by encode(). The tile arrays are reused when the size has not changed, so decoding every update allocates nothing for the tiles. A range_error is thrown if the bytes end early, and an invalid_argument exception if they are not an encoded board of this version. The board is left empty if an exception is thrown.
+     *
+     * @param reader The ByteReader to read from. It is moved past the board.
+     */
+    void decode(ByteReader& reader);
+    
+    /*!
+     * Write only the given tiles, with the creature and building on each, in the binary format. Used to send the changes found by changedTilesSince().
+     *
+     * @param tiles The tiles to write.
+     * @param writer The ByteWriter to write to.
+     */
+    void encodeTiles(const BitBoard& tiles, ByteWriter& writer) const;
+    
+    /*!
+     * Write one tile in the format of encodeTiles(). A range_error is thrown if the tile is off of the board.
+     *
+     * @param x The x coordinate of the tile.
+     * @param y The y coordinate of the tile.
+     * @param occupants Whether to write the tile's damage, creature and building. If not, the tile is written with only its terrain, which clears them on a client that decodes it.
+     * @param writer The ByteWriter to write to.
+     * @param viewer The player the tile is written for, as for encode(). Autoinitialized as Board::anyViewer.
+     */
+    void encodeTile(unsigned int x, unsigned int y, bool occupants, ByteWriter& writer, int viewer = Board::anyViewer) const;
+    
+    /*!
+     * Replace tiles of this board, and whatever is on them, with ones written by encodeTiles(). Nothing else on the board is changed, so the board is not rebuilt. A range_error is thrown if a tile is off of the board or the bytes end early.
+     *
+     * @param reader The ByteReader to read from. It is moved past the tiles.
+     * @param decodedTiles A BitBoard the size of the board that the replaced tiles are added to. Use nullptr if they are not needed.
+     */
+    void decodeTiles(ByteReader& reader, BitBoard* decodedTiles = nullptr);
     
 private:
     //Private properties
-    std::vector<std::vector<Tile> > gameBoard;
-    std::list<Creature> creatures; //List of creatures on the game board, for board tiles to have pointers to
-    std::list<Building> buildings; //List of buildings on the game board, for board tiles to have pointers to
+    
+    //Board dimensions
+    unsigned int boardWidth = 0;
+    unsigned int boardHeight = 0;
+    
+    TerrainRules rules; //The costs and restrictions of each terrain, looked up by the searches
+    
+    //Tile data, one entry per tile. See Board::index()
+    std::vector<unsigned char> tileTerrain;
+    std::vector<SlotMap<Creature>::Handle> tileCreatures; //Handle of the creature in Board::creatures occupying each tile, or SlotMap::null
+    std::vector<SlotMap<Building>::Handle> tileBuildings; //Handle of the building in Board::buildings occupying each tile, or SlotMap::null
+    std::vector<unsigned int> tileDamage;
+    std::vector<float> tileDamageTime;
+    
+    SlotMap<Creature> creatures; //Creatures on the game board, for board tiles to have handles to
+    SlotMap<Building> buildings; //Buildings on the game board, for board tiles to have handles to
+    
+    //Handles of the creatures and buildings controlled by each player, indexed by controller. Kept up to date by the set and delete functions
+    std::vector<std::vector<SlotMap<Creature>::Handle> > controlledCreatures;
+    std::vector<std::vector<SlotMap<Building>::Handle> > controlledBuildings;
+    std::vector<std::vector<SlotMap<Creature>::Handle> > controlledAnimating; //Handles of the animating creatures controlled by each player
+    
+    std::vector<SlotMap<Creature>::Handle> animating; //Handles of the creatures that are moving or have directions left
+    
+    //Where each handle is in the vectors above, indexed by the slot of the handle, so that it can be removed without searching. Board::noPosition if it is not in one
+    std::vector<unsigned int> controlledCreaturePositions;
+    std::vector<unsigned int> controlledBuildingPositions;
+    std::vector<unsigned int> controlledAnimatingPositions;
+    std::vector<unsigned int> animatingPositions;
+    static const unsigned int noPosition = UINT_MAX;
+    
+    std::vector<Visibility> playerVisibility; //Fog of war of each player, indexed by controller
+    Visibility noVisibility; //Returned for players that have never had a creature, sized like the board so that it can be combined with the others
+    std::vector<std::vector<unsigned int> > creatureVision; //Tile indices each creature currently sees and has added to its controller's Visibility, indexed by the slot of the creature's handle
+    
+    //The first bytes of an encoded board, and the version of the format. Change the version whenever the format changes
+    static const uint8_t encodingTag = 'B';
+    static const uint8_t encodingVersion = 3;
+    
+    //Set in the byte after the version if the terrain is written as runs
+    static const uint8_t runLengthTerrainFlag = 1;
+    
+    //Terrain movement costs are multiples of 0.5, so searches multiply them by this to work with whole numbers
+    static const unsigned int movementCostScale = TerrainRules::movementCostScale;
+    
+    /*!
+     * A rectangle of tiles, inclusive on all sides.
+     */
+    struct Region {
+        unsigned int minX, minY, maxX, maxY;
+        
+        bool overlaps(const Region& other) const { return this->minX <= other.maxX && other.minX <= this->maxX && this->minY <= other.maxY && other.minY <= this->maxY; }
+    };
+    
+    std::vector<Region> creatureVisionBounds; //The tiles in or next to each creature's footprint, indexed like creatureVision. Only terrain changes inside them can change the footprint
+    
+    /*!
+     * A region of tiles that changed, and the board version after the change.
+     */
+    struct DirtyRegion {
+        unsigned int version;
+        Region region;
+        bool terrain; //Whether the terrain of the tiles changed
+    };
+    
+    /*!
+     * A tactical map kept for reuse, and the region its search looked at. See Board::getTacticalMap().
+     */
+    struct CachedTacticalMap {
+        SlotMap<Creature>::Handle creature;
+        unsigned int origin; //Tile index the creature was at
+        Region footprint;
+        TacticalMap map;
+    };
+    
+    unsigned int boardVersion = 0;
+    
+    std::vector<DirtyRegion> dirtyLog; //Changes that affect searches, in order of version. Only the most recent ones are kept, see Board::markDirty()
+    unsigned int dirtyLogStart = 0; //Every change after this version that affects searches is in the dirty log
+    static const unsigned int dirtyLogLength = 64;
+    
+    std::vector<DirtyRegion> changeLog; //Every change, in order of version, for sending changes to clients. Only the most recent ones are kept
+    unsigned int changeLogStart = 0; //Every change after this version is in the change log
+    static const unsigned int changeLogLength = 1024;
+    
+    mutable std::vector<CachedTacticalMap> tacticalMapCache;
+    mutable unsigned int nextCacheEntry = 0; //The cache entry to replace next once the cache is full
+    static const unsigned int tacticalMapCacheLength = 8;
+    
+    //Scratch buffers for searches, kept between calls so that they are not reallocated for every search. They do not affect the state of the board
+    mutable std::vector<unsigned int> searchCost; //Cheapest cost found to each tile, or UINT_MAX if not reached. Indexed like the tile arrays
+    mutable std::vector<unsigned int> searchTouched; //Tiles whose searchCost has been set, so only they need to be reset
+    mutable std::vector<std::vector<unsigned int> > searchBuckets; //Bucket queue of tile indices, indexed by cost
+    mutable std::vector<int> searchAttack; //Best attack range left at each tile, or -1 if not reached
+    mutable std::vector<int> searchVision; //Best vision range left at each tile, or -1 if not seen
+    mutable std::vector<unsigned int> searchQueue; //Work queue of Board::getTacticalMap()
+    mutable std::vector<bool> searchQueued; //Whether each tile is currently in searchQueue
+    mutable std::vector<unsigned int> searchParent; //The tile each tile was reached from, for rebuilding paths
+    mutable std::vector<std::pair<unsigned int, unsigned int> > searchOpen; //Open set of Board::getPath(), as a heap of (estimated cost, tile index)
+    
+    friend class TileView;
     
     //Private member functions
+    
+    /*!
+     * Add a handle to the end of an unordered vector of handles, and record where it is. Nothing happens if it is already there.
+     *
+     * @param handles The vector to add the handle to.
+     * @param positions The position of each handle in the vector, indexed by slot.
+     * @param handle The handle to add.
+     */
+    static void addHandle(std::vector<unsigned int>& handles, std::vector<unsigned int>& positions, unsigned int handle);
+    
+    /*!
+     * Remove a handle from an unordered vector of handles, by moving the last one into its place. Nothing happens if it is not there.
+     *
+     * @param handles The vector to remove the handle from.
+     * @param positions The position of each handle in the vector, indexed by slot. The moved handle's position is updated.
+     * @param handle The handle to remove.
+     */
+    static void removeHandle(std::vector<unsigned int>& handles, std::vector<unsigned int>& positions, unsigned int handle);
+    
+    /*!
+     * Remove every creature and building, keeping the tiles.
+     */
+    void clearEntities();
+    
+    /*!
+     * Record that a rectangle of tiles changed, and increase the board version.
+     *
+     * @param minX The lowest x index of the changed tiles.
+     * @param minY The lowest y index of the changed tiles.
+     * @param maxX The highest x index of the changed tiles.
+     * @param maxY The highest y index of the changed tiles.
+     * @param affectsSearches Whether the change can affect movement, attack or vision searches. If not, as with damage or direction, cached searches are kept and only clients are sent the change.
+     * @param changesTerrain Whether the terrain of the tiles changed, so that every client is sent them, not only those that can see them.
+     */
+    void markDirty(unsigned int minX, unsigned int minY, unsigned int maxX, unsigned int maxY, bool affectsSearches = true, bool changesTerrain = false);
+    
+    /*!
+     * Check if any change after a version overlaps a region. If the dirty log no longer reaches back to that version, the region is treated as changed.
+     *
+     * @param version The board version to check from.
+     * @param region The region to check.
+     *
+     * @return Whether a change since the version may have touched the region.
+     */
+    bool changedSince(unsigned int version, const Region& region) const;
+    
+    /*!
+     * Search a creature's vision footprint again and apply the difference to its controller's Visibility. Call this whenever the creature is set or moved.
+     *
+     * @param handle The handle of the creature.
+     */
+    void updateVision(SlotMap<Creature>::Handle handle);
+    
+    /*!
+     * Remove a creature's vision footprint from its controller's Visibility. Call this before the creature is deleted.
+     *
+     * @param handle The handle of the creature.
+     * @param controller The controller of the creature.
+     */
+    void removeVision(SlotMap<Creature>::Handle handle, unsigned int controller);
+    
+    /*!
+     * Search the vision footprint again of every creature that could see across a tile. Call this whenever the tile's terrain changes, since that can open or block lines of sight.
+     *
+     * @param x The x index of the tile.
+     * @param y The y index of the tile.
+     */
+    void refreshVision(unsigned int x, unsigned int y);
+    
+    /*!
+     * Start a creature moving to the adjacent tile in a direction. Creatures moving north or east stay on their tile until they reach the next one, and creatures moving south or west are moved first and then come from their old tile, so that a creature is never drawn under the tile it is going to.
+     *
+     * @param handle The handle of the creature.
+     * @param direction The direction to move in.
+     * @param deltaTime The time that the creature has been moving for, in seconds.
+     *
+     * @return Whether the creature could start moving. False if the tile is off of the board or cannot be passed.
+     */
+    bool startStep(SlotMap<Creature>::Handle handle, unsigned int direction, float deltaTime);
+    
+    /*!
+     * Find the tiles a creature can see. Vision only depends on terrain, so unlike getTacticalMap() nothing else is searched.
+     *
+     * @param x The x index of the creature in the board.
+     * @param y The y index of the creature in the board.
+     * @param creature The creature that is seeing.
+     * @param footprint An std::vector to fill with the indices of the tiles that can be seen.
+     */
+    void findVisionFootprint(unsigned int x, unsigned int y, const Creature& creature, std::vector<unsigned int>& footprint) const;
+    
+    /*!
+     * Prepare the scratch buffers for a new search, resetting only the tiles the previous search touched.
+     */
+    void resetSearch() const;
+    
+    /*!
+     * The terrain costs shared by the Tile and TileView overloads of getTerrainMovementCost(), getTerrainAttackCost() and getTerrainVisionCost().
+     *
+     * @param creature The creature on the origin tile, or nullptr.
+     * @param originTerrain The terrain of the origin tile.
+     * @param destinationTerrain The terrain of the destination tile.
+     *
+     * @return The cost of going from the origin to the destination.
+     */
+    float terrainMovementCost(const Creature* creature, unsigned int destinationTerrain) const;
+    float terrainAttackCost(const Creature* creature, unsigned int originTerrain, unsigned int destinationTerrain) const;
+    float terrainVisionCost(const Creature* creature, unsigned int originTerrain, unsigned int destinationTerrain) const;
+    
+    /*!
+     * Get the index of a tile in the tile arrays. No bounds checking is done.
+     *
+     * @param x The x index of the coordinate in the board.
+     * @param y The y index of the coordinate in the board.
+     *
+     * @return The index of the tile in the tile arrays.
+     */
+    inline unsigned int index(unsigned int x, unsigned int y) const { return x * this->boardHeight + y; }
 };
 
+//TileView is defined here, after Board, since it reads directly from the board's tile arrays
+
+inline TileView::TileView(const Board* board, unsigned int x, unsigned int y) : board(board), tileIndex(board->index(x, y)), tileX(x), tileY(y) {}
+
+inline unsigned int TileView::x() const {
+    return this->tileX;
+}
+
+inline unsigned int TileView::y() const {
+    return this->tileY;
+}
+
+//Like Board::get(), a view of a const board still gives out modifiable creatures and buildings
+inline Creature* TileView::creature() const {
+    return const_cast<Creature*>(this->board->creatures.get(this->board->tileCreatures[this->tileIndex]));
+}
+
+inline Building* TileView::building() const {
+    return const_cast<Building*>(this->board->buildings.get(this->board->tileBuildings[this->tileIndex]));
+}
+
+inline SlotMap<Creature>::Handle TileView::creatureHandle() const {
+    return this->board->tileCreatures[this->tileIndex];
+}
+
+inline SlotMap<Building>::Handle TileView::buildingHandle() const {
+    return this->board->tileBuildings[this->tileIndex];
+}
+
+inline unsigned int TileView::terrain() const {
+    return this->board->tileTerrain[this->tileIndex];
+}
+
+inline bool TileView::occupied() const {
+    return this->creatureHandle() != SlotMap<Creature>::null || this->buildingHandle() != SlotMap<Building>::null;
+}
+
+inline unsigned int TileView::creatureType() const {
+    return Tile::creatureType(this->creature());
+}
+
+inline unsigned int TileView::buildingType() const {
+    return Tile::buildingType(this->building());
+}
+
+//Unlike Tile, views use the terrain rules of their board
+inline bool TileView::passableByCreature(const Creature& creature) const {
+    return !this->occupied() && this->board->rules.passableByCreature(this->terrain(), creature.race());
+}
+
+inline bool TileView::passableByAttackStyle(const Creature& creature) const {
+    return this->board->rules.passableByAttackStyle(this->terrain(), creature.attackStyle());
+}
+
+inline bool TileView::passableByVision(const Creature&) const {
+    return this->board->rules.passableByVision(this->terrain());
+}
+
+inline unsigned int TileView::damage() const {
+    return this->board->tileDamage[this->tileIndex];
+}
+
+inline float TileView::timeOfDamage() const {
+    return this->board->tileDamageTime[this->tileIndex];
+}
+
+inline Tile TileView::tile() const {
+    Tile tile(this->terrain(), this->tileX, this->tileY);
+    tile.setCreature(this->creature());
+    tile.setBuilding(this->building());
+    tile.setDamage(this->damage(), this->timeOfDamage());
+    return tile;
+}
+
 #endif /* Board_hpp */
@@ -29,23 +29,52 @@ std::string Building::serialize() const {
     return "Building:" + std::to_string(this->maxHealthVal) + "," + std::to_string(this->controllerVal) + "," + std::to_string(this->xVal) + "," + std::to_string(this->yVal) + "," + std::to_string(this->healthVal) + "," + this->Attackable::serialize() + "-Building-";
 }
 
-Building Building::deserialize(std::string str) {
-    str.erase(0, 9); //To erase "Building:"
-    int maxHealth = std::stoi(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
-    int controller = std::stoi(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
-    int x = std::stoi(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
-    int y = std::stoi(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
-    int health = std::stoi(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
+Building Building::deserialize(const std::string& str) {
+    TextReader reader(str);
+    return Building::deserialize(reader);
+}
+
+Building Building::deserialize(TextReader& reader) {
+    reader.expect("Building:");
+    int maxHealth = reader.readInt(',');
+    int controller = reader.readInt(',');
+    int x = reader.readInt(',');
+    int y = reader.readInt(',');
+    int health = reader.readInt(',');
+    
+    Building building(x, y, maxHealth, controller);
+    building.takeDamage(maxHealth - health);
+    
+    building.buttonInfo = Attackable::deserializeButtons(reader);
+    reader.skip("-Building-");
+    
+    return building;
+}
+
+void Building::encode(ByteWriter& writer) const {
+    writer.writeVarint(this->maxHealthVal);
+    writer.writeVarint(this->controllerVal);
+    writer.writeVarint(this->xVal);
+    writer.writeVarint(this->yVal);
+    writer.writeVarint(this->healthVal);
+    this->Attackable::encodeButtons(writer);
+}
+
+Building Building::decode(ByteReader& reader) {
+    unsigned int maxHealth = reader.readVarint();
+    unsigned int controller = reader.readVarint();
+    unsigned int x = reader.readVarint();
+    unsigned int y = reader.readVarint();
+    unsigned int health = reader.readVarint();
+    
+    //Health is applied as what is missing from the maximum, which would wrap around if it were above it
+    if (health > maxHealth)
+        throw std::invalid_argument("Error decoding building: health above maximum health");
     
     Building building(x, y, maxHealth, controller);
     building.takeDamage(maxHealth - health);
     
-    building.buttonInfo = Attackable::deserializeButtons(str.substr(0, str.find_first_of("-Buttons-")));
+    building.buttonInfo = Attackable::decodeButtons(reader);
     
     return building;
 }
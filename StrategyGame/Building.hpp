@@ -54,7 +54,32 @@ public:
      *
      * @return The object created.
      */
-    static Building deserialize(std::string str);
+    static Building deserialize(const std::string& str);
+    
+    /*!
+     * Create an object from a serialized string, as part of a longer message.
+     *
+     * @param reader The TextReader to read from. It is moved past the object.
+     *
+     * @return The object created.
+     */
+    static Building deserialize(TextReader& reader);
+    
+    /*!
+     * Write this object in the binary format, which is much smaller than the serialized string and is read in linear time. See ByteStream.hpp.
+     *
+     * @param writer The ByteWriter to write to.
+     */
+    void encode(ByteWriter& writer) const;
+    
+    /*!
+     * Create an object from bytes written by encode(). A range_error is thrown if the bytes end early, and an invalid_argument exception if they hold an impossible value.
+     *
+     * @param reader The ByteReader to read from. It is moved past the object.
+     *
+     * @return The object created.
+     */
+    static Building decode(ByteReader& reader);
     
 private:
 };
@@ -0,0 +1,125 @@
+//
+//  ByteStream.cpp
+//  Strategy Game
+//
+
+#include "ByteStream.hpp"
+
+//ByteWriter
+
+ByteWriter::ByteWriter(size_t reserve) {
+    this->bytes.reserve(reserve);
+}
+
+void ByteWriter::writeUInt16(uint16_t value) {
+    this->writeByte(value & 0xFF);
+    this->writeByte(value >> 8);
+}
+
+void ByteWriter::writeUInt32(uint32_t value) {
+    for (int a = 0; a < 4; a++) {
+        this->writeByte((value >> (8 * a)) & 0xFF);
+    }
+}
+
+void ByteWriter::writeFloat(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    this->writeUInt32(bits);
+}
+
+void ByteWriter::writeVarint(uint32_t value) {
+    while (value >= 0x80) {
+        this->writeByte((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    this->writeByte(value);
+}
+
+void ByteWriter::writeString(const std::string& value) {
+    this->writeVarint((uint32_t)value.size());
+    this->bytes.append(value);
+}
+
+void ByteWriter::writeBytes(const char* data, size_t length) {
+    this->bytes.append(data, length);
+}
+
+void ByteWriter::clear() {
+    this->bytes.clear();
+}
+
+const std::string& ByteWriter::data() const {
+    return this->bytes;
+}
+
+size_t ByteWriter::size() const {
+    return this->bytes.size();
+}
+
+//ByteReader
+
+ByteReader::ByteReader(const char* data, size_t length) : current(data), end(data + length) {}
+
+ByteReader::ByteReader(const std::string& data) : current(data.data()), end(data.data() + data.size()) {}
+
+uint8_t ByteReader::readByte() {
+    this->require(1);
+    return (uint8_t)*this->current++;
+}
+
+uint16_t ByteReader::readUInt16() {
+    this->require(2);
+    uint16_t value = (uint8_t)this->current[0] | ((uint16_t)(uint8_t)this->current[1] << 8);
+    this->current += 2;
+    return value;
+}
+
+uint32_t ByteReader::readUInt32() {
+    this->require(4);
+    uint32_t value = 0;
+    for (int a = 0; a < 4; a++) {
+        value |= (uint32_t)(uint8_t)this->current[a] << (8 * a);
+    }
+    this->current += 4;
+    return value;
+}
+
+float ByteReader::readFloat() {
+    uint32_t bits = this->readUInt32();
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+uint32_t ByteReader::readVarint() {
+    uint32_t value = 0;
+    
+    //A 32 bit value takes at most 5 bytes
+    for (int shift = 0; shift < 35; shift += 7) {
+        uint8_t byte = this->readByte();
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        
+        if ((byte & 0x80) == 0)
+            return value;
+    }
+    
+    throw std::range_error("Varint is too long");
+}
+
+std::string ByteReader::readString() {
+    uint32_t length = this->readVarint();
+    const char* start = this->readBytes(length);
+    return std::string(start, length);
+}
+
+const char* ByteReader::readBytes(size_t length) {
+    this->require(length);
+    const char* start = this->current;
+    this->current += length;
+    return start;
+}
+
+size_t ByteReader::remaining() const {
+    return this->end - this->current;
+}
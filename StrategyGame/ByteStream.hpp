@@ -0,0 +1,136 @@
+//
+//  ByteStream.hpp
+//  Strategy Game
+//
+
+#ifndef ByteStream_hpp
+#define ByteStream_hpp
+
+#include <string>
+#include <exception>
+#include <stdexcept>
+#include <stdint.h>
+#include <string.h>
+
+//How the binary format is laid out:
+//Fixed-width numbers are little-endian, whatever the machine. Floats are written as the 4 bytes of their IEEE 754 representation. Counts, coordinates and stats are written as varints: 7 bits per byte, lowest bits first, with the top bit set on every byte but the last, so that values below 128 take a single byte. Enums are single bytes, and strings are a varint length followed by their bytes.
+
+/*!
+ * Builds a binary message. Values are appended to the end of one std::string, which can be sent through sockets as it is.
+ */
+class ByteWriter {
+public:
+    //Constructor
+    
+    /*!
+     * @param reserve The number of bytes to allocate up front.
+     */
+    ByteWriter(size_t reserve = 0);
+    
+    //Public member functions
+    
+    inline void writeByte(uint8_t value) { this->bytes.push_back((char)value); }
+    
+    void writeUInt16(uint16_t value);
+    void writeUInt32(uint32_t value);
+    void writeFloat(float value);
+    
+    /*!
+     * Write an unsigned number in as few bytes as it needs. See ByteStream.hpp.
+     */
+    void writeVarint(uint32_t value);
+    
+    /*!
+     * Write a string as its varint length followed by its bytes.
+     */
+    void writeString(const std::string& value);
+    
+    /*!
+     * Write raw bytes, with no length in front.
+     */
+    void writeBytes(const char* data, size_t length);
+    
+    /*!
+     * Empty the message, keeping the allocated memory for the next one.
+     */
+    void clear();
+    
+    //Public get functions
+    
+    /*!
+     * @return The bytes written so far.
+     */
+    const std::string& data() const;
+    
+    /*!
+     * @return The number of bytes written so far.
+     */
+    size_t size() const;
+    
+private:
+    //Private properties
+    
+    std::string bytes;
+};
+
+/*!
+ * Reads a binary message written by a ByteWriter. The reader only points at the bytes, so nothing is copied, and the bytes must stay alive and unchanged while it is used. Reading past the end throws a range_error instead of reading outside of the bytes.
+ */
+class ByteReader {
+public:
+    //Constructors
+    
+    /*!
+     * @param data The first byte to read.
+     * @param length The number of bytes that can be read.
+     */
+    ByteReader(const char* data, size_t length);
+    
+    /*!
+     * @param data The bytes to read. They are not copied, so the string must outlive the reader.
+     */
+    ByteReader(const std::string& data);
+    
+    //Public member functions
+    
+    uint8_t readByte();
+    uint16_t readUInt16();
+    uint32_t readUInt32();
+    float readFloat();
+    uint32_t readVarint();
+    std::string readString();
+    
+    /*!
+     * Get the next bytes without copying them, and move past them.
+     *
+     * @param length The number of bytes.
+     *
+     * @return A pointer to the first of the bytes.
+     */
+    const char* readBytes(size_t length);
+    
+    //Public get functions
+    
+    /*!
+     * @return The number of bytes that have not been read yet.
+     */
+    size_t remaining() const;
+    
+private:
+    //Private properties
+    
+    const char* current;
+    const char* end;
+    
+    //Private member functions
+    
+    /*!
+     * Throw a range_error if fewer than the given number of bytes are left.
+     */
+    inline void require(size_t length) const {
+        if ((size_t)(this->end - this->current) < length)
+            throw std::range_error("Unexpected end of binary data");
+    }
+};
+
+#endif /* ByteStream_hpp */
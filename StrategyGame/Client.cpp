@@ -8,7 +8,9 @@
 
 #include "Client.hpp"
 
-Client::Client(Window* w, ClientSocket *socket, bool* mouseDown, bool* mouseUp, bool* returnToMenu, bool* keys) : visualizer(Visualizer(w, "Shaders/board/board.vert", "Shaders/board/board.geom", "Shaders/board/board.frag", mouseDown, mouseUp, keys)), board(Board(std::vector<std::vector<Tile> >(0))) {
+constexpr const float Client::predictionTimestep; //Defined here as well, so that it can be passed by reference
+
+Client::Client(Window* w, ClientSocket *socket, bool* mouseDown, bool* mouseUp, bool* returnToMenu, bool* keys) : visualizer(Visualizer(w, "Shaders/board/board.vert", "Shaders/board/board.geom", "Shaders/board/board.frag", mouseDown, mouseUp, keys)), board(Board(std::vector<std::vector<Tile> >(0))), hostBoard(Board(std::vector<std::vector<Tile> >(0))) {
     
     this->returnToMenu = returnToMenu;
     
@@ -18,18 +20,34 @@ Client::Client(Window* w, ClientSocket *socket, bool* mouseDown, bool* mouseUp,
     if (initialInfo == "starting") {
         this->socket->send("message_received");
         initialInfo = this->socket->receive();
+    } else if (initialInfo == "spectating") {
+        initialInfo = this->socket->receive();
     }
-    this->socket->send("initialDataReceived");
     
-    this->playerNum = std::stoi(initialInfo.substr(0, initialInfo.find_first_of(',')));
+    //Spectators are sent the board without a player number, and the host does not wait for them to answer
+    if (initialInfo.compare(0, 10, "spectator,") == 0) {
+        this->playerNum = Client::spectatorNum;
+    } else {
+        this->socket->send("initialDataReceived");
+        this->playerNum = std::stoi(initialInfo.substr(0, initialInfo.find_first_of(',')));
+    }
     initialInfo = initialInfo.substr(initialInfo.find_first_of(',') + 1, std::string::npos); //Set the string equal to the rest of the string after the ','
     
     this->board = Board::deserialize(initialInfo);
+    this->hostBoard = this->board;
+    
+    //The whole board was just sent, and nothing is moving yet
+    this->predictionTime = this->lastFrameTime = glfwGetTime();
+    this->tileReceived.assign(this->board.width() * this->board.height(0), this->predictionTime);
+    this->offsetCorrections.assign(this->tileReceived.size(), 0.0);
+    this->shownDirections.assign(this->tileReceived.size(), -1);
+    this->hostChangedTiles = BitBoard(this->board.width(), this->board.height(0));
+    this->predictedTiles = BitBoard(this->board.width(), this->board.height(0));
     
     //Initialize the various 2D vectors that hold information for each tile
     for (int x = 0; x < this->board.width(); x++) {
         std::vector<std::array<int, 2> > boardInfoColumn(this->board.height(x));
-        std::vector<std::queue<std::string> > tileActionColumn(this->board.height(x));
+        std::vector<std::queue<Command> > tileActionColumn(this->board.height(x));
         this->boardInfo.push_back(boardInfoColumn);
         this->tileActions.push_back(tileActionColumn);
     }
@@ -43,43 +61,62 @@ Client::Client(Window* w, ClientSocket *socket, bool* mouseDown, bool* mouseUp,
     
     //Set the visualizer
     this->visualizer.set(this->board.width(), this->board.height(0));
+    
+    //From now on, the host is only heard from through the network thread
+    this->network.start(this->socket);
+    
+    //Board updates are most of what the host sends, so ask for them compressed. It is sent with the first batch of commands
+    this->commands.requestCompression();
 }
 
 void Client::render() {
 //    this->visualizer.startFrame();
 //
     
-    std::string str = this->socket->receive();
-    while (str.size() > 0) {
-        if (str == "closing_host") {
+    //Apply everything the host has sent since the last frame, without waiting for more, so that the newest board is shown however fast the host sends
+    HostMessage message;
+    bool updated = false;
+    while (this->network.receive(message)) {
+        if (message.closed || (message.type == TEXT_MESSAGE && message.message.compare(0, 12, "closing_host") == 0)) {
             *this->returnToMenu = true;
             std::cout << "Closing" << std::endl;
             return;
         }
-        if (this->processFromHost(str.substr(0, str.find_first_of(';')))) break; //Process the action. If the board was deserialized, break from the loop
-        str = str.find_first_of(';') == std::string::npos ? "" : str.substr(str.find_first_of(';') + 1, std::string::npos); //Set the string equal to the rest of the string after the ','
+        
+        if (this->processFromHost(message.message, message.type))
+            updated = true;
     }
     
-    //If the window will be closing notify the Host
-    if (this->visualizer.window->shouldClose()) this->actionsForClientInfo.push_back("leaving_game_player_" + std::to_string(this->playerNum));
+    this->updatePrediction(updated);
     
-    std::string clientInfo = "";
+    //If the window will be closing notify the Host
+    if (this->visualizer.window->shouldClose()) this->commands.leaveGame();
     
     for (auto a = this->visualizer.actions.begin(); a != this->visualizer.actions.end(); a++) {
         this->processAction(*a);
         a = this->visualizer.actions.erase(a);
     }
     
-    for (auto a = this->actionsForClientInfo.begin(); a != this->actionsForClientInfo.end(); a++) {
-        clientInfo += *a + ";";
-        a = this->actionsForClientInfo.erase(a);
+    //Tell the host which tiles are on the screen, so that it only sends what can be seen
+    glm::ivec2 cameraMin, cameraMax;
+    if (this->visualizer.tilesOnScreen(&cameraMin, &cameraMax) && (cameraMin != this->cameraMin || cameraMax != this->cameraMax)) {
+        this->commands.camera(cameraMin, cameraMax);
+        this->cameraMin = cameraMin;
+        this->cameraMax = cameraMax;
     }
     
-    if (clientInfo == "") {
-        clientInfo = "no_updates";
+    //Tell the host which version of the board this has, so that the next update only has what changed after it. Nothing is acknowledged while waiting for a resync, since the host would go back to sending deltas from the version this could not apply them to
+    if (!this->awaitingKeyframe && this->boardVersion != Board::noVersion && this->boardVersion != this->acknowledgedVersion) {
+        this->commands.acknowledge(this->boardVersion);
+        this->acknowledgedVersion = this->boardVersion;
     }
     
-    this->socket->send(clientInfo.c_str());
+    //The host no longer waits to hear from every client each frame, so nothing is sent unless there is something to say
+    if (!this->commands.empty()) {
+        this->outgoing.assign(this->commands.data());
+        if (this->network.send(this->outgoing))
+            this->commands.clear();
+    }
     
     this->updateSelected(this->visualizer.mousePressed(), this->visualizer.getTile(), glfwGetTime());
     
@@ -138,28 +175,40 @@ void Client::updateSelected(bool mouseDown, glm::ivec2 mousePos, unsigned int cu
                     //Select this new tile
                     this->boardInfo[mousePos.x][mousePos.y][TILE_STYLE] = SELECTED;
                     
-                    Creature* creature = this->board.get(mousePos.x, mousePos.y).creature();
+                    Creature* creature = this->board.view(mousePos.x, mousePos.y).creature();
                     
                     //If the selected tile is a creature, highlight reachable tiles and update the creature's direction
                     if (creature != nullptr && creature->controller() == this->playerNum) {
-                        std::vector<Tile> reachableTiles = this->board.getReachableTiles(this->board.get(mousePos.x, mousePos.y));
+                        //One traversal finds both the reachable and attackable tiles
+                        TacticalMap tacticalMap = this->board.getTacticalMap(mousePos.x, mousePos.y);
+                        
+                        std::vector<glm::ivec2> reachableTiles = tacticalMap.reachable.tiles();
+                        
+                        Command move;
+                        move.opcode = MOVE_CREATURE_OPCODE;
+                        move.origin = this->selectedTile;
                         
                         for (int a = 0; a < reachableTiles.size(); a++) {
-                            if (this->board.get(reachableTiles[a].x(), reachableTiles[a].y()).passableByCreature(*creature)) {
-                                this->boardInfo[reachableTiles[a].x()][reachableTiles[a].y()][TILE_STYLE] = REACHABLE;
-                                this->tileActions[reachableTiles[a].x()][reachableTiles[a].y()].push("move_creature_at_" + std::to_string(this->selectedTile.x) + "_" + std::to_string(this->selectedTile.y));
+                            if (this->board.viewUnchecked(reachableTiles[a].x, reachableTiles[a].y).passableByCreature(*creature)) {
+                                this->boardInfo[reachableTiles[a].x][reachableTiles[a].y][TILE_STYLE] = REACHABLE;
+                                this->tileActions[reachableTiles[a].x][reachableTiles[a].y].push(move);
                             }
                         }
                         
-                        if (creature->energy() > 0) {
-                            std::vector<Tile> attackableTiles = this->board.getAttackableTiles(this->board.get(mousePos.x, mousePos.y));
+                        //The attackable set is empty if the creature has no energy
+                        std::vector<glm::ivec2> attackableTiles = tacticalMap.attackable.tiles();
+                        
+                        Command attack;
+                        attack.opcode = ATTACK_OPCODE;
+                        attack.origin = this->selectedTile;
+                        
+                        for (int a = 0; a < attackableTiles.size(); a++) {
+                            TileView tile = this->board.viewUnchecked(attackableTiles[a].x, attackableTiles[a].y);
                             
-                            for (int a = 0; a < attackableTiles.size(); a++) {
-                                //If there is a creature or building on the tile, controlled by an opponent, make it attackable
-                                if ((this->board.get(attackableTiles[a].x(), attackableTiles[a].y()).creature() != nullptr && this->board.get(attackableTiles[a].x(), attackableTiles[a].y()).creature()->controller() != this->playerNum) || (this->board.get(attackableTiles[a].x(), attackableTiles[a].y()).building() != nullptr && this->board.get(attackableTiles[a].x(), attackableTiles[a].y()).building()->controller() != this->playerNum)) {
-                                    this->boardInfo[attackableTiles[a].x()][attackableTiles[a].y()][TILE_STYLE] = ATTACKABLE;
-                                    this->tileActions[attackableTiles[a].x()][attackableTiles[a].y()].push("attack_from_" + std::to_string(this->selectedTile.x) + "_" + std::to_string(this->selectedTile.y));
-                                }
+                            //If there is a creature or building on the tile, controlled by an opponent, make it attackable
+                            if ((tile.creature() != nullptr && tile.creature()->controller() != this->playerNum) || (tile.building() != nullptr && tile.building()->controller() != this->playerNum)) {
+                                this->boardInfo[attackableTiles[a].x][attackableTiles[a].y][TILE_STYLE] = ATTACKABLE;
+                                this->tileActions[attackableTiles[a].x][attackableTiles[a].y].push(attack);
                             }
                         }
                     }
@@ -196,7 +245,7 @@ void Client::updateInterfaces() {
     
     //If the selected tile is on the board
     if (this->board.validTile(this->selectedTile)) {
-        Tile tile = this->board.get(this->selectedTile.x, this->selectedTile.y);
+        TileView tile = this->board.view(this->selectedTile.x, this->selectedTile.y);
         
         if (tile.creature() != nullptr) {
             //Set the right interface to be the creature if there is a creature at the selected tile
@@ -260,12 +309,14 @@ void Client::getBufferData(std::vector<int>* terrainData, std::vector<int>* crea
     
     for (int x = 0; x < this->board.width(); x++) {
         for (int y = 0; y < this->board.height(x); y++) {
-            (*terrainData).push_back(this->board.get(x, y).terrain());
+            TileView tile = this->board.viewUnchecked(x, y);
+            
+            (*terrainData).push_back(tile.terrain());
             
-            (*creatureData).push_back(this->board.get(x, y).creatureType());
-            if (this->board.get(x, y).creature() != nullptr) { //If there is a creature set the data properly, otherwise as 0
-                (*creatureData).push_back(this->board.get(x, y).creature()->direction());
-                (*creatureData).push_back(this->board.get(x, y).creature()->controller());
+            (*creatureData).push_back(tile.creatureType());
+            if (tile.creature() != nullptr) { //If there is a creature set the data properly, otherwise as 0
+                (*creatureData).push_back(tile.creature()->direction());
+                (*creatureData).push_back(tile.creature()->controller());
             } else {
                 (*creatureData).push_back(0);
                 (*creatureData).push_back(0);
@@ -276,16 +327,16 @@ void Client::getBufferData(std::vector<int>* terrainData, std::vector<int>* crea
             (*colorData).push_back(tileColor.y);
             (*colorData).push_back(tileColor.z);
             
-            (*damageData).push_back(this->board.get(x, y).damage());
+            (*damageData).push_back(tile.damage());
             
-            if (this->board.get(x, y).creature() != nullptr)
-                (*offsetData).push_back(this->board.get(x, y).creature()->offset());
+            if (tile.creature() != nullptr)
+                (*offsetData).push_back(tile.creature()->offset() + this->offsetCorrections[x * this->board.height(0) + y]);
             else
                 (*offsetData).push_back(0);
             
-            (*buildingData).push_back(this->board.get(x, y).buildingType());
-            if (this->board.get(x, y).building() != nullptr) //If there is a building set the data properly, otherwise as 0
-                (*buildingData).push_back(this->board.get(x, y).building()->controller());
+            (*buildingData).push_back(tile.buildingType());
+            if (tile.building() != nullptr) //If there is a building set the data properly, otherwise as 0
+                (*buildingData).push_back(tile.building()->controller());
             else
                 (*buildingData).push_back(0);
         }
@@ -317,37 +368,207 @@ glm::vec3 Client::tileColor(unsigned int x, unsigned int y) {
 void Client::processAction(std::string action) {
     if (action == "return_to_menu") {
         *this->returnToMenu = true;
-        this->actionsForClientInfo.push_back("leaving_game_player_" + std::to_string(this->playerNum));
+        this->commands.leaveGame();
     } else if (action.find("set_mage_strike")) {
-        Creature* creature = this->board.get(this->selectedTile.x, this->selectedTile.y).creature();
+        Creature* creature = this->board.view(this->selectedTile.x, this->selectedTile.y).creature();
         if (creature != nullptr && creature->controller() == this->playerNum && creature->energy() == creature->maxEnergy()) {
+            Command strike;
+            strike.opcode = MAGE_STRIKE_OPCODE;
+            strike.origin = this->selectedTile;
+            
             for (int x = 0; x < this->board.width(); x++) {
                 for (int y = 0; y < this->board.height(x); y++) {
-                    if (this->board.get(x, y).creature() != nullptr && this->board.get(x, y).creature()->controller() != this->playerNum) {
+                    if (this->board.view(x, y).creature() != nullptr && this->board.view(x, y).creature()->controller() != this->playerNum) {
                         this->boardInfo[x][y][TILE_STYLE] = ATTACKABLE;
-                        this->tileActions[x][y].push("mage_strike_from_" + std::to_string(this->selectedTile.x) + "_" + std::to_string(this->selectedTile.y));
+                        this->tileActions[x][y].push(strike);
                     }
                 }
             }
         }
-    } else {
-        this->actionsForClientInfo.push_back(action);
     }
 }
 
-bool Client::processFromHost(std::string action) {
-    if (action.find("Board:") == 0) {
-        this->board = Board::deserialize(action);
+bool Client::processFromHost(const std::string& message, MessageType type) {
+    if (type == KEYFRAME_MESSAGE) {
+        ByteReader reader(message);
+        unsigned int version = reader.readVarint();
+        this->hostBoard.decode(reader);
+        this->boardVersion = version;
+        this->awaitingKeyframe = false;
+        this->keyframeReceived = true;
+        
+        this->tileReceived.assign(this->hostBoard.width() * this->hostBoard.height(0), glfwGetTime());
+        
+        return true; //Only returns true when the board was updated
+    } else if (type == DELTA_MESSAGE) {
+        ByteReader reader(message);
+        unsigned int baseVersion = reader.readVarint();
+        unsigned int version = reader.readVarint();
+        
+        //The delta has everything that changed after the base version, so it can only be applied to a board at least that recent
+        if (this->boardVersion == Board::noVersion || this->boardVersion < baseVersion) {
+            //Deltas sent before the host gets the request keep arriving, but it only needs asking once
+            if (!this->awaitingKeyframe) {
+                this->commands.resync();
+                this->awaitingKeyframe = true;
+                this->acknowledgedVersion = Board::noVersion; //The host forgets the acknowledged version, so the next one must be sent even if it is the same
+            }
+            return true;
+        }
+        
+        if (this->decodedTiles.width() == this->hostBoard.width() && this->decodedTiles.height() == this->hostBoard.height(0))
+            this->decodedTiles.clear();
+        else
+            this->decodedTiles = BitBoard(this->hostBoard.width(), this->hostBoard.height(0));
         
-        return true; //Only returns true when the board was deserialized
-    } else if (action.find("announcement:") != std::string::npos) {
-        action.erase(0, 13); //Erase "announcement:"
-        this->announcementStr = action;
+        this->hostBoard.decodeTiles(reader, &this->decodedTiles);
+        this->boardVersion = version;
+        
+        //Only these need copying to the shown board, see updatePrediction()
+        if (this->hostChangedTiles.width() == this->decodedTiles.width() && this->hostChangedTiles.height() == this->decodedTiles.height())
+            this->hostChangedTiles |= this->decodedTiles;
+        else
+            this->hostChangedTiles = this->decodedTiles;
+        
+        float currentTime = glfwGetTime();
+        std::vector<glm::ivec2> tiles = this->decodedTiles.tiles();
+        for (int a = 0; a < tiles.size(); a++) {
+            this->tileReceived[tiles[a].x * this->hostBoard.height(0) + tiles[a].y] = currentTime;
+        }
+        
+        return true;
+    }
+    
+    TextReader actions(message);
+    while (!actions.atEnd()) {
+        TextReader action = actions.readUntil(';');
+        if (action.skip("announcement:"))
+            this->announcementStr = action.readString('\0');
     }
     
     return false;
 }
 
+void Client::updatePrediction(bool updated) {
+    float currentTime = glfwGetTime();
+    
+    //Corrections fade out over time, however fast frames are drawn
+    float fade = exp(-(currentTime - this->lastFrameTime) / Client::correctionTime);
+    this->lastFrameTime = currentTime;
+    
+    //Moved on first, so that creatures copied below are not moved on twice
+    for (int steps = 0; this->predictionTime + Client::predictionTimestep <= currentTime; steps++) {
+        if (steps == Client::maximumPredictionSteps) {
+            this->predictionTime = currentTime; //Too far behind to catch up, so skip the time, as the host does
+            break;
+        }
+        
+        //Backwards, since a creature that stops is replaced by the last one
+        const std::vector<SlotMap<Creature>::Handle>& animating = this->board.animatingCreatures();
+        for (int a = (int)animating.size() - 1; a >= 0; a--) {
+            glm::ivec2 arrival;
+            const Creature* creature = this->board.creature(animating[a]);
+            this->predictedTiles.set(creature->x(), creature->y());
+            
+            //A correction is for the tile the creature left
+            if (this->board.updateCreature(animating[a], Client::predictionTimestep, &arrival)) {
+                this->offsetCorrections[arrival.x * this->board.height(0) + arrival.y] = 0.0;
+                this->predictedTiles.set(arrival.x, arrival.y);
+            }
+        }
+        this->predictionTime += Client::predictionTimestep;
+    }
+    
+    if (updated) {
+        unsigned int width = this->hostBoard.width();
+        unsigned int height = this->hostBoard.height(0);
+        bool sameSize = this->board.width() == width && this->board.height(0) == height;
+        
+        //After a keyframe everything is copied. Otherwise only the tiles the host changed are, and the tiles prediction changed, since they may no longer match the host
+        bool wholeBoard = this->keyframeReceived || !sameSize;
+        if (wholeBoard) {
+            this->copiedTiles = BitBoard(width, height);
+            this->copiedTiles.setRegion(0, 0, (int)width - 1, (int)height - 1);
+        } else {
+            this->copiedTiles = this->hostChangedTiles;
+            this->copiedTiles |= this->predictedTiles;
+        }
+        std::vector<glm::ivec2> tiles = this->copiedTiles.tiles();
+        
+        //Remember where each creature was shown, so that it can be blended from there
+        this->offsetCorrections.resize(width * height, 0.0);
+        this->shownDirections.resize(width * height, -1);
+        for (int a = 0; a < tiles.size(); a++) {
+            unsigned int tileIndex = tiles[a].x * height + tiles[a].y;
+            const Creature* creature = sameSize ? this->board.viewUnchecked(tiles[a].x, tiles[a].y).creature() : nullptr;
+            if (creature != nullptr) {
+                this->offsetCorrections[tileIndex] += creature->offset();
+                this->shownDirections[tileIndex] = creature->direction();
+            } else {
+                this->shownDirections[tileIndex] = -1;
+            }
+        }
+        
+        if (wholeBoard) {
+            this->board = this->hostBoard;
+            this->hostChangedTiles = BitBoard(width, height);
+            this->predictedTiles = BitBoard(width, height);
+        } else {
+            //Copied in the format the host sends tiles in, which replaces whatever was on them
+            this->tileCopy.clear();
+            this->hostBoard.encodeTiles(this->copiedTiles, this->tileCopy);
+            ByteReader reader(this->tileCopy.data());
+            this->board.decodeTiles(reader);
+            this->hostChangedTiles.clear();
+            this->predictedTiles.clear();
+        }
+        this->keyframeReceived = false;
+        
+        //Each copied creature is moved on by however long ago its tile was sent, up to where the rest were moved on to. After a keyframe, that is now
+        float predictedTo = wholeBoard ? currentTime : this->predictionTime;
+        const std::vector<SlotMap<Creature>::Handle>& animating = this->board.animatingCreatures();
+        for (int a = (int)animating.size() - 1; a >= 0; a--) {
+            SlotMap<Creature>::Handle handle = animating[a];
+            Creature* creature = this->board.creature(handle);
+            if (!this->copiedTiles.test(creature->x(), creature->y()))
+                continue;
+            
+            float elapsed = predictedTo - this->tileReceived[creature->x() * height + creature->y()];
+            
+            //Moved on in the same steps as every frame, until it has caught up or stopped
+            while (elapsed > 0.0 && (creature->offset() != 0.0 || creature->directions.size() > 0)) {
+                glm::ivec2 arrival;
+                this->predictedTiles.set(creature->x(), creature->y());
+                if (this->board.updateCreature(handle, std::min(elapsed, Client::predictionTimestep), &arrival)) {
+                    this->predictedTiles.set(arrival.x, arrival.y);
+                    
+                    //Nothing was shown going this way on a tile that was not copied
+                    if (!this->copiedTiles.test(arrival.x, arrival.y))
+                        this->offsetCorrections[arrival.x * height + arrival.y] = 0.0;
+                }
+                elapsed -= Client::predictionTimestep;
+            }
+        }
+        if (wholeBoard)
+            this->predictionTime = currentTime;
+        
+        for (int a = 0; a < tiles.size(); a++) {
+            unsigned int tileIndex = tiles[a].x * height + tiles[a].y;
+            const Creature* creature = this->board.viewUnchecked(tiles[a].x, tiles[a].y).creature();
+            
+            //Only a creature still going the same way on the same tile is blended, since an offset means nothing on a different tile or in a different direction
+            if (creature != nullptr && this->shownDirections[tileIndex] == creature->direction() && fabs(this->offsetCorrections[tileIndex] - creature->offset()) < 0.4)
+                this->offsetCorrections[tileIndex] -= creature->offset();
+            else
+                this->offsetCorrections[tileIndex] = 0.0;
+        }
+    }
+    
+    for (int a = 0; a < this->offsetCorrections.size(); a++) {
+        this->offsetCorrections[a] *= fade;
+    }
+}
+
 void Client::resolveTileAction(int x, int y) {
     if (x > this->tileActions.size())
         throw std::range_error("X out of bounds");
@@ -358,8 +579,8 @@ void Client::resolveTileAction(int x, int y) {
     if (this->tileActions[x][y].size() == 0)
         throw std::logic_error("No actions to call");
     
-    std::string action = this->tileActions[x][y].front();
+    Command command = this->tileActions[x][y].front();
     this->tileActions[x][y].pop();
     
-    this->actionsForClientInfo.push_back(std::to_string(x) + "," + std::to_string(y) + "," + action);
+    this->commands.tileCommand(command.opcode, command.origin, glm::ivec2(x, y));
 }
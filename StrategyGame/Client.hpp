@@ -17,10 +17,14 @@
 #include <list>
 #include <map>
 #include <thread>
+#include <algorithm>
+#include <cmath>
 
 //Local includes
 #include "Board.hpp"
 #include "Visualizer.hpp"
+#include "NetworkThread.hpp"
+#include "Command.hpp"
 
 //Macros
 #define NO_SELECTION glm::ivec2(-1, -1)
@@ -54,10 +58,17 @@ class Client {
 public:
     
     //Constructor
+    
+    /*!
+     * Receives the initial board from the host, then hands the socket to a network thread, see NetworkThread.hpp.
+     */
     Client(Window* w, ClientSocket* socket, bool* mouseDown, bool* mouseUp, bool* returnToMenu, bool* keys);
     
     //Public member functions
     
+    /*!
+     * Render a frame. Whatever the host has sent since the last frame is applied first and this frame's actions are queued to be sent, without waiting on the network either way, so frames are drawn at the display's rate.
+     */
     void render();
     
     bool getShouldWindowClose();
@@ -68,10 +79,37 @@ private:
     bool* returnToMenu;
     
     //Board info
-    Board board;
+    Board board; //The board that is shown, which is the host's board with its creatures moved on since it was sent, see updatePrediction()
+    Board hostBoard; //The board as the host sent it, which updates are applied to
+    unsigned int boardVersion = Board::noVersion; //The version of the last board update applied to hostBoard, sent back to the host so that it only sends what changed after it. The host counts these for each client, see Host::cameraEpochs
+    unsigned int acknowledgedVersion = Board::noVersion; //The last version sent back to the host
+    bool awaitingKeyframe = false; //Whether a resync was asked for and its keyframe has not arrived yet
+    
+    //Prediction
+    std::vector<float> tileReceived; //When each tile of hostBoard was last sent, from glfwGetTime(), indexed like the board's tile arrays
+    std::vector<float> offsetCorrections; //Added to the offset of the creature on each tile when it is shown, so that it is blended to where the host put it instead of jumping there
+    std::vector<int> shownDirections; //The direction of the creature shown on each tile before an update, or -1 if there was none
+    BitBoard decodedTiles; //The tiles in the last delta, kept so that its memory is reused
+    BitBoard hostChangedTiles; //The tiles of hostBoard that deltas replaced since board was last copied from it
+    BitBoard predictedTiles; //The tiles of board that prediction moved creatures on, off or along since it was last copied from hostBoard
+    BitBoard copiedTiles; //The tiles copied from hostBoard in the last update, kept so that its memory is reused
+    ByteWriter tileCopy; //The copied tiles, encoded, kept so that its memory is reused
+    bool keyframeReceived = false; //Whether a keyframe was decoded into hostBoard since board was last copied from it, in which case all of it is copied
+    float predictionTime = 0.0; //The time that board has been moved on to
+    float lastFrameTime = 0.0;
+    
+    //Creatures are moved in fixed steps, so that they move the same however fast frames are drawn
+    constexpr static const float predictionTimestep = 1.0f / 60.0f;
+    
+    //If the prediction falls further behind than this many steps, the missed time is skipped instead of moved through
+    static const int maximumPredictionSteps = 10;
+    
+    //About how long a correction from the host takes to blend away, in seconds
+    constexpr static const float correctionTime = 0.1f;
     
     //Info unique to client
-    unsigned int playerNum;
+    unsigned int playerNum; //Client::spectatorNum for a spectator, who controls nothing
+    static const unsigned int spectatorNum = UINT_MAX;
     glm::ivec2 selectedTile = glm::ivec2(-1, -1);
     
     std::vector<std::vector<std::array<int, 2> > > boardInfo; //Contains an array of ints (represented by macros) that give information:
@@ -80,7 +118,7 @@ private:
      * [1]: Whether the mouse is hovering, either as TRUE or FALSE
      */
     
-    std::vector<std::vector<std::queue<std::string> > > tileActions; //For each tile, contains a queue of action strings, the first to be done when the tile is clicked if it is reachable
+    std::vector<std::vector<std::queue<Command> > > tileActions; //For each tile, contains a queue of tile commands with only their origin set, the first to be sent with the tile as its destination when the tile is clicked if it is reachable
     
     ClientSocket* socket;
     
@@ -92,7 +130,15 @@ private:
     std::string announcementStr = "Defeat the enemy tower!";
     
     //Information for host
-    std::list<std::string> actionsForClientInfo;
+    CommandWriter commands; //Commands that have not been queued to send yet, including any left over because the network thread's queue was full
+    std::string outgoing; //The batch handed to the network thread, kept so that its memory is reused
+    
+    //The corners of the tiles on the screen that the host was last told about, so that it is only told when they change
+    glm::ivec2 cameraMin = NO_SELECTION;
+    glm::ivec2 cameraMax = NO_SELECTION;
+    
+    //Last, so that the network thread stops before anything else is destroyed
+    NetworkThread network;
     
     
     //Private member functions
@@ -131,20 +177,28 @@ private:
     glm::vec3 tileColor(unsigned int x, unsigned int y);
     
     /*!
-     * A function to process a local action. This may include button actions. Any action to be performed on the host will be added to actionsForClientInfo.
+     * A function to process a local action. This may include button actions. Any command for the host will be added to commands.
      *
      * @param An std::string representing the action to be done.
      */
     void processAction(std::string action);
     
     /*!
-     * A function to process an action received from the host. This likely will be an announcement or the board.
+     * A function to process a message received from the host. This likely will be an announcement or a board update, see Host::boardUpdate(). Keyframes and deltas are decoded into hostBoard in place, and the time that each tile was sent is recorded for updatePrediction(). If a delta cannot be applied, the host is asked to resync.
      *
-     * @param An std::string representing the action to be done.
+     * @param message The body of the message.
+     * @param type What the message holds, from its header.
+     *
+     * @return Whether the message was a board update. If false, that means text actions were processed.
+     */
+    bool processFromHost(const std::string& message, MessageType type);
+    
+    /*!
+     * Move the creatures of the shown board on to the current time. The host only sends a creature's tile when it starts or finishes a step, so in between the creature is moved here the same way the host moves it, see Board::updateCreature(). After an update, the tiles the host changed and the tiles prediction changed are copied from the host's board again, or the whole board after a keyframe, and each moving creature on them is moved on by however long ago its tile was sent. Wherever that puts a creature somewhere other than where it was shown, the difference is blended away instead of the creature jumping. Should be called every frame.
      *
-     * @return Whether the board was deserialized. If false, that means another action was processed.
+     * @param updated Whether an update from the host was applied since the last frame.
      */
-    bool processFromHost(std::string action);
+    void updatePrediction(bool updated);
     
     void resolveTileAction(int x, int y);
 };
@@ -10,7 +10,7 @@
 
 ClientSocket::ClientSocket() {}
 
-void ClientSocket::setSocket(const char* hostName, int portNum) {
+void ClientSocket::setSocket(const char* hostName, int portNum, Transport transport) {
     this->portNumber = portNum;
     
     int returnVal;
@@ -20,7 +20,7 @@ void ClientSocket::setSocket(const char* hostName, int portNum) {
     
     memset(&hints, 0, sizeof(hints)); //Set hints
     hints.ai_family = AF_UNSPEC; //Can be either IPv4 or IPv6
-    hints.ai_socktype = SOCK_STREAM; //TCP Socket
+    hints.ai_socktype = transport == DATAGRAM_TRANSPORT ? SOCK_DGRAM : SOCK_STREAM; //UDP or TCP Socket
     
     /* getaddrinfo
      The getaddrinfo() fills a given addrinfo struct with the relevant information. The return value is nonzero when there is an error.
@@ -77,87 +77,114 @@ void ClientSocket::setSocket(const char* hostName, int portNum) {
      The third argument is the size of the address.
      
      The function returns 0 if successful and -1 if it fails.
+     
+     For UDP, this only sets where packets are sent and which are received. The host is asked to accept this client afterwards.
      */
     if (connect(this->connectionSocket, serverAddress.ai_addr, serverAddress.ai_addrlen) < 0)
         throw std::runtime_error(std::string("ERROR connecting: ") + std::string(strerror(errno)));
     
     freeaddrinfo(serverAddressList); //Free the linked list now that we have the local host information
     
+    if (transport == DATAGRAM_TRANSPORT) {
+        try {
+            DatagramChannel::connect(this->connectionSocket, ClientSocket::connectTimeout);
+        } catch (std::runtime_error) {
+            close(this->connectionSocket);
+            throw;
+        }
+    }
+    
+    this->framer.setSocket(this->connectionSocket);
     this->setUp = true;
 }
 
-void ClientSocket::send(const char* message, bool throwErrorIfNotFullySent) {
+void ClientSocket::send(const char* message) {
+    this->send(message, strlen(message), TEXT_MESSAGE);
+}
+
+void ClientSocket::send(const std::string& message, MessageType type) {
+    this->send(message.data(), message.size(), type);
+}
+
+void ClientSocket::send(const char* message, size_t length, MessageType type) {
     if (!this->setUp)
         throw std::logic_error("Socket not set");
     
-    if (std::string(message) == "")
+    if (length < 1)
         throw std::logic_error("No message to send");
     
-    long messageLength = strlen(message);
-    
-    long messageSize = write(this->connectionSocket, message, messageLength);
-    
-    if (messageSize < 0) {
-        throw std::runtime_error(std::string("ERROR sending message: ") + std::string(strerror(errno)));
-    } else if (messageSize < messageLength) {
-        if (throwErrorIfNotFullySent) { //Error sent only if optional parameter is manually set to true: if the message was too long to send all of it
-            throw std::runtime_error(std::string("ERROR message too long: only sent ") + std::to_string(messageSize) + std::string(" of ") + std::to_string(messageLength));
-        } else {
-            std::cout << "ERROR message too long: only sent " << messageSize << " of " << messageLength << std::endl;
-        }
-    }
+    this->framer.send(message, length, type);
 }
 
-std::string ClientSocket::receive(bool* socketClosed) {
+std::string ClientSocket::receive(bool* socketClosed, MessageType* type) {
     if (!this->setUp)
         throw std::logic_error("Socket not set");
     
-    char buffer[MAXIMUM_SOCKET_MESSAGE_SIZE]; //This program will read characters from the connection into this buffer
+    std::string message;
+    MessageType messageType = TEXT_MESSAGE;
     
-    //Initialize the buffer where received info is stored
-    bzero(buffer, MAXIMUM_SOCKET_MESSAGE_SIZE);
+    //Blocks until the whole message has arrived, or the timeout set with setTimeout() passes
+    if (!this->framer.receive(message, messageType)) {
+        if (socketClosed != nullptr)
+            *socketClosed = true;
+    }
     
-    long messageSize; //Stores the return value from the calls to read() and write() by holding the number of characters either read or written
+    if (type != nullptr)
+        *type = messageType;
     
-    /* read()
-     The read() function will read in info from the client socket, with three arguments. It will block until the client writes and there is something to read in.
-     
-     The first argument is the reference for the client's socket.
-     
-     The second argument is the buffer to store the message.
-     
-     The third argument is the maximum number of characters to to be read into the buffer.
-     */
-    messageSize = read(this->connectionSocket, buffer, MAXIMUM_SOCKET_MESSAGE_SIZE);
+    return message;
+}
+
+bool ClientSocket::messageWaiting() {
+    if (!this->setUp)
+        throw std::logic_error("Socket not set");
     
-    //Checks for errors reading from the socket
-    if (messageSize < 0)
-        throw std::runtime_error(std::string("ERROR reading from socket: ") + std::string(strerror(errno)));
+    if (this->framer.hasMessage())
+        return true;
     
-    if (socketClosed != nullptr && messageSize == 0) {
-        *socketClosed = true;
-    }
+    pollfd readable;
+    readable.fd = this->connectionSocket;
+    readable.events = POLLIN;
+    readable.revents = 0;
+    
+    return poll(&readable, 1, 0) > 0;
+}
+
+void ClientSocket::setNonBlocking() {
+    if (!this->setUp)
+        throw std::logic_error("Socket not set");
     
-    std::string str = std::string(buffer, messageSize);
+    int flags = fcntl(this->connectionSocket, F_GETFL, 0);
+    if (flags < 0 || fcntl(this->connectionSocket, F_SETFL, flags | O_NONBLOCK) < 0)
+        throw std::runtime_error(std::string("ERROR making socket non-blocking: ") + std::string(strerror(errno)));
+}
+
+bool ClientSocket::readAvailable() {
+    if (!this->setUp)
+        throw std::logic_error("Socket not set");
     
-    //Check if there is more data waiting to be read, and if so, read it
-    fd_set readfds;
-    FD_ZERO(&readfds);
-    FD_SET(this->connectionSocket, &readfds);
-    int n = this->connectionSocket + 1;
+    return this->framer.readAvailable();
+}
+
+bool ClientSocket::nextMessage(std::string& message, MessageType& type) {
+    if (!this->setUp)
+        throw std::logic_error("Socket not set");
     
-    struct timeval timeout;
-    timeout.tv_sec = 0;
-    timeout.tv_usec = 20000;
+    return this->framer.nextMessage(message, type);
+}
+
+void ClientSocket::flush() {
+    if (!this->setUp)
+        throw std::logic_error("Socket not set");
     
-    int returnValue = select(n, &readfds, NULL, NULL, &timeout);
-    if (returnValue < 0) {
-        throw std::runtime_error(std::string("ERROR finding information about socket: ") + std::string(strerror(errno)));
-    } else if (returnValue > 0) {
-        str += this->receive();
-    }
+    this->framer.flush();
+}
+
+int ClientSocket::timeUntilDue() {
+    if (!this->setUp)
+        throw std::logic_error("Socket not set");
     
-    return str;
+    return this->framer.timeUntilDue();
 }
 
 void ClientSocket::setTimeout(unsigned int seconds, unsigned int milliseconds) {
@@ -170,14 +197,23 @@ void ClientSocket::setTimeout(unsigned int seconds, unsigned int milliseconds) {
     time.tv_usec = (milliseconds * 1000);
     setsockopt(this->connectionSocket, SOL_SOCKET, SO_RCVTIMEO, (const char*)&time, sizeof(time));
 #endif
+    
+    //UDP is always read without blocking, so the framer times out waiting instead
+    this->framer.setReceiveTimeout((seconds == 0 && milliseconds == 0) ? -1 : (int)(seconds * 1000 + milliseconds));
 }
 
 bool ClientSocket::getSet() {
     return this->setUp;
 }
 
+int ClientSocket::getFileDescriptor() {
+    return this->setUp ? this->connectionSocket : -1;
+}
+
 ClientSocket::~ClientSocket() {
-    if (this->setUp)
+    if (this->setUp) {
         //Properly terminate the sockets
+        this->framer.sendClose();
         close(this->connectionSocket);
+    }
 }
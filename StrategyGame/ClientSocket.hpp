@@ -24,6 +24,10 @@
 #include <netinet/in.h>
 #include <netdb.h>
 #include <fcntl.h>
+#include <poll.h>
+
+#include "MessageFramer.hpp"
+#include "DatagramChannel.hpp"
 
 class ClientSocket {
 public:
@@ -42,25 +46,82 @@ public:
      *
      * @param hostName A const char* indicating the name of the host to whom to connect. "localhost" specifies that the host is on the same machine. Otherwise, use the name of the client.
      * @param portNum The number of the port on the host at which clients should connect.
+     * @param transport An optional parameter indicating whether to connect over TCP or UDP, which must be the same as the host's, see DatagramChannel.hpp. Autoinitialized as DEFAULT_TRANSPORT.
+     */
+    void setSocket(const char* hostName, int portNum, Transport transport = DEFAULT_TRANSPORT);
+    
+    /*!
+     * A function that sends a text message to the host. The whole message is always sent, see MessageFramer.hpp. An error will be thrown if the socket is not set or if an error occurs in sending the message.
+     *
+     * @param message The message to be sent, as a const char*.
+     */
+    void send(const char* message);
+    
+    /*!
+     * A function that sends a message of any type to the host. The message may hold any bytes, including '\0'. An error will be thrown if the socket is not set or if an error occurs in sending the message.
+     *
+     * @param message The message to be sent.
+     * @param type What the message holds.
+     */
+    void send(const std::string& message, MessageType type);
+    
+    /*!
+     * A function that sends a message of any type to the host, straight from the given bytes. An error will be thrown if the socket is not set or if an error occurs in sending the message.
+     *
+     * @param message The first byte of the message.
+     * @param length The number of bytes in the message.
+     * @param type What the message holds.
+     */
+    void send(const char* message, size_t length, MessageType type);
+    
+    /*!
+     * A function that receives a whole message from the host, exactly as it was sent. The function will wait for the host to send the message, until the timeout set with setTimeout(), and if the message is not received it will throw an error. An error is also thrown if the socket is not set.
+     *
+     * @param socketClosed An optional pointer to a bool that would be set to true if the host disconnected. Automatically set to a null pointer otherwise.
+     * @param type An optional pointer to a MessageType that is set to the type of the message. Automatically set to a null pointer otherwise.
+     *
+     * @return The received message from the host. Empty if the host disconnected.
      */
-    void setSocket(const char* hostName, int portNum);
+    std::string receive(bool* socketClosed = nullptr, MessageType* type = nullptr);
     
     /*!
-     * A function that sends a message to the host. An error will be thrown if the socket is not set or if an error occurs in sending the message.
+     * A function that checks, without waiting, whether receive() has something to return right away. An error is thrown if the socket is not set.
      *
-     * @param message A std::string of the message to be sent.
-     * @param throwErrorIfNotFullySent An optional boolean indicating if an error should be thrown if only part of the message was sent. Automatically set to false.
+     * @return True if a message, or part of one, has arrived from the host.
      */
-    void send(const char* message, bool throwErrorIfNotFullySent = false);
+    bool messageWaiting();
     
     /*!
-     * A function that receives a message from the host. The function will wait for a short period for the client to send the message, and if the message is not received it will throw an error. An error is also thrown if the socket is not set.
+     * A function to make the socket non-blocking, so that readAvailable() never waits. receive() and send() still wait, until their timeouts. An error is thrown if the socket is not set or cannot be made non-blocking.
+     */
+    void setNonBlocking();
+    
+    /*!
+     * A function that reads everything that has arrived from the host, without waiting, so that the whole messages can be taken with nextMessage(). The socket must be non-blocking, see setNonBlocking(). An error is thrown if the socket is not set, if reading fails, or if the host sent a corrupt stream.
      *
-     * @param socketClosed An optional pointer to a bool that would be set to true if the client disconnected. Automatically set to a null pointer otherwise.
+     * @return False if the host disconnected.
+     */
+    bool readAvailable();
+    
+    /*!
+     * A function that takes the next whole message that has already been read from the host, without reading or waiting. An error is thrown if the socket is not set.
+     *
+     * @param message Set to the body of the message.
+     * @param type Set to what the message holds.
      *
-     * @return The received message from the host.
+     * @return Whether there was a whole message.
+     */
+    bool nextMessage(std::string& message, MessageType& type);
+    
+    /*!
+     * A function that resends whatever the host has not acknowledged in time and acknowledges what it sent, over UDP. Call this whenever timeUntilDue() runs out. An error is thrown if the socket is not set, if sending fails, or if the host has stopped answering.
      */
-    std::string receive(bool* socketClosed = nullptr);
+    void flush();
+    
+    /*!
+     * @return The milliseconds until flush() has something to send, or -1 if it never does by itself, as over TCP.
+     */
+    int timeUntilDue();
     
     /*!
      * A function to set a timeout for reading from the socket, until otherwise specified. If a socket times out and receive()'s optional bool pointer has been into it, then it will indicate the socket closed. To reset to no timeout, set seconds to 0.
@@ -75,6 +136,11 @@ public:
      */
     bool getSet();
     
+    /*!
+     * @return The file descriptor of the connection, so that it can be waited on with poll(). -1 if the socket is not set.
+     */
+    int getFileDescriptor();
+    
 private:
     //Private properties
     
@@ -98,9 +164,13 @@ private:
      */
     
     int connectionSocket; //This is the "file descriptor", which stores values from both the socket system call and the accept system call
+    
+    MessageFramer framer; //Splits the bytes from the host into messages, see MessageFramer.hpp
     int portNumber; //The port nubmer where connections are accepted
     
     bool setUp = false; //Represents if the socket has already been set. If not, reading and writing will cause errors
+    
+    static const int connectTimeout = 5000; //The milliseconds to wait for the host to accept over UDP
 };
 
 #endif /* ClientSocket_hpp */
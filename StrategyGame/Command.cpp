@@ -0,0 +1,96 @@
+//
+//  Command.cpp
+//  Strategy Game
+//
+
+#include "Command.hpp"
+
+//Indexed by opcode
+static constexpr unsigned int fieldCounts[NUMBER_OF_OPCODES] = {1, 0, 0, 4, 4, 4, 0, 4};
+
+//Command
+
+unsigned int Command::fieldCount(uint8_t opcode) {
+    if (opcode >= NUMBER_OF_OPCODES)
+        throw std::range_error("Invalid opcode: " + std::to_string(opcode));
+    
+    return fieldCounts[opcode];
+}
+
+//CommandWriter
+
+void CommandWriter::acknowledge(unsigned int version) {
+    this->writer.writeByte(ACKNOWLEDGE_OPCODE);
+    this->writer.writeVarint(version);
+}
+
+void CommandWriter::resync() {
+    this->writer.writeByte(RESYNC_OPCODE);
+}
+
+void CommandWriter::leaveGame() {
+    this->writer.writeByte(LEAVE_GAME_OPCODE);
+}
+
+void CommandWriter::requestCompression() {
+    this->writer.writeByte(REQUEST_COMPRESSION_OPCODE);
+}
+
+void CommandWriter::camera(glm::ivec2 minTile, glm::ivec2 maxTile) {
+    this->writer.writeByte(CAMERA_OPCODE);
+    this->writer.writeVarint(minTile.x);
+    this->writer.writeVarint(minTile.y);
+    this->writer.writeVarint(maxTile.x);
+    this->writer.writeVarint(maxTile.y);
+}
+
+void CommandWriter::tileCommand(Opcode opcode, glm::ivec2 origin, glm::ivec2 destination) {
+    if (opcode != MOVE_CREATURE_OPCODE && opcode != ATTACK_OPCODE && opcode != MAGE_STRIKE_OPCODE)
+        throw std::invalid_argument("Not a tile command: " + std::to_string(opcode));
+    
+    this->writer.writeByte(opcode);
+    this->writer.writeVarint(origin.x);
+    this->writer.writeVarint(origin.y);
+    this->writer.writeVarint(destination.x);
+    this->writer.writeVarint(destination.y);
+}
+
+void CommandWriter::clear() {
+    this->writer.clear();
+}
+
+const std::string& CommandWriter::data() const {
+    return this->writer.data();
+}
+
+bool CommandWriter::empty() const {
+    return this->writer.size() == 0;
+}
+
+//CommandReader
+
+CommandReader::CommandReader(const std::string& data) : reader(data) {}
+
+bool CommandReader::next(Command& command) {
+    if (this->reader.remaining() == 0)
+        return false;
+    
+    uint8_t opcode = this->reader.readByte();
+    
+    switch (Command::fieldCount(opcode)) {
+        case 0:
+            break;
+        case 1:
+            command.version = this->reader.readVarint();
+            break;
+        case 4:
+            command.origin.x = this->reader.readVarint();
+            command.origin.y = this->reader.readVarint();
+            command.destination.x = this->reader.readVarint();
+            command.destination.y = this->reader.readVarint();
+            break;
+    }
+    
+    command.opcode = (Opcode)opcode;
+    return true;
+}
@@ -0,0 +1,148 @@
+//
+//  Command.hpp
+//  Strategy Game
+//
+
+#ifndef Command_hpp
+#define Command_hpp
+
+//Standard library includes
+#include <string>
+#include <exception>
+#include <stdexcept>
+#include <stdint.h>
+
+//GLM: OpenGL mathematics for vectors here
+#include <glm/glm.hpp>
+
+//Local includes
+#include "ByteStream.hpp"
+
+//How commands are sent:
+//A client sends everything it wants the host to do as commands, batched into one ACTION_MESSAGE per frame. Each command is an opcode byte followed by a fixed set of varint fields that depends only on the opcode, see Command::fieldCount(), so a batch is read straight through with no delimiters or string matching. Tile coordinates are written as x then y, the creature's tile first and then the tile it acts on.
+
+/*!
+ * What a command asks the host to do.
+ */
+enum Opcode : uint8_t {
+    ACKNOWLEDGE_OPCODE = 0, //The client has applied the board update with the given version. Fields: version
+    RESYNC_OPCODE = 1, //The client could not apply a delta and needs the whole board. No fields
+    LEAVE_GAME_OPCODE = 2, //The client's player is leaving the game. No fields
+    MOVE_CREATURE_OPCODE = 3, //Move the creature on the origin tile to the destination. Fields: origin, destination
+    ATTACK_OPCODE = 4, //Attack the destination with the creature on the origin tile. Fields: origin, destination
+    MAGE_STRIKE_OPCODE = 5, //Strike the destination with the mage on the origin tile, ignoring range. Fields: origin, destination
+    REQUEST_COMPRESSION_OPCODE = 6, //The client can read COMPRESSED_MESSAGEs and would like its board updates compressed, see Compressor.hpp. No fields
+    CAMERA_OPCODE = 7, //The client's camera shows the tiles from the origin to the destination, inclusive, so it only needs to be sent what is there. Fields: origin, destination
+};
+
+#define NUMBER_OF_OPCODES 8
+
+/*!
+ * One decoded command. Only the fields of its opcode are set.
+ */
+struct Command {
+    Opcode opcode = ACKNOWLEDGE_OPCODE;
+    glm::ivec2 origin = glm::ivec2(0, 0); //The tile of the creature doing the action, or the corner of the camera with the lowest coordinates
+    glm::ivec2 destination = glm::ivec2(0, 0); //The tile the action is done to, or the corner of the camera with the highest coordinates
+    unsigned int version = 0;
+    
+    /*!
+     * @param opcode An opcode, which may be invalid.
+     *
+     * @return The number of varint fields that follow the opcode. Tiles count as two fields. A range_error is thrown if the opcode is invalid.
+     */
+    static unsigned int fieldCount(uint8_t opcode);
+    
+    /*!
+     * @return Whether the command acts on tiles, and so has an origin and destination.
+     */
+    inline bool hasTiles() const { return Command::fieldCount(this->opcode) == 4; }
+    
+    /*!
+     * @return Whether the command acts on the game, rather than on what the client is sent. Only these are refused from spectators.
+     */
+    inline bool changesGame() const { return this->opcode == LEAVE_GAME_OPCODE || this->opcode == MOVE_CREATURE_OPCODE || this->opcode == ATTACK_OPCODE || this->opcode == MAGE_STRIKE_OPCODE; }
+};
+
+/*!
+ * Builds a batch of commands to send to the host.
+ */
+class CommandWriter {
+public:
+    //Public member functions
+    
+    void acknowledge(unsigned int version);
+    void resync();
+    void leaveGame();
+    void requestCompression();
+    
+    /*!
+     * Write which tiles the client's camera shows.
+     *
+     * @param minTile The corner of the camera with the lowest coordinates.
+     * @param maxTile The corner of the camera with the highest coordinates.
+     */
+    void camera(glm::ivec2 minTile, glm::ivec2 maxTile);
+    
+    /*!
+     * Write a command that acts on tiles.
+     *
+     * @param opcode MOVE_CREATURE_OPCODE, ATTACK_OPCODE or MAGE_STRIKE_OPCODE. An invalid_argument exception is thrown otherwise.
+     * @param origin The tile of the creature doing the action.
+     * @param destination The tile the action is done to.
+     */
+    void tileCommand(Opcode opcode, glm::ivec2 origin, glm::ivec2 destination);
+    
+    /*!
+     * Empty the batch, keeping the allocated memory for the next one.
+     */
+    void clear();
+    
+    //Public get functions
+    
+    /*!
+     * @return The bytes of the batch, to send as an ACTION_MESSAGE.
+     */
+    const std::string& data() const;
+    
+    /*!
+     * @return Whether no commands have been written.
+     */
+    bool empty() const;
+    
+private:
+    //Private properties
+    
+    ByteWriter writer;
+};
+
+/*!
+ * Reads a batch of commands written by a CommandWriter. Like a ByteReader, the bytes are not copied, so they must outlive the reader.
+ */
+class CommandReader {
+public:
+    //Constructor
+    
+    /*!
+     * @param data The bytes of the batch.
+     */
+    CommandReader(const std::string& data);
+    
+    //Public member functions
+    
+    /*!
+     * Read the next command. A range_error is thrown if the batch is corrupt, either with an invalid opcode or with missing fields.
+     *
+     * @param command Set to the command read.
+     *
+     * @return Whether there was a command. False once the whole batch has been read.
+     */
+    bool next(Command& command);
+    
+private:
+    //Private properties
+    
+    ByteReader reader;
+};
+
+#endif /* Command_hpp */
@@ -0,0 +1,183 @@
+//
+//  Compressor.cpp
+//  Strategy Game
+//
+
+#include "Compressor.hpp"
+
+//Constructor
+
+Compressor::Compressor() : hashTable(1 << Compressor::hashBits, 0) {}
+
+//Public member functions
+
+void Compressor::compress(const char* data, size_t length, ByteWriter& writer) {
+    std::fill(this->hashTable.begin(), this->hashTable.end(), 0);
+    
+    size_t anchor = 0; //The first byte that has not been written yet
+    size_t position = 0;
+    
+    while (position + Compressor::minimumMatch <= length) {
+        uint32_t& entry = this->hashTable[Compressor::hash(data + position)];
+        size_t candidate = entry;
+        entry = (uint32_t)position + 1;
+        
+        //The same hash does not mean the same bytes, so they are compared
+        if (candidate == 0 || position - (candidate - 1) > Compressor::maximumOffset || memcmp(data + candidate - 1, data + position, Compressor::minimumMatch) != 0) {
+            position++;
+            continue;
+        }
+        
+        size_t match = candidate - 1;
+        size_t matchLength = Compressor::minimumMatch;
+        while (position + matchLength < length && data[match + matchLength] == data[position + matchLength]) {
+            matchLength++;
+        }
+        
+        Compressor::writeSequence(data + anchor, position - anchor, position - match, matchLength, writer);
+        
+        position += matchLength;
+        anchor = position;
+    }
+    
+    Compressor::writeSequence(data + anchor, length - anchor, 0, 0, writer);
+}
+
+void Compressor::compressMessage(const std::string& message, MessageType type, ByteWriter& writer) {
+    writer.clear();
+    writer.writeByte(type);
+    writer.writeVarint((uint32_t)message.size());
+    this->compress(message.data(), message.size(), writer);
+}
+
+void Compressor::decompress(const char* data, size_t length, size_t decompressedLength, std::string& output) {
+    output.resize(decompressedLength);
+    
+    ByteReader reader(data, length);
+    size_t written = 0;
+    
+    while (true) {
+        uint8_t token = reader.readByte();
+        
+        size_t numberOfLiterals = token >> 4;
+        if (numberOfLiterals == 15)
+            numberOfLiterals += Compressor::readLength(reader);
+        
+        if (numberOfLiterals > decompressedLength - written)
+            throw std::range_error("Compressed literals past the end of the output");
+        
+        if (numberOfLiterals > 0)
+            memcpy(&output[written], reader.readBytes(numberOfLiterals), numberOfLiterals);
+        written += numberOfLiterals;
+        
+        if (reader.remaining() == 0)
+            break;
+        
+        size_t offset = reader.readUInt16();
+        if (offset == 0 || offset > written)
+            throw std::range_error("Compressed match before the start of the output");
+        
+        size_t matchLength = (token & 15) + Compressor::minimumMatch;
+        if ((token & 15) == 15)
+            matchLength += Compressor::readLength(reader);
+        
+        if (matchLength > decompressedLength - written)
+            throw std::range_error("Compressed match past the end of the output");
+        
+        //Copied a byte at a time, since the match may overlap the bytes it is copying, which is how runs are written
+        for (size_t a = 0; a < matchLength; a++) {
+            output[written + a] = output[written + a - offset];
+        }
+        written += matchLength;
+    }
+    
+    if (written != decompressedLength)
+        throw std::range_error("Compressed block is shorter than its length");
+}
+
+MessageType Compressor::decompressMessage(const std::string& message, std::string& output) {
+    ByteReader reader(message);
+    
+    uint8_t type = reader.readByte();
+    if (type == COMPRESSED_MESSAGE)
+        throw std::range_error("Compressed message inside of a compressed message");
+    
+    uint32_t decompressedLength = reader.readVarint();
+    if (decompressedLength > MAXIMUM_SOCKET_MESSAGE_SIZE)
+        throw std::range_error("Compressed message is too long: " + std::to_string(decompressedLength));
+    
+    size_t blockLength = reader.remaining();
+    Compressor::decompress(reader.readBytes(blockLength), blockLength, decompressedLength, output);
+    
+    return (MessageType)type;
+}
+
+void Compressor::runLengthEncode(const unsigned char* data, size_t length, ByteWriter& writer) {
+    size_t a = 0;
+    while (a < length) {
+        size_t runEnd = a + 1;
+        while (runEnd < length && data[runEnd] == data[a] && runEnd - a < UINT32_MAX) {
+            runEnd++;
+        }
+        
+        writer.writeVarint((uint32_t)(runEnd - a));
+        writer.writeByte(data[a]);
+        a = runEnd;
+    }
+}
+
+void Compressor::runLengthDecode(ByteReader& reader, unsigned char* output, size_t length) {
+    size_t a = 0;
+    while (a < length) {
+        uint32_t runLength = reader.readVarint();
+        uint8_t value = reader.readByte();
+        
+        if (runLength == 0 || runLength > length - a)
+            throw std::range_error("Run of " + std::to_string(runLength) + " does not fit in the data");
+        
+        memset(output + a, value, runLength);
+        a += runLength;
+    }
+}
+
+//Private member functions
+
+void Compressor::writeSequence(const char* literals, size_t numberOfLiterals, size_t offset, size_t matchLength, ByteWriter& writer) {
+    size_t matchNibble = offset != 0 ? matchLength - Compressor::minimumMatch : 0;
+    
+    writer.writeByte((uint8_t)((std::min(numberOfLiterals, (size_t)15) << 4) | std::min(matchNibble, (size_t)15)));
+    
+    if (numberOfLiterals >= 15)
+        Compressor::writeLength(numberOfLiterals - 15, writer);
+    writer.writeBytes(literals, numberOfLiterals);
+    
+    if (offset == 0)
+        return;
+    
+    writer.writeUInt16((uint16_t)offset);
+    if (matchNibble >= 15)
+        Compressor::writeLength(matchNibble - 15, writer);
+}
+
+void Compressor::writeLength(size_t length, ByteWriter& writer) {
+    while (length >= 255) {
+        writer.writeByte(255);
+        length -= 255;
+    }
+    writer.writeByte((uint8_t)length);
+}
+
+size_t Compressor::readLength(ByteReader& reader) {
+    size_t length = 0;
+    uint8_t byte;
+    do {
+        byte = reader.readByte();
+        length += byte;
+        
+        //Each byte adds at most 255, so a corrupt block cannot make a length much longer than itself
+        if (length > MAXIMUM_SOCKET_MESSAGE_SIZE)
+            throw std::range_error("Compressed length is too long");
+    } while (byte == 255);
+    
+    return length;
+}
@@ -0,0 +1,139 @@
+//
+//  Compressor.hpp
+//  Strategy Game
+//
+
+#ifndef Compressor_hpp
+#define Compressor_hpp
+
+#include "Macros.h"
+
+//Standard library includes
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+
+#include <stdint.h>
+#include <string.h>
+
+//Local includes
+#include "ByteStream.hpp"
+#include "MessageFramer.hpp"
+
+//How board updates are compressed:
+//A client can ask the host to compress its board updates, see REQUEST_COMPRESSION_OPCODE. Keyframes for it then have their terrain run-length encoded, since most of a board is long runs of the same terrain, see Board::encode(). The whole update is then compressed with an LZ4-style codec, which mostly finds the creatures and buildings repeating each other's stats, and sent as a COMPRESSED_MESSAGE: the type of the update as a byte, its length as a varint, then the compressed block. The host sends whichever of the two is smaller, so small deltas are not made larger.
+//A block is a series of sequences, each a token byte, some literal bytes, and then a match: a copy of earlier output, given by a 2 byte little-endian offset back from the end of the output. The high 4 bits of the token are the number of literals and the low 4 bits are the length of the match minus Compressor::minimumMatch. A nibble of 15 is followed by bytes that are added to it, each 255 meaning another follows. The last sequence has only literals, and the block ends after them.
+
+/*!
+ * Compresses board updates for clients that asked for it, see Compressor.hpp. The compression functions keep a hash table between calls so that its memory is reused, so each thread needs its own Compressor, but the decompression functions are static.
+ */
+class Compressor {
+public:
+    //Constructor
+    Compressor();
+    
+    //Public member functions
+    
+    /*!
+     * Compress bytes into a block.
+     *
+     * @param data The bytes to compress.
+     * @param length The number of bytes.
+     * @param writer The ByteWriter to append the block to.
+     */
+    void compress(const char* data, size_t length, ByteWriter& writer);
+    
+    /*!
+     * Compress a message to be sent as a COMPRESSED_MESSAGE.
+     *
+     * @param message The bytes of the message.
+     * @param type What the message holds.
+     * @param writer The ByteWriter to write the compressed message to. It is cleared first.
+     */
+    void compressMessage(const std::string& message, MessageType type, ByteWriter& writer);
+    
+    /*!
+     * Decompress a block written by compress(). A range_error is thrown if the block is corrupt or does not decompress to exactly the given length.
+     *
+     * @param data The first byte of the block.
+     * @param length The number of bytes in the block.
+     * @param decompressedLength The number of bytes that the block decompresses to.
+     * @param output Set to the decompressed bytes. Its memory is reused.
+     */
+    static void decompress(const char* data, size_t length, size_t decompressedLength, std::string& output);
+    
+    /*!
+     * Decompress a message written by compressMessage(). A range_error is thrown if it is corrupt or would decompress to more than MAXIMUM_SOCKET_MESSAGE_SIZE.
+     *
+     * @param message The bytes of the COMPRESSED_MESSAGE.
+     * @param output Set to the bytes of the original message. Its memory is reused, so it must not be the same string as message.
+     *
+     * @return What the original message holds.
+     */
+    static MessageType decompressMessage(const std::string& message, std::string& output);
+    
+    /*!
+     * Write bytes as runs of the same value, each a varint count followed by the value. The number of bytes is not written.
+     *
+     * @param data The bytes to encode.
+     * @param length The number of bytes.
+     * @param writer The ByteWriter to write to.
+     */
+    static void runLengthEncode(const unsigned char* data, size_t length, ByteWriter& writer);
+    
+    /*!
+     * Read bytes written by runLengthEncode(). A range_error is thrown if the runs do not add up to exactly the given length, or the bytes end early.
+     *
+     * @param reader The ByteReader to read from. It is moved past the runs.
+     * @param output Where to write the decoded bytes.
+     * @param length The number of bytes to decode.
+     */
+    static void runLengthDecode(ByteReader& reader, unsigned char* output, size_t length);
+    
+private:
+    //Private properties
+    
+    std::vector<uint32_t> hashTable; //The position after the last place each hash of 4 bytes was seen, or 0 if it has not been
+    
+    static const unsigned int hashBits = 12;
+    
+    //The shortest match that is worth a sequence, and the farthest back that one can be
+    static const size_t minimumMatch = 4;
+    static const size_t maximumOffset = 65535;
+    
+    //Private member functions
+    
+    /*!
+     * Write a token, the literals and a match.
+     *
+     * @param literals The first literal byte.
+     * @param numberOfLiterals The number of literal bytes.
+     * @param offset How far back the match starts, or 0 if this is the last sequence and has no match.
+     * @param matchLength The length of the match.
+     * @param writer The ByteWriter to write to.
+     */
+    static void writeSequence(const char* literals, size_t numberOfLiterals, size_t offset, size_t matchLength, ByteWriter& writer);
+    
+    /*!
+     * Write the part of a length that did not fit in its nibble.
+     */
+    static void writeLength(size_t length, ByteWriter& writer);
+    
+    /*!
+     * Read the part of a length that did not fit in its nibble.
+     */
+    static size_t readLength(ByteReader& reader);
+    
+    /*!
+     * @return The index in the hash table of 4 bytes.
+     */
+    static inline unsigned int hash(const char* data) {
+        uint32_t bytes;
+        memcpy(&bytes, data, sizeof(bytes));
+        return (bytes * 2654435761U) >> (32 - Compressor::hashBits);
+    }
+};
+
+#endif /* Compressor_hpp */
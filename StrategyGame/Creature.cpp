@@ -9,6 +9,8 @@
 #include "Creature.hpp"
 #include <iostream>
 
+const unsigned int Creature::encodedDirections; //Defined here as well, so that it can be passed by reference
+
 //Constructors
 
 Creature::Creature(unsigned int x, unsigned int y, Race race, unsigned int maxHealth, unsigned int maxEnergy, unsigned int attack, AttackStyle attackStyle,  unsigned int vision, unsigned int range, unsigned int startDirection, unsigned int controller) : Attackable(maxHealth, x, y, controller), raceVal(race), maxEnergyVal(maxEnergy), attackVal(attack), attackStyleVal(attackStyle), visionVal(vision), rangeVal(range) {
@@ -231,96 +233,169 @@ std::string Creature::serialize() const {
     
 }
 
-Creature Creature::deserialize(std::string str) {
-    str.erase(0, 9); //To erase "Creature:"
+Creature Creature::deserialize(const std::string& str) {
+    TextReader reader(str);
+    return Creature::deserialize(reader);
+}
+
+Creature Creature::deserialize(TextReader& reader) {
+    reader.expect("Creature:");
     
     Race race = Human;
     AttackStyle attackStyle = Melee;
     int direction;
     
     
-    int controller = std::stoi(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
+    int controller = reader.readInt(',');
     
     //Extract the race of the creature
     
-    if (str.substr(0, str.find_first_of(',')) == "Human") {
+    if (reader.skip("Human,")) {
         race = Human;
-    } else if (str.substr(0, str.find_first_of(',')) == "Elf") {
+    } else if (reader.skip("Elf,")) {
         race = Elf;
-    } else if (str.substr(0, str.find_first_of(',')) == "Dwarf") {
+    } else if (reader.skip("Dwarf,")) {
         race = Dwarf;
-    } else if (str.substr(0, str.find_first_of(',')) == "Orc") {
+    } else if (reader.skip("Orc,")) {
         race = Orc;
-    } else if (str.substr(0, str.find_first_of(',')) == "Goblin") {
+    } else if (reader.skip("Goblin,")) {
         race = Goblin;
-    } else if (str.substr(0, str.find_first_of(',')) == "Undead") {
+    } else if (reader.skip("Undead,")) {
         race = Undead;
-    } else if (str.substr(0, str.find_first_of(',')) == "Vampire") {
+    } else if (reader.skip("Vampire,")) {
         race = Vampire;
     } else {
         throw std::invalid_argument("Error deserializing creature: unreadable creature race");
     }
-    str = str.substr(str.find_first_of(',') + 1);
     
-    if (str.substr(0, str.find_first_of(',')) == "Melee") {
+    if (reader.skip("Melee,")) {
         attackStyle = Melee;
-    } else if (str.substr(0, str.find_first_of(',')) == "Ranged") {
+    } else if (reader.skip("Ranged,")) {
         attackStyle = Ranged;
-    } else if (str.substr(0, str.find_first_of(',')) == "Magic") {
+    } else if (reader.skip("Magic,")) {
         attackStyle = Magic;
     } else {
         throw std::invalid_argument("Error deserializing creature: unreadable creature race");
     }
-    str = str.substr(str.find_first_of(',') + 1);
     
     //Extract the numerical values of the creature
-    int maxHealth = std::stoi(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
-    int maxEnergy = std::stoi(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
-    int attack = std::stoi(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
-    int vision = std::stoi(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
-    int range = std::stoi(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
-    int health = std::stoi(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
-    int energy = std::stoi(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
-    
-    if (str.substr(0, str.find_first_of(',')) == "NORTH") {
+    int maxHealth = reader.readInt(',');
+    int maxEnergy = reader.readInt(',');
+    int attack = reader.readInt(',');
+    int vision = reader.readInt(',');
+    int range = reader.readInt(',');
+    int health = reader.readInt(',');
+    int energy = reader.readInt(',');
+    
+    if (reader.skip("NORTH,")) {
         direction = NORTH;
-        str = str.substr(str.find_first_of(',') + 1);
-    } else if (str.substr(0, str.find_first_of(',')) == "EAST") {
+    } else if (reader.skip("EAST,")) {
         direction = EAST;
-        str = str.substr(str.find_first_of(',') + 1);
-    } else if (str.substr(0, str.find_first_of(',')) == "SOUTH") {
+    } else if (reader.skip("SOUTH,")) {
         direction = SOUTH;
-        str = str.substr(str.find_first_of(',') + 1);
-    } else if (str.substr(0, str.find_first_of(',')) == "WEST") {
+    } else if (reader.skip("WEST,")) {
         direction = WEST;
-        str = str.substr(str.find_first_of(',') + 1);
     } else {
         throw std::invalid_argument("Error deserializing creature: unreadable creature direction");
     }
     
-    float offset = std::stof(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
-    int x = std::stoi(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
-    int y = std::stoi(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
+    float offset = reader.readFloat(',');
+    int x = reader.readInt(',');
+    int y = reader.readInt(',');
     
     Creature creature(x, y, race, maxHealth, maxEnergy, attack, attackStyle, vision, range, direction, controller);
     creature.takeDamage(maxHealth - health);
     creature.decrementEnergy(maxEnergy - energy);
     creature.setOffset(offset);
     
-    creature.buttonInfo = Attackable::deserializeButtons(str.substr(0, str.find("-Buttons-")));
+    creature.buttonInfo = Attackable::deserializeButtons(reader);
+    reader.skip("-Creature-");
+    
+    return creature;
+}
+
+void Creature::encode(ByteWriter& writer, bool withDirections) const {
+    writer.writeVarint(this->controllerVal);
+    writer.writeByte(this->raceVal);
+    writer.writeByte(this->attackStyleVal);
+    writer.writeVarint(this->maxHealthVal);
+    writer.writeVarint(this->maxEnergyVal);
+    writer.writeVarint(this->attackVal);
+    writer.writeVarint(this->visionVal);
+    writer.writeVarint(this->rangeVal);
+    writer.writeVarint(this->healthVal);
+    writer.writeVarint(this->energyVal);
+    writer.writeByte(this->directionVal);
+    writer.writeFloat(this->offsetVal);
+    
+    unsigned int numDirections = withDirections ? std::min((unsigned int)this->directions.size(), Creature::encodedDirections) : 0;
+    writer.writeVarint(numDirections);
+    if (numDirections > 0) {
+        std::queue<int> directions = this->directions;
+        for (unsigned int a = 0; a < numDirections; a++) {
+            writer.writeByte(directions.front());
+            directions.pop();
+        }
+    }
+    
+    writer.writeVarint(this->xVal);
+    writer.writeVarint(this->yVal);
+    this->Attackable::encodeButtons(writer);
+}
+
+Creature Creature::decode(ByteReader& reader) {
+    unsigned int controller = reader.readVarint();
     
+    uint8_t race = reader.readByte();
+    if (race >= NUMBER_OF_RACES)
+        throw std::invalid_argument("Error decoding creature: unknown creature race");
+    
+    uint8_t attackStyle = reader.readByte();
+    if (attackStyle >= NUMBER_OF_ATTACK_STYLES)
+        throw std::invalid_argument("Error decoding creature: unknown creature attack style");
+    
+    unsigned int maxHealth = reader.readVarint();
+    unsigned int maxEnergy = reader.readVarint();
+    unsigned int attack = reader.readVarint();
+    unsigned int vision = reader.readVarint();
+    unsigned int range = reader.readVarint();
+    unsigned int health = reader.readVarint();
+    unsigned int energy = reader.readVarint();
+    
+    //Health and energy are applied as what is missing from the maximum, which would wrap around if they were above it
+    if (health > maxHealth)
+        throw std::invalid_argument("Error decoding creature: health above maximum health");
+    if (energy > maxEnergy)
+        throw std::invalid_argument("Error decoding creature: energy above maximum energy");
+    
+    uint8_t direction = reader.readByte();
+    if (direction > WEST)
+        throw std::invalid_argument("Error decoding creature: unknown creature direction");
+    
+    float offset = reader.readFloat();
+    
+    unsigned int numDirections = reader.readVarint();
+    if (numDirections > Creature::encodedDirections)
+        throw std::invalid_argument("Error decoding creature: too many directions");
+    
+    std::queue<int> directions;
+    for (unsigned int a = 0; a < numDirections; a++) {
+        uint8_t queuedDirection = reader.readByte();
+        if (queuedDirection > WEST)
+            throw std::invalid_argument("Error decoding creature: unknown creature direction");
+        directions.push(queuedDirection);
+    }
+    
+    unsigned int x = reader.readVarint();
+    unsigned int y = reader.readVarint();
+    
+    Creature creature(x, y, (Race)race, maxHealth, maxEnergy, attack, (AttackStyle)attackStyle, vision, range, direction, controller);
+    creature.takeDamage(maxHealth - health);
+    creature.decrementEnergy(maxEnergy - energy);
+    creature.setOffset(offset);
+    creature.directions = directions;
     
+    creature.buttonInfo = Attackable::decodeButtons(reader);
     
     return creature;
 }
@@ -14,6 +14,7 @@
 //Standard library includes
 #include <string>
 #include <queue>
+#include <algorithm>
 
 //Local includes
 #include "Attackable.hpp"
@@ -39,6 +40,10 @@ enum AttackStyle {
     Magic, //ignores terrain
 };
 
+//Numbers of the enum values above, for the tables in TerrainRules
+#define NUMBER_OF_RACES 7
+#define NUMBER_OF_ATTACK_STYLES 3
+
 
 class Creature : public Attackable {
 public:
@@ -218,7 +223,33 @@ public:
      *
      * @return The object created.
      */
-    static Creature deserialize(std::string str);
+    static Creature deserialize(const std::string& str);
+    
+    /*!
+     * Create an object from a serialized string, as part of a longer message.
+     *
+     * @param reader The TextReader to read from. It is moved past the object.
+     *
+     * @return The object created.
+     */
+    static Creature deserialize(TextReader& reader);
+    
+    /*!
+     * Write this object in the binary format, which is much smaller than the serialized string and is read in linear time. See ByteStream.hpp. Only the next Creature::encodedDirections directions are written, enough for a client to keep the creature moving until the host sends its tile again.
+     *
+     * @param writer The ByteWriter to write to.
+     * @param withDirections An optional bool indicating whether to write the directions the creature is about to move in. Clients that do not control the creature are sent none, so that they cannot see where it is going. Autoinitialized as true.
+     */
+    void encode(ByteWriter& writer, bool withDirections = true) const;
+    
+    /*!
+     * Create an object from bytes written by encode(). A range_error is thrown if the bytes end early, and an invalid_argument exception if they hold an impossible value.
+     *
+     * @param reader The ByteReader to read from. It is moved past the object.
+     *
+     * @return The object created.
+     */
+    static Creature decode(ByteReader& reader);
     
 private:
     //Private properties
@@ -238,6 +269,9 @@ private:
     //The speed that the creature moves when it is animated.
     constexpr static const float movementAnimationSpeed = 2.0f;
     
+    //The most directions written by encode()
+    static const unsigned int encodedDirections = 4;
+    
     //Private member functions
     
     /*!
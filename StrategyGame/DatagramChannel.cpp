@@ -0,0 +1,715 @@
+//
+//  DatagramChannel.cpp
+//  Strategy Game
+//
+
+#include "DatagramChannel.hpp"
+
+//Defined here as well, so that they can be passed by reference
+const size_t DatagramChannel::maximumPacketSize;
+const size_t DatagramChannel::maximumFragmentSize;
+constexpr const float DatagramChannel::minimumResendTime;
+constexpr const float DatagramChannel::maximumResendTime;
+constexpr const float DatagramChannel::acknowledgementDelay;
+constexpr const float DatagramChannel::connectResendTime;
+
+//Constructor
+
+DatagramChannel::DatagramChannel(int socket) : socket(socket), reliableWindow(DatagramChannel::reliableWindowSize), packet(DatagramChannel::maximumPacketSize), received(DatagramChannel::maximumPacketSize + 1) {
+    this->lastSent = Clock::now();
+    this->lastReceived = this->lastSent;
+    
+    this->setMaximumReceiveLength(MAXIMUM_SOCKET_MESSAGE_SIZE);
+}
+
+//Static functions
+
+int DatagramChannel::accept(int listeningSocket, sockaddr_storage* address, socklen_t* addressSize, std::deque<uint32_t>& acceptedNonces) {
+    char request[DatagramChannel::cookieHandshakeLength + 1];
+    
+    while (true) {
+        *addressSize = sizeof(sockaddr_storage);
+        long bytesRead = recvfrom(listeningSocket, request, sizeof(request), MSG_DONTWAIT, (struct sockaddr *)address, addressSize);
+        if (bytesRead < 0)
+            return -1;
+        
+        uint32_t nonce;
+        uint64_t cookie;
+        uint64_t period = DatagramChannel::cookiePeriodNow();
+        
+        //Nothing is kept for a request, so that requests from addresses that never hear the answer cost nothing
+        if (DatagramChannel::readHandshake(request, bytesRead, CONNECT_PACKET, nonce, cookie)) {
+            char challenge[DatagramChannel::cookieHandshakeLength];
+            size_t length = DatagramChannel::writeHandshake(CHALLENGE_PACKET, nonce, DatagramChannel::cookie(address, nonce, period), challenge);
+            sendto(listeningSocket, challenge, length, MSG_DONTWAIT, (struct sockaddr *)address, *addressSize); //If the challenge is lost, the client asks again
+            continue;
+        }
+        
+        if (!DatagramChannel::readHandshake(request, bytesRead, RESPONSE_PACKET, nonce, cookie))
+            continue;
+        if (cookie != DatagramChannel::cookie(address, nonce, period) && (period == 0 || cookie != DatagramChannel::cookie(address, nonce, period - 1)))
+            continue;
+        
+        //The client answers until it hears back, so the answers that were already accepted may still be waiting
+        if (std::find(acceptedNonces.begin(), acceptedNonces.end(), nonce) != acceptedNonces.end())
+            continue;
+        
+        sockaddr_storage localAddress;
+        socklen_t localAddressSize = sizeof(sockaddr_storage);
+        if (getsockname(listeningSocket, (struct sockaddr *)&localAddress, &localAddressSize) < 0)
+            return -1;
+        
+        int clientSocket = ::socket(localAddress.ss_family, SOCK_DGRAM, 0);
+        if (clientSocket < 0)
+            return -1;
+        
+        //Bound to the same port as the listening socket, which Linux allows with SO_REUSEADDR and other systems with SO_REUSEPORT
+        int enable = 1;
+#if defined(__linux__)
+        int reuseOption = SO_REUSEADDR;
+#else
+        int reuseOption = SO_REUSEPORT;
+#endif
+        if (setsockopt(clientSocket, SOL_SOCKET, reuseOption, &enable, sizeof(int)) < 0 || bind(clientSocket, (struct sockaddr *)&localAddress, localAddressSize) < 0 || ::connect(clientSocket, (struct sockaddr *)address, *addressSize) < 0) {
+            int error = errno;
+            close(clientSocket);
+            errno = error;
+            return -1;
+        }
+        
+        char answer[DatagramChannel::handshakeLength];
+        size_t length = DatagramChannel::writeHandshake(ACCEPT_PACKET, nonce, 0, answer);
+        ::send(clientSocket, answer, length, MSG_DONTWAIT); //If the answer is lost, the client answers the challenge again, and the new socket answers it
+        
+        acceptedNonces.push_back(nonce);
+        if (acceptedNonces.size() > DatagramChannel::maximumAcceptedNonces)
+            acceptedNonces.pop_front();
+        
+        return clientSocket;
+    }
+}
+
+void DatagramChannel::connect(int socket, int timeoutMilliseconds) {
+    std::random_device random;
+    uint32_t nonce = random();
+    
+    char request[DatagramChannel::cookieHandshakeLength];
+    size_t requestLength = DatagramChannel::writeHandshake(CONNECT_PACKET, nonce, 0, request);
+    
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMilliseconds);
+    
+    while (Clock::now() < deadline) {
+        if (::send(socket, request, requestLength, MSG_DONTWAIT) < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            throw std::runtime_error(std::string("ERROR connecting: ") + std::string(strerror(errno)));
+        
+        Clock::time_point resend = std::min(deadline, Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(DatagramChannel::connectResendTime)));
+        
+        //Wait for the answer until it is time to ask again
+        while (true) {
+            int wait = (int)std::chrono::duration_cast<std::chrono::milliseconds>(resend - Clock::now()).count();
+            if (wait <= 0)
+                break;
+            
+            pollfd readable;
+            readable.fd = socket;
+            readable.events = POLLIN;
+            readable.revents = 0;
+            
+            if (poll(&readable, 1, wait) <= 0)
+                continue;
+            
+            char answer[DatagramChannel::cookieHandshakeLength + 1];
+            long bytesRead = recv(socket, answer, sizeof(answer), MSG_DONTWAIT);
+            
+            if (bytesRead < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+                    continue;
+                throw std::runtime_error(std::string("ERROR connecting: ") + std::string(strerror(errno))); //Such as ECONNREFUSED, when nothing is listening on the port
+            }
+            
+            uint32_t answerNonce;
+            uint64_t cookie;
+            if (DatagramChannel::readHandshake(answer, bytesRead, ACCEPT_PACKET, answerNonce, cookie) && answerNonce == nonce)
+                return;
+            
+            //From now on the cookie is sent back instead of the request, starting right away
+            if (DatagramChannel::readHandshake(answer, bytesRead, CHALLENGE_PACKET, answerNonce, cookie) && answerNonce == nonce) {
+                requestLength = DatagramChannel::writeHandshake(RESPONSE_PACKET, nonce, cookie, request);
+                break;
+            }
+        }
+    }
+    
+    throw std::runtime_error("ERROR connecting: timed out");
+}
+
+//Public member functions
+
+void DatagramChannel::send(const char* data, size_t length, MessageType type) {
+    if (length > MAXIMUM_SOCKET_MESSAGE_SIZE)
+        throw std::range_error("ERROR message too long: " + std::to_string(length) + " bytes");
+    
+    uint16_t count = (uint16_t)std::max((length + DatagramChannel::maximumFragmentSize - 1) / DatagramChannel::maximumFragmentSize, (size_t)1);
+    
+    if (DatagramChannel::isReliable(type)) {
+        if (this->unacknowledgedBytes + length > MAXIMUM_SOCKET_MESSAGE_SIZE)
+            throw std::runtime_error("ERROR sending message: the other side is not reading");
+        
+        for (uint16_t a = 0; a < count; a++) {
+            size_t start = a * DatagramChannel::maximumFragmentSize;
+            
+            this->unacknowledged.emplace_back();
+            SentFragment& fragment = this->unacknowledged.back();
+            fragment.sequence = this->nextReliable++;
+            fragment.type = type;
+            fragment.index = a;
+            fragment.count = count;
+            fragment.bytes.assign(data + start, std::min(length - start, DatagramChannel::maximumFragmentSize));
+        }
+        this->unacknowledgedBytes += length;
+        
+        this->flush();
+        return;
+    }
+    
+    uint32_t number = this->nextSequenced++;
+    
+    for (uint16_t a = 0; a < count; a++) {
+        size_t start = a * DatagramChannel::maximumFragmentSize;
+        
+        this->startData();
+        this->packet.writeByte(type);
+        this->packet.writeUInt32(number);
+        this->packet.writeUInt32(this->nextReliable);
+        this->packet.writeUInt16(a);
+        this->packet.writeUInt16(count);
+        this->packet.writeBytes(data + start, std::min(length - start, DatagramChannel::maximumFragmentSize));
+        
+        //Board updates are never resent, so one that does not fit is dropped like any other lost packet
+        if (!this->sendPacket())
+            return;
+    }
+}
+
+bool DatagramChannel::receive(std::string& message, MessageType& type, int timeoutMilliseconds) {
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMilliseconds);
+    
+    while (!this->hasMessage()) {
+        int wait = this->timeUntilDue();
+        if (timeoutMilliseconds >= 0) {
+            int remaining = (int)std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+            if (remaining <= 0)
+                throw std::runtime_error("ERROR reading from socket: timed out");
+            wait = std::min(wait, remaining);
+        }
+        
+        pollfd readable;
+        readable.fd = this->socket;
+        readable.events = POLLIN;
+        readable.revents = 0;
+        
+        if (poll(&readable, 1, wait) < 0 && errno != EINTR)
+            throw std::runtime_error(std::string("ERROR reading from socket: ") + std::string(strerror(errno)));
+        
+        if (!this->readAvailable())
+            return this->nextMessage(message, type); //Messages that arrived before the connection closed are still taken
+        
+        this->flush();
+    }
+    
+    return this->nextMessage(message, type);
+}
+
+bool DatagramChannel::readAvailable() {
+    while (!this->closed) {
+        long bytesRead = recv(this->socket, this->received.data(), this->received.size(), MSG_DONTWAIT);
+        
+        if (bytesRead < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return true; //Everything that has arrived has been read
+            if (errno == ECONNREFUSED)
+                return false; //Nothing is listening on the other side any more
+            
+            throw std::runtime_error(std::string("ERROR reading from socket: ") + std::string(strerror(errno)));
+        }
+        
+        //The buffer is one byte longer than any packet that is sent, so that a longer one shows
+        if (bytesRead > (long)DatagramChannel::maximumPacketSize)
+            continue;
+        
+        try {
+            this->handlePacket(this->received.data(), bytesRead);
+        } catch (std::range_error) {} //Unlike a stream, a corrupt packet does not affect the ones after it, so it is only dropped
+    }
+    
+    return false;
+}
+
+bool DatagramChannel::nextMessage(std::string& message, MessageType& type) {
+    if (this->messages.empty())
+        return false;
+    
+    type = this->messages.front().first;
+    message.swap(this->messages.front().second);
+    this->messages.pop_front();
+    
+    return true;
+}
+
+bool DatagramChannel::flush() {
+    Clock::time_point now = Clock::now();
+    
+    if (std::chrono::duration<float>(now - this->lastReceived).count() > DatagramChannel::connectionTimeout)
+        throw std::runtime_error("ERROR reading from socket: the other side stopped answering");
+    
+    this->blocked = false;
+    float resendTime = this->resendTime();
+    
+    for (auto fragment = this->unacknowledged.begin(); fragment != this->unacknowledged.end(); fragment++) {
+        if (fragment->sequence - this->unacknowledged.front().sequence >= DatagramChannel::reliableWindowSize)
+            break;
+        
+        if (fragment->acknowledged || (fragment->sent && std::chrono::duration<float>(now - fragment->lastSent).count() < resendTime))
+            continue;
+        
+        if (!this->sendFragment(*fragment, now))
+            return false;
+    }
+    
+    if ((this->acknowledgementDue && now >= this->acknowledgementTime) || std::chrono::duration<float>(now - this->lastSent).count() >= DatagramChannel::heartbeatInterval) {
+        this->startData();
+        if (!this->sendPacket())
+            return false;
+    }
+    
+    return true;
+}
+
+void DatagramChannel::sendClose() {
+    if (this->closed)
+        return;
+    
+    this->packet.clear();
+    this->packet.writeUInt16(DatagramChannel::protocolId);
+    this->packet.writeByte(CLOSE_PACKET);
+    ::send(this->socket, this->packet.data().data(), this->packet.size(), MSG_DONTWAIT);
+    
+    this->closed = true;
+}
+
+void DatagramChannel::setMaximumReceiveLength(size_t length) {
+    this->maximumReceiveLength = std::min(length, (size_t)MAXIMUM_SOCKET_MESSAGE_SIZE);
+    this->maximumFragments = (this->maximumReceiveLength + DatagramChannel::maximumFragmentSize - 1) / DatagramChannel::maximumFragmentSize;
+}
+
+//Public get functions
+
+bool DatagramChannel::hasMessage() const {
+    return !this->messages.empty();
+}
+
+bool DatagramChannel::hasQueued() const {
+    for (auto fragment = this->unacknowledged.begin(); fragment != this->unacknowledged.end(); fragment++) {
+        if (!fragment->sent)
+            return true;
+    }
+    return false;
+}
+
+int DatagramChannel::timeUntilDue() const {
+    Clock::time_point now = Clock::now();
+    float resendTime = this->resendTime();
+    
+    //The connection timing out is found by flush() as well
+    float due = std::min(DatagramChannel::heartbeatInterval - std::chrono::duration<float>(now - this->lastSent).count(), DatagramChannel::connectionTimeout - std::chrono::duration<float>(now - this->lastReceived).count());
+    
+    if (this->acknowledgementDue)
+        due = std::min(due, std::chrono::duration<float>(this->acknowledgementTime - now).count());
+    
+    for (auto fragment = this->unacknowledged.begin(); fragment != this->unacknowledged.end(); fragment++) {
+        if (fragment->sequence - this->unacknowledged.front().sequence >= DatagramChannel::reliableWindowSize)
+            break;
+        
+        if (fragment->acknowledged)
+            continue;
+        
+        //A fragment the socket had no room for is tried again shortly, rather than spinning until there is room
+        if (!fragment->sent)
+            due = std::min(due, this->blocked ? DatagramChannel::minimumResendTime : 0.0f);
+        else
+            due = std::min(due, resendTime - std::chrono::duration<float>(now - fragment->lastSent).count());
+    }
+    
+    return std::max((int)std::ceil(due * 1000.0f), 0);
+}
+
+size_t DatagramChannel::partialLength() const {
+    return this->reliableMessage.size() + (this->sequenced.active ? this->sequenced.bytes.size() : 0);
+}
+
+//Private member functions
+
+void DatagramChannel::startData() {
+    this->packet.clear();
+    this->packet.writeUInt16(DatagramChannel::protocolId);
+    this->packet.writeByte(DATA_PACKET);
+    this->packet.writeUInt32(this->nextExpected);
+    
+    uint32_t bits = 0;
+    for (uint32_t a = 0; a < 32; a++) {
+        if (this->reliableWindow[(this->nextExpected + 1 + a) % DatagramChannel::reliableWindowSize].present)
+            bits |= 1u << a;
+    }
+    this->packet.writeUInt32(bits);
+}
+
+void DatagramChannel::writeFragment(const SentFragment& fragment) {
+    this->packet.writeByte(fragment.type);
+    this->packet.writeUInt32(fragment.sequence);
+    this->packet.writeUInt16(fragment.index);
+    this->packet.writeUInt16(fragment.count);
+    this->packet.writeBytes(fragment.bytes.data(), fragment.bytes.size());
+}
+
+bool DatagramChannel::sendFragment(SentFragment& fragment, Clock::time_point now) {
+    this->startData();
+    this->writeFragment(fragment);
+    
+    if (!this->sendPacket())
+        return false;
+    
+    fragment.resent = fragment.sent;
+    fragment.sent = true;
+    fragment.lastSent = now;
+    return true;
+}
+
+bool DatagramChannel::sendPacket() {
+    while (true) {
+        long bytesSent = ::send(this->socket, this->packet.data().data(), this->packet.size(), MSG_DONTWAIT);
+        
+        if (bytesSent >= 0)
+            break;
+        if (errno == EINTR)
+            continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+            this->blocked = true;
+            return false;
+        }
+        if (errno == ECONNREFUSED)
+            return true; //Reported for an earlier packet, and the next read finds that the other side is gone
+        
+        throw std::runtime_error(std::string("ERROR sending message: ") + std::string(strerror(errno)));
+    }
+    
+    this->lastSent = Clock::now();
+    this->acknowledgementDue = false;
+    return true;
+}
+
+void DatagramChannel::handlePacket(const char* data, size_t length) {
+    uint32_t nonce;
+    uint64_t cookie;
+    if (DatagramChannel::readHandshake(data, length, RESPONSE_PACKET, nonce, cookie)) {
+        //The client did not hear the answer from accept(), so it is sent again. The cookie was already checked when this socket was made
+        char answer[DatagramChannel::handshakeLength];
+        size_t answerLength = DatagramChannel::writeHandshake(ACCEPT_PACKET, nonce, 0, answer);
+        ::send(this->socket, answer, answerLength, MSG_DONTWAIT);
+        this->lastReceived = Clock::now();
+        return;
+    }
+    
+    ByteReader reader(data, length);
+    if (reader.readUInt16() != DatagramChannel::protocolId)
+        return;
+    
+    uint8_t kind = reader.readByte();
+    if (kind == CLOSE_PACKET) {
+        this->closed = true;
+        return;
+    }
+    if (kind != DATA_PACKET)
+        return;
+    
+    uint32_t next = reader.readUInt32();
+    uint32_t bits = reader.readUInt32();
+    this->lastReceived = Clock::now();
+    this->acknowledge(next, bits);
+    
+    if (reader.remaining() == 0)
+        return;
+    
+    uint8_t type = reader.readByte();
+    if (type > COMPRESSED_MESSAGE)
+        throw std::range_error("Unknown message type: " + std::to_string(type));
+    
+    uint32_t sequence = reader.readUInt32();
+    uint32_t reliableBefore = DatagramChannel::isReliable((MessageType)type) ? 0 : reader.readUInt32();
+    uint16_t index = reader.readUInt16();
+    uint16_t count = reader.readUInt16();
+    
+    size_t fragmentLength = reader.remaining();
+    
+    //Every fragment but the last is full, which is how the length of a message is known once its last fragment arrives
+    if (count > this->maximumFragments || index >= count || fragmentLength > DatagramChannel::maximumFragmentSize || (index + 1 < count && fragmentLength != DatagramChannel::maximumFragmentSize))
+        throw std::range_error("Fragment " + std::to_string(index) + " of " + std::to_string(count) + " has the wrong length");
+    
+    const char* fragment = reader.readBytes(fragmentLength);
+    
+    if (DatagramChannel::isReliable((MessageType)type))
+        this->receiveReliable(sequence, (MessageType)type, index, count, fragment, fragmentLength);
+    else
+        this->receiveSequenced(sequence, reliableBefore, (MessageType)type, index, count, fragment, fragmentLength);
+}
+
+void DatagramChannel::acknowledge(uint32_t next, uint32_t bits) {
+    Clock::time_point now = Clock::now();
+    
+    auto measure = [this, now](const SentFragment& fragment) {
+        if (fragment.sent && !fragment.resent && !fragment.acknowledged)
+            this->roundTrip += (std::chrono::duration<float>(now - fragment.lastSent).count() - this->roundTrip) / 8.0f;
+    };
+    
+    //Compared by their difference, so that sequence numbers can wrap around
+    while (!this->unacknowledged.empty() && (int32_t)(this->unacknowledged.front().sequence - next) < 0) {
+        measure(this->unacknowledged.front());
+        this->unacknowledgedBytes -= std::min(this->unacknowledgedBytes, this->unacknowledged.front().bytes.size());
+        this->unacknowledged.pop_front();
+    }
+    
+    if (this->unacknowledged.empty() || bits == 0)
+        return;
+    
+    for (uint32_t a = 0; a < 32; a++) {
+        uint32_t offset = next + 1 + a - this->unacknowledged.front().sequence;
+        if ((bits & (1u << a)) && offset < this->unacknowledged.size()) {
+            measure(this->unacknowledged[offset]);
+            this->unacknowledged[offset].acknowledged = true;
+        }
+    }
+}
+
+void DatagramChannel::receiveReliable(uint32_t sequence, MessageType type, uint16_t index, uint16_t count, const char* data, size_t length) {
+    //Even a fragment that was already received is acknowledged again, since its acknowledgement may have been lost
+    if (!this->acknowledgementDue) {
+        this->acknowledgementDue = true;
+        this->acknowledgementTime = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(DatagramChannel::acknowledgementDelay));
+    }
+    
+    if (sequence - this->nextExpected >= DatagramChannel::reliableWindowSize)
+        return; //Already received, or too far ahead to have been sent
+    
+    ReceivedFragment& slot = this->reliableWindow[sequence % DatagramChannel::reliableWindowSize];
+    slot.present = true;
+    slot.type = type;
+    slot.index = index;
+    slot.count = count;
+    slot.bytes.assign(data, length);
+    
+    while (true) {
+        ReceivedFragment& fragment = this->reliableWindow[this->nextExpected % DatagramChannel::reliableWindowSize];
+        if (!fragment.present)
+            break;
+        
+        if (fragment.index == 0) {
+            this->reliableMessage.clear();
+            this->reliableIndex = 0;
+            this->reliableCount = fragment.count;
+        }
+        
+        //A fragment that does not carry on the message being put back together is dropped along with that message, so that the other side cannot make it grow past the longest message accepted
+        if (fragment.index != this->reliableIndex || fragment.count != this->reliableCount || this->reliableMessage.size() + fragment.bytes.size() > this->maximumReceiveLength) {
+            this->reliableMessage.clear();
+            this->reliableIndex = 0;
+        } else if (fragment.index + 1 == fragment.count) {
+            this->reliableMessage.append(fragment.bytes);
+            this->messages.emplace_back(fragment.type, std::string());
+            this->messages.back().second.swap(this->reliableMessage);
+            this->reliableIndex = 0;
+        } else {
+            this->reliableMessage.append(fragment.bytes);
+            this->reliableIndex++;
+        }
+        
+        fragment.present = false;
+        this->nextExpected++;
+    }
+    
+    this->deliverSequenced();
+}
+
+void DatagramChannel::receiveSequenced(uint32_t number, uint32_t reliableBefore, MessageType type, uint16_t index, uint16_t count, const char* data, size_t length) {
+    //Older than the newest message handed over, so it would undo it
+    if ((int32_t)(number - this->sequencedReceived) < 0)
+        return;
+    
+    SequencedMessage& message = this->sequenced;
+    
+    if (!message.active || message.number != number) {
+        if (message.active && (int32_t)(number - message.number) < 0)
+            return; //A newer message has already started arriving
+        
+        //Whatever is left of an older message is given up on, since this one replaces it
+        message.active = true;
+        message.number = number;
+        message.type = type;
+        message.reliableBefore = reliableBefore;
+        message.count = count;
+        message.received = 0;
+        message.length = 0;
+        message.fragments.assign(count, false);
+        message.bytes.resize(count * DatagramChannel::maximumFragmentSize);
+    }
+    
+    if (count != message.count || type != message.type || message.fragments[index])
+        return;
+    
+    memcpy(&message.bytes[index * DatagramChannel::maximumFragmentSize], data, length);
+    message.fragments[index] = true;
+    message.received++;
+    if (index + 1 == count)
+        message.length = index * DatagramChannel::maximumFragmentSize + length;
+    
+    this->deliverSequenced();
+}
+
+void DatagramChannel::deliverSequenced() {
+    SequencedMessage& message = this->sequenced;
+    
+    if (!message.active || message.received < message.count || (int32_t)(this->nextExpected - message.reliableBefore) < 0)
+        return;
+    
+    message.bytes.resize(message.length);
+    this->messages.emplace_back(message.type, std::string());
+    this->messages.back().second.swap(message.bytes);
+    
+    this->sequencedReceived = message.number + 1;
+    message.active = false;
+}
+
+float DatagramChannel::resendTime() const {
+    return std::min(std::max(2.0f * this->roundTrip, DatagramChannel::minimumResendTime), DatagramChannel::maximumResendTime);
+}
+
+size_t DatagramChannel::writeHandshake(uint8_t kind, uint32_t nonce, uint64_t cookie, char* packet) {
+    packet[0] = (char)(DatagramChannel::protocolId & 0xFF);
+    packet[1] = (char)(DatagramChannel::protocolId >> 8);
+    packet[2] = (char)kind;
+    for (int a = 0; a < 4; a++) {
+        packet[3 + a] = (char)((nonce >> (8 * a)) & 0xFF);
+    }
+    
+    if (kind != CHALLENGE_PACKET && kind != RESPONSE_PACKET)
+        return DatagramChannel::handshakeLength;
+    
+    for (int a = 0; a < 8; a++) {
+        packet[DatagramChannel::handshakeLength + a] = (char)((cookie >> (8 * a)) & 0xFF);
+    }
+    return DatagramChannel::cookieHandshakeLength;
+}
+
+bool DatagramChannel::readHandshake(const char* data, size_t length, uint8_t kind, uint32_t& nonce, uint64_t& cookie) {
+    bool hasCookie = kind == CHALLENGE_PACKET || kind == RESPONSE_PACKET;
+    if (length != (hasCookie ? DatagramChannel::cookieHandshakeLength : DatagramChannel::handshakeLength))
+        return false;
+    
+    ByteReader reader(data, length);
+    if (reader.readUInt16() != DatagramChannel::protocolId || reader.readByte() != kind)
+        return false;
+    
+    nonce = reader.readUInt32();
+    cookie = 0;
+    if (hasCookie) {
+        cookie = reader.readUInt32();
+        cookie |= (uint64_t)reader.readUInt32() << 32;
+    }
+    return true;
+}
+
+uint64_t DatagramChannel::cookie(const sockaddr_storage* address, uint32_t nonce, uint64_t period) {
+    //Made once and never sent, so that no one else can make a cookie
+    static const std::array<uint64_t, 2> key = [] {
+        std::random_device random;
+        std::array<uint64_t, 2> key;
+        for (int a = 0; a < 2; a++) {
+            key[a] = ((uint64_t)random() << 32) | random();
+        }
+        return key;
+    }();
+    
+    //The port and address of the client, followed by the nonce and the period
+    uint8_t input[2 + 16 + 4 + 8];
+    size_t length = 0;
+    
+    if (address->ss_family == AF_INET) {
+        const sockaddr_in* client = (const sockaddr_in*)address;
+        memcpy(input, &client->sin_port, 2);
+        memcpy(input + 2, &client->sin_addr, 4);
+        length = 6;
+    } else if (address->ss_family == AF_INET6) {
+        const sockaddr_in6* client = (const sockaddr_in6*)address;
+        memcpy(input, &client->sin6_port, 2);
+        memcpy(input + 2, &client->sin6_addr, 16);
+        length = 18;
+    }
+    
+    for (int a = 0; a < 4; a++) {
+        input[length++] = (uint8_t)(nonce >> (8 * a));
+    }
+    for (int a = 0; a < 8; a++) {
+        input[length++] = (uint8_t)(period >> (8 * a));
+    }
+    
+    return DatagramChannel::sipHash(key, input, length);
+}
+
+uint64_t DatagramChannel::cookiePeriodNow() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::seconds>(Clock::now().time_since_epoch()).count() / DatagramChannel::cookiePeriod;
+}
+
+uint64_t DatagramChannel::sipHash(const std::array<uint64_t, 2>& key, const uint8_t* data, size_t length) {
+    uint64_t v0 = key[0] ^ 0x736f6d6570736575ull;
+    uint64_t v1 = key[1] ^ 0x646f72616e646f6dull;
+    uint64_t v2 = key[0] ^ 0x6c7967656e657261ull;
+    uint64_t v3 = key[1] ^ 0x7465646279746573ull;
+    
+    auto rotate = [](uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    };
+    auto round = [&]() {
+        v0 += v1; v1 = rotate(v1, 13); v1 ^= v0; v0 = rotate(v0, 32);
+        v2 += v3; v3 = rotate(v3, 16); v3 ^= v2;
+        v0 += v3; v3 = rotate(v3, 21); v3 ^= v0;
+        v2 += v1; v1 = rotate(v1, 17); v1 ^= v2; v2 = rotate(v2, 32);
+    };
+    
+    //Whole little-endian words, and then the rest with the length in the top byte
+    size_t end = length - length % 8;
+    for (size_t a = 0; a < end; a += 8) {
+        uint64_t word = 0;
+        for (int b = 0; b < 8; b++) {
+            word |= (uint64_t)data[a + b] << (8 * b);
+        }
+        v3 ^= word;
+        round();
+        round();
+        v0 ^= word;
+    }
+    
+    uint64_t last = (uint64_t)(length & 0xFF) << 56;
+    for (size_t a = end; a < length; a++) {
+        last |= (uint64_t)data[a] << (8 * (a - end));
+    }
+    v3 ^= last;
+    round();
+    round();
+    v0 ^= last;
+    
+    v2 ^= 0xFF;
+    for (int a = 0; a < 4; a++) {
+        round();
+    }
+    return v0 ^ v1 ^ v2 ^ v3;
+}
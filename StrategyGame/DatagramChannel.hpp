@@ -0,0 +1,374 @@
+//
+//  DatagramChannel.hpp
+//  Strategy Game
+//
+
+#ifndef DatagramChannel_hpp
+#define DatagramChannel_hpp
+
+#include "Macros.h"
+
+//Standard library includes
+#include <string>
+#include <vector>
+#include <deque>
+#include <utility>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <array>
+#include <exception>
+#include <stdexcept>
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+//Local includes
+#include "ByteStream.hpp"
+#include "MessageFramer.hpp"
+
+//How messages are sent over UDP:
+//With TCP, a lost segment holds back every byte behind it until it is resent, so one dropped packet delays every board update after it, even though each update replaces the one before. A DatagramChannel sends the same messages as a MessageFramer over a connected UDP socket instead, on one of two channels depending on the type of the message.
+//Board updates, KEYFRAME_MESSAGE, DELTA_MESSAGE and COMPRESSED_MESSAGE, are sequenced and unreliable. They are never resent, and one that arrives after a newer one is dropped, so a lost update only costs the time until the next. The host sends deltas from the last version the client acknowledged, see Host::boardUpdate(), so nothing else is needed to recover from one. An update is still held back until every reliable message sent before it has arrived, so that a client never sees a keyframe before the initial data of the handshake.
+//Everything else, TEXT_MESSAGE and ACTION_MESSAGE, is reliable and ordered. Each fragment is resent until the other side acknowledges it, and messages are handed over in the order they were sent.
+//Every packet acknowledges the reliable fragments received so far, as the next one expected and a bitfield of the 32 after it, so acknowledgements ride along on board updates and commands. A packet with nothing else in it is only sent if nothing carried them for DatagramChannel::acknowledgementDelay, or if nothing at all was sent for DatagramChannel::heartbeatInterval, so that the other side knows the connection is alive. A connection that receives nothing for DatagramChannel::connectionTimeout is treated as closed.
+//Messages are split into fragments so that no packet is longer than DatagramChannel::maximumPacketSize, which IP never has to split. Otherwise losing any one piece of a datagram would lose all of it.
+//Every packet starts with DatagramChannel::protocolId as 2 bytes, then its kind as a byte. CONNECT_PACKET and ACCEPT_PACKET have a 4 byte nonce after that, CHALLENGE_PACKET and RESPONSE_PACKET have the nonce and an 8 byte cookie, and CLOSE_PACKET has nothing. DATA_PACKET has the next reliable fragment expected and the bitfield, 4 bytes each, and then may have a fragment: the type of its message as a byte, the 4 byte sequence number of the fragment if it is reliable or of the message if it is sequenced, for sequenced messages the 4 byte number of reliable fragments that were sent before it, the 2 byte index of the fragment and the 2 byte number of fragments in its message, and then its bytes. Numbers are little-endian, see ByteStream.hpp.
+
+//How clients connect:
+//The client sends CONNECT_PACKETs with a random nonce to the host's port until one is answered, see connect(). The host reads them from its listening socket, see accept(), and answers each with a CHALLENGE_PACKET holding a cookie, a keyed hash of the client's address, the nonce and the time, without keeping anything. The client sends the cookie back in RESPONSE_PACKETs, and only for a valid one does the host make a new socket, bound to the same port and connected to the client, which answers with an ACCEPT_PACKET. So a socket is only ever made for an address that can receive packets, and requests with forged addresses cost the host nothing, like SYN cookies do for TCP.
+//The system hands a connected socket the packets from its own client instead of the listening socket, so every client ends up with its own file descriptor, as with TCP, and ServerSocket and Server can hand it around in the same way.
+
+/*!
+ * Sends and receives whole messages over a connected UDP socket, like a MessageFramer does over TCP. MessageFramer uses one for datagram sockets, so it is rarely needed directly. See DatagramChannel.hpp.
+ */
+class DatagramChannel {
+public:
+    //Constructor
+    
+    /*!
+     * @param socket The file descriptor of a connected datagram socket, which has already finished connecting with connect() or accept().
+     */
+    DatagramChannel(int socket);
+    
+    //Static functions
+    
+    /*!
+     * Take the next new client waiting on a listening datagram socket, like accept() does for a stream socket, see DatagramChannel.hpp. Requests to connect are answered with a cookie, and only a client that sends a valid one back is taken. Other packets, and clients that were already accepted, are skipped. This never waits.
+     *
+     * @param listeningSocket The file descriptor of the bound datagram socket that clients connect to.
+     * @param address Set to the address of the client.
+     * @param addressSize Set to the size of the address.
+     * @param acceptedNonces The nonces of the clients accepted most recently, so that a client that asked more than once is only accepted once. It is added to.
+     *
+     * @return The file descriptor of a new socket connected to the client, or -1 with errno set if no client is waiting or an error occurred.
+     */
+    static int accept(int listeningSocket, sockaddr_storage* address, socklen_t* addressSize, std::deque<uint32_t>& acceptedNonces);
+    
+    /*!
+     * Ask the host to accept this client, and wait until it has. A runtime_error is thrown if the host refuses or does not answer in time.
+     *
+     * @param socket The file descriptor of a datagram socket connected to the host's port.
+     * @param timeoutMilliseconds How long to wait for an answer.
+     */
+    static void connect(int socket, int timeoutMilliseconds);
+    
+    //Public member functions
+    
+    /*!
+     * Send a whole message on the channel for its type. Board updates are sent right away, and dropped if the socket cannot take them. Other messages are kept until they are acknowledged, and sent as soon as there is room for them, so this never waits. A runtime_error is thrown if an error occurs while sending, or if too much is waiting to be acknowledged, which means the other side has stopped reading, and a range_error if the message is too long.
+     *
+     * @param data The bytes of the message.
+     * @param length The number of bytes.
+     * @param type What the message holds.
+     */
+    void send(const char* data, size_t length, MessageType type);
+    
+    /*!
+     * Receive the next whole message, resending and acknowledging while waiting for it. A runtime_error is thrown if an error occurs or the wait times out.
+     *
+     * @param message Set to the message received.
+     * @param type Set to the type of the message.
+     * @param timeoutMilliseconds The longest time to wait, or -1 to wait until the connection times out.
+     *
+     * @return True if a message was received, false if the connection closed first.
+     */
+    bool receive(std::string& message, MessageType& type, int timeoutMilliseconds);
+    
+    /*!
+     * Read every packet that has arrived, without waiting for more. A runtime_error is thrown if an error occurs while reading. Packets that are corrupt or not from this protocol are ignored.
+     *
+     * @return False if the connection closed, true otherwise.
+     */
+    bool readAvailable();
+    
+    /*!
+     * Take the next whole message that has already been read, without reading from the socket.
+     *
+     * @param message Set to the message, if there is one.
+     * @param type Set to the type of the message, if there is one.
+     *
+     * @return Whether there was a whole message.
+     */
+    bool nextMessage(std::string& message, MessageType& type);
+    
+    /*!
+     * Send whatever is due: reliable fragments that were not sent yet or have not been acknowledged in time, and acknowledgements that have waited long enough. Call this whenever timeUntilDue() runs out. A runtime_error is thrown if an error occurs while sending, or if nothing has arrived for connectionTimeout.
+     *
+     * @return Whether everything due was sent, rather than some waiting for room in the socket.
+     */
+    bool flush();
+    
+    /*!
+     * Tell the other side that the connection is closing, so that it does not wait for it to time out. This is only sent once and never throws.
+     */
+    void sendClose();
+    
+    /*!
+     * Set the longest message that is accepted from the other side. A fragment of a longer message is treated as corrupt, so that the other side cannot make this allocate more than its messages should ever need. See MessageFramer::setMaximumReceiveLength().
+     *
+     * @param length The longest message, up to MAXIMUM_SOCKET_MESSAGE_SIZE, which is the default.
+     */
+    void setMaximumReceiveLength(size_t length);
+    
+    //Public get functions
+    
+    /*!
+     * @return Whether a whole message has already arrived, so that receive() will not wait.
+     */
+    bool hasMessage() const;
+    
+    /*!
+     * @return Whether there are reliable fragments that have not been sent yet.
+     */
+    bool hasQueued() const;
+    
+    /*!
+     * @return The milliseconds until flush() has something to send.
+     */
+    int timeUntilDue() const;
+    
+    /*!
+     * @return The bytes held for messages that have only partly arrived.
+     */
+    size_t partialLength() const;
+    
+    //Public properties
+    
+    static const size_t maximumPacketSize = 1200; //Leaves room for the IP and UDP headers in the 1280 bytes that every IPv6 link carries whole
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    
+    /*!
+     * The kinds of packet. See DatagramChannel.hpp.
+     */
+    enum PacketKind : uint8_t {
+        CONNECT_PACKET = 0,
+        ACCEPT_PACKET = 1,
+        DATA_PACKET = 2,
+        CLOSE_PACKET = 3,
+        CHALLENGE_PACKET = 4,
+        RESPONSE_PACKET = 5,
+    };
+    
+    /*!
+     * A reliable fragment that has not been acknowledged yet.
+     */
+    struct SentFragment {
+        uint32_t sequence;
+        MessageType type;
+        uint16_t index;
+        uint16_t count;
+        std::string bytes;
+        Clock::time_point lastSent;
+        bool sent = false;
+        bool resent = false; //Resent fragments are not used to measure the round trip, since it is unknown which send was acknowledged
+        bool acknowledged = false; //Acknowledged out of order, so it is kept until the ones before it are
+    };
+    
+    /*!
+     * A reliable fragment that arrived before the ones in front of it.
+     */
+    struct ReceivedFragment {
+        bool present = false;
+        MessageType type;
+        uint16_t index;
+        uint16_t count;
+        std::string bytes;
+    };
+    
+    /*!
+     * The sequenced message being put back together. Only the newest one is kept.
+     */
+    struct SequencedMessage {
+        bool active = false;
+        uint32_t number;
+        MessageType type;
+        uint32_t reliableBefore; //Reliable fragments sent before this message, which must arrive first
+        uint16_t count;
+        uint16_t received;
+        size_t length;
+        std::vector<bool> fragments; //Which fragments have arrived
+        std::string bytes;
+    };
+    
+    //Private properties
+    
+    int socket;
+    
+    std::deque<SentFragment> unacknowledged; //Reliable fragments, oldest first, with consecutive sequence numbers
+    uint32_t nextReliable = 0; //The sequence number of the next reliable fragment sent
+    size_t unacknowledgedBytes = 0;
+    uint32_t nextSequenced = 0; //The number of the next sequenced message sent
+    float roundTrip = 0.1f; //A smoothed estimate of the seconds between sending a fragment and its acknowledgement
+    
+    std::vector<ReceivedFragment> reliableWindow; //Reliable fragments that arrived out of order, indexed by sequence number modulo reliableWindowSize
+    uint32_t nextExpected = 0; //The sequence number of the next reliable fragment to hand over
+    std::string reliableMessage; //The fragments so far of the reliable message being put back together
+    uint16_t reliableIndex = 0; //The index of the next fragment of that message, or 0 if none is being put back together
+    uint16_t reliableCount = 0; //The number of fragments in that message
+    SequencedMessage sequenced;
+    uint32_t sequencedReceived = 0; //One more than the number of the newest sequenced message handed over
+    
+    std::deque<std::pair<MessageType, std::string> > messages; //Whole messages that have not been taken yet
+    size_t maximumReceiveLength; //See setMaximumReceiveLength()
+    size_t maximumFragments; //Enough for the longest message accepted
+    
+    bool acknowledgementDue = false;
+    Clock::time_point acknowledgementTime; //When an acknowledgement is sent on its own, if nothing carried it first
+    Clock::time_point lastSent;
+    Clock::time_point lastReceived;
+    
+    bool closed = false;
+    bool blocked = false; //The socket could not take the last packet, so sending waits for the next flush()
+    
+    ByteWriter packet; //Kept between packets, so that its memory is reused
+    std::vector<char> received;
+    
+    static const uint16_t protocolId = 0x4753;
+    
+    static const size_t handshakeLength = 7;
+    static const size_t cookieHandshakeLength = 15; //For CHALLENGE_PACKET and RESPONSE_PACKET
+    static const size_t packetHeaderLength = 11;
+    static const size_t fragmentHeaderLength = 13; //The longest, for a sequenced fragment
+    static const size_t maximumFragmentSize = DatagramChannel::maximumPacketSize - DatagramChannel::packetHeaderLength - DatagramChannel::fragmentHeaderLength;
+    
+    static const uint32_t reliableWindowSize = 256; //The most reliable fragments that can be sent past the oldest one that was not acknowledged
+    static const unsigned int maximumAcceptedNonces = 64;
+    
+    //In seconds
+    constexpr static const float minimumResendTime = 0.02f;
+    constexpr static const float maximumResendTime = 1.0f;
+    constexpr static const float acknowledgementDelay = 0.02f;
+    constexpr static const float heartbeatInterval = 0.5f;
+    constexpr static const float connectionTimeout = 10.0f;
+    constexpr static const float connectResendTime = 0.25f;
+    static const unsigned int cookiePeriod = 30; //A cookie is valid for the period it was made in and the one after
+    
+    //Private member functions
+    
+    /*!
+     * Start a DATA_PACKET in packet with the current acknowledgements. A fragment can be written after them.
+     */
+    void startData();
+    
+    /*!
+     * Write the header of a reliable fragment after the acknowledgements in packet, followed by its bytes.
+     */
+    void writeFragment(const SentFragment& fragment);
+    
+    /*!
+     * Send a reliable fragment, and note when it was sent.
+     *
+     * @return Whether the socket took it.
+     */
+    bool sendFragment(SentFragment& fragment, Clock::time_point now);
+    
+    /*!
+     * Send packet, if the socket can take it. Any DATA_PACKET carries the acknowledgements, so they are no longer due.
+     *
+     * @return Whether the socket took the packet.
+     */
+    bool sendPacket();
+    
+    /*!
+     * Handle a packet that arrived. A range_error is thrown if it is corrupt.
+     */
+    void handlePacket(const char* data, size_t length);
+    
+    /*!
+     * Forget the reliable fragments that the other side acknowledged.
+     *
+     * @param next The next fragment the other side expects.
+     * @param bits Which of the 32 fragments after that one it has.
+     */
+    void acknowledge(uint32_t next, uint32_t bits);
+    
+    /*!
+     * Keep a reliable fragment, and hand over every message that is now whole and in order.
+     */
+    void receiveReliable(uint32_t sequence, MessageType type, uint16_t index, uint16_t count, const char* data, size_t length);
+    
+    /*!
+     * Add a fragment to the newest sequenced message, starting a new one if it is newer.
+     */
+    void receiveSequenced(uint32_t number, uint32_t reliableBefore, MessageType type, uint16_t index, uint16_t count, const char* data, size_t length);
+    
+    /*!
+     * Hand over the sequenced message if it is whole and every reliable message sent before it has been handed over.
+     */
+    void deliverSequenced();
+    
+    /*!
+     * @return How long to wait for an acknowledgement before resending.
+     */
+    float resendTime() const;
+    
+    /*!
+     * @return Whether messages of a type are sent on the reliable channel.
+     */
+    static inline bool isReliable(MessageType type) {
+        return type == TEXT_MESSAGE || type == ACTION_MESSAGE;
+    }
+    
+    /*!
+     * Write a CONNECT_PACKET, ACCEPT_PACKET, CHALLENGE_PACKET or RESPONSE_PACKET. The cookie is only written for the last two.
+     *
+     * @return The length of the packet.
+     */
+    static size_t writeHandshake(uint8_t kind, uint32_t nonce, uint64_t cookie, char* packet);
+    
+    /*!
+     * @return Whether a packet is a handshake of the given kind, and if so, its nonce and, if it has one, its cookie.
+     */
+    static bool readHandshake(const char* data, size_t length, uint8_t kind, uint32_t& nonce, uint64_t& cookie);
+    
+    /*!
+     * Make the cookie for a client's request, see DatagramChannel.hpp.
+     *
+     * @param address The address of the client.
+     * @param nonce The nonce of the request.
+     * @param period The number of DatagramChannel::cookiePeriod long periods since the clock started.
+     */
+    static uint64_t cookie(const sockaddr_storage* address, uint32_t nonce, uint64_t period);
+    
+    /*!
+     * @return The number of DatagramChannel::cookiePeriod long periods since the clock started.
+     */
+    static uint64_t cookiePeriodNow();
+    
+    /*!
+     * SipHash-2-4, a hash that cannot be forged without its key, which is what keeps cookies from being made by anyone but the host.
+     */
+    static uint64_t sipHash(const std::array<uint64_t, 2>& key, const uint8_t* data, size_t length);
+};
+
+#endif /* DatagramChannel_hpp */
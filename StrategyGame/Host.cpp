@@ -8,6 +8,10 @@
 
 #include "Host.hpp"
 
+//Defined here as well, so that they can be passed by reference
+constexpr const float Host::timeBetweenUpkeep;
+constexpr const float Host::timeBetweenKeyframes;
+
 Host::Host(Board gameBoard) : board(gameBoard) {}
 
 std::string Host::storeVectorOfInts(std::vector<int> vec) {
@@ -30,10 +34,129 @@ std::string Host::storeVectorOfFloats(std::vector<float> vec) {
     return str;
 }
 
-void Host::set(int portNum, unsigned int numberOfPlayers) {
+Board Host::standardBoard(unsigned int numberOfPlayers) {
+    if (numberOfPlayers > Host::maximumStandardPlayers)
+        throw std::invalid_argument("The standard board has room for at most " + std::to_string(Host::maximumStandardPlayers) + " players: " + std::to_string(numberOfPlayers));
+    
+    //Terrain
+    std::vector<std::vector<Tile> > board;
+    for (int x = 0; x < BOARD_WIDTH; x++) {
+        std::vector<Tile> row;
+        for (int y = 0; y < BOARD_WIDTH; y++) {
+            if ((x == 3 && y == BOARD_WIDTH - 1 - 3) || (x == 4 && y == BOARD_WIDTH - 1 - 4) || (x == BOARD_WIDTH - 1 - 3 && y == 3) || (x == BOARD_WIDTH - 1 - 4 && y == 4))
+                row.push_back(Tile(MOUNTAIN_TERRAIN, x, y));
+            else if (x >= y - 1 && x <= y + 1)
+                row.push_back(Tile(FOREST_TERRAIN, x, y));
+            else
+                row.push_back(Tile(OPEN_TERRAIN, x, y));
+        }
+        board.push_back(row);
+    }
+    
+    Board standard(board);
+    
+    //Reminder: Creature(x, y, Race, maxHealth, maxEnergy, attack, attackStyle, vision, range, startDirection, controller)
+    
+    int boardBack = BOARD_WIDTH - 1; //Represents the opposite index of the board.
+    
+    //Player 1
+    
+    standard.setCreature(Creature(0, boardBack - 2, Human, 4, 4, 3, Melee,  1, 1, WEST, 0));
+    standard.setCreature(Creature(1, boardBack - 2, Human, 4, 4, 1, Melee,  1, 1, WEST, 0));
+    standard.setCreature(Creature(2, boardBack - 2, Human, 4, 4, 3, Melee,  1, 1, WEST, 0));
+    standard.setCreature(Creature(2, boardBack - 1, Human, 4, 4, 3, Melee,  1, 1, WEST, 0));
+    standard.setCreature(Creature(2, boardBack,     Human, 4, 4, 3, Melee,  1, 1, WEST, 0));
+    
+    standard.setCreature(Creature(0, boardBack - 1, Human, 2, 4, 2, Ranged, 1, 4, WEST, 0));
+    standard.setCreature(Creature(1, boardBack,     Human, 2, 4, 2, Ranged, 1, 4, WEST, 0));
+    
+    standard.setCreature(Creature(1, boardBack - 1, Human, 3, 2, 1, Magic,  1, 1, WEST, 0));
+    standard.get(1, boardBack - 1).creature()->addButton("mage_strike_from_", "Fireball");
+    
+    //Player 2
+    
+    standard.setCreature(Creature(boardBack - 2, 0, Human, 4, 4, 3, Melee,  1, 1, EAST, 1));
+    standard.setCreature(Creature(boardBack - 2, 1, Human, 4, 4, 1, Melee,  1, 1, EAST, 1));
+    standard.setCreature(Creature(boardBack - 2, 2, Human, 4, 4, 3, Melee,  1, 1, EAST, 1));
+    standard.setCreature(Creature(boardBack - 1, 2, Human, 4, 4, 3, Melee,  1, 1, EAST, 1));
+    standard.setCreature(Creature(boardBack,     2, Human, 4, 4, 3, Melee,  1, 1, EAST, 1));
+    
+    standard.setCreature(Creature(boardBack - 1, 0, Human, 2, 4, 2, Ranged, 1, 4, EAST, 1));
+    standard.setCreature(Creature(boardBack,     1, Human, 2, 4, 2, Ranged, 1, 4, EAST, 1));
+    
+    standard.setCreature(Creature(boardBack - 1, 1, Human, 3, 2, 1, Magic,  1, 1, EAST, 1));
+    standard.get(boardBack - 1, 1).creature()->addButton("mage_strike_from_", "Fireball");
+    
+    //Player 3
+    
+    if (numberOfPlayers > 2) {
+        standard.setCreature(Creature(0, 2, Human, 4, 4, 3, Melee,  1, 1, WEST, 2));
+        standard.setCreature(Creature(1, 2, Human, 4, 4, 1, Melee,  1, 1, WEST, 2));
+        standard.setCreature(Creature(2, 2, Human, 4, 4, 3, Melee,  1, 1, WEST, 2));
+        standard.setCreature(Creature(2, 1, Human, 4, 4, 3, Melee,  1, 1, WEST, 2));
+        standard.setCreature(Creature(2, 0, Human, 4, 4, 3, Melee,  1, 1, WEST, 2));
+        
+        standard.setCreature(Creature(0, 1, Human, 2, 4, 2, Ranged, 1, 4, WEST, 2));
+        standard.setCreature(Creature(1, 0, Human, 2, 4, 2, Ranged, 1, 4, WEST, 2));
+        
+        standard.setCreature(Creature(1, 1, Human, 3, 2, 1, Magic,  1, 1, WEST, 2));
+        standard.get(1, 1).creature()->addButton("mage_strike_from_", "Fireball");
+    }
+    
+    //Player 4
+    
+    if (numberOfPlayers > 3) {
+        standard.setCreature(Creature(boardBack,     boardBack - 2, Human, 4, 4, 3, Melee,  1, 1, EAST, 3));
+        standard.setCreature(Creature(boardBack - 1, boardBack - 2, Human, 4, 4, 1, Melee,  1, 1, EAST, 3));
+        standard.setCreature(Creature(boardBack - 2, boardBack - 2, Human, 4, 4, 3, Melee,  1, 1, EAST, 3));
+        standard.setCreature(Creature(boardBack - 2, boardBack - 1, Human, 4, 4, 3, Melee,  1, 1, EAST, 3));
+        standard.setCreature(Creature(boardBack - 2, boardBack,     Human, 4, 4, 3, Melee,  1, 1, EAST, 3));
+        
+        standard.setCreature(Creature(boardBack,     boardBack - 1, Human, 2, 4, 2, Ranged, 1, 4, EAST, 3));
+        standard.setCreature(Creature(boardBack - 1, boardBack,     Human, 2, 4, 2, Ranged, 1, 4, EAST, 3));
+        
+        standard.setCreature(Creature(boardBack - 1, boardBack - 1, Human, 3, 2, 1, Magic,  1, 1, EAST, 3));
+        standard.get(boardBack - 1, boardBack - 1).creature()->addButton("mage_strike_from_", "Fireball");
+    }
+    
+    /*
+    standard.setCreature(Creature(0, boardBack - 1, Human, 4, 4, 3, Melee,  1, 1, WEST, 0));
+    standard.setCreature(Creature(1, boardBack - 1, Human, 4, 4, 1, Melee,  1, 1, WEST, 0));
+    standard.setCreature(Creature(1, boardBack,     Human, 4, 4, 3, Melee,  1, 1, WEST, 0));
+    standard.setCreature(Creature(1, boardBack - 1, Human, 4, 4, 1, Ranged, 1, 3, WEST, 0));
+    
+    standard.setCreature(Creature(boardBack,     1, Human, 4, 4, 3, Melee,  1, 1, EAST, 1));
+    standard.setCreature(Creature(boardBack - 1, 1, Human, 4, 4, 1, Melee,  1, 3, EAST, 1));
+    standard.setCreature(Creature(boardBack - 1, 0, Human, 4, 4, 3, Melee,  1, 1, EAST, 1));
+    standard.setCreature(Creature(boardBack - 1, 1, Human, 4, 4, 1, Ranged, 1, 3, EAST, 1));
+    */
+    
+    Building player0Home(0, BOARD_WIDTH - 1, 10, 0);
+    player0Home.deathAction = "player_lose_0";
+    Building player1Home(BOARD_WIDTH - 1, 0, 1, 1);
+    player1Home.deathAction = "player_lose_1";
+    
+    standard.setBuilding(player0Home);
+    standard.setBuilding(player1Home);
+    
+    if (numberOfPlayers > 2) {
+        Building player2Home(0, 0, 10, 2);
+        player2Home.deathAction = "player_lose_2";
+        standard.setBuilding(player2Home);
+    }
+    if (numberOfPlayers > 3) {
+        Building player3Home(BOARD_WIDTH - 1, BOARD_WIDTH - 1, 10, 3);
+        player3Home.deathAction = "player_lose_3";
+        standard.setBuilding(player3Home);
+    }
+    
+    return standard;
+}
+
+void Host::set(int portNum, unsigned int numberOfPlayers, Transport transport) {
     this->setUp = true;
     
-    this->socket.setSocket(portNum);
+    this->socket.setSocket(portNum, transport);
     std::cout << "Host name: " << this->socket.getHostName() << std::endl;
     
     for (int a = 0; a < numberOfPlayers; a++) {
@@ -45,24 +168,87 @@ void Host::set(int portNum, unsigned int numberOfPlayers) {
     }
 }
 
+void Host::set() {
+    this->setUp = true;
+    
+    this->socket.setSocket();
+}
+
 void Host::addPlayer() {
     if (!this->setUp)
         throw std::logic_error("Socket not set");
     
     this->socket.addClient();
+    this->addConnectedPlayer();
+}
+
+void Host::addPlayer(int clientSocket) {
+    if (!this->setUp)
+        throw std::logic_error("Socket not set");
+    
+    this->socket.addClient(clientSocket);
+    this->addConnectedPlayer();
+}
+
+void Host::addConnectedPlayer() {
+    if (!this->setUp)
+        throw std::logic_error("Socket not set");
+    
     this->alivePlayers.push_back({true, true});
+    this->ackedVersions.push_back(Board::noVersion);
+    this->lastKeyframes.push_back(std::chrono::steady_clock::time_point());
+    this->compressedUpdates.push_back(false);
+    this->cameras.push_back(BitBoard(this->board.width(), this->board.height(0)));
+    this->cameras.back().setRegion(0, 0, this->board.width() - 1, this->board.height(0) - 1);
+    this->cameraEpochs.push_back(0);
+    this->sentViews.push_back(std::deque<SentView>());
     
     int playerNum = (int)alivePlayers.size() - 1;
     this->players.push_back(Player(&this->board, playerNum));
 }
 
+void Host::addSpectator(int clientSocket) {
+    if (!this->setUp)
+        throw std::logic_error("Socket not set");
+    
+    if (!this->begun)
+        throw std::logic_error("Spectators can only join after the game begins");
+    
+    unsigned int clientIndex = this->socket.addClient(clientSocket, true);
+    this->spectators.push_back(clientIndex);
+    
+    //An index freed by a player that left may be reused, so only grow the tables if it is a new one
+    if (clientIndex >= this->ackedVersions.size()) {
+        this->ackedVersions.resize(clientIndex + 1, Board::noVersion);
+        this->lastKeyframes.resize(clientIndex + 1, std::chrono::steady_clock::time_point());
+        this->compressedUpdates.resize(clientIndex + 1, false);
+        this->cameras.resize(clientIndex + 1, BitBoard(this->board.width(), this->board.height(0)));
+        this->cameraEpochs.resize(clientIndex + 1, 0);
+        this->sentViews.resize(clientIndex + 1);
+    }
+    this->ackedVersions[clientIndex] = Board::noVersion; //Spectators are sent a keyframe next, so the board they start with does not need to be acknowledged
+    this->lastKeyframes[clientIndex] = std::chrono::steady_clock::time_point(); //Nothing about the client that had the index before applies to this one
+    this->compressedUpdates[clientIndex] = false;
+    this->cameras[clientIndex].setRegion(0, 0, this->board.width() - 1, this->board.height(0) - 1);
+    this->sentViews[clientIndex].clear();
+    
+    //Sent like the players' initial data, but without waiting for an answer, since the game is already running
+    unsigned int spectator = (unsigned int)this->spectators.size() - 1;
+    if (this->sendToSpectator("spectating", spectator, TEXT_MESSAGE))
+        this->sendToSpectator("spectator," + this->board.serialize(), spectator, TEXT_MESSAGE);
+}
+
 void Host::begin() {
     if (!this->setUp)
         throw std::logic_error("Socket not set");
     
+    this->begun = true;
+    
     //Initialize time
-    this->programStartTime = std::chrono::steady_clock::now();
-    this->lastFrame = std::chrono::steady_clock::now() - this->programStartTime;
+    this->lastFrame = std::chrono::steady_clock::now();
+    this->nextSend = this->lastFrame;
+    this->currentTick = 0;
+    this->lastUpkeep = 0;
     
     this->socket.setTimeout(2);
     
@@ -72,7 +258,7 @@ void Host::begin() {
     }
     
     for (int a = 0; a < this->players.size(); a++) {
-        this->socket.send((std::to_string(a) + "," + this->board.serialize()).c_str(), a); //Send each player his/her player number along with the board
+        this->socket.send(std::to_string(a) + "," + this->board.serialize(), a, TEXT_MESSAGE); //Send each player his/her player number along with the board
     }
     
     if (!this->receivedFromAll("initialDataReceived")) {
@@ -80,31 +266,19 @@ void Host::begin() {
     }
 }
 
-void Host::update(bool* done) {
+void Host::update(bool* done, bool wait) {
     if (!this->setUp)
         throw std::logic_error("Socket not set");
     
-    //Update frame information first
-    std::chrono::duration<float> currentFrame = std::chrono::steady_clock::now() - this->programStartTime;
-    this->deltaTime = currentFrame.count() - this->lastFrame.count();
+    std::chrono::steady_clock::time_point currentTime = std::chrono::steady_clock::now();
     
-    //Go through all tiles' damage and reset them if enough time has passed
-    for (int x = 0; x < this->board.width(); x++) {
-        for (int y = 0; y < this->board.height(x); y++) {
-            if (this->board.get(x, y).damage() > 0 && currentFrame.count() - this->board.get(x, y).timeOfDamage() > Tile::damageScreenTime)
-                this->board.setDamage(x, y, 0, currentFrame.count());
+    //Simulate in fixed steps until the simulation has caught up with the clock
+    for (int ticks = 0; this->lastFrame + this->timestep <= currentTime; ticks++) {
+        if (ticks == Host::maximumTicksPerUpdate) {
+            this->lastFrame = currentTime; //Too far behind to catch up, so skip the time rather than falling further behind
+            break;
         }
-    }
-    
-    //Regenerate energy (Energy is incremented by 1 every 5 seconds)
-    if (currentFrame.count() - this->lastUpkeep.count() > Host::timeBetweenUpkeep) {
-        this->board.regenerateEnergy();
-        this->lastUpkeep = currentFrame;
-        
-    }
-    
-    for (int a = 0; a < this->players.size(); a++) {
-        this->players[a].updateCreatures(this->deltaTime);
+        this->tick();
     }
     
     if (done != nullptr && *done) {
@@ -112,40 +286,20 @@ void Host::update(bool* done) {
         return;
     }
     
-    std::string hostInfo = this->board.serialize();
-    if (this->announcementStr.size() > 0) {
-        hostInfo = this->announcementStr + ";" + hostInfo;
-        this->announcementStr = "";
-    }
-    this->broadcast(hostInfo);
-
-    if (done != nullptr && *done) {
-        this->broadcast("closing_host");
-        return;
+    //Snapshots go out at their own rate, independent of the simulation
+    if (currentTime >= this->nextSend) {
+        this->sendUpdates(currentTime);
+        
+        this->nextSend += this->sendInterval;
+        if (this->nextSend < currentTime)
+            this->nextSend = currentTime + this->sendInterval;
     }
     
-    for (int a = 0; a < this->socket.numberOfClients(); a++) {
-        std::string clientInfo;
-        if (a == this->mainClientNum) {
-            try {
-                clientInfo = this->socket.receive(a);
-            } catch (std::runtime_error) { // If the hosting client closed, then close the program
-                if (done != nullptr && *done) {
-                    this->broadcast("closing_host");
-                    return;
-                } else {
-                    clientInfo = this->socket.receive(a);
-                }
-            }
-        } else {
-            clientInfo = this->socket.receive(a);
-        }
-        while (clientInfo.size() > 0) {
-            this->processAction(clientInfo.substr(0, clientInfo.find_first_of(';')), a); //Process the action
-            clientInfo = clientInfo.find_first_of(';') == std::string::npos ? "" : clientInfo.substr(clientInfo.find_first_of(';') + 1, std::string::npos); //Set the string equal to the rest of the string after the ','
-        }
-    }
-
+    //Sleep until the next tick or send is due, handling whatever the clients send in the meantime
+    int timeout = wait ? (int)ceilf(this->timeUntilDue() * 1000.0f) : 0;
+    
+    this->socket.processEvents(std::max(timeout, 0), this->eventHandlers());
+    
 //    this->socket.broadcast(std::to_string(this->activePlayer));
 //    if (!this->socket.allReceived("activePlayerReceived"))
 //        throw std::runtime_error("Active player not received");
@@ -190,9 +344,39 @@ void Host::update(bool* done) {
 //    }
 //
 //    this->socket.broadcast("End of frame");
+}
+
+void Host::setTickRate(float ticksPerSecond) {
+    if (ticksPerSecond <= 0)
+        throw std::invalid_argument("Tick rate must be positive: " + std::to_string(ticksPerSecond));
+    
+    this->timestep = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / ticksPerSecond));
+    this->deltaTime = 1.0f / ticksPerSecond;
+}
+
+void Host::setSendRate(float sendsPerSecond) {
+    if (sendsPerSecond <= 0)
+        throw std::invalid_argument("Send rate must be positive: " + std::to_string(sendsPerSecond));
     
-    //Set the tiem of the previous frame to currentTime
-    this->lastFrame = currentFrame;
+    this->sendInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / sendsPerSecond));
+}
+
+void Host::setCompression(bool allowed) {
+    this->compressionAllowed = allowed;
+}
+
+float Host::timeUntilDue() {
+    std::chrono::steady_clock::time_point nextDeadline = std::min(this->lastFrame + this->timestep, this->nextSend);
+    
+    return std::max(std::chrono::duration<float>(nextDeadline - std::chrono::steady_clock::now()).count(), 0.0f);
+}
+
+bool Host::finished() {
+    for (int a = 0; a < this->alivePlayers.size(); a++) {
+        if (this->alivePlayers[a].second)
+            return false;
+    }
+    return true;
 }
 
 unsigned int Host::getNumberPlayers() {
@@ -212,109 +396,240 @@ std::string Host::serialize() {
 
 //Private member functions
 
-void Host::processAction(std::string action, int playerNum) {
+void Host::processAction(TextReader action, int playerNum) {
     if (!this->setUp)
         throw std::logic_error("Socket not set");
     
-    if (playerNum < this->alivePlayers.size() && !this->alivePlayers[playerNum].first) return; //If the player is dead, ignore any remaining actions.
-    //Without checking if playerNum was in bounds, for some reason during runtime, if it was out of bounds, the expression would simply evaluate as false instead
+    if (playerNum >= 0 && playerNum < this->alivePlayers.size() && !this->alivePlayers[playerNum].first) return; //If the player is dead, ignore any remaining actions.
     
-    if (action.find("no_updates") != std::string::npos) {
+    if (action.skip("player_lose_")) {
+        int playerToLose = action.readInt();
+        this->losePlayer(playerToLose);
+    }
+}
+
+void Host::processCommand(const Command& command, int playerNum) {
+    if (!this->setUp)
+        throw std::logic_error("Socket not set");
+    
+    //Dead players are still sent the board, so they keep acknowledging it
+    switch (command.opcode) {
+        case ACKNOWLEDGE_OPCODE:
+            if (playerNum >= 0 && playerNum < this->ackedVersions.size())
+                this->ackedVersions[playerNum] = command.version;
+            return;
+        case RESYNC_OPCODE:
+            if (playerNum >= 0 && playerNum < this->ackedVersions.size())
+                this->ackedVersions[playerNum] = Board::noVersion;
+            return;
+        case REQUEST_COMPRESSION_OPCODE:
+            if (playerNum >= 0 && playerNum < this->compressedUpdates.size())
+                this->compressedUpdates[playerNum] = this->compressionAllowed;
+            return;
+        case CAMERA_OPCODE:
+            if (playerNum >= 0 && playerNum < this->cameras.size())
+                this->setCamera(playerNum, command.origin, command.destination);
+            return;
+        default:
+            break;
+    }
+    
+    if (playerNum < 0 || playerNum >= this->alivePlayers.size() || !this->alivePlayers[playerNum].first) return; //If the player is dead, ignore any remaining commands.
+    
+    if (command.hasTiles() && (!this->board.validTile(command.origin) || !this->board.validTile(command.destination)))
         return;
-    } else if (action.find("move_creature_at_") != std::string::npos) {
-        //Parse the destination tile from the string
-        glm::ivec2 destination;
-        destination.x = std::stoi(action.substr(0, action.find_first_of(',')));
-        action = action.substr(action.find_first_of(',') + 1);
-        destination.y = std::stoi(action.substr(0, action.find_first_of(',')));
-        action = action.substr(action.find_first_of(',') + 1);
-        
-        //Erase the "move_creature_at_"
-        action.erase(0, 17);
+    
+    switch (command.opcode) {
+        case LEAVE_GAME_OPCODE:
+            this->losePlayer(playerNum);
+            this->alivePlayers[playerNum].second = false; //Set the player to disconnected.
+            break;
+        case MOVE_CREATURE_OPCODE:
+            this->moveCreature(command, playerNum);
+            break;
+        case ATTACK_OPCODE:
+            this->attack(command, playerNum);
+            break;
+        case MAGE_STRIKE_OPCODE:
+            this->mageStrike(command, playerNum);
+            break;
+        default:
+            break;
+    }
+}
+
+void Host::setCamera(unsigned int clientIndex, glm::ivec2 minTile, glm::ivec2 maxTile) {
+    if (minTile.x > maxTile.x || minTile.y > maxTile.y)
+        return;
+    
+    //Clipped before the margin is added, so that corners near the limits of an int cannot overflow
+    int lastX = (int)this->board.width() - 1;
+    int lastY = (int)this->board.height(0) - 1;
+    int minX = std::min(std::max(minTile.x, 0), lastX);
+    int minY = std::min(std::max(minTile.y, 0), lastY);
+    int maxX = std::min(std::max(maxTile.x, 0), lastX);
+    int maxY = std::min(std::max(maxTile.y, 0), lastY);
+    
+    BitBoard camera(this->board.width(), this->board.height(0));
+    camera.setRegion(minX - Host::cameraMargin, minY - Host::cameraMargin, maxX + Host::cameraMargin, maxY + Host::cameraMargin);
+    if (camera == this->cameras[clientIndex])
+        return;
+    
+    //The board may not change for a while, so the client is sent a new version anyway, and the host can tell once it has stopped being sent the tiles around its old camera
+    this->cameras[clientIndex] = camera;
+    this->cameraEpochs[clientIndex]++;
+}
+
+void Host::interest(unsigned int clientIndex, BitBoard& tiles) {
+    tiles = this->cameras[clientIndex];
+    
+    //Checked first, since a spectator may have the index of a player that left
+    if (this->socket.isSpectator(clientIndex) || clientIndex >= this->players.size() || !this->alivePlayers[clientIndex].first)
+        return;
+    
+    tiles &= this->board.visibility(clientIndex).visible();
+    
+    const std::vector<SlotMap<Creature>::Handle>& creatures = this->board.creaturesControlledBy(clientIndex);
+    for (int a = 0; a < creatures.size(); a++) {
+        Creature* creature = this->board.creature(creatures[a]);
+        tiles.set(creature->x(), creature->y());
+    }
+    
+    const std::vector<SlotMap<Building>::Handle>& buildings = this->board.buildingsControlledBy(clientIndex);
+    for (int a = 0; a < buildings.size(); a++) {
+        Building* building = this->board.building(buildings[a]);
+        tiles.set(building->x(), building->y());
+    }
+}
+
+void Host::moveCreature(const Command& command, int playerNum) {
+    glm::ivec2 currentTile = command.origin;
+    glm::ivec2 destination = command.destination;
+    
+    if (this->board.view(currentTile.x, currentTile.y).creature() != nullptr && this->board.destinationInRange(destination, currentTile) && this->board.view(currentTile.x, currentTile.y).creature()->controller() == playerNum) {
+        std::vector<unsigned int> directions = this->board.getPath(currentTile.x, currentTile.y, destination.x, destination.y);
         
-        //Parse the original tile from the string
-        glm::ivec2 currentTile;
-        currentTile.x = std::stoi(action.substr(0, action.find_first_of('_')));
-        action = action.substr(action.find_first_of('_') + 1);
-        currentTile.y = std::stoi(action);
+        this->board.queueDirections(currentTile.x, currentTile.y, directions);
+    }
+}
+
+void Host::attack(const Command& command, int playerNum) {
+    glm::ivec2 currentTile = command.origin;
+    glm::ivec2 destination = command.destination;
+    
+    if (this->board.view(currentTile.x, currentTile.y).creature() != nullptr && this->board.attackInRange(destination, currentTile) && this->board.view(currentTile.x, currentTile.y).creature()->controller() == playerNum && ((this->board.view(destination.x, destination.y).creature() != nullptr && this->board.view(destination.x, destination.y).creature()->controller() != playerNum) || (this->board.view(destination.x, destination.y).building() != nullptr && this->board.view(destination.x, destination.y).building()->controller() != playerNum))) {
+        glm::ivec2 attacker = glm::ivec2(currentTile.x, currentTile.y);
+        glm::ivec2 defender = glm::ivec2(destination.x, destination.y);
         
-        if (this->board.get(currentTile.x, currentTile.y).creature() != nullptr && this->board.destinationInRange(destination, currentTile) && this->board.get(currentTile.x, currentTile.y).creature()->controller() == playerNum) {
-            std::vector<unsigned int> directions = this->players[playerNum].getPath(currentTile.x, currentTile.y, destination.x, destination.y);
+        if (this->board.tileDistances(attacker.x, attacker.y, defender.x, defender.y) <= this->board.view(attacker.x, attacker.y).creature()->range()) {
             
-            for (int a = 0; a < directions.size(); a++) {
-                this->board.get(currentTile.x, currentTile.y).creature()->directions.push(directions[a]);
-                if (a == 0)
-                    this->board.setDirection(currentTile.x, currentTile.y, directions[a]);
+            int attackDamage = 0, defendDamage = 0;
+            
+            std::vector<std::pair<std::string, int> > actions = this->board.initiateCombat(attacker.x, attacker.y, defender.x, defender.y, &attackDamage, &defendDamage);
+            this->board.setDamage(defender.x, defender.y, attackDamage, this->gameTime()); //Make the damage visible
+            this->board.setDamage(attacker.x, attacker.y, defendDamage, this->gameTime()); //For attacker and defender
+            
+            for (int a = 0; a < actions.size(); a++) {
+                this->processAction(actions[a].first, actions[a].second); //playerNum doesn't matter
             }
         }
-    } else if (action.find("attack_from_") != std::string::npos) {
-        //Parse the destination tile from the string
-        glm::ivec2 destination;
-        destination.x = std::stoi(action.substr(0, action.find_first_of(',')));
-        action = action.substr(action.find_first_of(',') + 1);
-        destination.y = std::stoi(action.substr(0, action.find_first_of(',')));
-        action = action.substr(action.find_first_of(',') + 1);
-        
-        //Erase the "attack_from_"
-        action.erase(0, 12);
-        
-        //Parse the original tile from the string
-        glm::ivec2 currentTile;
-        currentTile.x = std::stoi(action.substr(0, action.find_first_of('_')));
-        action = action.substr(action.find_first_of('_') + 1);
-        currentTile.y = std::stoi(action);
-        
-        if (this->board.get(currentTile.x, currentTile.y).creature() != nullptr && this->board.attackInRange(destination, currentTile) && this->board.get(currentTile.x, currentTile.y).creature()->controller() == playerNum && ((this->board.get(destination.x, destination.y).creature() != nullptr && this->board.get(destination.x, destination.y).creature()->controller() != playerNum) || (this->board.get(destination.x, destination.y).building() != nullptr && this->board.get(destination.x, destination.y).building()->controller() != playerNum))) {
-            glm::ivec2 attacker = glm::ivec2(currentTile.x, currentTile.y);
-            glm::ivec2 defender = glm::ivec2(destination.x, destination.y);
+    }
+}
+
+void Host::mageStrike(const Command& command, int playerNum) {
+    glm::ivec2 currentTile = command.origin;
+    glm::ivec2 destination = command.destination;
+    
+    if (this->board.view(currentTile.x, currentTile.y).creature() != nullptr && this->board.view(currentTile.x, currentTile.y).creature()->controller() == playerNum && this->board.view(destination.x, destination.y).creature() != nullptr) {
+        glm::ivec2 attacker = glm::ivec2(currentTile.x, currentTile.y);
+        glm::ivec2 defender = glm::ivec2(destination.x, destination.y);
+        int attackDamage = 0;
+        std::vector<std::pair<std::string, int> > actions = this->board.initiateCombat(attacker.x, attacker.y, defender.x, defender.y, &attackDamage, nullptr, NO_STRIKE_BACKS | IGNORE_RANGE);
+        this->board.setDamage(defender.x, defender.y, attackDamage, this->gameTime()); //Make the damage visible
+    }
+}
+
+MessageType Host::boardUpdate(unsigned int player, std::chrono::steady_clock::time_point currentFrame, ByteWriter& writer) {
+    bool compressed = this->compressedUpdates[player];
+    
+    //Compressed updates are written somewhere else first, and then compressed into the writer
+    ByteWriter& update = compressed ? this->uncompressedWriter : writer;
+    update.clear();
+    
+    this->interest(player, this->interestTiles);
+    int viewer = this->socket.isSpectator(player) ? Board::noViewer : (int)player;
+    
+    MessageType type = KEYFRAME_MESSAGE;
+    unsigned int version = this->board.version() + this->cameraEpochs[player]; //Both only increase, so this does too
+    unsigned int ackedVersion = this->ackedVersions[player];
+    std::deque<SentView>& views = this->sentViews[player];
+    
+    //The client has been sent nothing before the version it acknowledged that it could still be waiting on
+    while (ackedVersion != Board::noVersion && !views.empty() && views.front().version < ackedVersion) {
+        views.pop_front();
+    }
+    
+    //A delta can only be sent if it is known what the client may have been sent at the version it has
+    bool viewKnown = !views.empty() && views.front().version == ackedVersion;
+    
+    if (ackedVersion != Board::noVersion && viewKnown && currentFrame - this->lastKeyframes[player] < std::chrono::duration<float>(Host::timeBetweenKeyframes)) {
+        if (this->snapshotCache.changedTilesSince(this->board, views.front().boardVersion, this->changedTiles, this->terrainChangedTiles)) {
+            //Changes the client cannot see are not sent, except to terrain, which every client is sent all of
+            this->changedTiles &= this->interestTiles;
+            this->changedTiles |= this->terrainChangedTiles;
             
-            if (this->board.tileDistances(attacker.x, attacker.y, defender.x, defender.y) <= this->board.get(attacker.x, attacker.y).creature()->range()) {
-                
-                int attackDamage = 0, defendDamage = 0;
-                
-                std::vector<std::pair<std::string, int> > actions = this->board.initiateCombat(attacker.x, attacker.y, defender.x, defender.y, &attackDamage, &defendDamage);
-                this->board.setDamage(defender.x, defender.y, attackDamage, this->lastFrame.count()); //Make the damage visible
-                this->board.setDamage(attacker.x, attacker.y, defendDamage, this->lastFrame.count()); //For attacker and defender
-                
-                for (int a = 0; a < actions.size(); a++) {
-                    this->processAction(actions[a].first, actions[a].second); //playerNum doesn't matter
-                }
+            this->anyInterest = views.front().any;
+            this->allInterest = views.front().all;
+            for (int a = 1; a < views.size(); a++) {
+                this->anyInterest |= views[a].any;
+                this->allInterest &= views[a].all;
             }
+            
+            //Tiles the client may have with their contents that it is no longer sent
+            this->anyInterest.subtract(this->interestTiles);
+            this->changedTiles |= this->anyInterest;
+            
+            //Tiles the client may have without their contents that it is now sent
+            this->anyInterest = this->interestTiles;
+            this->anyInterest.subtract(this->allInterest);
+            this->changedTiles |= this->anyInterest;
+            
+            update.writeVarint(ackedVersion);
+            update.writeVarint(version);
+            this->snapshotCache.encodeTiles(this->board, this->changedTiles, this->interestTiles, viewer, update);
+            type = DELTA_MESSAGE;
         }
-    } else if (action.find("mage_strike_from_") != std::string::npos) {
-        //Parse the destination tile from the string
-        glm::ivec2 destination;
-        destination.x = std::stoi(action.substr(0, action.find_first_of(',')));
-        action = action.substr(action.find_first_of(',') + 1);
-        destination.y = std::stoi(action.substr(0, action.find_first_of(',')));
-        action = action.substr(action.find_first_of(',') + 1);
-        
-        //Erase the "mage_strike_from_"
-        action.erase(0, 17);
-        
-        //Parse the original tile from the string
-        glm::ivec2 currentTile;
-        currentTile.x = std::stoi(action.substr(0, action.find_first_of('_')));
-        action = action.substr(action.find_first_of('_') + 1);
-        currentTile.y = std::stoi(action);
-        
-        if (this->board.get(currentTile.x, currentTile.y).creature() != nullptr && this->board.get(currentTile.x, currentTile.y).creature()->controller() == playerNum && this->board.get(destination.x, destination.y).creature() != nullptr) {
-            glm::ivec2 attacker = glm::ivec2(currentTile.x, currentTile.y);
-            glm::ivec2 defender = glm::ivec2(destination.x, destination.y);
-            int attackDamage = 0;
-            std::vector<std::pair<std::string, int> > actions = this->board.initiateCombat(attacker.x, attacker.y, defender.x, defender.y, &attackDamage, nullptr, NO_STRIKE_BACKS | IGNORE_RANGE);
-            this->board.setDamage(defender.x, defender.y, attackDamage, this->lastFrame.count()); //Make the damage visible
-        }
-    } else if (action.find("player_lose_") != std::string::npos) {
-        action.erase(0, 12); //Erases "player_lose_"
-        int playerToLose = std::stoi(action);
-        this->losePlayer(playerToLose);
-    } else if (action.find("leaving_game_player_") != std::string::npos) {
-        action.erase(0, 20); //Erases "leaving_game_player_"
-        int leavingPlayer = std::stoi(action);
-        this->losePlayer(leavingPlayer);
-        this->alivePlayers[leavingPlayer].second = false; //Set the player to disconnected.
     }
+    
+    if (type == KEYFRAME_MESSAGE) {
+        this->lastKeyframes[player] = currentFrame;
+        update.writeVarint(version);
+        this->board.encode(update, compressed, &this->interestTiles, viewer);
+    }
+    
+    //Remember what the client may have at this version
+    if (!views.empty() && views.back().version == version) {
+        views.back().any |= this->interestTiles;
+        views.back().all &= this->interestTiles;
+    } else {
+        views.push_back(SentView{version, this->board.version(), this->interestTiles, this->interestTiles});
+        if (views.size() > Host::maximumSentViews)
+            views.pop_front();
+    }
+    
+    if (!compressed)
+        return type;
+    
+    this->compressor.compressMessage(update.data(), type, writer);
+    
+    //A delta of a few tiles has little to compress, and can come out larger, so it is sent as it is
+    if (writer.size() >= update.size()) {
+        writer.clear();
+        writer.writeBytes(update.data().data(), update.size());
+        return type;
+    }
+    
+    return COMPRESSED_MESSAGE;
 }
 
 void Host::getBufferData(std::vector<int>* terrainData, std::vector<int>* creatureData, std::vector<std::vector<float> >* colorDataVec, std::vector<int>* damageData, std::vector<float>* offsetData, std::vector<int>* buildingData) {
@@ -326,12 +641,14 @@ void Host::getBufferData(std::vector<int>* terrainData, std::vector<int>* creatu
     
     for (int x = 0; x < this->board.width(); x++) {
         for (int y = 0; y < this->board.height(x); y++) {
-            (*terrainData).push_back(this->board.get(x, y).terrain());
+            TileView tile = this->board.viewUnchecked(x, y);
             
-            (*creatureData).push_back(this->board.get(x, y).creatureType());
-            if (this->board.get(x, y).creature() != nullptr) { //If there is a creature set the data properly, otherwise as 0
-                (*creatureData).push_back(this->board.get(x, y).creature()->direction());
-                (*creatureData).push_back(this->board.get(x, y).creature()->controller());
+            (*terrainData).push_back(tile.terrain());
+            
+            (*creatureData).push_back(tile.creatureType());
+            if (tile.creature() != nullptr) { //If there is a creature set the data properly, otherwise as 0
+                (*creatureData).push_back(tile.creature()->direction());
+                (*creatureData).push_back(tile.creature()->controller());
             } else {
                 (*creatureData).push_back(0);
                 (*creatureData).push_back(0);
@@ -344,16 +661,16 @@ void Host::getBufferData(std::vector<int>* terrainData, std::vector<int>* creatu
                 (*colorDataVec)[a].push_back(tileColor.z);
             }
             
-            (*damageData).push_back(this->board.get(x, y).damage());
+            (*damageData).push_back(tile.damage());
             
-            if (this->board.get(x, y).creature() != nullptr)
-                (*offsetData).push_back(this->board.get(x, y).creature()->offset());
+            if (tile.creature() != nullptr)
+                (*offsetData).push_back(tile.creature()->offset());
             else
                 (*offsetData).push_back(0);
             
-            (*buildingData).push_back(this->board.get(x, y).buildingType());
-            if (this->board.get(x, y).building() != nullptr) //If there is a building set the data properly, otherwise as 0
-                (*buildingData).push_back(this->board.get(x, y).building()->controller());
+            (*buildingData).push_back(tile.buildingType());
+            if (tile.building() != nullptr) //If there is a building set the data properly, otherwise as 0
+                (*buildingData).push_back(tile.building()->controller());
             else
                 (*buildingData).push_back(0);
         }
@@ -372,38 +689,42 @@ void Host::losePlayer(int playerNum) {
     
     this->alivePlayers[playerNum].first = false;
     
-    for (int x = 0; x < this->board.width(); x++) {
-        for (int y = 0; y < this->board.height(x); y++) {
-            Creature* creature = this->board.get(x, y).creature();
-            if (creature != nullptr && creature->controller() == playerNum) {
-                this->processAction(this->board.deleteCreature(x, y), creature->controller());
-            }
-            Building* building = this->board.get(x, y).building();
-            if (building != nullptr && building->controller() == playerNum) {
-                this->processAction(this->board.deleteBuilding(x, y), building->controller());
-            }
+    //Only go through the player's own creatures and buildings. The handles are copied since deleting changes the board's lists
+    std::vector<SlotMap<Creature>::Handle> creatures = this->board.creaturesControlledBy(playerNum);
+    for (int a = 0; a < creatures.size(); a++) {
+        Creature* creature = this->board.creature(creatures[a]);
+        if (creature != nullptr) { //It may have already been deleted by another death action
+            this->processAction(this->board.deleteCreature(creature->x(), creature->y()), playerNum);
+        }
+    }
+    
+    std::vector<SlotMap<Building>::Handle> buildings = this->board.buildingsControlledBy(playerNum);
+    for (int a = 0; a < buildings.size(); a++) {
+        Building* building = this->board.building(buildings[a]);
+        if (building != nullptr) {
+            this->processAction(this->board.deleteBuilding(building->x(), building->y()), playerNum);
         }
     }
     this->announcementStr = "Player " + std::to_string(playerNum + 1) + " lost the game";
 }
 
-void Host::send(std::string message, unsigned int player) {
+void Host::send(const std::string& message, unsigned int player, MessageType type) {
     if (!this->alivePlayers[player].second) {
         return; //Skip if the player disconnected;
     } else if (!this->alivePlayers[player].first) { //Test if the dead player is still connected
         try {
-            this->socket.send(message.c_str(), player);
+            this->socket.send(message, player, type);
         } catch (std::runtime_error) {
             this->alivePlayers[player].second = false; //If the player didn't receive it, set that player to disconnected.
-            std::cout << "Player " << player << " (dead) didn't receive " << message << std::endl;
+            std::cout << "Player " << player << " (dead) didn't receive " << (type == TEXT_MESSAGE ? message : "a board update") << std::endl;
         }
     } else {
         try {
-            this->socket.send(message.c_str(), player);
+            this->socket.send(message, player, type);
         } catch (std::runtime_error) {
             this->losePlayer(player); //If the player didn't receive it, that player disconnected. Remove that player.
             this->alivePlayers[player].second = false;
-            std::cout << "Player " << player << " (alive) didn't receive " << message << std::endl;
+            std::cout << "Player " << player << " (alive) didn't receive " << (type == TEXT_MESSAGE ? message : "a board update") << std::endl;
         }
     }
 }
@@ -417,14 +738,14 @@ void Host::broadcast(std::string message) {
             continue; //Skip if the player disconnected;
         } else if (!this->alivePlayers[player].first) { //Test if the dead player is still connected
             try {
-                this->socket.send(message.c_str(), player);
+                this->socket.send(message, player, TEXT_MESSAGE);
             } catch (std::runtime_error) {
                 this->alivePlayers[player].second = false; //If the player didn't receive it, set that player to disconnected.
                 std::cout << "Player " << player << " (dead) didn't receive " << message << std::endl;
             }
         } else {
             try {
-                this->socket.send(message.c_str(), player);
+                this->socket.send(message, player, TEXT_MESSAGE);
             } catch (std::runtime_error) {
                 this->losePlayer(player); //If the player didn't receive it, that player disconnected. Remove that player.
                 this->alivePlayers[player].second = false;
@@ -432,6 +753,132 @@ void Host::broadcast(std::string message) {
             }
         }
     }
+    
+    //Backwards, since spectators that cannot be sent to are removed
+    for (int spectator = (int)this->spectators.size() - 1; spectator >= 0; spectator--) {
+        this->sendToSpectator(message, spectator, TEXT_MESSAGE);
+    }
+}
+
+void Host::tick() {
+    this->lastFrame += this->timestep;
+    this->currentTick++;
+    float currentTime = this->gameTime();
+    
+    //Go through all tiles' damage and reset them if enough time has passed
+    for (int x = 0; x < this->board.width(); x++) {
+        for (int y = 0; y < this->board.height(x); y++) {
+            TileView tile = this->board.viewUnchecked(x, y);
+            
+            //The time is cleared too, since keyframes write every tile with a damage or a time, see Board::encode()
+            if (tile.damage() > 0 && currentTime - tile.timeOfDamage() > Tile::damageScreenTime)
+                this->board.setDamage(x, y, 0, 0);
+        }
+    }
+    
+    //Regenerate energy (Energy is incremented by 1 every 5 seconds)
+    if (this->timestep * (long long)(this->currentTick - this->lastUpkeep) > std::chrono::duration<float>(Host::timeBetweenUpkeep)) {
+        this->board.regenerateEnergy();
+        this->lastUpkeep = this->currentTick;
+    }
+    
+    for (int a = 0; a < this->players.size(); a++) {
+        this->players[a].updateCreatures(this->deltaTime);
+        this->players[a].updateVision();
+    }
+}
+
+float Host::gameTime() {
+    return (float)std::chrono::duration<double>(this->timestep * (long long)this->currentTick).count();
+}
+
+void Host::sendUpdates(std::chrono::steady_clock::time_point currentTime) {
+    this->snapshotCache.reset(this->board);
+    
+    //Announcements go in their own message, before the board update
+    if (this->announcementStr.size() > 0) {
+        this->broadcast("announcement:" + this->announcementStr);
+        this->announcementStr = "";
+    }
+    
+    for (int a = 0; a < this->players.size(); a++) {
+        if (!this->alivePlayers[a].second)
+            continue; //Its index may belong to a spectator now
+        
+        MessageType type = this->boardUpdate(a, currentTime, this->updateWriter);
+        this->send(this->updateWriter.data(), a, type);
+    }
+    
+    for (int a = (int)this->spectators.size() - 1; a >= 0; a--) {
+        MessageType type = this->boardUpdate(this->spectators[a], currentTime, this->updateWriter);
+        this->sendToSpectator(this->updateWriter.data(), a, type);
+    }
+}
+
+bool Host::sendToSpectator(const std::string& message, unsigned int spectator, MessageType type) {
+    unsigned int clientIndex = this->spectators[spectator];
+    
+    try {
+        this->socket.send(message, clientIndex, type);
+        return true;
+    } catch (std::runtime_error) {
+        std::cout << "Spectator " << clientIndex << " didn't receive " << (type == TEXT_MESSAGE ? message : "a board update") << std::endl;
+        this->spectators.erase(this->spectators.begin() + spectator);
+        this->socket.closeConnection(clientIndex);
+        return false;
+    }
+}
+
+ServerSocketHandlers Host::eventHandlers() {
+    ServerSocketHandlers handlers;
+    
+    handlers.received = [this](unsigned int clientIndex, const std::string& message, MessageType type) {
+        this->messageReceived(clientIndex, message, type);
+    };
+    handlers.disconnected = [this](unsigned int clientIndex) {
+        this->clientDisconnected(clientIndex);
+    };
+    
+    return handlers;
+}
+
+void Host::messageReceived(unsigned int clientIndex, const std::string& message, MessageType type) {
+    if (type != ACTION_MESSAGE)
+        return;
+    
+    //Spectators can only say which board they have and how they want it, checked first since they may have the index of a player that left
+    bool spectator = this->socket.isSpectator(clientIndex);
+    if (!spectator && clientIndex >= this->players.size())
+        return;
+    
+    CommandReader commands(message);
+    Command command;
+    while (true) {
+        try {
+            if (!commands.next(command))
+                break;
+        } catch (std::range_error) { //The rest of the batch is corrupt, so it is dropped
+            std::cout << "Client " << clientIndex << " sent a corrupt command" << std::endl;
+            break;
+        }
+        
+        if (!spectator || !command.changesGame())
+            this->processCommand(command, clientIndex);
+    }
+}
+
+void Host::clientDisconnected(unsigned int clientIndex) {
+    if (this->socket.isSpectator(clientIndex)) {
+        this->spectators.erase(std::remove(this->spectators.begin(), this->spectators.end(), clientIndex), this->spectators.end());
+        return;
+    }
+    
+    if (clientIndex >= this->players.size())
+        return;
+    
+    if (this->alivePlayers[clientIndex].first)
+        this->losePlayer(clientIndex);
+    this->alivePlayers[clientIndex].second = false;
 }
 
 bool Host::receivedFromAll(std::string str) {
@@ -13,12 +13,17 @@
 #include <chrono>
 #include <mutex>
 #include <vector>
+#include <deque>
+#include <algorithm>
 #include <exception>
 
 //Local includes
 #include "ServerSocket.hpp"
 #include "Player.hpp"
 #include "Board.hpp"
+#include "Command.hpp"
+#include "Compressor.hpp"
+#include "SnapshotCache.hpp"
 
 class Host {
 public:
@@ -39,36 +44,104 @@ public:
     
     int mainClientNum = -1; //Set by the thread in main.cpp to the index of the client that runs this thread in a host, if there is one
     
+    static const unsigned int maximumStandardPlayers = 4; //One for each corner of the standard board
+    
     //Public member functions
     
     static std::string storeVectorOfInts(std::vector<int> vec);
     
     static std::string storeVectorOfFloats(std::vector<float> vec);
     
+    /*!
+     * Create the board that games are played on, with each player's starting creatures and home building. The first two players start in opposite corners, and any others in the remaining corners. An invalid_argument exception is thrown if there are more players than Host::maximumStandardPlayers.
+     *
+     * @param numberOfPlayers An optional parameter indicating how many players to create the starting creatures and home buildings of. Autoinitialized as 2.
+     *
+     * @return The board.
+     */
+    static Board standardBoard(unsigned int numberOfPlayers = 2);
+    
     /*!
      * A function that must be called before any other methods can be used. Initializes the socket of the game. If the optional parameter is nonzero, the game will automatically begin.
      *
      * @param portNum The port on this system (the server side) where to start taking connections. Succeeding ports may also be used, depending on implementation and number of players.
      * @param numberOfPlayers An optional parameter indicating the number of players with which to initialize the game. If unset it is set as 0. Otherwise (if numberOfPlayers != 0) then Host will automatically begin.
+     * @param transport An optional parameter indicating whether clients connect over TCP or UDP, see DatagramChannel.hpp. Autoinitialized as DEFAULT_TRANSPORT.
+     */
+    void set(int portNum, unsigned int numberOfPlayers = 0, Transport transport = DEFAULT_TRANSPORT);
+    
+    /*!
+     * Initializes the host without listening for connections, for a game whose clients are accepted elsewhere, such as by a Server, and handed over with addPlayer(int). Must be called before any other methods can be used, instead of set(int, unsigned int).
      */
-    void set(int portNum, unsigned int numberOfPlayers = 0);
+    void set();
     
     /*!
      * Adds a player to the game and initializes the connection socket with that player.
      */
     void addPlayer();
     
+    /*!
+     * Adds a player to the game for a client that has already connected.
+     *
+     * @param clientSocket The file descriptor of the connected client. The host takes ownership of it.
+     */
+    void addPlayer(int clientSocket);
+    
+    /*!
+     * Adds a player to the game for the client that the socket most recently accepted, such as from ServerSocket::processEvents().
+     */
+    void addConnectedPlayer();
+    
+    /*!
+     * Adds a spectator to the game, for a client that has already connected. Spectators are told "spectating", then sent the serialized board after "spectator," in place of a player number. From then on they are sent the whole board and the announcements, but cannot act. A logic_error is thrown if the game has not begun, since the players must have the first connections.
+     *
+     * @param clientSocket The file descriptor of the connected client. The host takes ownership of it.
+     */
+    void addSpectator(int clientSocket);
+    
     /*!
      * Begin the clock for the game and send out initial information to each client. Automatically called by constructor if numberOfPlayers != 0.
      */
     void begin();
     
     /*!
-     * Updates the players and the game based on input from clients. This should be called every frame.
+     * Runs the game: simulates however many fixed ticks are due, sends the board to the clients when a send is due, then sleeps until the next tick or send, handling the clients' messages as they arrive. This should be called in a loop, and only uses the processor while there is work to do. See setTickRate() and setSendRate().
      *
      * @param An optional pointer to a bool indicating whether the function should stop. If so, it ends before sending out or receiving data. If unset, it will be treated as false.
+     * @param wait An optional bool indicating whether to sleep until the next tick or send. If false, only the messages that have already arrived are handled, so that one thread can run several games, see timeUntilDue(). Autoinitialized as true.
+     */
+    void update(bool* done = nullptr, bool wait = true);
+    
+    /*!
+     * Set how many times a second the game is simulated. Each tick advances the game by the same amount of time, however often update() is called. An invalid_argument exception is thrown if the rate is not positive. Autoinitialized as Host::defaultTickRate.
+     *
+     * @param ticksPerSecond The number of ticks per second.
+     */
+    void setTickRate(float ticksPerSecond);
+    
+    /*!
+     * Set how many times a second the clients are sent the board, independent of the tick rate. An invalid_argument exception is thrown if the rate is not positive. Autoinitialized as Host::defaultSendRate.
+     *
+     * @param sendsPerSecond The number of board updates per second.
      */
-    void update(bool* done = nullptr);
+    void setSendRate(float sendsPerSecond);
+    
+    /*!
+     * Set whether clients that ask for compressed board updates get them, see Compressor.hpp. Compression makes updates several times smaller, for links where they are what fills the bandwidth, at the cost of the host's time to compress them. Clients that already asked keep getting what they were getting. Autoinitialized as true.
+     *
+     * @param allowed Whether to compress.
+     */
+    void setCompression(bool allowed);
+    
+    /*!
+     * @return The number of seconds until the next tick or send is due, or 0 if one is already due.
+     */
+    float timeUntilDue();
+    
+    /*!
+     * @return Whether every player has disconnected, so the game is over.
+     */
+    bool finished();
     
     /*!
      * @return The number of players currently connected.
@@ -86,33 +159,202 @@ private:
     //Private properties
     
     //Time
-    std::chrono::time_point<std::chrono::steady_clock> programStartTime;
-    std::chrono::duration<float> lastFrame;
-    std::chrono::duration<float> lastUpkeep;
+    std::chrono::steady_clock::time_point lastFrame; //The time that the game has been simulated up to, which advances by exactly one timestep per tick
+    std::chrono::steady_clock::time_point nextSend; //When the clients are next sent the board
+    
+    //The game time is counted in ticks, so that it does not drift however long the game runs, see gameTime()
+    unsigned long long currentTick = 0;
+    unsigned long long lastUpkeep = 0; //The tick of the last upkeep
+    
+    constexpr static const float defaultTickRate = 60.0f;
+    constexpr static const float defaultSendRate = 10.0f; //Clients move creatures themselves between updates, see Board::updateCreature(), so the board is sent far less often than it is simulated
+    
+    //If the simulation falls further behind than this, the missed time is skipped instead of simulated
+    static const int maximumTicksPerUpdate = 5;
+    
+    std::chrono::steady_clock::duration timestep = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / Host::defaultTickRate));
+    std::chrono::steady_clock::duration sendInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / Host::defaultSendRate));
     
     constexpr static const float timeBetweenUpkeep = 5.0f;
     
+    //How often each client is sent the whole board, even if it has been keeping up with the changes, in seconds
+    constexpr static const float timeBetweenKeyframes = 10.0f;
+    
 //    float timeOfLastUpkeep = 0;
     
-    float deltaTime = 0.0f;
+    float deltaTime = 1.0f / Host::defaultTickRate;
     
     //Game
     std::vector<Player> players;
     std::vector<std::pair<bool, bool> > alivePlayers; // { alive, connected }
+    std::vector<unsigned int> spectators; //The client index of each spectator
+    bool begun = false;
     
     std::string announcementStr = ""; //A string to be displayed by each client.
     
+    //Replication. Each client is only sent the tiles that changed since the board version it last acknowledged
+    std::vector<unsigned int> ackedVersions; //The version each client has, see Host::cameraEpochs, or Board::noVersion if it needs the whole board. Indexed by client index, which for players is the player number
+    std::vector<std::chrono::steady_clock::time_point> lastKeyframes; //When each client was last sent the whole board. Indexed like ackedVersions
+    ByteWriter updateWriter; //Kept between frames so that its memory is reused
+    
+    //Interest management. Each client is only sent the creatures, buildings and damage on the tiles in its interest, see Host::interest()
+    
+    /*!
+     * The interests of the updates sent to a client at one version. A client that acknowledges the version may have been sent any of them.
+     */
+    struct SentView {
+        unsigned int version; //The version the client was sent, see Host::cameraEpochs
+        unsigned int boardVersion; //The version of the board it was sent at
+        BitBoard any; //Tiles in the interest of at least one of the updates
+        BitBoard all; //Tiles in the interest of every one of the updates
+    };
+    
+    std::vector<BitBoard> cameras; //The tiles each client's camera shows, with Host::cameraMargin around them, or the whole board if it has not said. Indexed like ackedVersions
+    std::vector<unsigned int> cameraEpochs; //How many times each client's camera has moved. Added to the board version to get the versions the client is sent, so that it acknowledges a new one once its camera moves even if the board has not changed. Indexed like ackedVersions
+    std::vector<std::deque<SentView> > sentViews; //The views of the updates sent to each client since the version it acknowledged, oldest first. Indexed like ackedVersions
+    SnapshotCache snapshotCache;
+    
+    //Kept between updates so that their memory is reused
+    BitBoard interestTiles;
+    BitBoard changedTiles;
+    BitBoard terrainChangedTiles;
+    BitBoard anyInterest;
+    BitBoard allInterest;
+    
+    //Tiles around a client's camera that are sent as well, so that what scrolls into view is already there
+    static const int cameraMargin = 2;
+    
+    //Once this many updates at different versions have not been acknowledged, the oldest are forgotten, and a client that acknowledges one is sent a keyframe
+    static const unsigned int maximumSentViews = 64;
+    
+    //Compression
+    bool compressionAllowed = true;
+    std::vector<bool> compressedUpdates; //Whether each client asked for compressed board updates and was allowed them. Indexed like ackedVersions
+    Compressor compressor;
+    ByteWriter uncompressedWriter; //Holds a board update before it is compressed into updateWriter
+    
     bool setUp = false;
     
     //Private member functions
     
     /*!
-     * Follow an action based on a std::string sent from the client. The string comes from the clientInfo string.
+     * Follow an action written as text, which is how the death actions of creatures and buildings are set, see Attackable::deathAction. Clients send commands instead, see processCommand().
+     *
+     * @param action A reader over the string telling what action to do. A std::string can be passed directly.
+     * @param playerNum The number of the player whose creature or building the action came from. -1 can be used to indicate that it is irrelevant.
+     */
+    void processAction(TextReader action, int playerNum);
+    
+    /*!
+     * Follow a command sent by a client, see Command.hpp. Commands on tiles outside of the board, or on creatures the player does not control, are ignored.
+     *
+     * @param command The command.
+     * @param playerNum The number of the player who sent the command.
+     */
+    void processCommand(const Command& command, int playerNum);
+    
+    /*!
+     * Move a creature along the best path to a tile, if the player controls it and it can reach the tile.
+     *
+     * @param command A MOVE_CREATURE_OPCODE command.
+     * @param playerNum The number of the player who sent the command.
+     */
+    void moveCreature(const Command& command, int playerNum);
+    
+    /*!
+     * Set which tiles a client's camera shows, see CAMERA_OPCODE. The corners are clipped to the board, and ignored if they are the wrong way around.
+     *
+     * @param clientIndex The index of the client.
+     * @param minTile The corner of the camera with the lowest coordinates.
+     * @param maxTile The corner of the camera with the highest coordinates.
+     */
+    void setCamera(unsigned int clientIndex, glm::ivec2 minTile, glm::ivec2 maxTile);
+    
+    /*!
+     * Find the tiles a client is sent the contents of. A player's interest is the tiles their creatures can see that their camera shows, and the tiles of their own creatures and buildings wherever they are, so enemies out of sight are never sent. Spectators and players who have lost see the whole board, as far as their cameras show.
+     *
+     * @param clientIndex The index of the client.
+     * @param tiles Set to the tiles.
+     */
+    void interest(unsigned int clientIndex, BitBoard& tiles);
+    
+    /*!
+     * Have a creature attack an opponent's creature or building, if the player controls it and the target is in range.
+     *
+     * @param command An ATTACK_OPCODE command.
+     * @param playerNum The number of the player who sent the command.
+     */
+    void attack(const Command& command, int playerNum);
+    
+    /*!
+     * Have a mage strike any creature, ignoring range, with no strike back.
+     *
+     * @param command A MAGE_STRIKE_OPCODE command.
+     * @param playerNum The number of the player who sent the command.
+     */
+    void mageStrike(const Command& command, int playerNum);
+    
+    /*!
+     * Advance the game by one timestep: expire damage, regenerate energy, and move and update the vision of every player's creatures.
+     */
+    void tick();
+    
+    /*!
+     * @return The number of seconds that have been simulated, which is the time used for damage and upkeep.
+     */
+    float gameTime();
+    
+    /*!
+     * Send each client the announcement, if there is one, and its board update.
+     *
+     * @param currentTime The current time.
+     */
+    void sendUpdates(std::chrono::steady_clock::time_point currentTime);
+    
+    /*!
+     * Send a message to a spectator. If it cannot be sent, the spectator is disconnected.
+     *
+     * @param message The message to send.
+     * @param spectator The position of the spectator in Host::spectators.
+     * @param type What the message holds.
+     *
+     * @return Whether the spectator is still connected.
+     */
+    bool sendToSpectator(const std::string& message, unsigned int spectator, MessageType type);
+    
+    /*!
+     * @return The functions that handle the socket's events during the game.
+     */
+    ServerSocketHandlers eventHandlers();
+    
+    /*!
+     * Process the actions in a message from a client.
+     *
+     * @param clientIndex The index of the client, which is also its player number.
+     * @param message The message, a batch of commands, see Command.hpp.
+     * @param type What the message holds. Only commands are expected from clients.
+     */
+    void messageReceived(unsigned int clientIndex, const std::string& message, MessageType type);
+    
+    /*!
+     * Remove a player whose client disconnected from the game.
+     *
+     * @param clientIndex The index of the client, which is also its player number.
+     */
+    void clientDisconnected(unsigned int clientIndex);
+    
+    /*!
+     * Write the board update to send to a client. This is either a delta, with only the tiles that changed since the version the client acknowledged, or a keyframe with the whole board. A keyframe is sent if the client has no version, asked to be resynced, is too far behind, or has not had one in Host::timeBetweenKeyframes. Either only has the contents of the tiles in the client's interest, see Host::interest().
+     *
+     * Deltas are the base version and the new version as varints, followed by Board::encodeTiles(), and can be applied by any client with a version at or after the base. Besides the tiles that changed, they have every tile that came into or went out of the client's interest since any update it may have, so that what it can no longer see is cleared. Keyframes are the version as a varint, followed by Board::encode(). Either is compressed if the client asked for compression and it comes out smaller, see Compressor.hpp.
+     *
+     * @param player The index of the client to send to, which for players is the player number.
+     * @param currentFrame The time of this frame.
+     * @param writer The ByteWriter to write the update to. It is cleared first.
      *
-     * @param action The string telling what action to do.
-     * @param playerNum The number of the player who sent the action. -1 can be used to indicate that it is irrelevant.
+     * @return The type of message to send the update as, either DELTA_MESSAGE, KEYFRAME_MESSAGE or COMPRESSED_MESSAGE.
      */
-    void processAction(std::string action, int playerNum);
+    MessageType boardUpdate(unsigned int player, std::chrono::steady_clock::time_point currentFrame, ByteWriter& writer);
     
     /*!
      * Fill given std::vectors with OpenGL data.
@@ -138,8 +380,9 @@ private:
      *
      * @param message The std::string to send.
      * @param player The number of the player to send.
+     * @param type What the message holds. Autoinitialized as TEXT_MESSAGE.
      */
-    void send(std::string message, unsigned int player);
+    void send(const std::string& message, unsigned int player, MessageType type = TEXT_MESSAGE);
     
     /*!
      * Broadcasts a given message to all remaining alive players.
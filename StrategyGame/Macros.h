@@ -22,6 +22,9 @@
 //To make the selected tile reset after movement
 //#define RESET_SELECTED_TILE_AFTER_MOVEMENT
 
+//To connect over UDP instead of TCP by default, so that a lost packet does not hold up the board updates after it. See DatagramChannel.hpp
+//#define DATAGRAM_SOCKETS
+
     //Various console outputs
 
 //#define COMBAT_CONSOLE_OUTPUT
@@ -30,7 +33,8 @@
 
     //Other
 #define FONT_PATH "Resources/Palatino.ttc"
-#define MAXIMUM_SOCKET_MESSAGE_SIZE 65535 //Arbitrary, but 65535 = 2^16 - 1
-#define MAX_NUMBER_OF_CONNECTIONS 5 //5 is the max for most systems, so 5 should be set
+#define MAXIMUM_SOCKET_MESSAGE_SIZE 67108864 //64 MiB, for the boards the host sends. Any longer length in a message header is treated as a corrupt stream
+#define SPECTATOR_PORT_OFFSET 1 //Spectators of a dedicated server connect to the port after the players' one, see Server::run()
+#define MAXIMUM_CLIENT_MESSAGE_SIZE 65535 //The longest message a host accepts from a client, which only sends commands and the replies of the handshake
 
 #endif /* Macros_h */
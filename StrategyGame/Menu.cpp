@@ -87,6 +87,7 @@ void Menu::render() {
             this->interface.addButton("return_to_start_menu", "Back");
         } else {
             this->interface.addButton("find_host", "Find host");
+            this->interface.addButton("spectate_host", "Spectate");
             this->interface.addButton("return_to_start_menu", "Back");
         }
         if (this->thread.joinable()) this->thread.join();
@@ -127,6 +128,7 @@ void Menu::processAction(std::string action) {
         this->interface.addBox("Input host name");
         this->textbox = &this->interface.boxes.back();
         this->interface.addButton("find_host", "Find host");
+        this->interface.addButton("spectate_host", "Spectate");
         
         this->interface.addButton("return_to_start_menu", "Back");
         
@@ -148,14 +150,16 @@ void Menu::processAction(std::string action) {
         
         this->interface.addButton("return_to_start_menu", "Back");
         
-    } else if (action == "find_host") { //Look for a host based on information from the textbox
+    } else if (action == "find_host" || action == "spectate_host") { //Look for a host based on information from the textbox, to play or to watch a match of a dedicated server
+        this->spectating = action == "spectate_host";
         this->interface.removePropertyLayer(); //Remove "Back"
         
         if (this->textbox == nullptr) {
             throw std::logic_error("No host submitted: Textbox is nullptr.");
         }
         this->connectToHost(this->textbox->text);
-        this->interface.removePropertyLayer();
+        this->interface.removePropertyLayer(); //Remove "Spectate"
+        this->interface.removePropertyLayer(); //Remove "Find host"
         this->interface.addBox("Looking for host");
         
     } else if (action == "begin_game_as_both") { //Start the game when playing as both a host and a client
@@ -164,7 +168,7 @@ void Menu::processAction(std::string action) {
         
     } else if (action.find("connect_to_host:") != std::string::npos) { //Connect to a host
         std::string hostName = action.substr(16); //The string after "connect_to_host:"
-        this->thread = std::thread(this->threadFunction, &this->connected, &this->failedToConnect, this->socket, hostName);
+        this->thread = std::thread(this->threadFunction, &this->connected, &this->failedToConnect, this->socket, hostName, this->spectating ? 3000 + SPECTATOR_PORT_OFFSET : 3000);
         this->connecting = true;
     } else if (action == "add_player") {
         this->status = ADD_PLAYER;
@@ -280,14 +284,14 @@ void Menu::connectToHost(std::string hostName) {
     this->processAction("connect_to_host:" + hostName);
 }
 
-void Menu::threadFunction(bool *done, bool *failed, ClientSocket *socket, std::string hostName) {
+void Menu::threadFunction(bool *done, bool *failed, ClientSocket *socket, std::string hostName, int port) {
     std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
     while (true) {
         std::chrono::duration<double> timeElapsed = std::chrono::steady_clock::now() - start;
         if (timeElapsed.count() > MAX_CONNECTION_TIME) break;
         
         try {
-            socket->setSocket(hostName.c_str(), 3000);
+            socket->setSocket(hostName.c_str(), port);
         } catch (std::runtime_error) {
             continue; //Keep trying to connect, for 10 seconds
         }
@@ -301,10 +305,14 @@ void Menu::threadListenForStart(bool *gameStarting, ClientSocket *socket, bool*
     socket->setTimeout(1);
     while(*keepListening) {
         try {
-            if (socket->receive() == "starting") {
+            std::string message = socket->receive();
+            if (message == "starting") {
                 socket->send("message_received");
                 *gameStarting = true;
                 break;
+            } else if (message == "spectating") { //Spectators join a game that has already begun, and the host does not wait for them
+                *gameStarting = true;
+                break;
             }
         } catch (std::runtime_error) {
             continue;
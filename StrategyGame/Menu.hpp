@@ -89,6 +89,7 @@ private:
     bool waitingForStart = false; //If there is connection but the host has not started
     bool gameStarting = false; //If the host is starting the game
     bool keepListening = true; //To keep the thread listening for when the game starts
+    bool spectating = false; //If the client is to watch a game instead of playing in it
     
     //Shaders
     Shader textureShader;
@@ -125,11 +126,12 @@ private:
      * @param failed A pointer to a bool indicating that no host was found.
      * @param socket A pointer to a ClientSocket object with the socket that should be connected to the host.
      * @param hostName A std::string representing the name of the host to connect to. Use "localhost" to connect to a host on the same device.
+     * @param port The port to connect to, which for a dedicated server is a different one for spectators.
      */
-    static void threadFunction(bool* done, bool* failed, ClientSocket *socket, std::string hostName);
+    static void threadFunction(bool* done, bool* failed, ClientSocket *socket, std::string hostName, int port);
     
     /*!
-     * A function to be run by an std::thread that will attempt to tell if the game is starting
+     * A function to be run by an std::thread that will attempt to tell if the game is starting, or if the client has been made a spectator of one that has begun
      *
      * @param gameStarting A pointer to a bool that will be set when the game is starting.
      * @param socket A pointer to a ClientSocket object with the socket that should be connected to the host.
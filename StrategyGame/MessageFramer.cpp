@@ -0,0 +1,274 @@
+//
+//  MessageFramer.cpp
+//  Strategy Game
+//
+
+#include "MessageFramer.hpp"
+#include "DatagramChannel.hpp"
+
+//Constructor
+
+MessageFramer::MessageFramer(int socket) {
+    this->setSocket(socket);
+}
+
+//Public member functions
+
+void MessageFramer::setSocket(int socket) {
+    this->socket = socket;
+    this->received.clear();
+    this->queued.clear();
+    
+    int socketType = SOCK_STREAM;
+    socklen_t socketTypeSize = sizeof(socketType);
+    if (socket >= 0 && getsockopt(socket, SOL_SOCKET, SO_TYPE, &socketType, &socketTypeSize) == 0 && socketType == SOCK_DGRAM) {
+        this->datagrams.reset(new DatagramChannel(socket));
+        this->datagrams->setMaximumReceiveLength(this->maximumReceiveLength);
+    } else
+        this->datagrams.reset();
+}
+
+void MessageFramer::setQueueing(bool queueing) {
+    this->queueing = queueing;
+}
+
+void MessageFramer::setReceiveTimeout(int milliseconds) {
+    this->receiveTimeout = milliseconds;
+}
+
+void MessageFramer::setMaximumReceiveLength(size_t length) {
+    this->maximumReceiveLength = std::min(length, (size_t)MAXIMUM_SOCKET_MESSAGE_SIZE);
+    
+    if (this->datagrams)
+        this->datagrams->setMaximumReceiveLength(this->maximumReceiveLength);
+}
+
+void MessageFramer::send(const char* data, size_t length, MessageType type) {
+    if (length > MAXIMUM_SOCKET_MESSAGE_SIZE)
+        throw std::range_error("ERROR message too long: " + std::to_string(length) + " bytes");
+    
+    if (this->datagrams) {
+        this->datagrams->send(data, length, type);
+        return;
+    }
+    
+    char header[MessageFramer::headerLength];
+    for (int a = 0; a < 4; a++) {
+        header[a] = (char)((length >> (8 * a)) & 0xFF);
+    }
+    header[4] = (char)type;
+    
+    //The header and the message go out together from their own buffers, so the message is never copied
+    iovec parts[2];
+    parts[0].iov_base = header;
+    parts[0].iov_len = MessageFramer::headerLength;
+    parts[1].iov_base = (void*)data;
+    parts[1].iov_len = length;
+    
+    //Anything queued has to go out first, so that messages are not mixed together
+    if (this->queued.size() > 0 && !this->flush()) {
+        if (this->queued.size() + MessageFramer::headerLength + length > MAXIMUM_SOCKET_MESSAGE_SIZE)
+            throw std::runtime_error("ERROR sending message: the other side is not reading");
+        
+        this->queue(parts, 2);
+        return;
+    }
+    
+    this->writeAll(parts, 2);
+}
+
+bool MessageFramer::receive(std::string& message, MessageType& type) {
+    if (this->datagrams)
+        return this->datagrams->receive(message, type, this->receiveTimeout);
+    
+    while (!this->hasMessage()) {
+        //Once the header has arrived, make room for the whole message so that the buffer only grows once
+        if (this->received.size() >= MessageFramer::headerLength)
+            this->received.reserve(MessageFramer::headerLength + this->frontMessageLength());
+        
+        long bytesRead = this->received.readFrom(this->socket);
+        
+        if (bytesRead < 0) {
+            if (errno == EINTR)
+                continue;
+            
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                //Nothing has arrived on a non-blocking socket, so wait for something to
+                pollfd readable;
+                readable.fd = this->socket;
+                readable.events = POLLIN;
+                readable.revents = 0;
+                
+                if (poll(&readable, 1, this->receiveTimeout) == 0)
+                    throw std::runtime_error("ERROR reading from socket: timed out");
+                continue;
+            }
+            
+            throw std::runtime_error(std::string("ERROR reading from socket: ") + std::string(strerror(errno)));
+        }
+        if (bytesRead == 0)
+            return false; //The connection closed
+    }
+    
+    return this->nextMessage(message, type);
+}
+
+bool MessageFramer::readAvailable() {
+    if (this->datagrams)
+        return this->datagrams->readAvailable();
+    
+    while (true) {
+        if (this->received.size() >= MessageFramer::headerLength)
+            this->received.reserve(MessageFramer::headerLength + this->frontMessageLength());
+        
+        long bytesRead = this->received.readFrom(this->socket);
+        
+        if (bytesRead < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return true; //Everything that has arrived has been read
+            
+            throw std::runtime_error(std::string("ERROR reading from socket: ") + std::string(strerror(errno)));
+        }
+        if (bytesRead == 0)
+            return false; //The connection closed
+    }
+}
+
+bool MessageFramer::nextMessage(std::string& message, MessageType& type) {
+    if (this->datagrams)
+        return this->datagrams->nextMessage(message, type);
+    
+    if (!this->hasMessage())
+        return false;
+    
+    uint32_t length = this->frontMessageLength();
+    
+    char typeByte;
+    this->received.peek(&typeByte, 1, 4);
+    type = (MessageType)typeByte;
+    
+    message.resize(length);
+    if (length > 0)
+        this->received.peek(&message[0], length, MessageFramer::headerLength);
+    this->received.consume(MessageFramer::headerLength + length);
+    
+    return true;
+}
+
+bool MessageFramer::flush() {
+    if (this->datagrams)
+        return this->datagrams->flush();
+    
+    while (this->queued.size() > 0) {
+        long bytesSent = this->queued.writeTo(this->socket);
+        
+        if (bytesSent < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return false;
+            
+            throw std::runtime_error(std::string("ERROR sending message: ") + std::string(strerror(errno)));
+        }
+    }
+    
+    return true;
+}
+
+void MessageFramer::sendClose() {
+    if (this->datagrams)
+        this->datagrams->sendClose();
+}
+
+//Public get functions
+
+bool MessageFramer::hasMessage() const {
+    if (this->datagrams)
+        return this->datagrams->hasMessage();
+    
+    return this->received.size() >= MessageFramer::headerLength && this->received.size() >= MessageFramer::headerLength + this->frontMessageLength();
+}
+
+bool MessageFramer::hasQueued() const {
+    if (this->datagrams)
+        return this->datagrams->hasQueued();
+    
+    return this->queued.size() > 0;
+}
+
+int MessageFramer::timeUntilDue() const {
+    return this->datagrams ? this->datagrams->timeUntilDue() : -1;
+}
+
+//Private member functions
+
+void MessageFramer::writeAll(iovec* parts, int count) {
+    //Skip any empty parts at the front
+    while (count > 0 && parts->iov_len == 0) {
+        parts++;
+        count--;
+    }
+    
+    while (count > 0) {
+        long bytesSent = writev(this->socket, parts, count);
+        
+        if (bytesSent < 0) {
+            if (errno == EINTR)
+                continue;
+            
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (this->queueing) {
+                    this->queue(parts, count);
+                    return;
+                }
+                
+                //The socket's send buffer is full. Wait until the other side has read enough for more to fit
+                pollfd writable;
+                writable.fd = this->socket;
+                writable.events = POLLOUT;
+                writable.revents = 0;
+                
+                if (poll(&writable, 1, MessageFramer::sendTimeout) == 0)
+                    throw std::runtime_error("ERROR sending message: timed out waiting for the socket to be writable");
+                continue;
+            }
+            
+            throw std::runtime_error(std::string("ERROR sending message: ") + std::string(strerror(errno)));
+        }
+        
+        //Move past whatever was sent, which can end partway through a part
+        while (count > 0 && (size_t)bytesSent >= parts->iov_len) {
+            bytesSent -= parts->iov_len;
+            parts++;
+            count--;
+        }
+        if (count > 0) {
+            parts->iov_base = (char*)parts->iov_base + bytesSent;
+            parts->iov_len -= bytesSent;
+        }
+    }
+}
+
+void MessageFramer::queue(const iovec* parts, int count) {
+    for (int a = 0; a < count; a++) {
+        this->queued.write((const char*)parts[a].iov_base, parts[a].iov_len);
+    }
+}
+
+uint32_t MessageFramer::frontMessageLength() const {
+    unsigned char header[4];
+    this->received.peek((char*)header, 4);
+    
+    uint32_t length = header[0] | (header[1] << 8) | (header[2] << 16) | ((uint32_t)header[3] << 24);
+    
+    if (length > this->maximumReceiveLength)
+        throw std::range_error("ERROR message too long: " + std::to_string(length) + " bytes");
+    
+    return length;
+}
+
+//Destructor
+
+MessageFramer::~MessageFramer() {}
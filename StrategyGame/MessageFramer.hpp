@@ -0,0 +1,208 @@
+//
+//  MessageFramer.hpp
+//  Strategy Game
+//
+
+#ifndef MessageFramer_hpp
+#define MessageFramer_hpp
+
+#include "Macros.h"
+
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+
+#include "RingBuffer.hpp"
+
+//How messages are framed:
+//TCP delivers a stream of bytes, so separate writes can arrive joined together or split apart. Every message is sent with a 5 byte header in front of it: its length as a 4 byte little-endian number, then its type. The receiver collects bytes until the whole message has arrived, and returns exactly that message, so messages can hold any bytes and be any size up to MAXIMUM_SOCKET_MESSAGE_SIZE.
+//A framer can be used two ways. receive() and send() wait until they are done, like read() and write() on a blocking socket. With a non-blocking socket in an event loop, such as ServerSocket::processEvents(), readAvailable() and nextMessage() take whatever has arrived without waiting, and with queueing set, send() keeps whatever the socket could not take and flush() sends it once the socket is writable.
+//Over a UDP socket, a framer hands everything to a DatagramChannel instead, which splits messages into packets and resends the ones that must arrive, see DatagramChannel.hpp. Since it resends and acknowledges on its own timers, an event loop has to call flush() whenever timeUntilDue() runs out, not only when the socket is writable. Otherwise the framer is used the same way over either kind of socket, and it finds out which one it has by itself.
+
+/*!
+ * What a message holds, sent in its header so that the receiver knows how to read it.
+ */
+enum MessageType : uint8_t {
+    TEXT_MESSAGE = 0, //Text, such as announcements and the messages of the handshake
+    KEYFRAME_MESSAGE = 1, //The whole board in the binary format, see Host::boardUpdate()
+    DELTA_MESSAGE = 2, //The changed tiles of the board in the binary format, see Host::boardUpdate()
+    ACTION_MESSAGE = 3, //A batch of commands from a client, see Command.hpp
+    COMPRESSED_MESSAGE = 4, //Another type of message, compressed, see Compressor.hpp
+};
+
+/*!
+ * Which protocol a socket sends messages over.
+ */
+enum Transport : uint8_t {
+    STREAM_TRANSPORT = 0, //TCP, where every message arrives, in order
+    DATAGRAM_TRANSPORT = 1, //UDP, where lost board updates are skipped instead of holding up the ones after them, see DatagramChannel.hpp
+};
+
+//The transport that sockets use unless they are told otherwise, see Macros.h
+#ifdef DATAGRAM_SOCKETS
+#define DEFAULT_TRANSPORT DATAGRAM_TRANSPORT
+#else
+#define DEFAULT_TRANSPORT STREAM_TRANSPORT
+#endif
+
+class DatagramChannel;
+
+/*!
+ * Sends and receives whole messages over a connected socket. See MessageFramer.hpp.
+ */
+class MessageFramer {
+public:
+    //Constructor
+    
+    /*!
+     * @param socket The file descriptor of a connected socket, or -1 if it will be set later.
+     */
+    MessageFramer(int socket = -1);
+    
+    //Destructor
+    ~MessageFramer();
+    
+    //Public member functions
+    
+    /*!
+     * Set the socket to send and receive with. Any bytes left over from the previous socket are discarded. A datagram socket must have finished connecting, see DatagramChannel.hpp.
+     *
+     * @param socket The file descriptor of a connected socket, or -1 to stop using one.
+     */
+    void setSocket(int socket);
+    
+    /*!
+     * Set whether send() queues the bytes that the socket cannot take yet instead of waiting for them to be sent. The queue is sent with flush().
+     *
+     * @param queueing Whether to queue.
+     */
+    void setQueueing(bool queueing);
+    
+    /*!
+     * Set how long receive() waits on a non-blocking socket before throwing. Blocking sockets use SO_RCVTIMEO instead.
+     *
+     * @param milliseconds The timeout, or -1 to wait forever.
+     */
+    void setReceiveTimeout(int milliseconds);
+    
+    /*!
+     * Set the longest message that is accepted from the other side. A longer length in a header is treated as a corrupt stream, so that the other side cannot make this reserve more memory than its messages should ever need. Hosts use MAXIMUM_CLIENT_MESSAGE_SIZE for their clients, since clients only send commands.
+     *
+     * @param length The longest message, up to MAXIMUM_SOCKET_MESSAGE_SIZE, which is the default.
+     */
+    void setMaximumReceiveLength(size_t length);
+    
+    /*!
+     * Send a whole message. Partial writes are continued and interrupted writes are retried until every byte is sent. If the socket is non-blocking and its send buffer is full, this waits for it to drain, or if queueing is set, the rest of the message is queued for flush(). A runtime_error is thrown if an error occurs while sending or if the queue would grow past MAXIMUM_SOCKET_MESSAGE_SIZE, which means the other side has stopped reading, and a range_error if the message is too long.
+     *
+     * @param data The bytes of the message.
+     * @param length The number of bytes.
+     * @param type What the message holds.
+     */
+    void send(const char* data, size_t length, MessageType type);
+    
+    /*!
+     * Receive the next whole message, waiting for the rest of it to arrive if needed. A runtime_error is thrown if an error occurs while reading, including timing out, and a range_error if the header says the message is longer than the maximum, see setMaximumReceiveLength(), which means the stream is corrupt.
+     *
+     * @param message Set to the message received.
+     * @param type Set to the type of the message.
+     *
+     * @return True if a message was received, false if the connection closed first.
+     */
+    bool receive(std::string& message, MessageType& type);
+    
+    /*!
+     * Read everything that has arrived on a non-blocking socket, without waiting for more. A runtime_error is thrown if an error occurs while reading.
+     *
+     * @return False if the connection closed, true otherwise.
+     */
+    bool readAvailable();
+    
+    /*!
+     * Take the next whole message that has already been read, without reading from the socket.
+     *
+     * @param message Set to the message, if there is one.
+     * @param type Set to the type of the message, if there is one.
+     *
+     * @return Whether there was a whole message.
+     */
+    bool nextMessage(std::string& message, MessageType& type);
+    
+    /*!
+     * Send as much of the queue as the socket will take without waiting. Over a datagram socket, this also resends whatever was not acknowledged in time and sends any acknowledgements that are due. A runtime_error is thrown if an error occurs while sending, or if the other side of a datagram socket has stopped answering.
+     *
+     * @return Whether the queue is now empty.
+     */
+    bool flush();
+    
+    /*!
+     * Tell the other side that the connection is closing. Closing a stream socket already tells it, so this only sends anything over a datagram socket. Call this before closing the socket. It never throws.
+     */
+    void sendClose();
+    
+    //Public get functions
+    
+    /*!
+     * @return Whether a whole message has already arrived, so that receive() will not wait.
+     */
+    bool hasMessage() const;
+    
+    /*!
+     * @return Whether there are queued bytes waiting for flush().
+     */
+    bool hasQueued() const;
+    
+    /*!
+     * @return The milliseconds until flush() has something to resend or acknowledge, or -1 if it never does by itself, as over a stream socket.
+     */
+    int timeUntilDue() const;
+    
+private:
+    //Private properties
+    
+    int socket;
+    
+    RingBuffer received; //Bytes read from the socket that are not part of a returned message yet
+    RingBuffer queued; //Bytes of sent messages that the socket could not take yet
+    
+    bool queueing = false;
+    int receiveTimeout = -1;
+    size_t maximumReceiveLength = MAXIMUM_SOCKET_MESSAGE_SIZE;
+    
+    std::unique_ptr<DatagramChannel> datagrams; //Does the framing instead while the socket is a datagram socket, see DatagramChannel.hpp
+    
+    static const size_t headerLength = 5;
+    static const int sendTimeout = 5000; //The milliseconds to wait for a full send buffer to drain before giving up on the connection
+    
+    //Private member functions
+    
+    /*!
+     * Write all of the bytes of every part with writev(), calling it again for whatever a call did not send. The parts are changed to track what is left. If queueing is set, whatever does not fit in the socket's send buffer is queued instead.
+     *
+     * @param parts The buffers to send, in order.
+     * @param count The number of buffers.
+     */
+    void writeAll(iovec* parts, int count);
+    
+    /*!
+     * Add the bytes of every part to the back of the queue.
+     */
+    void queue(const iovec* parts, int count);
+    
+    /*!
+     * @return The length of the message at the front of the received bytes, from its header. The header must have arrived.
+     */
+    uint32_t frontMessageLength() const;
+};
+
+#endif /* MessageFramer_hpp */
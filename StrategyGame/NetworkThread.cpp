@@ -0,0 +1,200 @@
+//
+//  NetworkThread.cpp
+//  Strategy Game
+//
+
+#include "NetworkThread.hpp"
+
+const int NetworkThread::fullQueueWait; //Defined here as well, so that it can be passed by reference
+
+//Constructor
+
+NetworkThread::NetworkThread() : inbound(256), outbound(64), stopping(false) {}
+
+//Public member functions
+
+void NetworkThread::start(ClientSocket* socket) {
+    if (this->thread.joinable())
+        throw std::logic_error("Network thread already started");
+    
+    if (socket == nullptr || !socket->getSet())
+        throw std::logic_error("Socket not set");
+    
+#if !defined(_WIN32)
+    if (pipe(this->wakePipe) < 0)
+        throw std::runtime_error(std::string("ERROR creating pipe: ") + std::string(strerror(errno)));
+    
+    //Neither end may block: the render thread must never wait to wake the network thread, and the network thread empties the pipe until it would block
+    for (int a = 0; a < 2; a++) {
+        int flags = fcntl(this->wakePipe[a], F_GETFL, 0);
+        fcntl(this->wakePipe[a], F_SETFL, flags | O_NONBLOCK);
+    }
+#endif
+    
+    this->socket = socket;
+    this->socket->setNonBlocking();
+    
+    this->stopping = false;
+    this->thread = std::thread(&NetworkThread::run, this);
+}
+
+void NetworkThread::stop() {
+    if (!this->thread.joinable())
+        return;
+    
+    this->stopping = true;
+    this->wake();
+    this->thread.join();
+    
+#if !defined(_WIN32)
+    close(this->wakePipe[0]);
+    close(this->wakePipe[1]);
+    this->wakePipe[0] = -1;
+    this->wakePipe[1] = -1;
+#endif
+}
+
+bool NetworkThread::receive(HostMessage& message) {
+    return this->inbound.pop(message);
+}
+
+bool NetworkThread::send(std::string& message) {
+    if (!this->outbound.push(message))
+        return false;
+    
+    this->wake();
+    return true;
+}
+
+//Private member functions
+
+void NetworkThread::run() {
+    HostMessage pending; //A message taken from the socket that did not fit in the inbound queue yet
+    bool hasPending = false;
+    bool connected = true;
+    
+    pollfd waiting[2];
+    waiting[0].fd = this->socket->getFileDescriptor();
+#if defined(_WIN32)
+    int numberWaiting = 1;
+#else
+    int numberWaiting = 2;
+    waiting[1].fd = this->wakePipe[0];
+    waiting[1].events = POLLIN;
+#endif
+    
+    while (connected && !this->stopping) {
+        try {
+            this->sendQueued();
+            this->socket->flush(); //Over UDP, resends what the host has not acknowledged and acknowledges what it sent
+            
+            //Hand over every whole message that has been read, unless the render thread has not made room for them
+            while (hasPending || this->takeMessage(pending)) {
+                hasPending = !this->inbound.push(pending);
+                if (hasPending)
+                    break;
+            }
+            
+            //Only read more once everything read so far has been handed over
+            waiting[0].events = hasPending ? 0 : POLLIN;
+            waiting[0].revents = 0;
+            waiting[1].revents = 0;
+            
+            int timeout = hasPending ? NetworkThread::fullQueueWait : -1;
+            int due = this->socket->timeUntilDue();
+            if (due >= 0 && (timeout < 0 || due < timeout))
+                timeout = due;
+            
+#if defined(_WIN32)
+            if (timeout < 0 || timeout > NetworkThread::wakeInterval)
+                timeout = NetworkThread::wakeInterval;
+            
+            if (WSAPoll(waiting, numberWaiting, timeout) < 0)
+                throw std::runtime_error("ERROR waiting for host: " + std::to_string(WSAGetLastError()));
+#else
+            if (poll(waiting, numberWaiting, timeout) < 0 && errno != EINTR)
+                throw std::runtime_error(std::string("ERROR waiting for host: ") + std::string(strerror(errno)));
+            
+            if (waiting[1].revents & POLLIN) {
+                char wakeBytes[64];
+                while (read(this->wakePipe[0], wakeBytes, sizeof(wakeBytes)) > 0) {}
+            }
+#endif
+            
+            if (waiting[0].revents & (POLLIN | POLLHUP | POLLERR))
+                connected = this->socket->readAvailable();
+        } catch (std::exception& e) { //Reading or sending failed, or the stream is corrupt
+            std::cout << "Lost connection to host: " << e.what() << std::endl;
+            connected = false;
+        }
+    }
+    
+    if (connected) {
+        //Stopped by the render thread, so send whatever it queued last, such as that it is leaving
+        try {
+            this->sendQueued();
+        } catch (std::exception) {}
+        return;
+    }
+    
+    //Messages that arrived before the connection closed are still handed over, followed by the message saying it closed
+    auto takeNextMessage = [this, &pending]() {
+        try {
+            return this->takeMessage(pending);
+        } catch (std::exception) { //The rest of the stream is corrupt
+            return false;
+        }
+    };
+    
+    if (!hasPending)
+        hasPending = takeNextMessage();
+    
+    while (!this->stopping) {
+        if (!hasPending) {
+            pending.message.clear();
+            pending.type = TEXT_MESSAGE;
+            pending.closed = true;
+        }
+        
+        bool closing = pending.closed; //Checked first, since pushing swaps an old message into pending
+        if (this->inbound.push(pending)) {
+            if (closing)
+                return;
+            hasPending = takeNextMessage();
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(NetworkThread::fullQueueWait));
+        }
+    }
+}
+
+bool NetworkThread::takeMessage(HostMessage& message) {
+    if (!this->socket->nextMessage(message.message, message.type))
+        return false;
+    
+    if (message.type == COMPRESSED_MESSAGE) {
+        std::swap(message.message, this->compressed);
+        message.type = Compressor::decompressMessage(this->compressed, message.message);
+    }
+    
+    return true;
+}
+
+void NetworkThread::sendQueued() {
+    std::string message;
+    while (this->outbound.pop(message)) {
+        this->socket->send(message, ACTION_MESSAGE);
+    }
+}
+
+void NetworkThread::wake() {
+#if !defined(_WIN32)
+    char wakeByte = 0;
+    write(this->wakePipe[1], &wakeByte, 1); //If the pipe is full, the network thread is already going to wake
+#endif
+}
+
+//Destructor
+
+NetworkThread::~NetworkThread() {
+    this->stop();
+}
@@ -0,0 +1,134 @@
+//
+//  NetworkThread.hpp
+//  Strategy Game
+//
+
+#ifndef NetworkThread_hpp
+#define NetworkThread_hpp
+
+//Standard library includes
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <exception>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#endif
+
+//Local includes
+#include "ClientSocket.hpp"
+#include "SPSCQueue.hpp"
+#include "Compressor.hpp"
+
+//How the client's networking works:
+//Once the client has the initial board, everything it sends to and receives from the host goes through a NetworkThread, so that the render thread never waits on the network. The network thread sleeps in poll() on the socket and on a pipe. Whenever the host sends something, it reads it, splits it into whole messages, decompresses any that are compressed, and hands them to the render thread through one queue. Whenever the render thread queues commands, it writes a byte to the pipe to wake the network thread, which sends them. Both queues are SPSCQueues, so neither thread ever locks. If the render thread falls so far behind that the inbound queue fills up, the network thread stops reading until there is room, and the host's messages wait in the socket. Over UDP, the network thread also wakes whenever something is due to be resent or acknowledged, see DatagramChannel.hpp. Windows cannot poll a pipe along with a socket, so there the network thread is never woken, and instead polls the socket for no longer than NetworkThread::wakeInterval at a time.
+
+/*!
+ * A message from the host, taken whole from the socket by a NetworkThread.
+ */
+struct HostMessage {
+    std::string message;
+    MessageType type = TEXT_MESSAGE; //Never COMPRESSED_MESSAGE, since those are decompressed first
+    bool closed = false; //True if the connection to the host was lost. This is always the last message
+};
+
+/*!
+ * A thread that does all of the socket I/O of a client with the host, see NetworkThread.hpp.
+ */
+class NetworkThread {
+public:
+    //Constructor
+    NetworkThread();
+    
+    //Destructor
+    ~NetworkThread();
+    
+    //Public member functions
+    
+    /*!
+     * Start the thread. From then on, the socket must only be used through this object, until stop() is called. The socket is made non-blocking. An error is thrown if the thread has already started, or if the socket is not set.
+     *
+     * @param socket The socket connected to the host. It must outlive the thread.
+     */
+    void start(ClientSocket* socket);
+    
+    /*!
+     * Send whatever is still queued, then stop the thread. Nothing happens if it is not running.
+     */
+    void stop();
+    
+    /*!
+     * Take the next message from the host, without waiting. Only call this from the thread that called start().
+     *
+     * @param message Set to the message. Its old contents are handed back to the network thread to reuse.
+     *
+     * @return Whether there was a message.
+     */
+    bool receive(HostMessage& message);
+    
+    /*!
+     * Queue a batch of commands to be sent to the host as an ACTION_MESSAGE, without waiting, see Command.hpp. Only call this from the thread that called start().
+     *
+     * @param message The bytes of the batch. If it is queued, it is left holding an old batch, whose memory may be reused.
+     *
+     * @return Whether the message was queued. False if the queue is full, in which case the message should be sent again later.
+     */
+    bool send(std::string& message);
+    
+private:
+    //Private properties
+    
+    ClientSocket* socket = nullptr;
+    
+    SPSCQueue<HostMessage> inbound; //From the network thread to the render thread
+    SPSCQueue<std::string> outbound; //From the render thread to the network thread
+    
+    std::thread thread;
+    std::atomic<bool> stopping;
+    
+#if defined(_WIN32)
+    //How long queued commands can wait to be sent, in milliseconds, since the network thread cannot be woken
+    constexpr static const int wakeInterval = 5;
+#else
+    int wakePipe[2] = {-1, -1}; //Written to by the render thread to wake the network thread from poll()
+#endif
+    
+    std::string compressed; //The last compressed message, swapped with the buffer it is decompressed into so that both are reused
+    
+    //How long the network thread waits for the render thread to make room in the inbound queue, in milliseconds
+    constexpr static const int fullQueueWait = 1;
+    
+    //Private member functions
+    
+    /*!
+     * The function the network thread runs until it is stopped or the host disconnects.
+     */
+    void run();
+    
+    /*!
+     * Take the next whole message from the socket, decompressing it if it is compressed. A range_error is thrown if it cannot be decompressed.
+     *
+     * @param message Set to the message. Its memory is reused.
+     *
+     * @return Whether there was a whole message.
+     */
+    bool takeMessage(HostMessage& message);
+    
+    /*!
+     * Send every message the render thread has queued. An error is thrown if one cannot be sent.
+     */
+    void sendQueued();
+    
+    /*!
+     * Wake the network thread from poll(). Does nothing on Windows, see NetworkThread.hpp.
+     */
+    void wake();
+};
+
+#endif /* NetworkThread_hpp */
@@ -45,6 +45,8 @@ void Player::resetAllTiles() {
                 this->tileActions[x][y].pop();
         }
     }
+    
+    this->selectionVersion = UINT_MAX;
 }
 
 bool Player::selectTile(unsigned int x, unsigned int y) {
@@ -57,7 +59,7 @@ bool Player::selectTile(unsigned int x, unsigned int y) {
     } else if (x < this->board->width() && y < this->board->height(x)) { //Make sure the passed in tile is on the board
         
         //If there is a creature at that spot, properly select it. Otherwise just set it normally
-        if (this->board->get(x, y).creature() != nullptr)
+        if (this->board->view(x, y).creature() != nullptr)
             this->selectCreature(x, y);
         else
             this->selectedTile = passedInTile;
@@ -76,6 +78,44 @@ bool Player::setStyle(unsigned int x, unsigned int y, unsigned int style) {
     } else return false;
 }
 
+void Player::updateVision() {
+    const Visibility& visibility = this->board->visibility(this->playerNum);
+    
+    if (visibility.version() == this->visionVersion)
+        return;
+    
+    if (this->regionVersions.size() != visibility.regionsWide() * visibility.regionsHigh())
+        this->regionVersions.assign(visibility.regionsWide() * visibility.regionsHigh(), UINT_MAX);
+    
+    //Only the regions that changed are copied, so a creature moving copies a few regions instead of the whole board
+    for (unsigned int regionX = 0; regionX < visibility.regionsWide(); regionX++) {
+        for (unsigned int regionY = 0; regionY < visibility.regionsHigh(); regionY++) {
+            unsigned int& regionVersion = this->regionVersions[regionX * visibility.regionsHigh() + regionY];
+            
+            if (visibility.regionVersion(regionX, regionY) == regionVersion)
+                continue;
+            
+            unsigned int maxX = std::min((regionX + 1) * Visibility::regionSize, this->board->width());
+            unsigned int maxY = std::min((regionY + 1) * Visibility::regionSize, this->board->height(0));
+            
+            for (unsigned int x = regionX * Visibility::regionSize; x < maxX; x++) {
+                for (unsigned int y = regionY * Visibility::regionSize; y < maxY; y++) {
+                    if (visibility.visible().test(x, y))
+                        this->boardInfo[x][y][TILE_VISION] = VISIBLE;
+                    else if (visibility.explored().test(x, y))
+                        this->boardInfo[x][y][TILE_VISION] = EXPLORED;
+                    else
+                        this->boardInfo[x][y][TILE_VISION] = UNEXPLORED;
+                }
+            }
+            
+            regionVersion = visibility.regionVersion(regionX, regionY);
+        }
+    }
+    
+    this->visionVersion = visibility.version();
+}
+
 //Public get functions
 
 glm::ivec2 Player::tileSelected() {
@@ -104,173 +144,31 @@ glm::vec3 Player::tileColor(unsigned int x, unsigned int y) {
     return WHITE;
 }
 
-std::vector<GLuint> Player::getPath(GLuint x, GLuint y, GLuint destinationX, GLuint destinationY) {
-    if (x >= this->board->width()) {
-        std::vector<GLuint> emptyVector;
-        return emptyVector;
-    } else if (y >= this->board->height(x)) {
-        std::vector<GLuint> emptyVector;
-        return emptyVector;
-    } else if (destinationX >= this->board->width()) {
-        std::vector<GLuint> emptyVector;
-        return emptyVector;
-    } else if (destinationY >= this->board->height(destinationX)) {
-        std::vector<GLuint> emptyVector;
-        return emptyVector;
-    } else if (this->board->get(x, y).creature() == nullptr) {
-        std::vector<GLuint> emptyVector;
-        return emptyVector;
-    } else if (!this->board->get(destinationX, destinationY).passableByCreature(*this->board->get(x, y).creature())) {
-        std::vector<GLuint> emptyVector;
-        return emptyVector;
-    }
-    
-    Creature creature = *this->board->get(x, y).creature();
-    
-    std::queue<std::vector<std::pair<GLuint, GLuint> > > possiblePaths;
-    
-    std::vector<std::pair<GLuint, GLuint> > firstTile { std::pair<GLuint, GLuint>(x, y) };
-    
-    possiblePaths.push(firstTile);
-    
-    std::vector<std::pair<GLuint, GLuint> > foundPath;
-    
-    while (possiblePaths.size() > 0) {
-        
-        std::vector<std::pair<GLuint, GLuint> > path = possiblePaths.front();
-        
-        if (path.back().first == destinationX && path.back().second == destinationY) {
-            foundPath = path;
-            break;
-        }
-        
-        if (possiblePaths.front().size() <= creature.energy()) { //If a creature at this spot would be able to continue to move further, expand in the four directions from that tile.
-            
-            std::pair<GLuint, GLuint> tile = path.back();
-            
-            //North
-            if (tile.second > 0) {
-                if (this->board->get(tile.first, tile.second - 1).passableByCreature(creature)) {
-                    std::vector<std::pair<GLuint, GLuint> > nextPath = path;
-                    nextPath.push_back(std::pair<GLuint, GLuint>(tile.first, tile.second - 1));
-                    possiblePaths.push(nextPath);
-                }
-            }
-            
-            //East
-            if (tile.first > 0) {
-                if (this->board->get(tile.first - 1, tile.second).passableByCreature(creature)) {
-                    std::vector<std::pair<GLuint, GLuint> > nextPath = path;
-                    nextPath.push_back(std::pair<GLuint, GLuint>(tile.first - 1, tile.second));
-                    possiblePaths.push(nextPath);
-                }
-            }
-            
-            //South
-            if (tile.second < this->board->height(tile.first) - 1) {
-                if (this->board->get(tile.first, tile.second + 1).passableByCreature(creature)) {
-                    std::vector<std::pair<GLuint, GLuint> > nextPath = path;
-                    nextPath.push_back(std::pair<GLuint, GLuint>(tile.first, tile.second + 1));
-                    possiblePaths.push(nextPath);
-                }
-            }
-            
-            //West
-            if (tile.first < this->board->width() - 1) {
-                if (this->board->get(tile.first + 1, tile.second).passableByCreature(creature)) {
-                    std::vector<std::pair<GLuint, GLuint> > nextPath = path;
-                    nextPath.push_back(std::pair<GLuint, GLuint>(tile.first + 1, tile.second));
-                    possiblePaths.push(nextPath);
-                }
-            }
-        }
-        
-        possiblePaths.pop();
-    }
-    
-    std::vector<GLuint> directions;
-    
-    for (GLuint a = 0; a < foundPath.size(); a++) {
-        if (foundPath[a].first == x && foundPath[a].second == y) {
-            continue; //First spot is the original location
-        }
-        
-        std::pair<GLuint, GLuint> previousTile = a == 0 ? std::pair<GLuint, GLuint>(x, y) : foundPath[a - 1];
-        
-        if (foundPath[a].second < previousTile.second && foundPath[a].first == previousTile.first) {
-            directions.push_back(NORTH);
-        } else if (foundPath[a].first < previousTile.first && foundPath[a].second == previousTile.second) {
-            directions.push_back(EAST);
-        } else if (foundPath[a].second > previousTile.second && foundPath[a].first == previousTile.first) {
-            directions.push_back(SOUTH);
-        } else if (foundPath[a].first > previousTile.first && foundPath[a].second == previousTile.second) {
-            directions.push_back(WEST);
-        }
-    }
+int Player::tileVision(unsigned int x, unsigned int y) {
+    if (x >= this->board->width())
+        throw std::range_error("X out of range");
+    if (y >= this->board->height(x))
+        throw std::range_error("Y out of range");
     
-    return directions;
+    return this->boardInfo[x][y][TILE_VISION];
+}
+
+std::vector<unsigned int> Player::getPath(unsigned int x, unsigned int y, unsigned int destinationX, unsigned int destinationY) {
+    return this->board->getPath(x, y, destinationX, destinationY);
 }
 
 void Player::updateCreatures(float deltaTime) {
-    for (int x = 0; x < this->board->width(); x++) {
-        for (int y = 0; y < this->board->height(x); y++) {
-            
-            Creature* creature = this->board->get(x, y).creature();
-            
-            if (creature != nullptr) {
-                
-                glm::ivec2 creatureLoc = glm::ivec2(x, y);
-                
-                unsigned int direction = creature->direction();
-                
-                if (direction == NORTH || direction == EAST) {
-                    //These two directions cause the creature to move up, visually, so they stay at the current tile until they reach the above one. If they moved tiles first, then the previous tile, which is lower, would be drawn on top
-                    
-                    //If the creature is in the process of moving currently, continue to move it
-                    if (creature->incrementOffset(deltaTime)) {
-                        if (direction == NORTH) {
-                            if (this->board->moveCreatureByDirection(creatureLoc.x, creatureLoc.y, direction)) {
-                                creatureLoc.y -= 1;
-                                
-#ifndef RESET_SELECTED_TILE_AFTER_MOVEMENT
-                                if (creature->controller() == this->playerNum)
-                                    this->selectCreature(x, y - 1);
-#endif
-                            }
-                        } else if (direction == EAST) {
-                            if (this->board->moveCreatureByDirection(creatureLoc.x, creatureLoc.y, direction)) {
-                                creatureLoc.x -= 1;
-                                
-#ifndef RESET_SELECTED_TILE_AFTER_MOVEMENT
-                                if (creature->controller() == this->playerNum)
-                                    this->selectCreature(x - 1, y);
-#endif
-                            }
-                        }
-                        
-                    }
-                } else if (direction == SOUTH || direction == WEST) {
-                    
-                    if (creature->incrementOffset(deltaTime)) {
-                        
+    //Only this player's creatures that are moving or have somewhere to go need updating
+    const std::vector<SlotMap<Creature>::Handle>& animating = this->board->animatingCreatures(this->playerNum);
+    
+    //Backwards, since a creature that stops is replaced by the last one
+    for (int a = (int)animating.size() - 1; a >= 0; a--) {
+        glm::ivec2 arrival;
+        
+        if (this->board->updateCreature(animating[a], deltaTime, &arrival)) {
 #ifndef RESET_SELECTED_TILE_AFTER_MOVEMENT
-                        if (creature->controller() == this->playerNum)
-                            this->selectCreature(x, y);
+            this->selectCreature(arrival.x, arrival.y);
 #endif
-                    }
-                }
-                
-                if (creature->directions.size() > 0 && creature->offset() == 0.0) {
-                    
-                    //Get the new direction that the creature will be travelling in.
-                    unsigned int newDirection = creature->directions.front();
-                    
-                    //Now that this direction is being dealt with, we can get rid of it from the directions left for the creature to go in.
-                    creature->directions.pop();
-                    
-                    this->moveAdjacent(creatureLoc.x, creatureLoc.y, newDirection, deltaTime);
-                }
-            }
         }
     }
 }
@@ -375,23 +273,19 @@ void Player::resolveTileAction(unsigned int x, unsigned int y) {
     this->tileActions[x][y].pop();
     
     if (action == "move_creature") {
-        if (this->board->get(this->selectedTile.x, this->selectedTile.y).creature() != nullptr) { //Move selected creature to the tile
-            std::vector<unsigned int> directions = this->getPath(this->selectedTile.x, this->selectedTile.y, x, y);
+        if (this->board->view(this->selectedTile.x, this->selectedTile.y).creature() != nullptr) { //Move selected creature to the tile
+            std::vector<unsigned int> directions = this->board->getPath(this->selectedTile.x, this->selectedTile.y, x, y);
             
-            for (int a = 0; a < directions.size(); a++) {
-                this->board->get(this->selectedTile.x, this->selectedTile.y).creature()->directions.push(directions[a]);
-                if (a == 0)
-                    this->board->setDirection(this->selectedTile.x, this->selectedTile.y, directions[a]);
-            }
+            this->board->queueDirections(this->selectedTile.x, this->selectedTile.y, directions);
             
             this->resetAllTiles();
             this->selectedTile = NO_SELECTION;
         }
     } else if (action == "make_creature") {
-        if (this->board->get(this->selectedTile.x, this->selectedTile.y).building() != nullptr) { //Create a creature from building
+        if (this->board->view(this->selectedTile.x, this->selectedTile.y).building() != nullptr) { //Create a creature from building
             Creature newCreature(x, y, Human, 100, 4, 30, Melee, 1, 1, NORTH, this->playerNum);
             
-            if (this->board->get(x, y).passableByCreature(newCreature)) {
+            if (this->board->view(x, y).passableByCreature(newCreature)) {
                 this->board->setCreature(newCreature);
             }
             
@@ -401,75 +295,6 @@ void Player::resolveTileAction(unsigned int x, unsigned int y) {
     }
 }
 
-bool Player::moveAdjacent(unsigned int x, unsigned int y, int direction, float deltaTime) {
-    //Return false if there is no creature at the designated spot to move
-    if (this->board->get(x, y).creature() == nullptr)
-        return false;
-    
-    //Check if move goes beyond map
-    int newX, newY;
-    
-    if (direction == NORTH) {
-        newX = x;
-        newY = y - 1;
-        
-        if (newY < 0)
-            return false;
-    } else if (direction == WEST) {
-        newX = x + 1;
-        newY = y;
-        
-        if (newX >= this->board->width())
-            return false;
-    } else if (direction == SOUTH) {
-        newX = x;
-        newY = y + 1;
-        
-        if (newY >= this->board->height(x))
-            return false;
-    } else if (direction == EAST) {
-        newX = x - 1;
-        newY = y;
-        
-        if (newX < 0)
-            return false;
-    }
-    
-    //Passable Check
-    if (!this->board->get(newX, newY).passableByCreature(*this->board->get(x, y).creature())) {
-        return false;
-    }
-    
-    //Set the direction that was found at the selected creature
-    this->board->setDirection(x, y, direction);
-    
-    //If the tile is going to be moving up (visually on the screen) slowly move the tile from the previous location to the new one
-    //For these directions, the creature is moved after, in the function that updates the offset data
-    if (direction == NORTH || direction == EAST)
-        this->board->get(x, y).creature()->initiateMovementOffset(deltaTime);
-    
-    //If it's going down, instead move it to the next square and slowly move it from that spot. This keeps it from being drawn under the tile it's going to
-    //For these directions, the creature is moved here, and then the offset is slowly updated to follow
-    if (direction == SOUTH || direction == WEST) {
-        unsigned int tile; //The location in the data array
-        
-        if (direction == SOUTH) {
-            tile = (x * this->board->width()) + (y + 1); //One row below
-        } else if (direction == WEST) {
-            tile = ((x + 1) * this->board->width()) + y; //One tile further
-        }
-        
-        if (tile < NUMBER_OF_TILES) {
-            this->board->get(x, y).creature()->initiateMovementOffset(deltaTime);
-            
-            this->board->moveCreatureByDirection(x, y, direction);
-        } else {
-            return false;
-        }
-    }
-    return true;
-}
-
 bool Player::selectCreature(unsigned int x, unsigned int y) {
     if (x >= this->board->width()) //No selecting happens if the x is out of range
         return false;
@@ -477,41 +302,46 @@ bool Player::selectCreature(unsigned int x, unsigned int y) {
     if (y >= this->board->height(x)) //No selecting happens if the y is out of range
         return false;
     
-    if (this->board->get(x, y).creature() == nullptr) //No selecting happens if there is no creature at the selected location
+    if (this->board->view(x, y).creature() == nullptr) //No selecting happens if there is no creature at the selected location
         return false;
     
-    Creature* creature = this->board->get(x, y).creature();
+    Creature* creature = this->board->view(x, y).creature();
     
     if (creature->directions.size() == 0) {
+        //One traversal finds both the reachable and attackable tiles. The board reuses the last one if nothing near the creature has changed
+        TacticalMap tacticalMap = this->board->getTacticalMap(x, y);
+        
+        //If this creature is already selected from the same map, the tiles are already styled
+        if (this->selectedTile == glm::ivec2(x, y) && this->selectionVersion == tacticalMap.version)
+            return true;
+        
         this->selectedTile = glm::vec2(x, y); //Set the selected tile to this location
+        this->selectionVersion = tacticalMap.version;
         
         this->boardInfo[x][y][TILE_STYLE] = SELECTED;
         
-        std::vector<Tile> reachableTiles = this->board->getReachableTiles(this->board->get(x, y));
+        std::vector<glm::ivec2> reachableTiles = tacticalMap.reachable.tiles();
         
-        Creature creature = *this->board->get(x, y).creature();
         for (int a = 0; a < reachableTiles.size(); a++) {
-            if (this->board->get(reachableTiles[a].x(), reachableTiles[a].y()).passableByCreature(creature)) {
-                this->boardInfo[reachableTiles[a].x()][reachableTiles[a].y()][TILE_STYLE] = REACHABLE;
-                this->tileActions[reachableTiles[a].x()][reachableTiles[a].y()].push("move_creature");
+            if (this->board->viewUnchecked(reachableTiles[a].x, reachableTiles[a].y).passableByCreature(*creature)) {
+                this->boardInfo[reachableTiles[a].x][reachableTiles[a].y][TILE_STYLE] = REACHABLE;
+                this->tileActions[reachableTiles[a].x][reachableTiles[a].y].push("move_creature");
             }
         }
         
-        std::vector<Tile> attackableTiles = this->board->getAttackableTiles(this->board->get(x, y));
+        //The attackable set is empty if the creature has no energy
+        std::vector<glm::ivec2> attackableTiles = tacticalMap.attackable.tiles();
         
         for (int a = 0; a < attackableTiles.size(); a++) {
+            TileView tile = this->board->viewUnchecked(attackableTiles[a].x, attackableTiles[a].y);
             
             //If there is a creature on the tile, controlled by an opponent, make it attackable
-            if (this->board->get(attackableTiles[a].x(), attackableTiles[a].y()).creature() != nullptr && this->board->get(attackableTiles[a].x(), attackableTiles[a].y()).creature()->controller() != this->playerNum)
-                
-                if (creature.energy() > 0)
-                    this->boardInfo[attackableTiles[a].x()][attackableTiles[a].y()][TILE_STYLE] = ATTACKABLE;
+            if (tile.creature() != nullptr && tile.creature()->controller() != this->playerNum)
+                this->boardInfo[attackableTiles[a].x][attackableTiles[a].y][TILE_STYLE] = ATTACKABLE;
             
             //If there is a building on the tile, controlled by an opponent, make it attackable
-            if (this->board->get(attackableTiles[a].x(), attackableTiles[a].y()).building() != nullptr && this->board->get(attackableTiles[a].x(), attackableTiles[a].y()).building()->controller() != this->playerNum)
-                
-                if (creature.energy() > 0)
-                    this->boardInfo[attackableTiles[a].x()][attackableTiles[a].y()][TILE_STYLE] = ATTACKABLE;
+            if (tile.building() != nullptr && tile.building()->controller() != this->playerNum)
+                this->boardInfo[attackableTiles[a].x][attackableTiles[a].y][TILE_STYLE] = ATTACKABLE;
         }
     }
     
@@ -16,9 +16,6 @@
 #include <queue>
 #include <string>
 
-//GLFW: Window functionality
-#include <GLFW/glfw3.h>
-
 //GLM: OpenGL mathematics for rotations, translations, dilations
 #include <GLM/glm.hpp>
 #include <GLM/gtc/matrix_transform.hpp>
@@ -110,6 +107,11 @@ public:
      */
     void updateCreatures(float deltaTime);
     
+    /*!
+     * A function that copies the fog of war of this player from the board into the TILE_VISION of each tile. Only the regions that changed since the last call are copied, see Visibility::regionVersion(), so this can be called once every frame.
+     */
+    void updateVision();
+    
     /*!
      * A function to update the selected tile based on mouse clicks.
      *
@@ -131,7 +133,15 @@ public:
      */
     glm::vec3 tileColor(unsigned int x, unsigned int y);
     
-    std::vector<GLuint> getPath(GLuint x, GLuint y, GLuint destinationX, GLuint destinationY);
+    /*!
+     * @return Whether the tile at the specified location is UNEXPLORED, EXPLORED or VISIBLE to this player, as of the last call to updateVision().
+     */
+    int tileVision(unsigned int x, unsigned int y);
+    
+    /*!
+     * @return The directions for the creature at (x, y) to take to get to the destination. See Board::getPath().
+     */
+    std::vector<unsigned int> getPath(unsigned int x, unsigned int y, unsigned int destinationX, unsigned int destinationY);
     
 private:
     
@@ -147,8 +157,13 @@ private:
     /*
      * [0]: Tile style (whether it is selected, attackable, reachable, etc...)
      * [1]: Whether the mouse is hovering, either as TRUE or FALSE
+     * [2]: Whether the tile is unexplored, explored or visible
      */
     
+    unsigned int visionVersion = UINT_MAX; //The Visibility::version() that TILE_VISION was last updated from
+    std::vector<unsigned int> regionVersions; //The Visibility::regionVersion() of each region that TILE_VISION was last updated from, indexed like the regions
+    unsigned int selectionVersion = UINT_MAX; //The TacticalMap::version of the selected creature that the tile styles were last set from
+    
     std::vector<std::vector<std::queue<std::string> > > tileActions; //For each tile, contains a queue of action strings, the first to be done when the tile is clicked if it is reachable
     
     //Private member functions
@@ -161,8 +176,6 @@ private:
      */
     void resolveTileAction(unsigned int x, unsigned int y);
     
-    bool moveAdjacent(unsigned int x, unsigned int y, int direction, float deltaTime);
-    
     /*!
      * A function to select a creature and and make nearby tiles properly stylized (reachable ones and attackable, for instance). If an error occurs (see below) no error is thrown, instead false is returned and nothing happens.
      *
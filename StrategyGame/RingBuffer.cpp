@@ -0,0 +1,121 @@
+//
+//  RingBuffer.cpp
+//  Strategy Game
+//
+
+#include "RingBuffer.hpp"
+
+//Constructor
+
+RingBuffer::RingBuffer(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity)
+        size <<= 1;
+    
+    this->bytes.resize(size);
+}
+
+//Public member functions
+
+void RingBuffer::reserve(size_t capacity) {
+    if (capacity <= this->bytes.size())
+        return;
+    
+    size_t size = this->bytes.size();
+    while (size < capacity)
+        size <<= 1;
+    
+    //Copy the bytes into the new allocation in order, so that they start at the front again
+    std::vector<char> grown(size);
+    this->peek(grown.data(), this->length);
+    
+    this->bytes.swap(grown);
+    this->start = 0;
+}
+
+void RingBuffer::write(const char* data, size_t length) {
+    this->reserve(this->length + length);
+    
+    //The bytes may wrap around the end of the allocation, so they are copied in up to two parts
+    size_t back = this->position(this->length);
+    size_t firstPart = std::min(length, this->bytes.size() - back);
+    memcpy(&this->bytes[back], data, firstPart);
+    memcpy(&this->bytes[0], data + firstPart, length - firstPart);
+    
+    this->length += length;
+}
+
+long RingBuffer::readFrom(int socket) {
+    if (this->length == this->bytes.size())
+        this->reserve(this->bytes.size() * 2);
+    
+    //The free space is one or two runs of bytes, depending on whether it wraps around the end of the allocation
+    size_t back = this->position(this->length);
+    size_t freeSpace = this->bytes.size() - this->length;
+    size_t firstPart = std::min(freeSpace, this->bytes.size() - back);
+    
+    iovec parts[2];
+    parts[0].iov_base = &this->bytes[back];
+    parts[0].iov_len = firstPart;
+    parts[1].iov_base = &this->bytes[0];
+    parts[1].iov_len = freeSpace - firstPart;
+    
+    long bytesRead = readv(socket, parts, parts[1].iov_len > 0 ? 2 : 1);
+    if (bytesRead > 0)
+        this->length += bytesRead;
+    
+    return bytesRead;
+}
+
+long RingBuffer::writeTo(int socket) {
+    if (this->length == 0)
+        return 0;
+    
+    //The bytes are one or two runs, depending on whether they wrap around the end of the allocation
+    size_t firstPart = std::min(this->length, this->bytes.size() - this->start);
+    
+    iovec parts[2];
+    parts[0].iov_base = &this->bytes[this->start];
+    parts[0].iov_len = firstPart;
+    parts[1].iov_base = &this->bytes[0];
+    parts[1].iov_len = this->length - firstPart;
+    
+    long bytesWritten = writev(socket, parts, parts[1].iov_len > 0 ? 2 : 1);
+    if (bytesWritten > 0)
+        this->consume(bytesWritten);
+    
+    return bytesWritten;
+}
+
+void RingBuffer::peek(char* destination, size_t length, size_t offset) const {
+    if (offset + length > this->length)
+        throw std::range_error("Not enough bytes in ring buffer");
+    
+    size_t front = this->position(offset);
+    size_t firstPart = std::min(length, this->bytes.size() - front);
+    memcpy(destination, &this->bytes[front], firstPart);
+    memcpy(destination + firstPart, &this->bytes[0], length - firstPart);
+}
+
+void RingBuffer::consume(size_t length) {
+    if (length > this->length)
+        throw std::range_error("Not enough bytes in ring buffer");
+    
+    this->start = this->position(length);
+    this->length -= length;
+}
+
+void RingBuffer::clear() {
+    this->start = 0;
+    this->length = 0;
+}
+
+//Public get functions
+
+size_t RingBuffer::size() const {
+    return this->length;
+}
+
+size_t RingBuffer::capacity() const {
+    return this->bytes.size();
+}
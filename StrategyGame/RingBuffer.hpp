@@ -0,0 +1,114 @@
+//
+//  RingBuffer.hpp
+//  Strategy Game
+//
+
+#ifndef RingBuffer_hpp
+#define RingBuffer_hpp
+
+#include <vector>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+
+#include <string.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/*!
+ * A queue of bytes stored in one circular allocation. Bytes are added at the back and taken from the front without moving the rest, and the allocation is kept and reused, only growing when more bytes are held at once than fit. Used to collect bytes from a socket until a whole message has arrived, and to hold bytes that a socket could not send yet.
+ */
+class RingBuffer {
+public:
+    //Constructor
+    
+    /*!
+     * @param capacity The number of bytes to allocate up front. Rounded up to a power of 2.
+     */
+    RingBuffer(size_t capacity = 4096);
+    
+    //Public member functions
+    
+    /*!
+     * Make sure that at least the given number of bytes can be held without growing again.
+     *
+     * @param capacity The number of bytes.
+     */
+    void reserve(size_t capacity);
+    
+    /*!
+     * Add bytes to the back of the buffer, growing it if needed.
+     *
+     * @param data The bytes to add.
+     * @param length The number of bytes.
+     */
+    void write(const char* data, size_t length);
+    
+    /*!
+     * Read bytes directly from a socket into the free space at the back of the buffer, with a single call to readv(). The buffer is grown first if it is full. Like read(), this blocks until something can be read.
+     *
+     * @param socket The file descriptor to read from.
+     *
+     * @return The return value of readv(): the number of bytes read, 0 if the connection closed, or -1 if there was an error.
+     */
+    long readFrom(int socket);
+    
+    /*!
+     * Write bytes from the front of the buffer directly to a socket, with a single call to writev(), and remove whatever was written.
+     *
+     * @param socket The file descriptor to write to.
+     *
+     * @return The return value of writev(): the number of bytes written, or -1 if there was an error.
+     */
+    long writeTo(int socket);
+    
+    /*!
+     * Copy bytes from the front of the buffer without removing them. A range_error is thrown if there are not enough bytes.
+     *
+     * @param destination Where to copy the bytes.
+     * @param length The number of bytes to copy.
+     * @param offset How many bytes from the front to start copying. Autoinitialized as 0.
+     */
+    void peek(char* destination, size_t length, size_t offset = 0) const;
+    
+    /*!
+     * Remove bytes from the front of the buffer. A range_error is thrown if there are not enough bytes.
+     *
+     * @param length The number of bytes to remove.
+     */
+    void consume(size_t length);
+    
+    /*!
+     * Remove every byte, keeping the allocation.
+     */
+    void clear();
+    
+    //Public get functions
+    
+    /*!
+     * @return The number of bytes in the buffer.
+     */
+    size_t size() const;
+    
+    /*!
+     * @return The number of bytes the buffer can hold before growing.
+     */
+    size_t capacity() const;
+    
+private:
+    //Private properties
+    
+    std::vector<char> bytes; //The size is always a power of 2, so positions wrap around with a mask
+    size_t start = 0; //Position of the front byte
+    size_t length = 0;
+    
+    //Private member functions
+    
+    /*!
+     * @return The position in bytes of the byte the given distance from the front.
+     */
+    inline size_t position(size_t distance) const { return (this->start + distance) & (this->bytes.size() - 1); }
+};
+
+#endif /* RingBuffer_hpp */
@@ -0,0 +1,113 @@
+//
+//  SPSCQueue.hpp
+//  Strategy Game
+//
+
+#ifndef SPSCQueue_hpp
+#define SPSCQueue_hpp
+
+#include <vector>
+#include <atomic>
+#include <utility>
+
+#include <stddef.h>
+
+//How the queue works without locks:
+//The values are kept in a circular array whose size is a power of 2. Only the producer moves the back and only the consumer moves the front, each with a release store after touching its slot, and each reads the other's position with an acquire load, so a slot is never read before it is written or written before it is read. Each thread also keeps its own copy of the other's position and only reloads it when the queue looks full or empty, and the positions are kept on separate cache lines, so the two threads rarely touch the same memory.
+//Values are swapped in and out of the slots rather than moved, so a std::string handed to push() comes back holding the memory of an old value, and the queue's memory is reused instead of being freed and allocated for every value.
+
+/*!
+ * A fixed size queue for passing values from exactly one producer thread to exactly one consumer thread without locking. Neither push() nor pop() ever waits.
+ */
+template <typename T>
+class SPSCQueue {
+public:
+    //Constructor
+    
+    /*!
+     * @param capacity The largest number of values that can be held at once. Rounded up to a power of 2.
+     */
+    SPSCQueue(size_t capacity = 64) : slots(SPSCQueue::roundUp(capacity)), mask(SPSCQueue::roundUp(capacity) - 1), front(0), back(0) {}
+    
+    //Public member functions
+    
+    /*!
+     * Add a value to the back of the queue. Only call this from the producer thread.
+     *
+     * @param value The value to add. It is swapped into the queue, so it is left holding an old value, whose memory may be reused.
+     *
+     * @return Whether the value was added. False if the queue is full, in which case value is unchanged.
+     */
+    bool push(T& value) {
+        size_t back = this->back.load(std::memory_order_relaxed);
+        
+        if (back - this->producerFront == this->slots.size()) {
+            this->producerFront = this->front.load(std::memory_order_acquire);
+            if (back - this->producerFront == this->slots.size())
+                return false;
+        }
+        
+        std::swap(this->slots[back & this->mask], value);
+        this->back.store(back + 1, std::memory_order_release);
+        return true;
+    }
+    
+    /*!
+     * Take the value at the front of the queue. Only call this from the consumer thread.
+     *
+     * @param value Set to the value taken. Its old contents are swapped into the queue, so its memory may be reused.
+     *
+     * @return Whether a value was taken. False if the queue is empty, in which case value is unchanged.
+     */
+    bool pop(T& value) {
+        size_t front = this->front.load(std::memory_order_relaxed);
+        
+        if (front == this->consumerBack) {
+            this->consumerBack = this->back.load(std::memory_order_acquire);
+            if (front == this->consumerBack)
+                return false;
+        }
+        
+        std::swap(this->slots[front & this->mask], value);
+        this->front.store(front + 1, std::memory_order_release);
+        return true;
+    }
+    
+    //Public get functions
+    
+    /*!
+     * @return Whether the queue is empty. Only exact when called from the consumer thread, since the producer may add a value at any time.
+     */
+    bool empty() const {
+        return this->front.load(std::memory_order_acquire) == this->back.load(std::memory_order_acquire);
+    }
+    
+private:
+    //Private properties
+    
+    std::vector<T> slots;
+    const size_t mask;
+    
+    alignas(64) std::atomic<size_t> front; //Only written by the consumer
+    size_t consumerBack = 0; //The consumer's copy of back
+    
+    alignas(64) std::atomic<size_t> back; //Only written by the producer
+    size_t producerFront = 0; //The producer's copy of front
+    
+    //Private member functions
+    
+    /*!
+     * @param capacity A number of values, at least 1.
+     *
+     * @return The smallest power of 2 at least as large.
+     */
+    static size_t roundUp(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size *= 2;
+        }
+        return size;
+    }
+};
+
+#endif /* SPSCQueue_hpp */
@@ -0,0 +1,259 @@
+//
+//  Server.cpp
+//  Strategy Game
+//
+
+#include "Server.hpp"
+
+//Constructor
+
+Server::Server(unsigned int playersPerMatch, unsigned int numberOfWorkers) : stopping(false), playersPerMatch(playersPerMatch) {
+    if (playersPerMatch == 0)
+        throw std::invalid_argument("Matches must have at least 1 player");
+    if (playersPerMatch > Host::maximumStandardPlayers)
+        throw std::invalid_argument("Matches can have at most " + std::to_string(Host::maximumStandardPlayers) + " players");
+    
+    for (unsigned int a = 0; a < std::max(numberOfWorkers, 1u); a++) {
+        this->workers.push_back(std::unique_ptr<Worker>(new Worker()));
+    }
+    
+    //Start the threads once every worker exists, so that none of them are moved while running
+    for (int a = 0; a < this->workers.size(); a++) {
+        this->workers[a]->thread = std::thread(&Server::runWorker, this, this->workers[a].get());
+    }
+}
+
+//Public member functions
+
+void Server::run(int portNum, const std::atomic<bool>* done, Transport transport) {
+    this->lobby.setSocket(portNum, transport);
+    this->lobby.setAccepting(true);
+    this->spectatorLobby.setSocket(portNum + SPECTATOR_PORT_OFFSET, transport);
+    this->spectatorLobby.setAccepting(true);
+    std::cout << "Host name: " << ServerSocket::getHostName() << std::endl;
+    
+    ServerSocketHandlers handlers;
+    handlers.connected = [this](unsigned int clientIndex) {
+        this->waitingClients.push_back(clientIndex);
+        
+        if (this->waitingClients.size() >= this->playersPerMatch)
+            this->startMatch();
+    };
+    handlers.disconnected = [this](unsigned int clientIndex) {
+        this->waitingClients.erase(std::remove(this->waitingClients.begin(), this->waitingClients.end(), clientIndex), this->waitingClients.end());
+    };
+    
+    ServerSocketHandlers spectatorHandlers;
+    spectatorHandlers.connected = [this](unsigned int clientIndex) {
+        this->waitingSpectators.push_back(clientIndex);
+    };
+    spectatorHandlers.disconnected = [this](unsigned int clientIndex) {
+        this->waitingSpectators.erase(std::remove(this->waitingSpectators.begin(), this->waitingSpectators.end(), clientIndex), this->waitingSpectators.end());
+    };
+    
+    while (done == nullptr || !*done) {
+        this->lobby.processEvents(100, handlers);
+        this->spectatorLobby.processEvents(0, spectatorHandlers);
+        this->joinStarters(false);
+        this->routeSpectators();
+    }
+    
+    //Let the matches that are beginning be handed to their workers first, so that their clients are told the host is closing as well
+    this->joinStarters(true);
+    
+    //Stop the workers, which tell their matches that the host is closing
+    this->stopping = true;
+    for (int a = 0; a < this->workers.size(); a++) {
+        std::lock_guard<std::mutex> lock(this->workers[a]->mutex);
+        this->workers[a]->wake.notify_one();
+    }
+    for (int a = 0; a < this->workers.size(); a++) {
+        if (this->workers[a]->thread.joinable())
+            this->workers[a]->thread.join();
+    }
+}
+
+void Server::setRates(float ticksPerSecond, float sendsPerSecond) {
+    if (ticksPerSecond <= 0 || sendsPerSecond <= 0)
+        throw std::invalid_argument("Rates must be positive");
+    
+    this->ticksPerSecond = ticksPerSecond;
+    this->sendsPerSecond = sendsPerSecond;
+}
+
+void Server::setTerrainRules(const TerrainRules& rules) {
+    this->rules = rules;
+}
+
+//Public get functions
+
+unsigned int Server::numberOfMatches() {
+    unsigned int matches = 0;
+    for (int a = 0; a < this->workers.size(); a++) {
+        matches += this->workers[a]->load;
+    }
+    return matches;
+}
+
+//Private member functions
+
+void Server::startMatch() {
+    Board board = Host::standardBoard(this->playersPerMatch);
+    board.setTerrainRules(this->rules);
+    
+    std::unique_ptr<Match> match(new Match(board));
+    match->host.set();
+    match->host.setTickRate(this->ticksPerSecond);
+    match->host.setSendRate(this->sendsPerSecond);
+    
+    //The clients keep their connections, and only move from the lobby to the match
+    for (int a = 0; a < this->playersPerMatch; a++) {
+        match->host.addPlayer(this->lobby.releaseClient(this->waitingClients[a]));
+    }
+    this->waitingClients.erase(this->waitingClients.begin(), this->waitingClients.begin() + this->playersPerMatch);
+    
+    //Beginning waits on the clients, so it is done on its own thread instead of blocking the lobby or a worker's other matches
+    std::unique_ptr<Starter> starter(new Starter());
+    starter->thread = std::thread(&Server::beginMatch, this, std::move(match), starter.get());
+    this->starters.push_back(std::move(starter));
+}
+
+void Server::beginMatch(std::unique_ptr<Match> match, Starter* starter) {
+    try {
+        match->host.begin();
+        
+        Worker* leastBusy = this->workers[0].get();
+        for (int a = 1; a < this->workers.size(); a++) {
+            if (this->workers[a]->load < leastBusy->load)
+                leastBusy = this->workers[a].get();
+        }
+        
+        leastBusy->load++;
+        std::lock_guard<std::mutex> lock(leastBusy->mutex);
+        leastBusy->newMatches.push_back(std::move(match));
+        leastBusy->wake.notify_one();
+    } catch (std::exception& e) { //A client left or did not answer before the match began
+        std::cout << "Match failed to begin: " << e.what() << std::endl;
+    }
+    
+    starter->finished = true;
+}
+
+void Server::routeSpectators() {
+    if (this->waitingSpectators.empty())
+        return;
+    
+    //Only workers that are running matches can take spectators. The workers are taken in turn, so that one does not get them all
+    for (int a = 0; a < this->workers.size(); a++) {
+        Worker* worker = this->workers[(this->nextSpectatorWorker + a) % this->workers.size()].get();
+        if (worker->load == 0)
+            continue;
+        
+        this->nextSpectatorWorker = (unsigned int)((this->nextSpectatorWorker + a + 1) % this->workers.size());
+        
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        for (int b = 0; b < this->waitingSpectators.size(); b++) {
+            worker->newSpectators.push_back(this->spectatorLobby.releaseClient(this->waitingSpectators[b]));
+        }
+        this->waitingSpectators.clear();
+        worker->wake.notify_one();
+        return;
+    }
+}
+
+void Server::joinStarters(bool all) {
+    for (auto starter = this->starters.begin(); starter != this->starters.end();) {
+        if (all || (*starter)->finished) {
+            if ((*starter)->thread.joinable())
+                (*starter)->thread.join();
+            starter = this->starters.erase(starter);
+        } else {
+            starter++;
+        }
+    }
+}
+
+void Server::runWorker(Worker* worker) {
+    std::vector<std::unique_ptr<Match> > matches;
+    
+    while (!this->stopping) {
+        //Take any new matches and spectators
+        std::vector<std::unique_ptr<Match> > newMatches;
+        std::vector<int> newSpectators;
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            newMatches.swap(worker->newMatches);
+            newSpectators.swap(worker->newSpectators);
+        }
+        
+        for (int a = 0; a < newMatches.size(); a++) {
+            matches.push_back(std::move(newMatches[a]));
+        }
+        
+        //Spectators are spread between the matches, newest first
+        for (int a = 0; a < newSpectators.size(); a++) {
+            if (matches.empty()) { //The matches ended after the spectator was given to this worker
+                close(newSpectators[a]);
+                continue;
+            }
+            
+            try {
+                matches[matches.size() - 1 - a % matches.size()]->host.addSpectator(newSpectators[a]);
+            } catch (std::exception& e) {
+                std::cout << "Spectator failed to join: " << e.what() << std::endl;
+            }
+        }
+        
+        //Run each match without sleeping in it, and find when the soonest one is due again
+        float sleepTime = Server::maximumWorkerSleep;
+        
+        for (auto match = matches.begin(); match != matches.end();) {
+            try {
+                (*match)->host.update(&(*match)->done, false);
+            } catch (std::exception& e) {
+                std::cout << "Match ended with an error: " << e.what() << std::endl;
+                match = matches.erase(match);
+                worker->load--;
+                continue;
+            }
+            
+            if ((*match)->host.finished()) {
+                match = matches.erase(match);
+                worker->load--;
+                continue;
+            }
+            
+            sleepTime = std::min(sleepTime, (*match)->host.timeUntilDue());
+            match++;
+        }
+        
+        std::unique_lock<std::mutex> lock(worker->mutex);
+        worker->wake.wait_for(lock, std::chrono::duration<float>(sleepTime), [this, worker]() {
+            return this->stopping || worker->newMatches.size() > 0 || worker->newSpectators.size() > 0;
+        });
+    }
+    
+    //Tell the clients of every match that the host is closing
+    for (int a = 0; a < matches.size(); a++) {
+        matches[a]->done = true;
+        try {
+            matches[a]->host.update(&matches[a]->done, false);
+        } catch (std::exception) {}
+    }
+}
+
+//Destructor
+
+Server::~Server() {
+    this->joinStarters(true);
+    
+    this->stopping = true;
+    for (int a = 0; a < this->workers.size(); a++) {
+        {
+            std::lock_guard<std::mutex> lock(this->workers[a]->mutex);
+            this->workers[a]->wake.notify_one();
+        }
+        if (this->workers[a]->thread.joinable())
+            this->workers[a]->thread.join();
+    }
+}
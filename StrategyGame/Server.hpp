@@ -0,0 +1,166 @@
+//
+//  Server.hpp
+//  Strategy Game
+//
+
+#ifndef Server_hpp
+#define Server_hpp
+
+//Standard library includes
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <exception>
+
+//Local includes
+#include "Host.hpp"
+
+//How the dedicated server works:
+//One ServerSocket, the lobby, listens on the server's port. Clients that connect wait in the lobby, in the order they arrived, until there are enough of them for a match. Those clients are then released from the lobby and handed to a new Host. Beginning a match waits on its clients, so each match begins on a thread of its own, and is then given to whichever worker thread has the fewest matches. Each worker runs its matches in turn without sleeping in any of them, then sleeps until the soonest tick or send of any of its matches, see Host::timeUntilDue(). Matches never share anything, so the workers only lock to take new matches and spectators. A match ends once all of its players have disconnected.
+//Spectators connect to a second lobby, on the port after the players' one, so that they are never mistaken for players. Each one is given to a worker that is running matches, which adds it to one of them, see Host::addSpectator().
+
+/*!
+ * A headless dedicated server that runs many matches at once behind one port. See Server.hpp.
+ */
+class Server {
+public:
+    //Constructor
+    
+    /*!
+     * @param playersPerMatch The number of clients that are put into each match, at most Host::maximumStandardPlayers. An invalid_argument exception is thrown otherwise.
+     * @param numberOfWorkers The number of threads that run matches, usually the number of cores. At least one is used.
+     */
+    Server(unsigned int playersPerMatch = 2, unsigned int numberOfWorkers = 1);
+    
+    //Destructor
+    ~Server();
+    
+    //Public member functions
+    
+    /*!
+     * Listen for clients and put them into matches, and for spectators to watch the matches, until told to stop. The matches are told the host is closing before this returns. Will throw an error if either port cannot be listened on.
+     *
+     * @param portNum The port where clients connect. Spectators connect to portNum + SPECTATOR_PORT_OFFSET.
+     * @param done An optional pointer to a bool that stops the server once it is true. If unset, the server runs forever.
+     * @param transport An optional parameter indicating whether clients connect over TCP or UDP, see DatagramChannel.hpp. Autoinitialized as DEFAULT_TRANSPORT.
+     */
+    void run(int portNum, const std::atomic<bool>* done = nullptr, Transport transport = DEFAULT_TRANSPORT);
+    
+    /*!
+     * Set how often the matches that start after this are simulated and sent to their clients. See Host::setTickRate() and Host::setSendRate().
+     *
+     * @param ticksPerSecond The number of ticks per second.
+     * @param sendsPerSecond The number of board updates per second.
+     */
+    void setRates(float ticksPerSecond, float sendsPerSecond);
+    
+    /*!
+     * Set the terrain rules of the matches that start after this, such as ones loaded from a mod. They are sent to the clients with the board, see Board::serialize().
+     *
+     * @param rules The terrain rules to use.
+     */
+    void setTerrainRules(const TerrainRules& rules);
+    
+    //Public get functions
+    
+    /*!
+     * @return The number of matches currently running.
+     */
+    unsigned int numberOfMatches();
+    
+private:
+    //Private properties
+    
+    /*!
+     * A match and whether it has been told to stop.
+     */
+    struct Match {
+        Host host;
+        bool done = false;
+        
+        Match(Board board) : host(board) {}
+    };
+    
+    /*!
+     * A thread that runs matches, with the matches it has been given but not run yet.
+     */
+    struct Worker {
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable wake; //Notified when the worker is given a match or the server stops
+        std::vector<std::unique_ptr<Match> > newMatches; //Guarded by mutex
+        std::vector<int> newSpectators; //The sockets of spectators to add to the worker's matches. Guarded by mutex
+        std::atomic<unsigned int> load; //The number of matches the worker has, including new ones
+        
+        Worker() : load(0) {}
+    };
+    
+    /*!
+     * A thread that begins one match, and whether it has finished, so that it can be joined.
+     */
+    struct Starter {
+        std::thread thread;
+        std::atomic<bool> finished;
+        
+        Starter() : finished(false) {}
+    };
+    
+    ServerSocket lobby;
+    std::vector<unsigned int> waitingClients; //Indices in the lobby of the clients waiting for a match, in the order they connected
+    
+    ServerSocket spectatorLobby;
+    std::vector<unsigned int> waitingSpectators; //Indices in the spectator lobby of the spectators waiting for a match to watch
+    unsigned int nextSpectatorWorker = 0; //So that spectators are spread between the workers
+    
+    std::vector<std::unique_ptr<Worker> > workers;
+    std::vector<std::unique_ptr<Starter> > starters; //Only used by the thread that runs the lobby
+    std::atomic<bool> stopping;
+    
+    unsigned int playersPerMatch;
+    float ticksPerSecond = 60.0f;
+    float sendsPerSecond = 10.0f;
+    TerrainRules rules;
+    
+    //The longest a worker sleeps, in seconds, so that it notices when the server stops even while it has no matches
+    constexpr static const float maximumWorkerSleep = 0.5f;
+    
+    //Private member functions
+    
+    /*!
+     * Create a match for the clients that have waited longest, and begin it on a new starter thread.
+     */
+    void startMatch();
+    
+    /*!
+     * The function each starter thread runs. Begins the match, see Host::begin(), and gives it to the least busy worker if all of its clients answered.
+     *
+     * @param match The match to begin.
+     * @param starter The starter running this, which is marked finished once the match has been handed off or dropped.
+     */
+    void beginMatch(std::unique_ptr<Match> match, Starter* starter);
+    
+    /*!
+     * Give each waiting spectator to a worker that is running matches, if there are any.
+     */
+    void routeSpectators();
+    
+    /*!
+     * Join the starter threads that have finished.
+     *
+     * @param all Whether to wait for the starters that have not finished as well.
+     */
+    void joinStarters(bool all);
+    
+    /*!
+     * The function each worker thread runs until the server stops.
+     *
+     * @param worker The worker whose matches to run.
+     */
+    void runWorker(Worker* worker);
+};
+
+#endif /* Server_hpp */
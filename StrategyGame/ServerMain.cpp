@@ -0,0 +1,69 @@
+//
+//  ServerMain.cpp
+//  Strategy Game
+//
+
+//The entry point of the headless dedicated server. It is built as its own target, from this file, Server.cpp, Host.cpp, Player.cpp, the board and entity sources, and the socket sources, without main.cpp or anything that uses OpenGL, GLFW or GLEW.
+//Usage: StrategyGameServer [port] [players per match] [worker threads] [ticks per second] [sends per second] [tcp|udp] [terrain rules file]
+//Spectators connect to the port after the players' one, see Server::run().
+//The terrain rules file holds a serialized TerrainRules, see TerrainRules::serialize(). Without one, the built-in rules are used.
+
+//Standard library includes
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <atomic>
+#include <thread>
+
+#include <signal.h>
+#include <stdlib.h>
+
+//Local includes
+#include "Server.hpp"
+
+#define DEFAULT_PORT 3000
+
+//Set by the signal handler so that the server shuts down cleanly
+std::atomic<bool> done(false);
+
+void stopServer(int) {
+    done = true;
+}
+
+int main(int argc, const char * argv[]) {
+    int port = argc > 1 ? atoi(argv[1]) : DEFAULT_PORT;
+    unsigned int playersPerMatch = argc > 2 ? atoi(argv[2]) : 2;
+    unsigned int numberOfWorkers = argc > 3 ? atoi(argv[3]) : std::thread::hardware_concurrency();
+    float ticksPerSecond = argc > 4 ? atof(argv[4]) : 60.0f;
+    float sendsPerSecond = argc > 5 ? atof(argv[5]) : 10.0f;
+    Transport transport = argc > 6 ? (std::string(argv[6]) == "udp" ? DATAGRAM_TRANSPORT : STREAM_TRANSPORT) : DEFAULT_TRANSPORT;
+    
+    //A client that disconnects while being sent to should only end its own connection, not the whole server
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, stopServer);
+    signal(SIGTERM, stopServer);
+    
+    try {
+        Server server(playersPerMatch, numberOfWorkers);
+        server.setRates(ticksPerSecond, sendsPerSecond);
+        
+        if (argc > 7) {
+            std::ifstream rulesFile(argv[7]);
+            if (!rulesFile)
+                throw std::runtime_error(std::string("Could not open ") + argv[7]);
+            
+            std::stringstream rules;
+            rules << rulesFile.rdbuf();
+            server.setTerrainRules(TerrainRules::deserialize(rules.str()));
+        }
+        
+        std::cout << "Serving matches of " << playersPerMatch << " players on " << (transport == DATAGRAM_TRANSPORT ? "UDP" : "TCP") << " port " << port << std::endl;
+        server.run(port, &done, transport);
+    } catch (std::exception& e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
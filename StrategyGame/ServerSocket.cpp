@@ -8,6 +8,8 @@
 
 #include "ServerSocket.hpp"
 
+const unsigned int ServerSocket::hostSocketIndex; //Defined here as well, so that it can be passed by reference
+
 ServerSocket::ServerSocket() {}
 
 //Static functions
@@ -22,7 +24,9 @@ std::string ServerSocket::getHostName() {
 
 //Public member functions
 
-void ServerSocket::setSocket(int portNum) {
+void ServerSocket::setSocket(int portNum, Transport transport, int backlog) {
+    this->transport = transport;
+    
     int returnVal;
     
     addrinfo hints; //A struct containing information on the address. Will be passed to getaddrinfo() to give hints about the connection to be made
@@ -30,7 +34,7 @@ void ServerSocket::setSocket(int portNum) {
     
     memset(&hints, 0, sizeof(hints)); //Initializes hints with all 0's
     hints.ai_family = AF_UNSPEC; //Can be either IPv4 or IPv6
-    hints.ai_socktype = SOCK_STREAM; //TCP Socket
+    hints.ai_socktype = transport == DATAGRAM_TRANSPORT ? SOCK_DGRAM : SOCK_STREAM; //UDP or TCP Socket
     hints.ai_flags = AI_PASSIVE; //Make the socket use localhost
     
     /* getaddrinfo
@@ -101,165 +105,327 @@ void ServerSocket::setSocket(int portNum) {
      
      The first argument is the socket, by its simple integer reference.=
      
-     The second argument is the size of the "backlog queue", or the number of connections that can be waiting as another connection is handled. It basically is the number of connections that can wait before being accepted.
+     The second argument is the size of the "backlog queue", or the number of connections that can be waiting as another connection is handled. It basically is the number of connections that can wait before being accepted. The system lowers it to its own maximum if it is larger.
      
      This function cannot fail, as long as the socket is valid, so there is no error code.
+     
+     UDP has no connections to listen for. Clients ask to connect with a packet instead, see DatagramChannel::accept().
      */
-    if (listen(this->hostSocket, MAX_NUMBER_OF_CONNECTIONS) < 0) {
+    if (transport == STREAM_TRANSPORT && listen(this->hostSocket, backlog) < 0) {
         throw std::runtime_error(std::string("ERROR listening for incoming connections") + std::string(strerror(errno)));
     }
     
-    //Initialize activeConnections[] as false
-    for (int a = 0; a < MAX_NUMBER_OF_CONNECTIONS; a++) {
-        this->activeConnections[a] = false;
-    }
+    //Clients are accepted from the event loop, so accept() must never block
+    ServerSocket::setNonBlocking(this->hostSocket);
+    
+    this->setUpConnections();
     
     freeaddrinfo(serverAddressList); //Free the linked list now that we have the local host information
     this->setUp = true;
 }
 
-void ServerSocket::addClient() {
+void ServerSocket::setSocket() {
+    this->hostSocket = -1;
+    this->setUpConnections();
+    this->setUp = true;
+}
+
+unsigned int ServerSocket::addClient(bool spectator) {
     if (!this->setUp)
         throw std::logic_error("Socket not set");
     
-    int nextIndex = this->getNextAvailableIndex();
+    if (this->hostSocket < 0)
+        throw std::logic_error("Socket does not listen for connections");
+    
+    sockaddr_storage clientAddress;
+    socklen_t clientAddressSize = sizeof(sockaddr_storage);
+    int clientSocket = -1;
+    
+    //Over UDP, whatever woke the host socket may not have been a client asking to connect, so this waits again until one is
+    while (clientSocket < 0) {
+        //The host socket is non-blocking, so wait for a client to connect first
+        pollfd connecting;
+        connecting.fd = this->hostSocket;
+        connecting.events = POLLIN;
+        connecting.revents = 0;
+        
+        int ready = poll(&connecting, 1, this->hostTimeout);
+        if (ready < 0)
+            throw std::runtime_error(std::string("ERROR waiting for client: ") + std::string(strerror(errno)));
+        if (ready == 0)
+            throw std::runtime_error("ERROR accepting client: timed out");
+        
+        /* accept()
+         The accept() function makes the process block until a connection is formed between the client and the server, with three arguments. It then wakes when the connection is successfully established.
+         
+         The first argument is the host side socket, passed by its reference.
+         
+         The second argument is a reference to the address of the client, in the form of a sockaddr struct pointer.
+         
+         The third argument is the size of the struct, passed by value.
+         
+         The return value is a socket, passed by a small integer reference.
+         */
+        clientSocket = this->acceptClient(&clientAddress, &clientAddressSize);
+        
+        //Checks for error with accepting
+        if (clientSocket < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            throw std::runtime_error(std::string("ERROR accepting client") + std::string(strerror(errno)));
+    }
+    
+    //Other clients may have connected at the same time, and edge-triggered events will not report them again
+    this->clientWaiting = true;
+    
+    return this->startConnection(clientSocket, clientAddress, clientAddressSize, spectator);
+}
+
+void ServerSocket::processEvents(int timeoutMilliseconds, const ServerSocketHandlers& handlers) {
+    if (!this->setUp)
+        throw std::logic_error("Socket not set");
+    
+    //Messages may already have been read, by receive() or in an earlier call, and the sockets will not report them again
+    for (unsigned int a = 0; a < this->connections.size(); a++) {
+        try {
+            if (this->connections[a].active && this->connections[a].framer.hasMessage()) {
+                this->dispatchMessages(a, handlers);
+                timeoutMilliseconds = 0;
+            }
+        } catch (std::range_error) { //The stream is corrupt
+            this->dropClient(a, handlers);
+        }
+    }
+    
+    //Datagram connections resend and acknowledge on their own timers, so wait no longer than the soonest one is due
+    for (unsigned int a = 0; a < this->connections.size(); a++) {
+        if (!this->connections[a].active)
+            continue;
+        
+        int due = this->connections[a].framer.timeUntilDue();
+        if (due == 0) {
+            try {
+                this->connections[a].framer.flush();
+            } catch (std::runtime_error) { //The client stopped answering
+                this->dropClient(a, handlers);
+                continue;
+            }
+            due = this->connections[a].framer.timeUntilDue();
+        }
+        
+        if (due >= 0 && (timeoutMilliseconds < 0 || due < timeoutMilliseconds))
+            timeoutMilliseconds = due;
+    }
     
-    if (nextIndex == -1) {
-        throw std::range_error("Cannot connect more than " + std::to_string(MAX_NUMBER_OF_CONNECTIONS) + " sockets");
+    if (this->accepting && this->clientWaiting && this->hostSocket >= 0) {
+        if (this->acceptClients(handlers))
+            timeoutMilliseconds = 0;
     }
     
-    /* accept()
-     The accept() function makes the process block until a connection is formed between the client and the server, with three arguments. It then wakes when the connection is successfully established.
-     
-     The first argument is the host side socket, passed by its reference.
-     
-     The second argument is a reference to the address of the client, in the form of a sockaddr struct pointer.
-     
-     The third argument is the size of the struct, passed by value.
-     
-     The return value is a socket, passed by a small integer reference.
-     */
-    this->clientSockets[nextIndex] = accept(this->hostSocket, (struct sockaddr *)&this->clientAddresses[nextIndex], &this->clientAddressSizes[nextIndex]);
+#if defined(__linux__)
+    //Room for every socket, so that each one is reported at most once per call
+    this->events.resize(this->connections.size() + 1);
+    int numberOfEvents = epoll_wait(this->eventQueue, this->events.data(), (int)this->events.size(), timeoutMilliseconds);
+    
+    if (numberOfEvents < 0) {
+        if (errno == EINTR)
+            return;
+        throw std::runtime_error(std::string("ERROR waiting for events: ") + std::string(strerror(errno)));
+    }
+    
+    for (int a = 0; a < numberOfEvents; a++) {
+        unsigned int index = (unsigned int)(this->events[a].data.u64 & 0xFFFFFFFF);
+        int socket = (int)(this->events[a].data.u64 >> 32);
+        
+        if (index == ServerSocket::hostSocketIndex) {
+            this->clientWaiting = true;
+            if (this->accepting)
+                this->acceptClients(handlers);
+            continue;
+        }
+        
+        //The client may have been closed by a handler for an earlier event, and its index even reused by a client accepted since
+        if (!this->connections[index].active || this->connections[index].socket != socket)
+            continue;
+        
+        if (this->events[a].events & EPOLLOUT) {
+            try {
+                this->connections[index].framer.flush();
+            } catch (std::runtime_error) {
+                this->dropClient(index, handlers);
+                continue;
+            }
+        }
+        
+        if (this->events[a].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+            this->readFromClient(index, handlers);
+    }
+#else
+    //Without epoll, the sockets are listed every call, and only watched for writing while they have something queued
+    this->pollSockets.clear();
+    this->pollIndices.clear();
+    
+    for (unsigned int a = 0; a < this->connections.size(); a++) {
+        if (this->connections[a].active) {
+            pollfd socket;
+            socket.fd = this->connections[a].socket;
+            socket.events = POLLIN | (this->connections[a].framer.hasQueued() ? POLLOUT : 0);
+            socket.revents = 0;
+            this->pollSockets.push_back(socket);
+            this->pollIndices.push_back(a);
+        }
+    }
     
-    //Checks for error with accepting
-    if (this->clientSockets[nextIndex] < 0)
-        throw std::runtime_error(std::string("ERROR accepting client") + std::string(strerror(errno)));
+    //Only watch the host socket while accepting, since a waiting client would be reported on every call
+    if (this->accepting && this->hostSocket >= 0) {
+        pollfd socket;
+        socket.fd = this->hostSocket;
+        socket.events = POLLIN;
+        socket.revents = 0;
+        this->pollSockets.push_back(socket);
+        this->pollIndices.push_back(ServerSocket::hostSocketIndex);
+    }
+    
+    if (poll(this->pollSockets.data(), this->pollSockets.size(), timeoutMilliseconds) < 0) {
+        if (errno == EINTR)
+            return;
+        throw std::runtime_error(std::string("ERROR waiting for events: ") + std::string(strerror(errno)));
+    }
     
-    this->activeConnections[nextIndex] = true;
+    for (int a = 0; a < this->pollSockets.size(); a++) {
+        unsigned int index = this->pollIndices[a];
+        
+        if (this->pollSockets[a].revents == 0)
+            continue;
+        
+        if (index == ServerSocket::hostSocketIndex) {
+            this->clientWaiting = true;
+            this->acceptClients(handlers);
+            continue;
+        }
+        
+        //The client may have been closed by a handler for an earlier event, and its index even reused
+        if (!this->connections[index].active || this->connections[index].socket != this->pollSockets[a].fd)
+            continue;
+        
+        if (this->pollSockets[a].revents & POLLOUT) {
+            try {
+                this->connections[index].framer.flush();
+            } catch (std::runtime_error) {
+                this->dropClient(index, handlers);
+                continue;
+            }
+        }
+        
+        if (this->pollSockets[a].revents & (POLLIN | POLLHUP | POLLERR))
+            this->readFromClient(index, handlers);
+    }
+#endif
 }
 
-void ServerSocket::closeConnection(unsigned int clientIndex) {
+void ServerSocket::setAccepting(bool accepting) {
+    this->accepting = accepting;
+}
+
+unsigned int ServerSocket::addClient(int clientSocket, bool spectator) {
     if (!this->setUp)
         throw std::logic_error("Socket not set");
     
-    if (clientIndex >= MAX_NUMBER_OF_CONNECTIONS || !this->activeConnections[clientIndex])
+    sockaddr_storage clientAddress;
+    socklen_t clientAddressSize = sizeof(sockaddr_storage);
+    if (getpeername(clientSocket, (struct sockaddr *)&clientAddress, &clientAddressSize) < 0)
+        clientAddressSize = 0;
+    
+    return this->startConnection(clientSocket, clientAddress, clientAddressSize, spectator);
+}
+
+int ServerSocket::releaseClient(unsigned int clientIndex) {
+    if (!this->setUp)
+        throw std::logic_error("Socket not set");
+    
+    if (!this->connected(clientIndex))
         throw std::range_error("Socket index uninitialized");
     
-    close(this->clientSockets[clientIndex]);
+    int clientSocket = this->connections[clientIndex].socket;
     
-    this->clientAddresses[clientIndex] = sockaddr_storage();
-    this->clientAddressSizes[clientIndex] = 0;
+#if defined(__linux__)
+    epoll_ctl(this->eventQueue, EPOLL_CTL_DEL, clientSocket, nullptr);
+#endif
+    this->endConnection(clientIndex);
     
-    this->activeConnections[clientIndex] = false;
+    return clientSocket;
 }
 
-void ServerSocket::send(const char* message, unsigned int clientIndex, bool throwErrorIfNotFullySent) {
+void ServerSocket::closeConnection(unsigned int clientIndex) {
     if (!this->setUp)
         throw std::logic_error("Socket not set");
     
-    if (clientIndex >= MAX_NUMBER_OF_CONNECTIONS || !this->activeConnections[clientIndex])
+    if (!this->connected(clientIndex))
         throw std::range_error("Socket index uninitialized");
     
-    long messageLength = strlen(message);
+    this->connections[clientIndex].framer.sendClose();
+    close(this->connections[clientIndex].socket); //Closing the socket also removes it from the event queue
+    this->endConnection(clientIndex);
+}
+
+void ServerSocket::send(const char* message, unsigned int clientIndex) {
+    this->send(message, strlen(message), clientIndex, TEXT_MESSAGE);
+}
+
+void ServerSocket::send(const std::string& message, unsigned int clientIndex, MessageType type) {
+    this->send(message.data(), message.size(), clientIndex, type);
+}
+
+void ServerSocket::send(const char* message, size_t length, unsigned int clientIndex, MessageType type) {
+    if (!this->setUp)
+        throw std::logic_error("Socket not set");
     
-    std::string str = std::string(message);
+    if (!this->connected(clientIndex))
+        throw std::range_error("Socket index uninitialized");
     
-    if (str == "" || messageLength < 1)
+    if (length < 1)
         throw std::logic_error("No message to send");
     
-    long messageSize = write(this->clientSockets[clientIndex], message, strlen(message));
-    
-    if (messageSize < 0) {
-        throw std::runtime_error(std::string("ERROR sending message: ") + std::string(strerror(errno)));
-    } else if (messageSize < messageLength) {
-        if (throwErrorIfNotFullySent) { //Error sent only if optional parameter is manually set to true: if the message was too long to send all of it
-            throw std::runtime_error(std::string("ERROR message too long: only sent ") + std::to_string(messageSize) + std::string(" of ") + std::to_string(messageLength) + std::string(" characters"));
-        } else {
-            std::cout << "ERROR message too long: only sent " << messageSize << " of " << messageLength << " characters" << std::endl;
-        }
-    }
+    this->connections[clientIndex].framer.send(message, length, type);
 }
 
-void ServerSocket::broadcast(const char* message, bool throwErrorIfNotFullySent) {
+void ServerSocket::broadcast(const char* message) {
     if (!this->setUp)
         throw std::logic_error("Socket not set");
     
-    for (int a = 0; a < MAX_NUMBER_OF_CONNECTIONS; a++) {
-        if (this->activeConnections[a]) {
-            this->send(message, a, throwErrorIfNotFullySent);
+    size_t length = strlen(message);
+    
+    for (unsigned int a = 0; a < this->connections.size(); a++) {
+        if (this->connections[a].active) {
+            this->send(message, length, a, TEXT_MESSAGE);
         }
     }
 }
 
-std::string ServerSocket::receive(unsigned int clientIndex, bool* socketClosed) {
+std::string ServerSocket::receive(unsigned int clientIndex, bool* socketClosed, MessageType* type) {
     if (!this->setUp)
         throw std::logic_error("Socket not set");
     
-    if (clientIndex >= MAX_NUMBER_OF_CONNECTIONS || !this->activeConnections[clientIndex])
+    if (!this->connected(clientIndex))
         throw std::range_error("Socket index uninitialized");
-        
-    char buffer[MAXIMUM_SOCKET_MESSAGE_SIZE]; //This program will read characters from the connection into this buffer
-    
-    //Initialize the buffer where received info is stored
-    bzero(buffer, MAXIMUM_SOCKET_MESSAGE_SIZE);
     
-    long messageSize; //Stores the return value from the calls to read() and write() by holding the number of characters either read or written
+    std::string message;
+    MessageType messageType = TEXT_MESSAGE;
     
-    /* read()
-     The read() function will read in info from the client socket, with three arguments. It will block until the client writes and there is something to read in.
-     
-     The first argument is the reference for the client's socket.
-     
-     The second argument is the buffer to store the message.
-     
-     The third argument is the maximum number of characters to to be read into the buffer.
-     */
-    messageSize = read(this->clientSockets[clientIndex], buffer, MAXIMUM_SOCKET_MESSAGE_SIZE);
-    
-    //Checks for errors reading from the socket
-    if (messageSize < 0)
-        throw std::runtime_error(std::string("ERROR reading from socket: ") + std::string(strerror(errno)));
-    
-    if (socketClosed != nullptr && messageSize == 0) {
-        *socketClosed = true;
+    //Blocks until the whole message has arrived, or the timeout set with setTimeout() passes
+    if (!this->connections[clientIndex].framer.receive(message, messageType)) {
+        if (socketClosed != nullptr)
+            *socketClosed = true;
     }
     
-    std::string str = std::string(buffer, messageSize);
-    
-    //Check if there is more data waiting to be read, and if so, read it
-    fd_set readfds;
-    FD_ZERO(&readfds);
-    FD_SET(this->hostSocket, &readfds);
-    int n = this->hostSocket + 1;
-    
-    struct timeval timeout;
-    timeout.tv_sec = 0;
-    timeout.tv_usec = 20000;
+    if (type != nullptr)
+        *type = messageType;
     
-    int returnValue = select(n, &readfds, NULL, NULL, &timeout);
-    if (returnValue < 0) {
-        throw std::runtime_error(std::string("ERROR finding information about socket: ") + std::string(strerror(errno)));
-    } else if (returnValue > 0) {
-        str += this->receive(clientIndex);
-    }
-    
-    return str;
+    return message;
 }
 
 bool ServerSocket::allReceived(const char* messageToCompare) {
-    for (int a = 0; a < MAX_NUMBER_OF_CONNECTIONS; a++) {
+    for (unsigned int a = 0; a < this->connections.size(); a++) {
         bool connectionClosed = false;
-        if (this->activeConnections[a] && this->receive(a, &connectionClosed) != messageToCompare)
+        if (this->connections[a].active && this->receive(a, &connectionClosed) != messageToCompare)
             if (connectionClosed) {
                 this->closeConnection(a);
                 return false;
@@ -269,41 +435,50 @@ bool ServerSocket::allReceived(const char* messageToCompare) {
 }
 
 void ServerSocket::setTimeout(unsigned int seconds, unsigned int milliseconds) {
-#if defined(_WIN32)
-    DWORD timeout = (seconds * 1000) + milliseconds;
-    for (int a = 0; a < MAX_NUMBER_OF_CONNECTIONS; a++) {
-        if (this->activeConnections[a]) setsockopt(this->clientSockets[a], SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
-    }
-#else
-    struct timeval time;
-    time.tv_sec = seconds;
-    time.tv_usec = (milliseconds * 1000);
-    for (int a = 0; a < MAX_NUMBER_OF_CONNECTIONS; a++) {
-        if (this->activeConnections[a]) setsockopt(this->clientSockets[a], SOL_SOCKET, SO_RCVTIMEO, (struct timeval*)&time, sizeof(struct timeval));
+    //The client sockets are non-blocking, so the framers time out waiting instead of the sockets
+    this->receiveTimeout = (seconds == 0 && milliseconds == 0) ? -1 : (int)(seconds * 1000 + milliseconds);
+    
+    for (unsigned int a = 0; a < this->connections.size(); a++) {
+        this->connections[a].framer.setReceiveTimeout(this->receiveTimeout);
     }
-#endif
 }
 
 void ServerSocket::setHostTimeout(unsigned int seconds, unsigned int milliseconds) {
-#if defined(_WIN32)
-    DWORD timeout = (seconds * 1000) + milliseconds;
-    setsockopt(this->hostSocket, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
-#else
-    struct timeval time;
-    time.tv_sec = seconds;
-    time.tv_usec = (milliseconds * 1000);
-    setsockopt(this->hostSocket, SOL_SOCKET, SO_RCVTIMEO, (struct timeval*)&time, sizeof(struct timeval));
-#endif
+    this->hostTimeout = (seconds == 0 && milliseconds == 0) ? -1 : (int)(seconds * 1000 + milliseconds);
 }
 
-unsigned int ServerSocket::numberOfClients() {
-    int connections = 0;
-    for (int a = 0; a < MAX_NUMBER_OF_CONNECTIONS; a++) {
-        if (this->activeConnections[a]) {
-            connections++;
-        }
+void ServerSocket::setSpectator(unsigned int clientIndex, bool spectator) {
+    if (!this->connected(clientIndex))
+        throw std::range_error("Socket index uninitialized");
+    
+    Connection& connection = this->connections[clientIndex];
+    if (connection.spectator == spectator)
+        return;
+    
+    connection.spectator = spectator;
+    if (spectator) {
+        this->activePlayers--;
+        this->activeSpectators++;
+    } else {
+        this->activeSpectators--;
+        this->activePlayers++;
     }
-    return connections;
+}
+
+bool ServerSocket::connected(unsigned int clientIndex) {
+    return clientIndex < this->connections.size() && this->connections[clientIndex].active;
+}
+
+bool ServerSocket::isSpectator(unsigned int clientIndex) {
+    return this->connected(clientIndex) && this->connections[clientIndex].spectator;
+}
+
+unsigned int ServerSocket::numberOfClients() {
+    return this->activePlayers;
+}
+
+unsigned int ServerSocket::numberOfSpectators() {
+    return this->activeSpectators;
 }
 
 bool ServerSocket::getSet() {
@@ -312,11 +487,180 @@ bool ServerSocket::getSet() {
 
 //Private member functions
 
-int ServerSocket::getNextAvailableIndex() {
-    for (int a = 0; a < MAX_NUMBER_OF_CONNECTIONS; a++) {
-        if (!this->activeConnections[a]) return a;
+unsigned int ServerSocket::getNextAvailableIndex() {
+    if (this->freeIndices.size() > 0) {
+        unsigned int index = this->freeIndices.back();
+        this->freeIndices.pop_back();
+        return index;
     }
-    return -1;
+    
+    this->connections.emplace_back();
+    return (unsigned int)this->connections.size() - 1;
+}
+
+void ServerSocket::setUpConnections() {
+#if defined(__linux__)
+    this->eventQueue = epoll_create1(0);
+    if (this->eventQueue < 0)
+        throw std::runtime_error(std::string("ERROR creating event queue: ") + std::string(strerror(errno)));
+    
+    if (this->hostSocket >= 0) {
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN | EPOLLET;
+        event.data.u64 = ServerSocket::eventData(this->hostSocket, ServerSocket::hostSocketIndex);
+        if (epoll_ctl(this->eventQueue, EPOLL_CTL_ADD, this->hostSocket, &event) < 0)
+            throw std::runtime_error(std::string("ERROR watching host socket: ") + std::string(strerror(errno)));
+    }
+#endif
+}
+
+#if defined(__linux__)
+uint64_t ServerSocket::eventData(int socket, unsigned int index) {
+    return ((uint64_t)(uint32_t)socket << 32) | index;
+}
+#endif
+
+void ServerSocket::setNonBlocking(int socket) {
+    int flags = fcntl(socket, F_GETFL, 0);
+    if (flags < 0 || fcntl(socket, F_SETFL, flags | O_NONBLOCK) < 0)
+        throw std::runtime_error(std::string("ERROR making socket non-blocking: ") + std::string(strerror(errno)));
+}
+
+unsigned int ServerSocket::startConnection(int clientSocket, const sockaddr_storage& address, socklen_t addressSize, bool spectator) {
+    try {
+        ServerSocket::setNonBlocking(clientSocket);
+    } catch (std::runtime_error) {
+        close(clientSocket);
+        throw;
+    }
+    
+    unsigned int clientIndex = this->getNextAvailableIndex();
+    Connection& connection = this->connections[clientIndex];
+    
+#if defined(__linux__)
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.u64 = ServerSocket::eventData(clientSocket, clientIndex);
+    if (epoll_ctl(this->eventQueue, EPOLL_CTL_ADD, clientSocket, &event) < 0) {
+        close(clientSocket);
+        this->freeIndices.push_back(clientIndex);
+        throw std::runtime_error(std::string("ERROR watching client: ") + std::string(strerror(errno)));
+    }
+#endif
+    
+    connection.socket = clientSocket;
+    connection.address = address;
+    connection.addressSize = addressSize;
+    
+    connection.framer.setMaximumReceiveLength(MAXIMUM_CLIENT_MESSAGE_SIZE); //Clients only send commands, so they cannot make the host reserve room for a whole board
+    connection.framer.setSocket(clientSocket);
+    connection.framer.setQueueing(true); //Sending never waits on a slow client, see MessageFramer.hpp
+    connection.framer.setReceiveTimeout(this->receiveTimeout);
+    
+    connection.active = true;
+    connection.spectator = spectator;
+    if (spectator)
+        this->activeSpectators++;
+    else
+        this->activePlayers++;
+    
+    return clientIndex;
+}
+
+void ServerSocket::endConnection(unsigned int clientIndex) {
+    Connection& connection = this->connections[clientIndex];
+    
+    connection.framer.setSocket(-1);
+    connection.socket = -1;
+    connection.address = sockaddr_storage();
+    connection.addressSize = 0;
+    
+    if (connection.spectator)
+        this->activeSpectators--;
+    else
+        this->activePlayers--;
+    
+    connection.active = false;
+    connection.spectator = false;
+    this->freeIndices.push_back(clientIndex);
+}
+
+int ServerSocket::acceptClient(sockaddr_storage* address, socklen_t* addressSize) {
+    *addressSize = sizeof(sockaddr_storage);
+    
+    if (this->transport == DATAGRAM_TRANSPORT)
+        return DatagramChannel::accept(this->hostSocket, address, addressSize, this->acceptedNonces);
+    
+    return accept(this->hostSocket, (struct sockaddr *)address, addressSize);
+}
+
+bool ServerSocket::acceptClients(const ServerSocketHandlers& handlers) {
+    bool accepted = false;
+    
+    while (this->accepting) {
+        sockaddr_storage clientAddress;
+        socklen_t clientAddressSize = sizeof(sockaddr_storage);
+        int clientSocket = this->acceptClient(&clientAddress, &clientAddressSize);
+        
+        if (clientSocket < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                this->clientWaiting = false;
+                return accepted;
+            }
+            if (errno == EMFILE || errno == ENFILE)
+                return accepted; //Out of files, so leave the rest waiting and try again on the next call
+            throw std::runtime_error(std::string("ERROR accepting client") + std::string(strerror(errno)));
+        }
+        
+        unsigned int clientIndex = this->startConnection(clientSocket, clientAddress, clientAddressSize, false);
+        accepted = true;
+        
+        if (handlers.connected)
+            handlers.connected(clientIndex);
+    }
+    
+    return accepted;
+}
+
+void ServerSocket::readFromClient(unsigned int clientIndex, const ServerSocketHandlers& handlers) {
+    bool open;
+    try {
+        open = this->connections[clientIndex].framer.readAvailable();
+    } catch (std::runtime_error) {
+        open = false;
+    }
+    
+    //Messages that arrived before the connection closed are still handled
+    try {
+        this->dispatchMessages(clientIndex, handlers);
+    } catch (std::range_error) { //The stream is corrupt
+        open = false;
+    }
+    
+    if (!open && this->connections[clientIndex].active)
+        this->dropClient(clientIndex, handlers);
+}
+
+void ServerSocket::dispatchMessages(unsigned int clientIndex, const ServerSocketHandlers& handlers) {
+    std::string message;
+    MessageType type;
+    
+    while (this->connections[clientIndex].active && this->connections[clientIndex].framer.nextMessage(message, type)) {
+        if (handlers.received)
+            handlers.received(clientIndex, message, type);
+    }
+}
+
+void ServerSocket::dropClient(unsigned int clientIndex, const ServerSocketHandlers& handlers) {
+    if (handlers.disconnected)
+        handlers.disconnected(clientIndex);
+    
+    if (this->connections[clientIndex].active)
+        this->closeConnection(clientIndex);
 }
 
 //Destructor
@@ -324,11 +668,18 @@ int ServerSocket::getNextAvailableIndex() {
 ServerSocket::~ServerSocket() {
     if (this->setUp) {
         //Properly terminate the sockets
-        for (int clientIndex = 0; clientIndex < MAX_NUMBER_OF_CONNECTIONS; clientIndex++) {
-            if (this->activeConnections[clientIndex]) {
-                close(this->clientSockets[clientIndex]);
+        for (unsigned int clientIndex = 0; clientIndex < this->connections.size(); clientIndex++) {
+            if (this->connections[clientIndex].active) {
+                this->connections[clientIndex].framer.sendClose();
+                close(this->connections[clientIndex].socket);
             }
         }
-        close(this->hostSocket);
+        if (this->hostSocket >= 0)
+            close(this->hostSocket);
+        
+#if defined(__linux__)
+        if (this->eventQueue >= 0)
+            close(this->eventQueue);
+#endif
     }
 }
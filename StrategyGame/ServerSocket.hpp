@@ -13,6 +13,9 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <deque>
+#include <functional>
 #include <exception>
 
 #include <stdio.h>
@@ -24,6 +27,30 @@
 #include <netinet/in.h>
 #include <netdb.h>
 #include <fcntl.h>
+#include <poll.h>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#endif
+
+#include "MessageFramer.hpp"
+#include "DatagramChannel.hpp"
+
+//How events are handled:
+//Every socket is non-blocking. ServerSocket::processEvents() waits on the host socket and all of the client connections at once, with epoll where it is available and poll() elsewhere, and reacts to whichever are ready: new clients are accepted, whatever each client sent is read and split into messages, and queued messages are sent once there is room for them. Nothing waits on a single client, so one slow client cannot hold up the others. The blocking functions, like receive() and addClient(), still work for handshakes outside of the event loop.
+//Over UDP, each client still gets its own connected socket, see DatagramChannel.hpp, so events are handled the same way. Its framer also has to resend and acknowledge on time, so processEvents() flushes the framers that are due and never waits past the next one.
+
+//How connections are stored:
+//There is no fixed limit on the number of clients. Each client has an index into a table of connections, which grows as clients connect and never shrinks, so an index stays valid for as long as its client is connected. The indices of closed connections are kept on a stack and reused before the table grows, so finding a free index never searches the table. Spectators are clients that are sent to like any other, but are not counted by numberOfClients(), so that games can tell their players from their observers.
+
+/*!
+ * The functions that ServerSocket::processEvents() calls for each event. Any of them can be left empty.
+ */
+struct ServerSocketHandlers {
+    std::function<void(unsigned int clientIndex)> connected; //A client was accepted
+    std::function<void(unsigned int clientIndex, const std::string& message, MessageType type)> received; //A whole message arrived from a client
+    std::function<void(unsigned int clientIndex)> disconnected; //A client closed its connection or had an error. The connection is closed after this returns
+};
 
 class ServerSocket {
 public:
@@ -48,13 +75,58 @@ public:
      * A function to initialize the socket. This must be done before the socket can be used. Will throw an error if the socket cannot be opened or if the port is occupied.
      *
      * @param portNum The number of the port on the host at which clients should connect.
+     * @param transport An optional parameter indicating whether clients connect over TCP or UDP, see DatagramChannel.hpp. Autoinitialized as DEFAULT_TRANSPORT.
+     * @param backlog An optional parameter indicating the number of clients that can wait to be accepted before the system turns more away. Autoinitialized as SOMAXCONN, the largest the system allows. Only used for TCP.
+     */
+    void setSocket(int portNum, Transport transport = DEFAULT_TRANSPORT, int backlog = SOMAXCONN);
+    
+    /*!
+     * A function to initialize the socket without listening for connections, for when clients are accepted by another ServerSocket and handed over with addClient(int). This must be done before the socket can be used, instead of setSocket(int).
+     */
+    void setSocket();
+    
+    /*!
+     * A function that adds a client. If there is no client, then the function waits for a connection to be initiated by the client, until the timeout set with setHostTimeout(). Will throw an error if the socket does not listen for connections, or if an error occurs connecting to the client.
+     *
+     * @param spectator An optional bool indicating whether the client is a spectator, see setSpectator(). Autoinitialized as false.
+     *
+     * @return The index of the client.
      */
-    void setSocket(int portNum);
+    unsigned int addClient(bool spectator = false);
     
     /*!
-     * A function that adds a client. If there is no client, then the function waits for a connection to be initiated by the client. Will throw an error if the maximum number of sockets (see MAXIMUM_NUMBER_OF_SOCKETS) have already been set, or if an error occurs connecting to the client.
+     * A function that waits for events on any of the sockets and handles them, see ServerSocket.hpp. Messages that have already arrived are handled without waiting. Handlers may send, close connections, and change whether clients are accepted. An error will be thrown if the socket is not set or if waiting for events fails.
+     *
+     * @param timeoutMilliseconds The longest time to wait for an event. 0 only handles events that are ready, and -1 waits until one happens.
+     * @param handlers The functions to call for each event.
      */
-    void addClient();
+    void processEvents(int timeoutMilliseconds, const ServerSocketHandlers& handlers);
+    
+    /*!
+     * A function to set whether processEvents() accepts new clients. While it does not, clients wait to be accepted until it does. Autoinitialized as false.
+     *
+     * @param accepting Whether to accept clients.
+     */
+    void setAccepting(bool accepting);
+    
+    /*!
+     * A function that adds a client that has already connected, such as one released by another ServerSocket. Will throw an error if the socket is not set, or if the client cannot be watched for events.
+     *
+     * @param clientSocket The file descriptor of the connected client. This object takes ownership of it.
+     * @param spectator An optional bool indicating whether the client is a spectator, see setSpectator(). Autoinitialized as false.
+     *
+     * @return The index of the client.
+     */
+    unsigned int addClient(int clientSocket, bool spectator = false);
+    
+    /*!
+     * A function that stops using a client without closing its connection, so that it can be handed to another ServerSocket. Anything the client sent that was not handled yet is discarded. Over UDP, so is whatever was sent to the client and not acknowledged yet, so a client should only be released before anything is sent to it. If there is no client at that index, an error is thrown.
+     *
+     * @param clientIndex The index of the client to release.
+     *
+     * @return The file descriptor of the client, which the caller now owns.
+     */
+    int releaseClient(unsigned int clientIndex);
     
     /*!
      * A function that removes a client at a given index. If there is no client at that index, an error is thrown. An error will also be thrown if the socket has not been set.
@@ -64,31 +136,49 @@ public:
     void closeConnection(unsigned int clientIndex);
     
     /*!
-     * A function that sends a message to a single client. An error will be thrown if the socket is not set, if the given index is out of range, or if an error occurs in sending the message. If the optional parameter is set to true, an error will also be thrown if only part of the message was thrown.
+     * A function that sends a text message to a single client. The whole message is always sent, see MessageFramer.hpp. An error will be thrown if the socket is not set, if the given index is out of range, or if an error occurs in sending the message.
      *
      * @param message The message to be sent, as a const char*.
      * @param clientIndex An unsigned int indicating the index of the client to whom to send the message.
-     * @param throwErrorIfNotFullySent An optional boolean indicating if an error should be thrown if only part of the message was sent. Automatically set to false.
      */
-    void send(const char* message, unsigned int clientIndex, bool throwErrorIfNotFullySent = false);
+    void send(const char* message, unsigned int clientIndex);
+    
+    /*!
+     * A function that sends a message of any type to a single client. The message may hold any bytes, including '\0'. An error will be thrown if the socket is not set, if the given index is out of range, or if an error occurs in sending the message.
+     *
+     * @param message The message to be sent.
+     * @param clientIndex An unsigned int indicating the index of the client to whom to send the message.
+     * @param type What the message holds.
+     */
+    void send(const std::string& message, unsigned int clientIndex, MessageType type);
+    
+    /*!
+     * A function that sends a message of any type to a single client, straight from the given bytes. An error will be thrown if the socket is not set, if the given index is out of range, or if an error occurs in sending the message.
+     *
+     * @param message The first byte of the message.
+     * @param length The number of bytes in the message.
+     * @param clientIndex An unsigned int indicating the index of the client to whom to send the message.
+     * @param type What the message holds.
+     */
+    void send(const char* message, size_t length, unsigned int clientIndex, MessageType type);
     
     /*!
-     * A function that sends a message to all clients. An error will be thrown if the socket is not set or if an error occurs in sending the message to any of the clients. If the optional parameter is set to true, an error will also be thrown if only part of the message was thrown.
+     * A function that sends a text message to all clients. An error will be thrown if the socket is not set or if an error occurs in sending the message to any of the clients.
      *
      * @param message The message to be sent, as a const char*.
-     * @param throwErrorIfNotFullySent An optional boolean indicating if an error should be thrown if only part of the message was sent. Automatically set to false.
      */
-    void broadcast(const char* message, bool throwErrorIfNotFullySent = false);
+    void broadcast(const char* message);
     
     /*!
-     * A function that receives a message from a single client. The function will wait for a short period for the client to send the message, and if the message is not received it will throw an error. An error is also thrown if the index is out of range or if the socket is not set.
+     * A function that receives a whole message from a single client, exactly as it was sent. The function will wait for the client to send the message, until the timeout set with setTimeout(), and if the message is not received it will throw an error. An error is also thrown if the index is out of range or if the socket is not set.
      *
      * @param clientIndex An unsigned int indicating the index of the client from whom to receive the message.
      * @param socketClosed An optional pointer to a bool that would be set to true if the client disconnected. Automatically set to a null pointer otherwise.
+     * @param type An optional pointer to a MessageType that is set to the type of the message. Automatically set to a null pointer otherwise.
      *
-     * @return The received message from the specified client as a std::string.
+     * @return The received message from the specified client as a std::string. Empty if the client disconnected.
      */
-    std::string receive(unsigned int clientIndex, bool* socketClosed = nullptr);
+    std::string receive(unsigned int clientIndex, bool* socketClosed = nullptr, MessageType* type = nullptr);
     
     /*!
      * A function that checks if all clients sent a specific message. This function calls ServerSocket::receive() so if another message has been sent that message may be received instead. This function throws no errors other than those called by ServerSocket::receive() or ServerSocket::closeConnection(). Any sockets where connection was lost are automatically closed. 
@@ -116,10 +206,37 @@ public:
     void setHostTimeout(unsigned int seconds, unsigned int milliseconds = 0);
     
     /*!
-     * @return The number of clients of this socket.
+     * A function to set whether a client is a spectator. Spectators are sent to and received from like any other client, but are not counted by numberOfClients(). If there is no client at that index, an error is thrown.
+     *
+     * @param clientIndex The index of the client.
+     * @param spectator Whether the client is a spectator.
+     */
+    void setSpectator(unsigned int clientIndex, bool spectator);
+    
+    /*!
+     * @param clientIndex The index of the client.
+     *
+     * @return Whether the client at that index is connected.
+     */
+    bool connected(unsigned int clientIndex);
+    
+    /*!
+     * @param clientIndex The index of the client.
+     *
+     * @return Whether the client at that index is connected as a spectator.
+     */
+    bool isSpectator(unsigned int clientIndex);
+    
+    /*!
+     * @return The number of clients of this socket, not counting spectators.
      */
     unsigned int numberOfClients();
     
+    /*!
+     * @return The number of spectators of this socket.
+     */
+    unsigned int numberOfSpectators();
+    
     /*!
      * @return If this object is set.
      */
@@ -145,11 +262,10 @@ private:
     addrinfo serverAddress;
     
     //These are "file descriptors", which store values from both the socket system call and the accept system call
-    int hostSocket;
-    
-    bool activeConnections[MAX_NUMBER_OF_CONNECTIONS]; //Initialized as all false. True if the connection of that index is an active connection
+    int hostSocket = -1; //-1 if this socket does not listen for connections
     
-    int clientSockets[MAX_NUMBER_OF_CONNECTIONS];
+    Transport transport = STREAM_TRANSPORT; //How clients connect to the host socket
+    std::deque<uint32_t> acceptedNonces; //The latest clients accepted over UDP, see DatagramChannel::accept()
     
     /* struct sockaddr_storage {
         sa_family_t ss_family; //Either AF_INET or AF_INET6
@@ -158,20 +274,127 @@ private:
      
      This struct is large enough that it can hold either an IPv4 or an IPv6 address (and be cast to either sockaddr_in or sockaddr_in6 if necessary)
      */
-    sockaddr_storage clientAddresses[MAX_NUMBER_OF_CONNECTIONS];
-    socklen_t clientAddressSizes[MAX_NUMBER_OF_CONNECTIONS];
+    
+    /*!
+     * Everything kept for one client.
+     */
+    struct Connection {
+        bool active = false; //True if this index is an active connection
+        bool spectator = false;
+        int socket = -1;
+        MessageFramer framer; //Splits the bytes from the client into messages, see MessageFramer.hpp
+        sockaddr_storage address;
+        socklen_t addressSize = 0;
+    };
+    
+    std::deque<Connection> connections; //A deque, so that the framers never move as the table grows. See ServerSocket.hpp
+    std::vector<unsigned int> freeIndices; //The indices of closed connections, reused last closed first
+    
+    unsigned int activePlayers = 0;
+    unsigned int activeSpectators = 0;
+
+#if defined(__linux__)
+    int eventQueue = -1; //The epoll instance that all of the sockets are registered with
+    std::vector<epoll_event> events; //Filled by epoll_wait(), kept between calls so that its memory is reused
+#else
+    std::vector<pollfd> pollSockets; //The sockets passed to poll(), kept between calls so that their memory is reused
+    std::vector<unsigned int> pollIndices; //The client index of each socket passed to poll()
+#endif
+    
+    //Marks the host socket in the event queue, since it is never a client index
+    constexpr static const unsigned int hostSocketIndex = 0xFFFFFFFF;
+    
+    bool accepting = false;
+    bool clientWaiting = false; //True if a client may be waiting to be accepted, since with edge-triggered events the host socket will not be reported again
+    
+    int receiveTimeout = -1; //In milliseconds, -1 to wait forever
+    int hostTimeout = -1; //In milliseconds, -1 to wait forever
     
     bool setUp = false; //Represents if the socket has already been set. If not, reading and writing will cause errors
     
     //Private member functions
     
     /*!
-     * A function to get the next index to which a client can connect. -1 is returned if there are no more available indices.
+     * A function to get the next index to which a client can connect, growing the table of connections if none are free. The index is taken, so it must be started with startConnection() or given back to freeIndices.
      *
      * @return The next available index.
      */
-    int getNextAvailableIndex();
+    unsigned int getNextAvailableIndex();
     
+    /*!
+     * Create the event queue, registering the host socket with it if there is one.
+     */
+    void setUpConnections();
+    
+    /*!
+     * Make a socket non-blocking. An error will be thrown if that fails.
+     *
+     * @param socket The file descriptor of the socket.
+     */
+    static void setNonBlocking(int socket);
+    
+#if defined(__linux__)
+    /*!
+     * Pack a socket and its index into the data of its epoll event. The socket is kept so that an event for a socket closed earlier in the same batch is not taken for the client that reused its index.
+     *
+     * @param socket The file descriptor of the socket.
+     * @param index The client index of the socket, or ServerSocket::hostSocketIndex.
+     *
+     * @return The data to register the socket with.
+     */
+    static uint64_t eventData(int socket, unsigned int index);
+#endif
+    
+    /*!
+     * Start using a newly connected client: give it an index, make it non-blocking, set up its framer, and register it for events. If it cannot be registered, the socket is closed and an error is thrown.
+     *
+     * @param clientSocket The file descriptor of the client.
+     * @param address The address of the client.
+     * @param addressSize The size of the address, or 0 if it is unknown.
+     * @param spectator Whether the client is a spectator.
+     *
+     * @return The index of the client.
+     */
+    unsigned int startConnection(int clientSocket, const sockaddr_storage& address, socklen_t addressSize, bool spectator);
+    
+    /*!
+     * Stop using a client without closing its socket, and free its index.
+     *
+     * @param clientIndex The index of the client.
+     */
+    void endConnection(unsigned int clientIndex);
+    
+    /*!
+     * Take the next client waiting on the host socket, over whichever transport it uses, without waiting.
+     *
+     * @param address Set to the address of the client.
+     * @param addressSize Set to the size of the address.
+     *
+     * @return The file descriptor of the client, or -1 with errno set if none is waiting or an error occurred.
+     */
+    int acceptClient(sockaddr_storage* address, socklen_t* addressSize);
+    
+    /*!
+     * Accept clients until none are waiting, no more files can be opened, or accepting is turned off.
+     *
+     * @return Whether any clients were accepted.
+     */
+    bool acceptClients(const ServerSocketHandlers& handlers);
+    
+    /*!
+     * Read whatever a client sent and hand each whole message to the handlers. If the client disconnected, the handlers are told and the connection is closed.
+     */
+    void readFromClient(unsigned int clientIndex, const ServerSocketHandlers& handlers);
+    
+    /*!
+     * Hand each whole message that has already been read from a client to the handlers. Stops if a handler closes the connection.
+     */
+    void dispatchMessages(unsigned int clientIndex, const ServerSocketHandlers& handlers);
+    
+    /*!
+     * Tell the handlers that a client disconnected, then close the connection.
+     */
+    void dropClient(unsigned int clientIndex, const ServerSocketHandlers& handlers);
 };
 
 #endif /* ServerSocket_hpp */
@@ -0,0 +1,190 @@
+//
+//  SlotMap.hpp
+//  Strategy Game
+//
+
+#ifndef SlotMap_hpp
+#define SlotMap_hpp
+
+#include <vector>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+//How a slot map works:
+//Values are kept packed together in one vector, so iterating over them is a linear pass with no gaps. Each value is reached from outside through a handle, which names a slot. The slot stores where the value currently is in the packed vector, so values can be moved around (a removed value is replaced by the last one) without invalidating any handle.
+//Each slot also has a generation, which is increased whenever its value is removed. A handle stores the generation it was created with, so a handle to a removed value will never find the value that later reuses its slot.
+
+/*!
+ * A container giving O(1) insertion, removal and lookup through stable handles, while keeping its values contiguous.
+ * Pointers and references to values are only valid until the next insertion or removal, since values are moved to stay packed. Keep handles instead.
+ */
+template <typename T>
+class SlotMap {
+public:
+    /*!
+     * A compact reference to a value in the slot map. The low bits are the slot index, the high bits are the slot's generation. SlotMap::null never refers to a value.
+     */
+    typedef unsigned int Handle;
+    
+    static const Handle null = 0;
+    
+    //Public member functions
+    
+    /*!
+     * Add a value to the slot map.
+     *
+     * @param value The value to copy into the slot map.
+     *
+     * @return A handle to the new value.
+     */
+    Handle insert(const T& value) {
+        unsigned int slot;
+        
+        if (this->firstFreeSlot != SlotMap::noSlot) { //Reuse a slot whose value has been removed
+            slot = this->firstFreeSlot;
+            this->firstFreeSlot = this->slots[slot].position;
+        } else {
+            if (this->slots.size() > SlotMap::indexMask)
+                throw std::length_error("Slot map is full");
+            
+            slot = (unsigned int)this->slots.size();
+            this->slots.push_back(Slot());
+        }
+        
+        this->slots[slot].position = (unsigned int)this->values.size();
+        this->values.push_back(value);
+        this->valueSlots.push_back(slot);
+        
+        return (this->slots[slot].generation << SlotMap::indexBits) | slot;
+    }
+    
+    /*!
+     * Remove a value from the slot map. The last value is moved into its place. Nothing happens if the handle does not refer to a value.
+     *
+     * @param handle The handle of the value to remove.
+     *
+     * @return Whether a value was removed.
+     */
+    bool erase(Handle handle) {
+        if (!this->contains(handle))
+            return false;
+        
+        unsigned int slot = handle & SlotMap::indexMask;
+        unsigned int position = this->slots[slot].position;
+        unsigned int lastPosition = (unsigned int)this->values.size() - 1;
+        
+        //Move the last value into the removed value's position, and point its slot at the new position
+        if (position != lastPosition) {
+            this->values[position] = std::move(this->values[lastPosition]);
+            this->valueSlots[position] = this->valueSlots[lastPosition];
+            this->slots[this->valueSlots[position]].position = position;
+        }
+        this->values.pop_back();
+        this->valueSlots.pop_back();
+        
+        //Retire the handle and add the slot to the free list. Generation 0 is skipped so that no handle is ever equal to SlotMap::null
+        this->slots[slot].generation = (this->slots[slot].generation + 1) & SlotMap::generationMask;
+        if (this->slots[slot].generation == 0)
+            this->slots[slot].generation = 1;
+        this->slots[slot].position = this->firstFreeSlot;
+        this->firstFreeSlot = slot;
+        
+        return true;
+    }
+    
+    /*!
+     * Remove all values. All existing handles become invalid.
+     */
+    void clear() {
+        while (!this->values.empty()) {
+            this->erase(this->handleAt(0));
+        }
+    }
+    
+    /*!
+     * @param handle The handle to check.
+     *
+     * @return Whether the handle refers to a value that is still in the slot map.
+     */
+    bool contains(Handle handle) const {
+        unsigned int slot = handle & SlotMap::indexMask;
+        return handle != SlotMap::null && slot < this->slots.size() && this->slots[slot].generation == handle >> SlotMap::indexBits;
+    }
+    
+    /*!
+     * @param handle The handle of the value to get.
+     *
+     * @return A pointer to the value, or nullptr if the handle does not refer to a value. The pointer is invalidated by the next insertion or removal.
+     */
+    T* get(Handle handle) {
+        return this->contains(handle) ? &this->values[this->slots[handle & SlotMap::indexMask].position] : nullptr;
+    }
+    
+    const T* get(Handle handle) const {
+        return this->contains(handle) ? &this->values[this->slots[handle & SlotMap::indexMask].position] : nullptr;
+    }
+    
+    /*!
+     * @param position The position of a value in the packed values, from 0 to size() - 1.
+     *
+     * @return The handle of the value at that position.
+     */
+    Handle handleAt(unsigned int position) const {
+        unsigned int slot = this->valueSlots[position];
+        return (this->slots[slot].generation << SlotMap::indexBits) | slot;
+    }
+    
+    /*!
+     * @param handle A handle to a value, or SlotMap::null.
+     *
+     * @return The slot the handle names, for indexing arrays that run alongside the slot map. Live values never share a slot.
+     */
+    static unsigned int slot(Handle handle) {
+        return handle & SlotMap::indexMask;
+    }
+    
+    /*!
+     * @return The number of values in the slot map.
+     */
+    unsigned int size() const {
+        return (unsigned int)this->values.size();
+    }
+    
+    /*!
+     * @return Whether the slot map has no values.
+     */
+    bool empty() const {
+        return this->values.empty();
+    }
+    
+    //Iteration goes through the packed values directly
+    typename std::vector<T>::iterator begin() { return this->values.begin(); }
+    typename std::vector<T>::iterator end() { return this->values.end(); }
+    typename std::vector<T>::const_iterator begin() const { return this->values.begin(); }
+    typename std::vector<T>::const_iterator end() const { return this->values.end(); }
+    
+private:
+    //Private properties
+    
+    static const unsigned int indexBits = 20; //Allows about a million slots, with 4095 generations before a slot's handles repeat
+    static const unsigned int indexMask = (1u << indexBits) - 1;
+    static const unsigned int generationMask = (1u << (32 - indexBits)) - 1;
+    static const unsigned int noSlot = 0xFFFFFFFF;
+    
+    struct Slot {
+        unsigned int position = 0; //Position of the value in SlotMap::values, or the next free slot if this slot is free
+        unsigned int generation = 1;
+    };
+    
+    std::vector<T> values; //Packed values
+    std::vector<unsigned int> valueSlots; //The slot of each value in SlotMap::values, so a moved value's slot can be updated
+    std::vector<Slot> slots;
+    
+    unsigned int firstFreeSlot = noSlot; //Head of the list of free slots, linked through Slot::position
+};
+
+template <typename T>
+const typename SlotMap<T>::Handle SlotMap<T>::null;
+
+#endif /* SlotMap_hpp */
@@ -0,0 +1,83 @@
+//
+//  SnapshotCache.cpp
+//  Strategy Game
+//
+
+#include "SnapshotCache.hpp"
+
+//Public member functions
+
+void SnapshotCache::reset(const Board& board) {
+    unsigned int numberOfTiles = board.width() * board.height(0);
+    
+    this->encodedTiles.clear();
+    this->tileStart.resize(numberOfTiles);
+    this->tileLength.assign(numberOfTiles, 0);
+    
+    this->numberOfChanges = 0;
+}
+
+bool SnapshotCache::changedTilesSince(const Board& board, unsigned int version, BitBoard& tiles, BitBoard& terrainTiles) {
+    for (unsigned int a = 0; a < this->numberOfChanges; a++) {
+        if (this->changes[a].first == version) {
+            tiles = this->changes[a].second;
+            terrainTiles = this->terrainChanges[a];
+            return this->changesKnown[a];
+        }
+    }
+    
+    if (this->numberOfChanges == this->changes.size()) {
+        this->changes.push_back(std::make_pair(version, BitBoard()));
+        this->terrainChanges.push_back(BitBoard());
+        this->changesKnown.push_back(false);
+    }
+    
+    std::pair<unsigned int, BitBoard>& found = this->changes[this->numberOfChanges];
+    BitBoard& foundTerrain = this->terrainChanges[this->numberOfChanges];
+    found.first = version;
+    if (found.second.width() == board.width() && found.second.height() == board.height(0)) {
+        found.second.clear();
+        foundTerrain.clear();
+    } else {
+        found.second = BitBoard(board.width(), board.height(0));
+        foundTerrain = BitBoard(board.width(), board.height(0));
+    }
+    this->changesKnown[this->numberOfChanges] = board.changedTilesSince(version, found.second, &foundTerrain);
+    this->numberOfChanges++;
+    
+    tiles = found.second;
+    terrainTiles = foundTerrain;
+    return this->changesKnown[this->numberOfChanges - 1];
+}
+
+void SnapshotCache::encodeTiles(const Board& board, const BitBoard& tiles, const BitBoard& interest, int viewer, ByteWriter& writer) {
+    std::vector<glm::ivec2> changed = tiles.tiles();
+    
+    writer.writeVarint((uint32_t)changed.size());
+    for (int a = 0; a < changed.size(); a++) {
+        unsigned int x = changed[a].x;
+        unsigned int y = changed[a].y;
+        
+        //Tiles with only their terrain are a few bytes, so they are not worth keeping
+        if (!interest.test(x, y)) {
+            board.encodeTile(x, y, false, writer);
+            continue;
+        }
+        
+        //The viewer's own creatures are written with their directions, which no other client is sent, so they are not kept either
+        const Creature* creature = board.viewUnchecked(x, y).creature();
+        if (creature != nullptr && (int)creature->controller() == viewer) {
+            board.encodeTile(x, y, true, writer, viewer);
+            continue;
+        }
+        
+        unsigned int tileIndex = x * board.height(0) + y;
+        if (this->tileLength[tileIndex] == 0) {
+            this->tileStart[tileIndex] = (uint32_t)this->encodedTiles.size();
+            board.encodeTile(x, y, true, this->encodedTiles, Board::noViewer);
+            this->tileLength[tileIndex] = (uint32_t)(this->encodedTiles.size() - this->tileStart[tileIndex]);
+        }
+        
+        writer.writeBytes(this->encodedTiles.data().data() + this->tileStart[tileIndex], this->tileLength[tileIndex]);
+    }
+}
@@ -0,0 +1,70 @@
+//
+//  SnapshotCache.hpp
+//  Strategy Game
+//
+
+#ifndef SnapshotCache_hpp
+#define SnapshotCache_hpp
+
+//Standard library includes
+#include <vector>
+#include <utility>
+
+#include <stdint.h>
+
+//Local includes
+#include "Board.hpp"
+#include "BitBoard.hpp"
+#include "ByteStream.hpp"
+
+/*!
+ * Shares the work of writing board updates between every client that is sent one in the same round. Each client is sent a different set of tiles, but a tile with its creature and building encodes to the same bytes for all of them, and every client at the same board version has the same changes to catch up on, so each is only worked out once and then copied.
+ */
+class SnapshotCache {
+public:
+    //Public member functions
+    
+    /*!
+     * Forget everything worked out so far. Call this at the start of each round of updates, since the board may have changed since the last one.
+     *
+     * @param board The board the updates are of.
+     */
+    void reset(const Board& board);
+    
+    /*!
+     * Find every tile that changed after a version of the board, like Board::changedTilesSince(), only searching once for each version until reset() is called.
+     *
+     * @param board The board the updates are of.
+     * @param version The board version the client has.
+     * @param tiles Set to the changed tiles.
+     * @param terrainTiles Set to the tiles whose terrain changed.
+     *
+     * @return Whether all of the changes were known.
+     */
+    bool changedTilesSince(const Board& board, unsigned int version, BitBoard& tiles, BitBoard& terrainTiles);
+    
+    /*!
+     * Write tiles in the format of Board::encodeTiles(), with the tiles that are not in the client's interest written with only their terrain, see Board::encodeTile(). Each tile that is written whole is only encoded once until reset() is called, and copied for every other client, unless it has one of the client's own creatures.
+     *
+     * @param board The board the updates are of.
+     * @param tiles The tiles to write.
+     * @param interest The tiles whose damage, creature and building the client is sent.
+     * @param viewer The player the tiles are written for, or Board::noViewer for a spectator. Only their creatures are written with the directions they are about to move in.
+     * @param writer The ByteWriter to write to.
+     */
+    void encodeTiles(const Board& board, const BitBoard& tiles, const BitBoard& interest, int viewer, ByteWriter& writer);
+    
+private:
+    //Private properties
+    
+    ByteWriter encodedTiles; //Every tile encoded whole since the last reset(), one after another
+    std::vector<uint32_t> tileStart; //Where each tile starts in encodedTiles, indexed like the board's tile arrays
+    std::vector<uint32_t> tileLength; //How long each tile is in encodedTiles, or 0 if it has not been encoded since the last reset()
+    
+    std::vector<std::pair<unsigned int, BitBoard> > changes; //The changed tiles found for each version since the last reset()
+    std::vector<BitBoard> terrainChanges; //The tiles whose terrain changed for each version in changes
+    std::vector<bool> changesKnown; //Whether all of the changes were known for each version in changes
+    unsigned int numberOfChanges = 0; //How many of changes are from since the last reset(). The rest are kept so that their memory is reused
+};
+
+#endif /* SnapshotCache_hpp */
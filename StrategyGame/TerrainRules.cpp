@@ -0,0 +1,223 @@
+//
+//  TerrainRules.cpp
+//  Strategy Game
+//
+
+#include "TerrainRules.hpp"
+
+//Defined here as well, so that they can be passed by reference
+const unsigned int TerrainRules::movementCostScale;
+constexpr const float TerrainRules::maximumMovementCost;
+
+//Built-in rules
+
+//Costs this high can never be paid, so the terrain cannot be attacked or seen into
+static constexpr float unpayable = 2147483647.0f;
+
+//Indexed by terrain (open, mountain, water, forest, hill, swamp, road), then race (human, elf, dwarf, orc, goblin, undead, vampire)
+static constexpr float builtInMovementCosts[NUMBER_OF_TERRAINS][NUMBER_OF_RACES] = {
+    {1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0},
+    {999.0, 999.0, 2.0, 999.0, 999.0, 999.0, 999.0}, //Only dwarves can enter mountains
+    {1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0}, //Water cannot be entered at all, see builtInCreaturePassable
+    {2.0, 1.0, 2.0, 2.0, 2.0, 2.0, 2.0}, //Elves travel through forest as though it were open
+    {2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0},
+    {3.0, 3.0, 3.0, 3.0, 3.0, 3.0, 3.0},
+    {0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5},
+};
+
+//The range it costs to attack or see from one terrain into another, indexed by origin terrain, then destination terrain. All attack styles currently use the same costs
+static constexpr float builtInRangeCosts[NUMBER_OF_TERRAINS][NUMBER_OF_TERRAINS] = {
+    {1, unpayable, 1, 2, 2, 1, 1},
+    {1, unpayable, 1, 2, 2, 1, 1},
+    {1, unpayable, 1, 2, 2, 1, 1},
+    {1, unpayable, 1, 2, 2, 1, 1},
+    {1, unpayable, 1, 1, 1, 1, 1}, //From a hill, forest and other hills can be seen and attacked into as if they were open
+    {1, unpayable, 1, 2, 2, 1, 1},
+    {1, unpayable, 1, 2, 2, 1, 1},
+};
+
+//Indexed by terrain, then race
+static constexpr bool builtInCreaturePassable[NUMBER_OF_TERRAINS][NUMBER_OF_RACES] = {
+    {true, true, true, true, true, true, true},
+    {false, false, true, false, false, false, false},
+    {false, false, false, false, false, false, false},
+    {true, true, true, true, true, true, true},
+    {true, true, true, true, true, true, true},
+    {true, true, true, true, true, true, true},
+    {true, true, true, true, true, true, true},
+};
+
+//Indexed by terrain, then attack style (melee, ranged, magic)
+static constexpr bool builtInAttackPassable[NUMBER_OF_TERRAINS][NUMBER_OF_ATTACK_STYLES] = {
+    {true, true, true},
+    {false, false, true}, //Only magic ignores mountains
+    {false, true, true}, //Melee attacks cannot cross water
+    {true, true, true},
+    {true, true, true},
+    {true, true, true},
+    {true, true, true},
+};
+
+static constexpr bool builtInVisionPassable[NUMBER_OF_TERRAINS] = {true, true, true, true, true, true, true};
+
+static constexpr float builtInDefenseModifiers[NUMBER_OF_TERRAINS] = {0.00, 0.50, 0.00, 0.20, 0.25, -0.20, 0.00};
+
+//Constructor
+
+TerrainRules::TerrainRules() {
+    for (int terrain = 0; terrain < NUMBER_OF_TERRAINS; terrain++) {
+        for (int race = 0; race < NUMBER_OF_RACES; race++) {
+            this->movementCosts[terrain][race] = builtInMovementCosts[terrain][race];
+            this->creaturePassable[terrain][race] = builtInCreaturePassable[terrain][race];
+        }
+        
+        for (int destination = 0; destination < NUMBER_OF_TERRAINS; destination++) {
+            for (int attackStyle = 0; attackStyle < NUMBER_OF_ATTACK_STYLES; attackStyle++) {
+                this->attackCosts[attackStyle][terrain][destination] = builtInRangeCosts[terrain][destination];
+            }
+            this->visionCosts[terrain][destination] = builtInRangeCosts[terrain][destination];
+        }
+        
+        for (int attackStyle = 0; attackStyle < NUMBER_OF_ATTACK_STYLES; attackStyle++) {
+            this->attackPassable[terrain][attackStyle] = builtInAttackPassable[terrain][attackStyle];
+        }
+        
+        this->visionPassable[terrain] = builtInVisionPassable[terrain];
+        this->defenseModifiers[terrain] = builtInDefenseModifiers[terrain];
+    }
+    
+    this->findCheapestMovementCosts();
+}
+
+//Public get functions
+
+const TerrainRules& TerrainRules::standard() {
+    static const TerrainRules rules;
+    return rules;
+}
+
+std::string TerrainRules::serialize() const {
+    //Every table is written in order, one value after another
+    std::string str = "TerrainRules:";
+    
+    //std::to_string() only keeps 6 decimal places, which does not always give back the same float. 12 places keep every cost above 0.001 exact, and TextReader::readFloat() reads them as they are
+    auto cost = [](float value) {
+        char number[64];
+        snprintf(number, sizeof(number), "%.12f,", value);
+        return std::string(number);
+    };
+    
+    for (int terrain = 0; terrain < NUMBER_OF_TERRAINS; terrain++)
+        for (int race = 0; race < NUMBER_OF_RACES; race++)
+            str += cost(this->movementCosts[terrain][race]);
+    
+    for (int attackStyle = 0; attackStyle < NUMBER_OF_ATTACK_STYLES; attackStyle++)
+        for (int origin = 0; origin < NUMBER_OF_TERRAINS; origin++)
+            for (int destination = 0; destination < NUMBER_OF_TERRAINS; destination++)
+                str += cost(this->attackCosts[attackStyle][origin][destination]);
+    
+    for (int origin = 0; origin < NUMBER_OF_TERRAINS; origin++)
+        for (int destination = 0; destination < NUMBER_OF_TERRAINS; destination++)
+            str += cost(this->visionCosts[origin][destination]);
+    
+    for (int terrain = 0; terrain < NUMBER_OF_TERRAINS; terrain++)
+        for (int race = 0; race < NUMBER_OF_RACES; race++)
+            str += std::to_string(this->creaturePassable[terrain][race]) + ",";
+    
+    for (int terrain = 0; terrain < NUMBER_OF_TERRAINS; terrain++)
+        for (int attackStyle = 0; attackStyle < NUMBER_OF_ATTACK_STYLES; attackStyle++)
+            str += std::to_string(this->attackPassable[terrain][attackStyle]) + ",";
+    
+    for (int terrain = 0; terrain < NUMBER_OF_TERRAINS; terrain++)
+        str += std::to_string(this->visionPassable[terrain]) + ",";
+    
+    for (int terrain = 0; terrain < NUMBER_OF_TERRAINS; terrain++)
+        str += cost(this->defenseModifiers[terrain]);
+    
+    return str + "-TerrainRules-";
+}
+
+TerrainRules TerrainRules::deserialize(const std::string& str) {
+    TextReader reader(str);
+    return TerrainRules::deserialize(reader);
+}
+
+TerrainRules TerrainRules::deserialize(TextReader& reader) {
+    reader.expect("TerrainRules:");
+    
+    TerrainRules rules;
+    
+    //Take the values in the same order that serialize() writes them
+    auto nextValue = [&reader]() {
+        return reader.readFloat(',');
+    };
+    
+    //Searches subtract costs from ranges and energy, so a cost that is negative or not finite would break them
+    auto nextCost = [&nextValue]() {
+        float cost = nextValue();
+        if (!std::isfinite(cost) || cost < 0)
+            throw std::range_error("Invalid cost in serialized string: " + std::to_string(cost));
+        return cost;
+    };
+    
+    //Movement costs are used in fixed point, so one that the scale cannot hold exactly would be searched with a different cost than the one loaded
+    auto nextMovementCost = [&nextCost]() {
+        float cost = nextCost();
+        float scaled = cost * TerrainRules::movementCostScale;
+        if (cost > TerrainRules::maximumMovementCost || scaled != std::floor(scaled))
+            throw std::range_error("Invalid movement cost in serialized string: " + std::to_string(cost));
+        return cost;
+    };
+    
+    for (int terrain = 0; terrain < NUMBER_OF_TERRAINS; terrain++)
+        for (int race = 0; race < NUMBER_OF_RACES; race++)
+            rules.movementCosts[terrain][race] = nextMovementCost();
+    
+    for (int attackStyle = 0; attackStyle < NUMBER_OF_ATTACK_STYLES; attackStyle++)
+        for (int origin = 0; origin < NUMBER_OF_TERRAINS; origin++)
+            for (int destination = 0; destination < NUMBER_OF_TERRAINS; destination++)
+                rules.attackCosts[attackStyle][origin][destination] = nextCost();
+    
+    for (int origin = 0; origin < NUMBER_OF_TERRAINS; origin++)
+        for (int destination = 0; destination < NUMBER_OF_TERRAINS; destination++)
+            rules.visionCosts[origin][destination] = nextCost();
+    
+    for (int terrain = 0; terrain < NUMBER_OF_TERRAINS; terrain++)
+        for (int race = 0; race < NUMBER_OF_RACES; race++)
+            rules.creaturePassable[terrain][race] = nextValue() != 0;
+    
+    for (int terrain = 0; terrain < NUMBER_OF_TERRAINS; terrain++)
+        for (int attackStyle = 0; attackStyle < NUMBER_OF_ATTACK_STYLES; attackStyle++)
+            rules.attackPassable[terrain][attackStyle] = nextValue() != 0;
+    
+    for (int terrain = 0; terrain < NUMBER_OF_TERRAINS; terrain++)
+        rules.visionPassable[terrain] = nextValue() != 0;
+    
+    for (int terrain = 0; terrain < NUMBER_OF_TERRAINS; terrain++) {
+        rules.defenseModifiers[terrain] = nextValue();
+        if (!std::isfinite(rules.defenseModifiers[terrain]))
+            throw std::range_error("Invalid defense modifier in serialized string");
+    }
+    
+    reader.skip("-TerrainRules-");
+    
+    rules.findCheapestMovementCosts();
+    return rules;
+}
+
+//Private member functions
+
+void TerrainRules::findCheapestMovementCosts() {
+    for (int race = 0; race < NUMBER_OF_RACES; race++) {
+        //A race that can enter nothing never moves, so any estimate is fine
+        this->cheapestMovementCosts[race] = 0;
+        bool found = false;
+        
+        for (int terrain = 0; terrain < NUMBER_OF_TERRAINS; terrain++) {
+            if (this->creaturePassable[terrain][race] && (!found || this->movementCosts[terrain][race] < this->cheapestMovementCosts[race])) {
+                this->cheapestMovementCosts[race] = this->movementCosts[terrain][race];
+                found = true;
+            }
+        }
+    }
+}
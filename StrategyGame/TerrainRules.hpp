@@ -0,0 +1,160 @@
+//
+//  TerrainRules.hpp
+//  Strategy Game
+//
+
+#ifndef TerrainRules_hpp
+#define TerrainRules_hpp
+
+#include <string>
+#include <exception>
+#include <stdexcept>
+#include <cmath>
+
+#include <stdio.h>
+
+#include "Creature.hpp"
+#include "Tile.hpp"
+
+//How terrain rules are stored:
+//Every rule that depends on terrain is a table, indexed by terrain and then by race or attack style where the rule depends on them. The built-in rules are constexpr tables in TerrainRules.cpp, and a TerrainRules object holds its own copy that can be replaced by deserializing a modded set of rules. Looking up a rule is then a single array access, with terrains outside of the tables treated like OPEN_TERRAIN.
+
+/*!
+ * The costs and restrictions of moving, attacking and seeing across each terrain. TerrainRules::standard() gives the built-in rules, and a Board uses its own copy, see Board::setTerrainRules().
+ */
+class TerrainRules {
+public:
+    //Constructor
+    
+    /*!
+     * Creates a copy of the built-in rules.
+     */
+    TerrainRules();
+    
+    //Public get functions
+    
+    /*!
+     * @return The built-in rules.
+     */
+    static const TerrainRules& standard();
+    
+    /*!
+     * @param terrain The terrain being moved into.
+     * @param race The race of the moving creature.
+     *
+     * @return The energy it costs to move into the terrain.
+     */
+    inline float movementCost(unsigned int terrain, Race race) const { return this->movementCosts[TerrainRules::row(terrain)][race]; }
+    
+    /*!
+     * @param race The race of the moving creature.
+     *
+     * @return The least energy it costs to move into any terrain the race can enter, so that searches can estimate distances without overestimating them.
+     */
+    inline float cheapestMovementCost(Race race) const { return this->cheapestMovementCosts[race]; }
+    
+    /*!
+     * @param originTerrain The terrain the attack is coming from.
+     * @param destinationTerrain The terrain the attack is going into.
+     * @param attackStyle The attack style of the attacking creature.
+     *
+     * @return The range it costs for an attack to go from one terrain into the other.
+     */
+    inline float attackCost(unsigned int originTerrain, unsigned int destinationTerrain, AttackStyle attackStyle) const { return this->attackCosts[attackStyle][TerrainRules::row(originTerrain)][TerrainRules::row(destinationTerrain)]; }
+    
+    /*!
+     * @param originTerrain The terrain being seen from.
+     * @param destinationTerrain The terrain being seen into.
+     *
+     * @return The vision range it costs to see from one terrain into the other.
+     */
+    inline float visionCost(unsigned int originTerrain, unsigned int destinationTerrain) const { return this->visionCosts[TerrainRules::row(originTerrain)][TerrainRules::row(destinationTerrain)]; }
+    
+    /*!
+     * @param terrain The terrain of the tile.
+     * @param race The race of the moving creature.
+     *
+     * @return Whether a creature of the race can enter the terrain. Whether the tile is occupied is not taken into account.
+     */
+    inline bool passableByCreature(unsigned int terrain, Race race) const { return this->creaturePassable[TerrainRules::row(terrain)][race]; }
+    
+    /*!
+     * @param terrain The terrain of the tile.
+     * @param attackStyle The attack style of the attacking creature.
+     *
+     * @return Whether an attack of the style can go through the terrain.
+     */
+    inline bool passableByAttackStyle(unsigned int terrain, AttackStyle attackStyle) const { return this->attackPassable[TerrainRules::row(terrain)][attackStyle]; }
+    
+    /*!
+     * @param terrain The terrain of the tile.
+     *
+     * @return Whether creatures can see through the terrain.
+     */
+    inline bool passableByVision(unsigned int terrain) const { return this->visionPassable[TerrainRules::row(terrain)]; }
+    
+    /*!
+     * @param terrain The terrain of the defender.
+     *
+     * @return The fraction subtracted from the attacker's combat modifier when attacking into the terrain.
+     */
+    inline float defenseModifier(unsigned int terrain) const { return this->defenseModifiers[TerrainRules::row(terrain)]; }
+    
+    /*!
+     * Serialize this object as a string that can be sent through sockets or saved with a mod. Costs are written with enough digits that deserializing them gives back the same floats, so a host and its clients search with exactly the same costs.
+     *
+     * @return The serialized string.
+     */
+    std::string serialize() const;
+    
+    /*!
+     * Create an object from a serialized string that can be sent through sockets. An invalid_argument exception is thrown if the string does not have a value for every rule, and a range_error if a cost is negative or not finite, or a movement cost is not a multiple of 1 / movementCostScale up to maximumMovementCost.
+     *
+     * @param str The string to convert into an object.
+     *
+     * @return The object created.
+     */
+    static TerrainRules deserialize(const std::string& str);
+    
+    /*!
+     * Create an object from a serialized string, as part of a longer message, such as a serialized Board.
+     *
+     * @param reader The TextReader to read from. It is moved past the object.
+     *
+     * @return The object created.
+     */
+    static TerrainRules deserialize(TextReader& reader);
+    
+    //Public properties
+    
+    static const unsigned int movementCostScale = 2; //Movement costs are multiples of 1 / movementCostScale, so that searches can add them up as whole numbers
+    constexpr static const float maximumMovementCost = 65535.0f; //Low enough that adding up the costs of a path in fixed point cannot overflow
+    
+private:
+    //Private properties
+    
+    float movementCosts[NUMBER_OF_TERRAINS][NUMBER_OF_RACES];
+    float attackCosts[NUMBER_OF_ATTACK_STYLES][NUMBER_OF_TERRAINS][NUMBER_OF_TERRAINS]; //Indexed by attack style, origin terrain, then destination terrain
+    float visionCosts[NUMBER_OF_TERRAINS][NUMBER_OF_TERRAINS]; //Indexed by origin terrain, then destination terrain
+    bool creaturePassable[NUMBER_OF_TERRAINS][NUMBER_OF_RACES];
+    bool attackPassable[NUMBER_OF_TERRAINS][NUMBER_OF_ATTACK_STYLES];
+    bool visionPassable[NUMBER_OF_TERRAINS];
+    float defenseModifiers[NUMBER_OF_TERRAINS];
+    float cheapestMovementCosts[NUMBER_OF_RACES]; //Found from the other tables whenever they are set, see findCheapestMovementCosts()
+    
+    //Private member functions
+    
+    /*!
+     * Find the cheapest movement cost of each race across the terrains it can enter.
+     */
+    void findCheapestMovementCosts();
+    
+    /*!
+     * @param terrain A terrain, which may not be in the tables.
+     *
+     * @return The row of the tables to use for the terrain. Unknown terrains use the OPEN_TERRAIN row.
+     */
+    static inline unsigned int row(unsigned int terrain) { return terrain < NUMBER_OF_TERRAINS ? terrain : OPEN_TERRAIN; }
+};
+
+#endif /* TerrainRules_hpp */
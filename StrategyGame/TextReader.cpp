@@ -0,0 +1,128 @@
+//
+//  TextReader.cpp
+//  Strategy Game
+//
+
+#include "TextReader.hpp"
+
+//Constructors
+
+TextReader::TextReader(const char* data, size_t length) : current(data), end(data + length) {}
+
+TextReader::TextReader(const std::string& data) : current(data.data()), end(data.data() + data.size()) {}
+
+//Public member functions
+
+bool TextReader::skip(const char* text) {
+    if (!this->startsWith(text))
+        return false;
+    
+    this->current += strlen(text);
+    return true;
+}
+
+void TextReader::expect(const char* text) {
+    if (!this->skip(text))
+        throw std::invalid_argument("Expected \"" + std::string(text) + "\" in serialized string");
+}
+
+int TextReader::readInt(char delimiter) {
+    bool negative = false;
+    if (this->current < this->end && (*this->current == '-' || *this->current == '+')) {
+        negative = *this->current == '-';
+        this->current++;
+    }
+    
+    const char* digits = this->current;
+    long long value = 0;
+    while (this->current < this->end && *this->current >= '0' && *this->current <= '9') {
+        value = value * 10 + (*this->current - '0');
+        if (value > (long long)INT_MAX + 1)
+            throw std::out_of_range("Number too large in serialized string");
+        this->current++;
+    }
+    
+    if (this->current == digits)
+        throw std::invalid_argument("Expected a number in serialized string");
+    
+    if (negative)
+        value = -value;
+    if (value > INT_MAX)
+        throw std::out_of_range("Number too large in serialized string");
+    
+    this->skipDelimiter(delimiter);
+    return (int)value;
+}
+
+float TextReader::readFloat(char delimiter) {
+    //Find where the number ends, so that strtof() is only given the number itself
+    const char* start = this->current;
+    const char* position = start;
+    if (position < this->end && (*position == '-' || *position == '+'))
+        position++;
+    while (position < this->end && ((*position >= '0' && *position <= '9') || *position == '.'))
+        position++;
+    
+    //std::to_string() writes floats with 6 decimal places, so anything longer than this is not a float it wrote
+    char number[64];
+    size_t length = position - start;
+    if (length == 0 || length >= sizeof(number))
+        throw std::invalid_argument("Expected a number in serialized string");
+    
+    memcpy(number, start, length);
+    number[length] = '\0';
+    
+    char* numberEnd;
+    float value = strtof(number, &numberEnd);
+    if (numberEnd != number + length)
+        throw std::invalid_argument("Expected a number in serialized string");
+    
+    this->current = position;
+    this->skipDelimiter(delimiter);
+    return value;
+}
+
+std::string TextReader::readString(char delimiter) {
+    const char* stringEnd = this->find(delimiter);
+    std::string str(this->current, stringEnd);
+    this->current = stringEnd == this->end ? this->end : stringEnd + 1;
+    return str;
+}
+
+TextReader TextReader::readUntil(char delimiter) {
+    const char* textEnd = this->find(delimiter);
+    TextReader text(this->current, textEnd - this->current);
+    this->current = textEnd == this->end ? this->end : textEnd + 1;
+    return text;
+}
+
+//Public get functions
+
+bool TextReader::startsWith(const char* text) const {
+    size_t length = strlen(text);
+    return length <= (size_t)(this->end - this->current) && memcmp(this->current, text, length) == 0;
+}
+
+char TextReader::peek() const {
+    return this->current < this->end ? *this->current : '\0';
+}
+
+bool TextReader::atEnd() const {
+    return this->current == this->end;
+}
+
+size_t TextReader::remaining() const {
+    return this->end - this->current;
+}
+
+//Private member functions
+
+void TextReader::skipDelimiter(char delimiter) {
+    if (delimiter == '\0')
+        return;
+    
+    if (this->current == this->end || *this->current != delimiter)
+        throw std::invalid_argument(std::string("Expected '") + delimiter + "' in serialized string");
+    
+    this->current++;
+}
@@ -0,0 +1,134 @@
+//
+//  TextReader.hpp
+//  Strategy Game
+//
+
+#ifndef TextReader_hpp
+#define TextReader_hpp
+
+#include <string>
+#include <exception>
+#include <stdexcept>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+/*!
+ * Reads the serialized strings sent through sockets. The reader only points at the text and moves forward through it, so parsing a whole message is linear in its length and nothing is copied except the strings that are returned. The text must stay alive and unchanged while it is used. Malformed text throws an invalid_argument exception, and numbers too large for an int throw an out_of_range exception, as std::stoi() does.
+ */
+class TextReader {
+public:
+    //Constructors
+    
+    /*!
+     * @param data The first character to read.
+     * @param length The number of characters that can be read.
+     */
+    TextReader(const char* data, size_t length);
+    
+    /*!
+     * @param data The text to read. It is not copied, so the string must outlive the reader.
+     */
+    TextReader(const std::string& data);
+    
+    //Public member functions
+    
+    /*!
+     * Move past the given text if it comes next.
+     *
+     * @param text The text to look for.
+     *
+     * @return Whether the text came next and was skipped.
+     */
+    bool skip(const char* text);
+    
+    /*!
+     * Move past the given text, throwing an invalid_argument exception if it does not come next.
+     *
+     * @param text The text that must come next.
+     */
+    void expect(const char* text);
+    
+    /*!
+     * Read a whole number, as written by std::to_string().
+     *
+     * @param delimiter A character that must come after the number, which is skipped too. '\0' if nothing is expected.
+     *
+     * @return The number read.
+     */
+    int readInt(char delimiter = '\0');
+    
+    /*!
+     * Read a decimal number, as written by std::to_string().
+     *
+     * @param delimiter A character that must come after the number, which is skipped too. '\0' if nothing is expected.
+     *
+     * @return The number read.
+     */
+    float readFloat(char delimiter = '\0');
+    
+    /*!
+     * Read the text up to the delimiter, or to the end if there is no delimiter. The delimiter is skipped.
+     *
+     * @param delimiter The character that ends the string.
+     *
+     * @return A copy of the text read.
+     */
+    std::string readString(char delimiter);
+    
+    /*!
+     * Split off the text up to the delimiter, or to the end if there is no delimiter, without copying it. The delimiter is skipped.
+     *
+     * @param delimiter The character that ends the text.
+     *
+     * @return A reader over only the text before the delimiter.
+     */
+    TextReader readUntil(char delimiter);
+    
+    //Public get functions
+    
+    /*!
+     * @param text The text to look for.
+     *
+     * @return Whether the given text comes next. Nothing is skipped.
+     */
+    bool startsWith(const char* text) const;
+    
+    /*!
+     * @return The next character, without skipping it. '\0' if all of the text has been read.
+     */
+    char peek() const;
+    
+    /*!
+     * @return Whether all of the text has been read.
+     */
+    bool atEnd() const;
+    
+    /*!
+     * @return The number of characters that have not been read yet.
+     */
+    size_t remaining() const;
+    
+private:
+    //Private properties
+    
+    const char* current;
+    const char* end;
+    
+    //Private member functions
+    
+    /*!
+     * Skip the delimiter after a number, throwing an invalid_argument exception if something else comes next. Nothing happens if the delimiter is '\0'.
+     */
+    void skipDelimiter(char delimiter);
+    
+    /*!
+     * @return The first occurrence of the character at or after the current position, or the end of the text if there is none.
+     */
+    inline const char* find(char character) const {
+        const char* found = (const char*)memchr(this->current, character, this->end - this->current);
+        return found != nullptr ? found : this->end;
+    }
+};
+
+#endif /* TextReader_hpp */
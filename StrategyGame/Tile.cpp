@@ -7,6 +7,7 @@
 //
 
 #include "Tile.hpp"
+#include "TerrainRules.hpp"
 
 //Constructors
 Tile::Tile(int terrain, unsigned int x, unsigned int y) : tileX(x), tileY(y) {
@@ -62,13 +63,33 @@ bool Tile::occupied() const {
     return this->tileCreature != nullptr ? true : this->tileBuilding ? true : false;
 }
 
-//Currently this returns the basic stick figure creature whenever there is any creature.
 unsigned int Tile::creatureType() const {
-    if (this->tileCreature == nullptr) {
+    return Tile::creatureType(this->tileCreature);
+}
+
+unsigned int Tile::buildingType() const {
+    return Tile::buildingType(this->tileBuilding);
+}
+
+bool Tile::passableByCreature(const Creature& creature) const {
+    return Tile::passableByCreature(this->tileTerrain, this->occupied(), creature);
+}
+
+bool Tile::passableByAttackStyle(const Creature& creature) const {
+    return Tile::passableByAttackStyle(this->tileTerrain, creature);
+}
+
+bool Tile::passableByVision(const Creature& creature) const {
+    return Tile::passableByVision(this->tileTerrain, creature);
+}
+
+//Currently this returns the basic stick figure creature whenever there is any creature.
+unsigned int Tile::creatureType(const Creature* creature) {
+    if (creature == nullptr) {
         return NO_CREATURE;
-    } else if (this->creature()->attackStyle() == Magic) {
+    } else if (creature->attackStyle() == Magic) {
         return MAGE_CREATURE;
-    } else if (this->creature()->attackStyle() == Ranged) {
+    } else if (creature->attackStyle() == Ranged) {
         return ARCHER_CREATURE;
     } else {
         return MELEE_CREATURE;
@@ -76,49 +97,21 @@ unsigned int Tile::creatureType() const {
 }
 
 //Currently this returns the basic tower building whenever there is any building.
-unsigned int Tile::buildingType() const {
-    if (this->tileBuilding == nullptr) {
+unsigned int Tile::buildingType(const Building* building) {
+    if (building == nullptr) {
         return NO_BUILDING;
     } else {
         return TOWER_BUILDING;
     }
 }
 
-bool Tile::passableByCreature(const Creature& creature) const {
-    //Mountains are not passable (except by dwarves)
-    if (this->tileTerrain == MOUNTAIN_TERRAIN && creature.race() != Dwarf) {
-        return false;
-    }
-    
-    //Water is never passable
-    if (this->tileTerrain == WATER_TERRAIN) {
-        return false;
-    }
-    
+//The static versions use the built-in terrain rules. Boards use their own rules, see TileView
+bool Tile::passableByCreature(unsigned int terrain, bool occupied, const Creature& creature) {
     //Tiles with creatures are never passable
-    if (this->occupied()) {
-        return false;
-    }
-    
-    //Everything else is passable
-    return true;
+    return !occupied && TerrainRules::standard().passableByCreature(terrain, creature.race());
 }
 
-bool Tile::passableByAttackStyle(const Creature& creature) const {
-    //Mountains are not passable (except by terrain ignoring spells)
-    if (this->tileTerrain == MOUNTAIN_TERRAIN) {
-        if (creature.attackStyle() != Magic) {
-            return false;
-        }
-    }
-    
-    //Water is not passable by melee attacks.
-    if (this->tileTerrain == WATER_TERRAIN) {
-        if (creature.attackStyle() == Melee) {
-            return false;
-        }
-    }
-    
+bool Tile::passableByAttackStyle(unsigned int terrain, const Creature& creature) {
     /*
     //Tiles with large creatures are never passable
     if (this->creature.creatureCharacteristics {includes blocking}  ()) {
@@ -129,13 +122,11 @@ bool Tile::passableByAttackStyle(const Creature& creature) const {
      
     */
     
-    //Everything else is passable
-    return true;
+    return TerrainRules::standard().passableByAttackStyle(terrain, creature.attackStyle());
 }
 
-bool Tile::passableByVision(const Creature& creature) const {
-    //This function will be used for later functionality. DO NOT REMOVE.
-    return true;
+bool Tile::passableByVision(unsigned int terrain, const Creature& creature) {
+    return TerrainRules::standard().passableByVision(terrain);
 }
 
 unsigned int Tile::damage() const {
@@ -150,19 +141,39 @@ std::string Tile::serialize() const {
     return "Tile:" + std::to_string(this->tileX) + "," + std::to_string(this->tileY) + "," + std::to_string(this->tileTerrain) + "," + std::to_string(this->tileDamage) + "," + std::to_string(this->damageHitTime) + "-Tile-";
 }
 
-Tile Tile::deserialize(std::string str) {
-    str.erase(0, 5); //To erase "Tile:"
-    std::string num = str.substr(0, str.find_first_of(','));
-    int x = std::stoi(num);
-    str = str.substr(str.find_first_of(',') + 1);
-    int y = std::stoi(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
-    int terrain = std::stoi(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
-    int damage = std::stoi(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
-    float damageTime = std::stof(str.substr(0, str.find_first_of(',')));
-    str = str.substr(str.find_first_of(',') + 1);
+Tile Tile::deserialize(const std::string& str) {
+    TextReader reader(str);
+    return Tile::deserialize(reader);
+}
+
+Tile Tile::deserialize(TextReader& reader) {
+    reader.expect("Tile:");
+    int x = reader.readInt(',');
+    int y = reader.readInt(',');
+    int terrain = reader.readInt(',');
+    int damage = reader.readInt(',');
+    float damageTime = reader.readFloat();
+    reader.skip("-Tile-");
+    
+    Tile tile(terrain, x, y);
+    tile.setDamage(damage, damageTime);
+    return tile;
+}
+
+void Tile::encode(ByteWriter& writer) const {
+    writer.writeVarint(this->tileX);
+    writer.writeVarint(this->tileY);
+    writer.writeByte(this->tileTerrain);
+    writer.writeVarint(this->tileDamage);
+    writer.writeFloat(this->damageHitTime);
+}
+
+Tile Tile::decode(ByteReader& reader) {
+    unsigned int x = reader.readVarint();
+    unsigned int y = reader.readVarint();
+    unsigned int terrain = reader.readByte();
+    unsigned int damage = reader.readVarint();
+    float damageTime = reader.readFloat();
     
     Tile tile(terrain, x, y);
     tile.setDamage(damage, damageTime);
@@ -30,6 +30,7 @@
 #define HILL_TERRAIN 4
 #define SWAMP_TERRAIN 5
 #define ROAD_TERRAIN 6
+#define NUMBER_OF_TERRAINS 7 //Terrains are numbered from 0 up to this, for the tables in TerrainRules
 //to add creature movement modifiers in terrain it needs to be set up as a creature stat.
 //#define CARROT_TREE_TERRAIN 7 //When Truell someday looks through the codebase, he will find this edit, and he will be satisfied.
 
@@ -145,6 +146,47 @@ public:
      */
     bool passableByVision(const Creature& creature) const;
     
+    //Static functions, shared with TileView so that both agree on the rules
+    
+    /*!
+     * @param creature A pointer to the creature to check, or nullptr.
+     *
+     * @return The type of the creature, indicating which texture to use to the openGL VBO. NO_CREATURE is returned if the pointer is null.
+     */
+    static unsigned int creatureType(const Creature* creature);
+    
+    /*!
+     * @param building A pointer to the building to check, or nullptr.
+     *
+     * @return The type of the building, indicating which texture to use to the openGL VBO. NO_BUILDING is returned if the pointer is null.
+     */
+    static unsigned int buildingType(const Building* building);
+    
+    /*!
+     * @param terrain The terrain of the tile.
+     * @param occupied Whether there is a creature or building on the tile.
+     * @param creature The creature trying to move onto the tile.
+     *
+     * @return A boolean representing whether the creature would be able to go through a tile with the given properties.
+     */
+    static bool passableByCreature(unsigned int terrain, bool occupied, const Creature& creature);
+    
+    /*!
+     * @param terrain The terrain of the tile.
+     * @param creature The creature attacking through the tile.
+     *
+     * @return A boolean representing whether an attack style would be able to go through a tile with the given terrain.
+     */
+    static bool passableByAttackStyle(unsigned int terrain, const Creature& creature);
+    
+    /*!
+     * @param terrain The terrain of the tile.
+     * @param creature The creature seeing through the tile.
+     *
+     * @return A boolean representing whether a creature can see through a tile with the given terrain.
+     */
+    static bool passableByVision(unsigned int terrain, const Creature& creature);
+    
     /*!
      * @return The damage amount at this tile.
      */
@@ -169,7 +211,32 @@ public:
      *
      * @return The object created.
      */
-    static Tile deserialize(std::string str);
+    static Tile deserialize(const std::string& str);
+    
+    /*!
+     * Create an object from a serialized string, as part of a longer message.
+     *
+     * @param reader The TextReader to read from. It is moved past the object.
+     *
+     * @return The object created.
+     */
+    static Tile deserialize(TextReader& reader);
+    
+    /*!
+     * Write this object in the binary format, which is much smaller than the serialized string and is read in linear time. See ByteStream.hpp.
+     *
+     * @param writer The ByteWriter to write to.
+     */
+    void encode(ByteWriter& writer) const;
+    
+    /*!
+     * Create an object from bytes written by encode(). A range_error is thrown if the bytes end early, and an invalid_argument exception if they hold an impossible value.
+     *
+     * @param reader The ByteReader to read from. It is moved past the object.
+     *
+     * @return The object created.
+     */
+    static Tile decode(ByteReader& reader);
     
     //I think we should impliment these later because they may be complex to program without that much reward
     //const bool vision() { return this->blocksVision; }
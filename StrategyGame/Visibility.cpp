@@ -0,0 +1,89 @@
+//
+//  Visibility.cpp
+//  Strategy Game
+//
+
+#include "Visibility.hpp"
+
+//Constructor
+
+Visibility::Visibility(unsigned int width, unsigned int height) : height(height), seenCount(width * height, 0), visibleTiles(width, height), exploredTiles(width, height) {
+    this->numRegionsWide = (width + Visibility::regionSize - 1) / Visibility::regionSize;
+    this->numRegionsHigh = (height + Visibility::regionSize - 1) / Visibility::regionSize;
+    this->regionChanges.assign(this->numRegionsWide * this->numRegionsHigh, 0);
+}
+
+//Public member functions
+
+void Visibility::addFootprint(const std::vector<unsigned int>& footprint) {
+    for (int a = 0; a < footprint.size(); a++) {
+        unsigned int tileIndex = footprint[a];
+        
+        if (tileIndex >= this->seenCount.size())
+            throw std::range_error("Tile index out of range: " + std::to_string(tileIndex));
+        
+        //Only the first creature to see a tile changes the sets
+        if (this->seenCount[tileIndex]++ == 0) {
+            this->visibleTiles.setIndex(tileIndex);
+            this->exploredTiles.setIndex(tileIndex);
+            this->tileChanged(tileIndex);
+        }
+    }
+}
+
+void Visibility::removeFootprint(const std::vector<unsigned int>& footprint) {
+    for (int a = 0; a < footprint.size(); a++) {
+        unsigned int tileIndex = footprint[a];
+        
+        if (tileIndex >= this->seenCount.size())
+            throw std::range_error("Tile index out of range: " + std::to_string(tileIndex));
+        
+        if (this->seenCount[tileIndex] == 0) //The footprint was never added
+            continue;
+        
+        //Only the last creature to stop seeing a tile changes the set
+        if (--this->seenCount[tileIndex] == 0) {
+            this->visibleTiles.resetIndex(tileIndex);
+            this->tileChanged(tileIndex);
+        }
+    }
+}
+
+//Public get functions
+
+const BitBoard& Visibility::visible() const {
+    return this->visibleTiles;
+}
+
+const BitBoard& Visibility::explored() const {
+    return this->exploredTiles;
+}
+
+unsigned int Visibility::version() const {
+    return this->changes;
+}
+
+unsigned int Visibility::regionsWide() const {
+    return this->numRegionsWide;
+}
+
+unsigned int Visibility::regionsHigh() const {
+    return this->numRegionsHigh;
+}
+
+unsigned int Visibility::regionVersion(unsigned int regionX, unsigned int regionY) const {
+    if (regionX >= this->numRegionsWide || regionY >= this->numRegionsHigh)
+        throw std::range_error("Region out of range: " + std::to_string(regionX) + ", " + std::to_string(regionY));
+    
+    return this->regionChanges[regionX * this->numRegionsHigh + regionY];
+}
+
+//Private member functions
+
+void Visibility::tileChanged(unsigned int tileIndex) {
+    unsigned int regionX = tileIndex / this->height / Visibility::regionSize;
+    unsigned int regionY = tileIndex % this->height / Visibility::regionSize;
+    
+    this->regionChanges[regionX * this->numRegionsHigh + regionY]++;
+    this->changes++;
+}
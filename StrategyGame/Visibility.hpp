@@ -0,0 +1,115 @@
+//
+//  Visibility.hpp
+//  Strategy Game
+//
+
+#ifndef Visibility_hpp
+#define Visibility_hpp
+
+#include <vector>
+#include <exception>
+#include <stdexcept>
+
+#include "BitBoard.hpp"
+
+//How visibility is tracked:
+//Each tile counts how many of the player's creatures can see it. A creature's vision footprint is added when it is placed and removed when it dies, and when it moves only the old footprint is removed and the new one added. A tile is visible while its count is above 0, and explored once it has ever been visible. Nothing is recomputed for creatures that have not moved.
+//The board is also split into square regions of Visibility::regionSize tiles, each with its own version, which only changes when a tile in it becomes visible, hidden or explored. A footprint that moves by a tile changes the counts of many tiles but the sets of only a few, so anything built from the sets only needs to update those regions.
+
+/*!
+ * The fog of war of one player: which tiles the player's creatures can currently see, and which tiles they have ever seen. Kept up to date by the Board as creatures are set, moved and deleted. See Board::visibility().
+ */
+class Visibility {
+public:
+    //Constructor
+    
+    /*!
+     * Creates a visibility with nothing visible or explored.
+     *
+     * @param width The x-side width of the board.
+     * @param height The y-side height of the board.
+     */
+    Visibility(unsigned int width = 0, unsigned int height = 0);
+    
+    //Public properties
+    
+    static const unsigned int regionSize = 8; //The width and height of the regions that have their own versions, see regionVersion()
+    
+    //Public member functions
+    
+    /*!
+     * Add a creature's vision to the visible tiles. Every tile is also marked explored.
+     *
+     * @param footprint The tile indices the creature can see, indexed like the board's tile arrays (x * height + y).
+     */
+    void addFootprint(const std::vector<unsigned int>& footprint);
+    
+    /*!
+     * Remove a creature's vision from the visible tiles. Tiles stay visible if another creature still sees them, and always stay explored.
+     *
+     * @param footprint The same tile indices that were given to addFootprint().
+     */
+    void removeFootprint(const std::vector<unsigned int>& footprint);
+    
+    //Public get functions
+    
+    /*!
+     * @return The tiles that can currently be seen.
+     */
+    const BitBoard& visible() const;
+    
+    /*!
+     * @return The tiles that have been seen at any point, including the ones that can currently be seen.
+     */
+    const BitBoard& explored() const;
+    
+    /*!
+     * @return A number that changes every time the visible or explored tiles change, so that anything built from them only needs updating when it does.
+     */
+    unsigned int version() const;
+    
+    /*!
+     * @return The number of regions across the x-side of the board. Regions are Visibility::regionSize tiles wide, and the last one may be narrower.
+     */
+    unsigned int regionsWide() const;
+    
+    /*!
+     * @return The number of regions across the y-side of the board.
+     */
+    unsigned int regionsHigh() const;
+    
+    /*!
+     * @param regionX The x index of the region, covering tiles from regionX * Visibility::regionSize.
+     * @param regionY The y index of the region.
+     *
+     * @return A number that changes every time a tile in the region becomes visible, hidden or explored.
+     */
+    unsigned int regionVersion(unsigned int regionX, unsigned int regionY) const;
+    
+private:
+    //Private properties
+    
+    unsigned int height;
+    
+    std::vector<unsigned short> seenCount; //Number of creatures that see each tile, indexed like the board's tile arrays
+    
+    BitBoard visibleTiles;
+    BitBoard exploredTiles;
+    
+    unsigned int changes = 0;
+    
+    unsigned int numRegionsWide;
+    unsigned int numRegionsHigh;
+    std::vector<unsigned int> regionChanges; //Version of each region, indexed by regionX * numRegionsHigh + regionY
+    
+    //Private member functions
+    
+    /*!
+     * Record that a tile became visible, hidden or explored.
+     *
+     * @param tileIndex The index of the tile, like the board's tile arrays.
+     */
+    void tileChanged(unsigned int tileIndex);
+};
+
+#endif /* Visibility_hpp */
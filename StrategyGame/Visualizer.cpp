@@ -200,6 +200,33 @@ glm::ivec2 Visualizer::getTile() {
     return this->getTile(this->window->cursorPos());
 }
 
+bool Visualizer::tilesOnScreen(glm::ivec2* minTile, glm::ivec2* maxTile) {
+    bool found = false;
+    
+    for (GLuint index = 0; index < this->numberOfTiles; index++) {
+        //The same transformation as getTile(), which puts the part of the window that shows the board between -1 and 1
+        glm::vec4 center = this->projection * this->view * this->model * glm::vec4(this->vertexData[2 * index], this->vertexData[(2 * index) + 1], 0.0f, 1.0f);
+        
+        if (center.x < -1.0f || center.x > 1.0f || center.y < -1.0f || center.y > 1.0f)
+            continue;
+        
+        glm::ivec2 tile = glm::ivec2(index / this->boardHeight, index % this->boardHeight);
+        
+        if (!found) {
+            *minTile = tile;
+            *maxTile = tile;
+            found = true;
+        } else {
+            minTile->x = std::min(minTile->x, tile.x);
+            minTile->y = std::min(minTile->y, tile.y);
+            maxTile->x = std::max(maxTile->x, tile.x);
+            maxTile->y = std::max(maxTile->y, tile.y);
+        }
+    }
+    
+    return found;
+}
+
 //void Visualizer::startFrame() {
 //    //At the start of each frame, if the mouse has been clicked, then mouseDown will be set to true
 //    if (mouseJustPressed) {
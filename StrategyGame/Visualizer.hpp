@@ -184,6 +184,16 @@ public:
     glm::ivec2 getTile();
     glm::ivec2 getTile(glm::dvec2 pos);
     
+    /*!
+     * A function to find the tiles that are on the screen, as the smallest rectangle of tile coordinates containing every tile whose center is in the part of the window that shows the board. Since the board is drawn rotated, the rectangle also has tiles past the corners of the screen.
+     *
+     * @param minTile A pointer to a glm::ivec2 to be set to the corner of the rectangle with the lowest coordinates.
+     * @param maxTile A pointer to a glm::ivec2 to be set to the corner of the rectangle with the highest coordinates.
+     *
+     * @return Whether any tile is on the screen. If not, the corners are not set.
+     */
+    bool tilesOnScreen(glm::ivec2* minTile, glm::ivec2* maxTile);
+    
 //    /*!
 //     * A function that should be called at the beginning of each frame from the larger class, in this case client.
 //     * If not, errors involving the mouse being pressed will occur.
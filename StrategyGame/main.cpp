@@ -63,7 +63,6 @@ void resizeCallback(GLFWwindow *window, int width, int height);
 //Functions
 void updateMouse();
 void host(bool* done);
-void threadAddPlayer(bool *done, bool *failed, Host* host);
 
 
 int main(int argc, const char * argv[]) {
@@ -182,144 +181,56 @@ void updateMouse() {
 }
 
 void host(bool* done) {
-    
-    //Gameboard:
-    std::vector<std::vector<Tile> > board;
-    for (GLint x = 0; x < BOARD_WIDTH; x++) {
-        std::vector<Tile> row;
-        for (GLint y = 0; y < BOARD_WIDTH; y++) {
-            if ((x == 3 && y == BOARD_WIDTH - 1 - 3) || (x == 4 && y == BOARD_WIDTH - 1 - 4) || (x == BOARD_WIDTH - 1 - 3 && y == 3) || (x == BOARD_WIDTH - 1 - 4 && y == 4))
-                row.push_back(Tile(MOUNTAIN_TERRAIN, x, y));
-            else if (x >= y - 1 && x <= y + 1)
-                row.push_back(Tile(FOREST_TERRAIN, x, y));
-            else
-                row.push_back(Tile(OPEN_TERRAIN, x, y));
-        }
-        board.push_back(row);
-    }
-    
-    Host H(board);
+    Host H(Host::standardBoard());
     H.set(PORT);
     
-    //Reminder: Creature(x, y, Race, maxHealth, maxEnergy, attack, attackStyle, vision, range, startDirection, controller)
-    
-    int boardBack = BOARD_WIDTH - 1; //Represents the opposite index of the board.
-    
-    //Player 1
-    
-    H.board.setCreature(Creature(0, boardBack - 2, Human, 4, 4, 3, Melee,  1, 1, WEST, 0));
-    H.board.setCreature(Creature(1, boardBack - 2, Human, 4, 4, 1, Melee,  1, 1, WEST, 0));
-    H.board.setCreature(Creature(2, boardBack - 2, Human, 4, 4, 3, Melee,  1, 1, WEST, 0));
-    H.board.setCreature(Creature(2, boardBack - 1, Human, 4, 4, 3, Melee,  1, 1, WEST, 0));
-    H.board.setCreature(Creature(2, boardBack,     Human, 4, 4, 3, Melee,  1, 1, WEST, 0));
-    
-    H.board.setCreature(Creature(0, boardBack - 1, Human, 2, 4, 2, Ranged, 1, 4, WEST, 0));
-    H.board.setCreature(Creature(1, boardBack,     Human, 2, 4, 2, Ranged, 1, 4, WEST, 0));
-    
-    H.board.setCreature(Creature(1, boardBack - 1, Human, 3, 2, 1, Magic,  1, 1, WEST, 0));
-    H.board.get(1, boardBack - 1).creature()->addButton("mage_strike_from_", "Fireball");
-    
-    //Player 2
-    
-    H.board.setCreature(Creature(boardBack - 2, 0, Human, 4, 4, 3, Melee,  1, 1, EAST, 1));
-    H.board.setCreature(Creature(boardBack - 2, 1, Human, 4, 4, 1, Melee,  1, 1, EAST, 1));
-    H.board.setCreature(Creature(boardBack - 2, 2, Human, 4, 4, 3, Melee,  1, 1, EAST, 1));
-    H.board.setCreature(Creature(boardBack - 1, 2, Human, 4, 4, 3, Melee,  1, 1, EAST, 1));
-    H.board.setCreature(Creature(boardBack,     2, Human, 4, 4, 3, Melee,  1, 1, EAST, 1));
-    
-    H.board.setCreature(Creature(boardBack - 1, 0, Human, 2, 4, 2, Ranged, 1, 4, EAST, 1));
-    H.board.setCreature(Creature(boardBack,     1, Human, 2, 4, 2, Ranged, 1, 4, EAST, 1));
-    
-    H.board.setCreature(Creature(boardBack - 1, 1, Human, 3, 2, 1, Magic,  1, 1, EAST, 1));
-    H.board.get(boardBack - 1, 1).creature()->addButton("mage_strike_from_", "Fireball");
-    
-    /*
-    H.board.setCreature(Creature(0, boardBack - 1, Human, 4, 4, 3, Melee,  1, 1, WEST, 0));
-    H.board.setCreature(Creature(1, boardBack - 1, Human, 4, 4, 1, Melee,  1, 1, WEST, 0));
-    H.board.setCreature(Creature(1, boardBack,     Human, 4, 4, 3, Melee,  1, 1, WEST, 0));
-    H.board.setCreature(Creature(1, boardBack - 1, Human, 4, 4, 1, Ranged, 1, 3, WEST, 0));
-    
-    H.board.setCreature(Creature(boardBack,     1, Human, 4, 4, 3, Melee,  1, 1, EAST, 1));
-    H.board.setCreature(Creature(boardBack - 1, 1, Human, 4, 4, 1, Melee,  1, 3, EAST, 1));
-    H.board.setCreature(Creature(boardBack - 1, 0, Human, 4, 4, 3, Melee,  1, 1, EAST, 1));
-    H.board.setCreature(Creature(boardBack - 1, 1, Human, 4, 4, 1, Ranged, 1, 3, EAST, 1));
-    */
-    
-    Building player0Home(0, BOARD_WIDTH - 1, 10, 0);
-    player0Home.deathAction = "player_lose_0";
-    Building player1Home(BOARD_WIDTH - 1, 0, 1, 1);
-    player1Home.deathAction = "player_lose_1";
-    
-    H.board.setBuilding(player0Home);
-    H.board.setBuilding(player1Home);
-    
     H.addPlayer();
     
     H.mainClientNum = 0;
     
-    //For adding players
-    std::thread addPlayerThread;
+    //For adding players. Clients are only accepted while the first client has asked for more players than have joined
     unsigned int playersToAdd = 0;
-    bool runningThread = false;
-    bool addedPlayer = false;
-    bool failedToAddPlayer = false;
+    bool beginning = false;
     
-    //Wait for syncing with client
-    while (true) {
-        try {
-            std::string action = H.socket.receive(0);
-            if (action.find("run:") != std::string::npos) {
-                action.erase(0, 4); //Erase "run:"
-                if (action == "begin()") {
-                    H.begin();
-                    break;
-                } else if (action == "addPlayer()") {
-                    playersToAdd++;
-                    H.socket.send("message_received", 0);
-                }
-            } else if (action == "send_number_of_players") {
-                H.socket.send(std::to_string(H.getNumberPlayers()).c_str(), 0);
-            }
-        } catch (std::runtime_error) { //Keep waiting for message from client
-            continue;
-        }
+    ServerSocketHandlers lobby;
+    lobby.connected = [&H, &playersToAdd](unsigned int clientIndex) {
+        H.addConnectedPlayer();
+        if (--playersToAdd == 0)
+            H.socket.setAccepting(false);
+    };
+    lobby.received = [&H, &playersToAdd, &beginning](unsigned int clientIndex, const std::string& message, MessageType type) {
+        if (clientIndex != H.mainClientNum)
+            return;
         
-        //If the thread finished running, end it, indicate no thread is running, and reset the two thread bools.
-        if (addedPlayer || failedToAddPlayer) {
-            addPlayerThread.join();
-            runningThread = false;
-            addedPlayer = false;
-            failedToAddPlayer = false;
-        }
-        if (playersToAdd > 0 && !runningThread) { //If no adding player thread is running and a player should be added, start the thread
-            playersToAdd--;
-            runningThread = true;
-            addPlayerThread = std::thread(threadAddPlayer, &addedPlayer, &failedToAddPlayer, &H);
+        std::string action = message;
+        if (action.find("run:") != std::string::npos) {
+            action.erase(0, 4); //Erase "run:"
+            if (action == "begin()") {
+                beginning = true;
+            } else if (action == "addPlayer()") {
+                playersToAdd++;
+                H.socket.setAccepting(true);
+                H.socket.send("message_received", clientIndex);
+            }
+        } else if (action == "send_number_of_players") {
+            H.socket.send(std::to_string(H.getNumberPlayers()).c_str(), clientIndex);
         }
+    };
+    
+    //Wait for syncing with client
+    while (!beginning) {
+        if (*done)
+            return;
+        H.socket.processEvents(100, lobby);
     }
+    H.socket.setAccepting(false);
+    H.begin();
     
     while (!*done) {
         H.update(done);
     }
 }
 
-void threadAddPlayer(bool *done, bool *failed, Host* host) {
-    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
-    while (true) {
-        std::chrono::duration<double> timeElapsed = std::chrono::steady_clock::now() - start;
-        if (timeElapsed.count() > MAX_CONNECTION_TIME) break;
-        host->socket.setHostTimeout(2);
-        try {
-            host->addPlayer();
-        } catch (std::runtime_error) {
-            continue; //Keep trying to connect, for 10 seconds
-        }
-        if (done != nullptr) *done = true; //If it connected without throwing an error, mark the connection was successful and end the function
-        return;
-    }
-    if (failed != nullptr) *failed = true;
-}
-
 //A function GLFW can call when a key event occurs
 void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods) {
     
@@ -0,0 +1,218 @@
+//
+//  BoardDeltaTests.cpp
+//  Strategy Game
+//
+
+//Standard library includes
+#include <string>
+#include <vector>
+
+//Local includes
+#include "Check.h"
+#include "Board.hpp"
+#include "SnapshotCache.hpp"
+
+//A board with two creatures for each of two players, and a wall unless it is left open
+Board testBoard(bool wall) {
+    std::vector<std::vector<Tile> > tiles(12);
+    for (unsigned int x = 0; x < 12; x++) {
+        for (unsigned int y = 0; y < 12; y++) {
+            tiles[x].push_back(Tile(wall && x == 6 && y >= 2 && y <= 8 ? MOUNTAIN_TERRAIN : OPEN_TERRAIN, x, y));
+        }
+    }
+    
+    Board board(tiles);
+    board.setCreature(Creature(2, 2, Human, 4, 4, 3, Melee, 5, 1, WEST, 0));
+    board.setCreature(Creature(3, 5, Human, 4, 4, 3, Melee, 5, 1, NORTH, 0));
+    board.setCreature(Creature(9, 9, Human, 4, 4, 3, Melee, 5, 1, EAST, 1));
+    board.setCreature(Creature(10, 4, Human, 4, 4, 3, Melee, 5, 1, SOUTH, 1));
+    return board;
+}
+
+//Whether every tile, with its damage, creature and building, is the same on both boards. The whole encoding is not compared, since a delta can reorder the creatures
+bool sameTiles(const Board& first, const Board& second) {
+    if (first.width() != second.width() || first.height(0) != second.height(0))
+        return false;
+    
+    for (unsigned int x = 0; x < first.width(); x++) {
+        for (unsigned int y = 0; y < first.height(0); y++) {
+            ByteWriter firstTile, secondTile;
+            first.encodeTile(x, y, true, firstTile);
+            second.encodeTile(x, y, true, secondTile);
+            if (firstTile.data() != secondTile.data())
+                return false;
+        }
+    }
+    return true;
+}
+
+//Write the changes after a version the way the host does, and apply them to a client board
+bool sendDelta(const Board& host, unsigned int version, const BitBoard& interest, Board& client, SnapshotCache& cache) {
+    BitBoard tiles, terrainTiles;
+    cache.reset(host);
+    if (!cache.changedTilesSince(host, version, tiles, terrainTiles))
+        return false;
+    
+    ByteWriter writer;
+    cache.encodeTiles(host, tiles, interest, Board::noViewer, writer);
+    ByteReader reader(writer.data());
+    client.decodeTiles(reader);
+    return true;
+}
+
+//A client that is sent the changes after its version ends up with the same board as the host
+int roundTrip() {
+    Board host = testBoard(false);
+    Board client = testBoard(true); //Replaced whole, walls and all
+    {
+        ByteWriter writer;
+        host.encode(writer);
+        ByteReader reader(writer.data());
+        client.decode(reader);
+    }
+    CHECK(sameTiles(client, host));
+    
+    BitBoard everything(host.width(), host.height(0));
+    everything.setRegion(0, 0, host.width() - 1, host.height(0) - 1);
+    SnapshotCache cache;
+    
+    unsigned int version = host.version();
+    CHECK(host.moveCreatureByDirection(2, 2, NORTH));
+    host.setDamage(9, 9, 3, 1.5);
+    CHECK(!sameTiles(client, host));
+    CHECK(sendDelta(host, version, everything, client, cache));
+    CHECK(sameTiles(client, host));
+    
+    //With nothing changed, nothing is sent, and the boards still match
+    BitBoard tiles, terrainTiles;
+    cache.reset(host);
+    CHECK(cache.changedTilesSince(host, host.version(), tiles, terrainTiles));
+    CHECK(tiles.count() == 0 && terrainTiles.count() == 0);
+    
+    //A version the board has not reached has no known changes
+    CHECK(!cache.changedTilesSince(host, host.version() + 1, tiles, terrainTiles));
+    
+    return 0;
+}
+
+//Tiles outside a client's interest are sent with only their terrain, so whatever was on them is removed
+int interestCulling() {
+    Board host = testBoard(false);
+    Board client = testBoard(false);
+    SnapshotCache cache;
+    
+    BitBoard interest(host.width(), host.height(0));
+    interest.setRegion(0, 0, 5, host.height(0) - 1);
+    
+    unsigned int version = host.version();
+    CHECK(host.moveCreatureByDirection(9, 9, NORTH));
+    CHECK(host.moveCreatureByDirection(2, 2, NORTH));
+    CHECK(sendDelta(host, version, interest, client, cache));
+    
+    CHECK(client.viewUnchecked(2, 2).creature() == nullptr);
+    CHECK(client.viewUnchecked(2, 1).creature() != nullptr && client.viewUnchecked(2, 1).creature()->controller() == 0);
+    CHECK(client.viewUnchecked(9, 9).creature() == nullptr);
+    CHECK(client.viewUnchecked(9, 8).creature() == nullptr);
+    
+    return 0;
+}
+
+//Only changes to terrain are reported as terrain changes
+int terrainChanges() {
+    Board client = testBoard(false);
+    Board walled = testBoard(true);
+    
+    unsigned int version = client.version();
+    BitBoard wall(client.width(), client.height(0));
+    wall.setRegion(6, 2, 6, 8);
+    wall.set(2, 2); //Has a creature on both boards, and the same terrain
+    {
+        ByteWriter writer;
+        walled.encodeTiles(wall, writer);
+        ByteReader reader(writer.data());
+        client.decodeTiles(reader);
+    }
+    client.setDamage(9, 9, 3, 1.5);
+    
+    BitBoard tiles(client.width(), client.height(0)), terrainTiles(client.width(), client.height(0));
+    CHECK(client.changedTilesSince(version, tiles, &terrainTiles));
+    CHECK(terrainTiles.count() == 7);
+    for (unsigned int y = 2; y <= 8; y++) {
+        CHECK(terrainTiles.test(6, y) && tiles.test(6, y));
+    }
+    CHECK(tiles.test(9, 9) && !terrainTiles.test(9, 9));
+    CHECK(!terrainTiles.test(2, 2));
+    
+    return 0;
+}
+
+//Regenerating energy only changes the tiles of the creatures that were not already full
+int energyChanges() {
+    Board board = testBoard(false);
+    BitBoard tiles(board.width(), board.height(0));
+    
+    unsigned int version = board.version();
+    board.regenerateEnergy();
+    CHECK(board.changedTilesSince(version, tiles));
+    CHECK(tiles.count() == 0);
+    
+    CHECK(board.moveCreatureByDirection(2, 2, NORTH));
+    version = board.version();
+    board.regenerateEnergy();
+    CHECK(board.changedTilesSince(version, tiles));
+    CHECK(tiles.count() == 1 && tiles.test(2, 1));
+    
+    return 0;
+}
+
+//Only the player controlling a creature is sent the directions it is about to move in
+int directionsForController() {
+    Board host = testBoard(false);
+    std::vector<unsigned int> path = {NORTH, NORTH, EAST};
+    CHECK(host.queueDirections(2, 2, path));
+    
+    BitBoard tiles(host.width(), host.height(0));
+    tiles.set(2, 2);
+    SnapshotCache cache;
+    cache.reset(host);
+    
+    int viewers[] = {0, 1, Board::noViewer};
+    for (int a = 0; a < 3; a++) {
+        Board client = testBoard(false);
+        ByteWriter writer;
+        cache.encodeTiles(host, tiles, tiles, viewers[a], writer);
+        ByteReader reader(writer.data());
+        client.decodeTiles(reader);
+        
+        const Creature* creature = client.viewUnchecked(2, 2).creature();
+        CHECK(creature != nullptr);
+        CHECK(creature->directions.size() == (viewers[a] == 0 ? path.size() : 0));
+    }
+    
+    //The same goes for keyframes
+    for (int a = 0; a < 3; a++) {
+        ByteWriter writer;
+        host.encode(writer, false, nullptr, viewers[a]);
+        ByteReader reader(writer.data());
+        Board client = testBoard(false);
+        client.decode(reader);
+        CHECK(client.viewUnchecked(2, 2).creature()->directions.size() == (viewers[a] == 0 ? path.size() : 0));
+    }
+    
+    return 0;
+}
+
+int main() {
+    if (roundTrip() != 0)
+        return 1;
+    if (interestCulling() != 0)
+        return 1;
+    if (terrainChanges() != 0)
+        return 1;
+    if (directionsForController() != 0)
+        return 1;
+    if (energyChanges() != 0)
+        return 1;
+    
+    return 0;
+}
@@ -0,0 +1,21 @@
+//
+//  Check.h
+//  Strategy Game
+//
+
+#ifndef Check_h
+#define Check_h
+
+//Standard library includes
+#include <iostream>
+
+//How the tests work:
+//Each test is its own executable, run by ctest, see CMakeLists.txt. A test's main() returns nonzero as soon as a check fails, after printing the check, so that the first failure is the one reported. Unlike assert(), checks are kept in release builds.
+
+#define CHECK(condition) \
+    if (!(condition)) { \
+        std::cout << __FILE__ << ":" << __LINE__ << ": Check failed: " << #condition << std::endl; \
+        return 1; \
+    }
+
+#endif /* Check_h */
@@ -0,0 +1,91 @@
+//
+//  CommandTests.cpp
+//  Strategy Game
+//
+
+//Standard library includes
+#include <string>
+#include <exception>
+
+//Local includes
+#include "Check.h"
+#include "Command.hpp"
+
+//Every opcode written by CommandWriter is read back by CommandReader with the same fields, in the same order
+int roundTrip() {
+    CommandWriter writer;
+    writer.acknowledge(0);
+    writer.acknowledge(4000000000u); //Takes the longest varint
+    writer.resync();
+    writer.leaveGame();
+    writer.tileCommand(MOVE_CREATURE_OPCODE, glm::ivec2(1, 2), glm::ivec2(300, 4));
+    writer.tileCommand(ATTACK_OPCODE, glm::ivec2(0, 0), glm::ivec2(127, 128));
+    writer.tileCommand(MAGE_STRIKE_OPCODE, glm::ivec2(5, 6), glm::ivec2(7, 8));
+    writer.requestCompression();
+    writer.camera(glm::ivec2(2, 3), glm::ivec2(20, 30));
+    
+    CommandReader reader(writer.data());
+    Command command;
+    
+    CHECK(reader.next(command) && command.opcode == ACKNOWLEDGE_OPCODE && command.version == 0);
+    CHECK(reader.next(command) && command.opcode == ACKNOWLEDGE_OPCODE && command.version == 4000000000u);
+    CHECK(reader.next(command) && command.opcode == RESYNC_OPCODE);
+    CHECK(reader.next(command) && command.opcode == LEAVE_GAME_OPCODE && command.changesGame());
+    CHECK(reader.next(command) && command.opcode == MOVE_CREATURE_OPCODE && command.origin == glm::ivec2(1, 2) && command.destination == glm::ivec2(300, 4));
+    CHECK(reader.next(command) && command.opcode == ATTACK_OPCODE && command.origin == glm::ivec2(0, 0) && command.destination == glm::ivec2(127, 128));
+    CHECK(reader.next(command) && command.opcode == MAGE_STRIKE_OPCODE && command.origin == glm::ivec2(5, 6) && command.destination == glm::ivec2(7, 8));
+    CHECK(reader.next(command) && command.opcode == REQUEST_COMPRESSION_OPCODE && !command.changesGame());
+    CHECK(reader.next(command) && command.opcode == CAMERA_OPCODE && command.origin == glm::ivec2(2, 3) && command.destination == glm::ivec2(20, 30));
+    CHECK(!reader.next(command));
+    
+    //A cleared writer starts a new batch
+    writer.clear();
+    CHECK(writer.empty());
+    CHECK(!CommandReader(writer.data()).next(command));
+    
+    return 0;
+}
+
+//A corrupt batch throws a range_error instead of being read past its end
+int corruptBatches() {
+    Command command;
+    
+    std::string invalidOpcode(1, (char)NUMBER_OF_OPCODES);
+    bool thrown = false;
+    try {
+        CommandReader(invalidOpcode).next(command);
+    } catch (std::range_error) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    
+    CommandWriter writer;
+    writer.tileCommand(MOVE_CREATURE_OPCODE, glm::ivec2(1, 2), glm::ivec2(3, 4));
+    std::string truncated = writer.data().substr(0, writer.data().size() - 1);
+    thrown = false;
+    try {
+        CommandReader(truncated).next(command);
+    } catch (std::range_error) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    
+    thrown = false;
+    try {
+        writer.tileCommand(RESYNC_OPCODE, glm::ivec2(0, 0), glm::ivec2(0, 0));
+    } catch (std::invalid_argument) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    
+    return 0;
+}
+
+int main() {
+    if (roundTrip() != 0)
+        return 1;
+    if (corruptBatches() != 0)
+        return 1;
+    
+    return 0;
+}
@@ -0,0 +1,136 @@
+//
+//  CompressorTests.cpp
+//  Strategy Game
+//
+
+//Standard library includes
+#include <string>
+#include <vector>
+#include <exception>
+#include <stdlib.h>
+
+//Local includes
+#include "Check.h"
+#include "Compressor.hpp"
+
+//Compresses the bytes into a block and checks that it decompresses back to them
+bool blockRoundTrips(Compressor& compressor, const std::string& data) {
+    ByteWriter writer;
+    compressor.compress(data.data(), data.size(), writer);
+    
+    std::string output;
+    Compressor::decompress(writer.data().data(), writer.data().size(), data.size(), output);
+    return output == data;
+}
+
+//Blocks of every kind decompress to exactly what was compressed
+int blocks() {
+    Compressor compressor;
+    
+    CHECK(blockRoundTrips(compressor, ""));
+    CHECK(blockRoundTrips(compressor, "a"));
+    CHECK(blockRoundTrips(compressor, "abc"));
+    CHECK(blockRoundTrips(compressor, std::string(100000, 'x'))); //One long match that overlaps itself
+    
+    //Matches further back than the greatest offset cannot be used, and must be written as literals
+    std::string repeated;
+    srand(1);
+    std::string pattern;
+    for (int a = 0; a < 70000; a++) {
+        pattern.push_back((char)(rand() % 256));
+    }
+    repeated = pattern + pattern + "end";
+    CHECK(blockRoundTrips(compressor, repeated));
+    
+    //Random bytes barely compress, so they are mostly literals
+    std::string random;
+    for (int a = 0; a < 5000; a++) {
+        random.push_back((char)(rand() % 256));
+    }
+    CHECK(blockRoundTrips(compressor, random));
+    
+    //Board updates repeat the same few bytes often
+    std::string board;
+    for (int a = 0; a < 2000; a++) {
+        board += std::string("\x01\x02\x00\x00", 4) + (char)(a % 7);
+    }
+    ByteWriter writer;
+    compressor.compress(board.data(), board.size(), writer);
+    CHECK(writer.data().size() < board.size() / 4);
+    CHECK(blockRoundTrips(compressor, board));
+    
+    return 0;
+}
+
+//Messages keep their type, and a corrupt one throws a range_error
+int messages() {
+    Compressor compressor;
+    ByteWriter writer;
+    std::string output;
+    
+    std::string delta(3000, 'd');
+    compressor.compressMessage(delta, DELTA_MESSAGE, writer);
+    CHECK(Compressor::decompressMessage(writer.data(), output) == DELTA_MESSAGE);
+    CHECK(output == delta);
+    
+    compressor.compressMessage("keyframe", KEYFRAME_MESSAGE, writer);
+    CHECK(Compressor::decompressMessage(writer.data(), output) == KEYFRAME_MESSAGE);
+    CHECK(output == "keyframe");
+    
+    //Every way of cutting the message short is caught
+    compressor.compressMessage(delta, DELTA_MESSAGE, writer);
+    std::string compressed = writer.data();
+    for (size_t length = 0; length < compressed.size(); length++) {
+        bool thrown = false;
+        try {
+            Compressor::decompressMessage(compressed.substr(0, length), output);
+        } catch (std::range_error) {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+    
+    return 0;
+}
+
+//Runs decode to exactly the bytes encoded
+int runLengths() {
+    std::vector<unsigned char> data;
+    for (int a = 0; a < 1000; a++) {
+        data.push_back((unsigned char)(a / 100));
+    }
+    data.push_back(255);
+    
+    ByteWriter writer;
+    Compressor::runLengthEncode(data.data(), data.size(), writer);
+    CHECK(writer.data().size() < 30);
+    
+    std::vector<unsigned char> output(data.size());
+    ByteReader reader(writer.data());
+    Compressor::runLengthDecode(reader, output.data(), output.size());
+    CHECK(output == data);
+    CHECK(reader.remaining() == 0);
+    
+    //A run that goes past the given length is corrupt
+    ByteReader shortReader(writer.data());
+    bool thrown = false;
+    try {
+        Compressor::runLengthDecode(shortReader, output.data(), 950);
+    } catch (std::range_error) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    
+    return 0;
+}
+
+int main() {
+    if (blocks() != 0)
+        return 1;
+    if (messages() != 0)
+        return 1;
+    if (runLengths() != 0)
+        return 1;
+    
+    return 0;
+}
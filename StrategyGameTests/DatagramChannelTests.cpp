@@ -0,0 +1,283 @@
+//
+//  DatagramChannelTests.cpp
+//  Strategy Game
+//
+
+//Standard library includes
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <exception>
+
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+//Local includes
+#include "Check.h"
+#include "DatagramChannel.hpp"
+
+//A UDP socket on the loopback address, bound to any free port, and connected to a port if one is given. It can share its port with the sockets DatagramChannel::accept() makes, as the host's can, see ServerSocket
+int loopbackSocket(int connectTo = 0) {
+    int socket = ::socket(AF_INET, SOCK_DGRAM, 0);
+    int enable = 1;
+#if defined(__linux__)
+    setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(int));
+#else
+    setsockopt(socket, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(int));
+#endif
+    
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(socket, (struct sockaddr *)&address, sizeof(address));
+    
+    if (connectTo != 0) {
+        address.sin_port = htons(connectTo);
+        connect(socket, (struct sockaddr *)&address, sizeof(address));
+    }
+    return socket;
+}
+
+int portOf(int socket) {
+    sockaddr_in address;
+    socklen_t addressSize = sizeof(address);
+    getsockname(socket, (struct sockaddr *)&address, &addressSize);
+    return ntohs(address.sin_port);
+}
+
+//Read one packet, waiting up to a second for it
+std::string receivePacket(int socket) {
+    pollfd readable = {socket, POLLIN, 0};
+    if (poll(&readable, 1, 1000) <= 0)
+        return "";
+    
+    char packet[DatagramChannel::maximumPacketSize + 1];
+    long bytesRead = recv(socket, packet, sizeof(packet), MSG_DONTWAIT);
+    return bytesRead > 0 ? std::string(packet, bytesRead) : "";
+}
+
+//A client is only given a socket once it sends back the cookie it was challenged with, and a forged cookie gets nothing
+int handshake() {
+    int listening = loopbackSocket();
+    int port = portOf(listening);
+    std::deque<uint32_t> acceptedNonces;
+    sockaddr_storage address;
+    socklen_t addressSize;
+    
+    //A request on its own is answered, but no socket is made for it
+    int client = loopbackSocket(port);
+    const char request[] = {0x53, 0x47, 0, 1, 2, 3, 4}; //CONNECT_PACKET with a nonce, see DatagramChannel.hpp
+    send(client, request, sizeof(request), 0);
+    usleep(10000);
+    CHECK(DatagramChannel::accept(listening, &address, &addressSize, acceptedNonces) < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+    
+    std::string challenge = receivePacket(client);
+    CHECK(challenge.size() == 15 && challenge[2] == 4 && challenge.substr(3, 4) == std::string(request + 3, 4));
+    
+    //Sent back with one bit of the cookie changed, it is refused
+    std::string response = challenge;
+    response[2] = 5; //RESPONSE_PACKET
+    response[14] ^= 1;
+    send(client, response.data(), response.size(), 0);
+    usleep(10000);
+    CHECK(DatagramChannel::accept(listening, &address, &addressSize, acceptedNonces) < 0);
+    
+    //From another address, it is refused too
+    int other = loopbackSocket(port);
+    response[14] ^= 1;
+    send(other, response.data(), response.size(), 0);
+    usleep(10000);
+    CHECK(DatagramChannel::accept(listening, &address, &addressSize, acceptedNonces) < 0);
+    
+    //Sent back whole from the address it was sent to, it is accepted, and only once
+    send(client, response.data(), response.size(), 0);
+    send(client, response.data(), response.size(), 0);
+    usleep(10000);
+    int accepted = DatagramChannel::accept(listening, &address, &addressSize, acceptedNonces);
+    CHECK(accepted >= 0);
+    CHECK(DatagramChannel::accept(listening, &address, &addressSize, acceptedNonces) < 0);
+    CHECK(receivePacket(client).substr(0, 3) == std::string("\x53\x47\x01", 3)); //ACCEPT_PACKET
+    close(accepted);
+    close(other);
+    close(client);
+    
+    //connect() goes through all of it on its own
+    client = loopbackSocket(port);
+    std::atomic<bool> connected(false);
+    std::thread connecting([client, &connected] {
+        try {
+            DatagramChannel::connect(client, 2000);
+            connected = true;
+        } catch (std::runtime_error) {}
+    });
+    
+    accepted = -1;
+    for (int a = 0; a < 200 && accepted < 0; a++) {
+        accepted = DatagramChannel::accept(listening, &address, &addressSize, acceptedNonces);
+        usleep(5000);
+    }
+    connecting.join();
+    CHECK(accepted >= 0 && connected);
+    
+    //The connection works both ways
+    DatagramChannel host(accepted), guest(client);
+    host.send("hello", 5, TEXT_MESSAGE);
+    std::string message;
+    MessageType type;
+    CHECK(guest.receive(message, type, 1000) && message == "hello" && type == TEXT_MESSAGE);
+    guest.send("hi", 2, ACTION_MESSAGE);
+    CHECK(host.receive(message, type, 1000) && message == "hi" && type == ACTION_MESSAGE);
+    
+    close(accepted);
+    close(client);
+    close(listening);
+    return 0;
+}
+
+//Moves the packets waiting on one end of a link to the other, dropping every dropEvery-th one
+void relay(int from, int to, unsigned int dropEvery, unsigned int& count) {
+    char packet[DatagramChannel::maximumPacketSize + 1];
+    while (true) {
+        long bytesRead = recv(from, packet, sizeof(packet), MSG_DONTWAIT);
+        if (bytesRead < 0)
+            return;
+        if (++count % dropEvery != 0)
+            send(to, packet, bytesRead, MSG_DONTWAIT);
+    }
+}
+
+//Over a link that loses packets, reliable messages still all arrive, whole and in order, and board updates arrive in order or not at all
+int lossAndResend() {
+    //Each channel talks to its own end of a pair, and the test moves packets between the other ends
+    int hostPair[2], guestPair[2];
+    CHECK(socketpair(AF_UNIX, SOCK_DGRAM, 0, hostPair) == 0 && socketpair(AF_UNIX, SOCK_DGRAM, 0, guestPair) == 0);
+    DatagramChannel host(hostPair[0]), guest(guestPair[0]);
+    
+    //Long enough to be split into several fragments, and different from each other
+    std::vector<std::string> sent;
+    for (int a = 0; a < 20; a++) {
+        std::string message(500 + a * 250, (char)('a' + a));
+        message += std::to_string(a);
+        sent.push_back(message);
+        host.send(message.data(), message.size(), a % 2 == 0 ? TEXT_MESSAGE : ACTION_MESSAGE);
+        
+        std::string update = std::to_string(a);
+        host.send(update.data(), update.size(), DELTA_MESSAGE);
+    }
+    
+    std::vector<std::string> reliable;
+    int lastUpdate = -1;
+    unsigned int toGuest = 0, toHost = 0;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    
+    while (reliable.size() < sent.size() && std::chrono::steady_clock::now() < deadline) {
+        host.flush();
+        guest.flush();
+        relay(hostPair[1], guestPair[1], 3, toGuest);
+        relay(guestPair[1], hostPair[1], 4, toHost);
+        CHECK(host.readAvailable() && guest.readAvailable());
+        
+        std::string message;
+        MessageType type;
+        while (guest.nextMessage(message, type)) {
+            if (type == DELTA_MESSAGE) {
+                CHECK(std::stoi(message) > lastUpdate);
+                lastUpdate = std::stoi(message);
+            } else {
+                CHECK(type == (reliable.size() % 2 == 0 ? TEXT_MESSAGE : ACTION_MESSAGE));
+                reliable.push_back(message);
+            }
+        }
+        usleep(1000);
+    }
+    
+    CHECK(reliable == sent);
+    
+    //Everything was resent until it got through, so nothing is left waiting once the acknowledgements arrive
+    for (int a = 0; a < 100 && host.timeUntilDue() < 100; a++) {
+        host.flush();
+        guest.flush();
+        relay(hostPair[1], guestPair[1], 3, toGuest);
+        relay(guestPair[1], hostPair[1], 4, toHost);
+        host.readAvailable();
+        guest.readAvailable();
+        usleep(1000);
+    }
+    CHECK(!host.hasQueued() && host.timeUntilDue() >= 100);
+    
+    for (int a = 0; a < 2; a++) {
+        close(hostPair[a]);
+        close(guestPair[a]);
+    }
+    return 0;
+}
+
+//A reliable fragment written the way the other side does, full unless it is the last of its message, see DatagramChannel.hpp
+void sendFragment(int socket, uint32_t sequence, uint16_t index, uint16_t count, char fill) {
+    ByteWriter packet;
+    packet.writeByte(0x53);
+    packet.writeByte(0x47);
+    packet.writeByte(2); //DATA_PACKET
+    packet.writeUInt32(0);
+    packet.writeUInt32(0);
+    packet.writeByte(TEXT_MESSAGE);
+    packet.writeUInt32(sequence);
+    packet.writeUInt16(index);
+    packet.writeUInt16(count);
+    
+    std::string bytes(index + 1 < count ? DatagramChannel::maximumPacketSize - 24 : 10, fill); //Less the headers of a packet and of the longest fragment
+    packet.writeBytes(bytes.data(), bytes.size());
+    send(socket, packet.data().data(), packet.size(), 0);
+}
+
+//Fragments that never finish a message are not kept past the longest message accepted, and do not get in the way of the messages after them
+int endlessFragments() {
+    int pair[2];
+    CHECK(socketpair(AF_UNIX, SOCK_DGRAM, 0, pair) == 0);
+    DatagramChannel channel(pair[0]);
+    channel.setMaximumReceiveLength(4000);
+    
+    //In order, so that each one is handed over rather than waiting for the ones before it
+    uint32_t sequence = 0;
+    sendFragment(pair[1], sequence++, 0, 2, 'a');
+    for (int a = 0; a < 2000; a++) {
+        sendFragment(pair[1], sequence++, 1, 3 - a % 2, 'b');
+        if (a % 50 == 49) {
+            CHECK(channel.readAvailable());
+            CHECK(channel.partialLength() <= 4000);
+        }
+    }
+    CHECK(channel.readAvailable());
+    CHECK(channel.partialLength() <= 4000);
+    CHECK(!channel.hasMessage());
+    
+    sendFragment(pair[1], sequence++, 0, 2, 'c');
+    sendFragment(pair[1], sequence++, 1, 2, 'd');
+    CHECK(channel.readAvailable());
+    std::string message;
+    MessageType type;
+    CHECK(channel.nextMessage(message, type) && type == TEXT_MESSAGE);
+    CHECK(message == std::string(DatagramChannel::maximumPacketSize - 24, 'c') + std::string(10, 'd'));
+    CHECK(!channel.hasMessage() && channel.partialLength() == 0);
+    
+    close(pair[0]);
+    close(pair[1]);
+    return 0;
+}
+
+int main() {
+    if (handshake() != 0)
+        return 1;
+    if (lossAndResend() != 0)
+        return 1;
+    if (endlessFragments() != 0)
+        return 1;
+    
+    return 0;
+}
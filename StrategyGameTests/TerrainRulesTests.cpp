@@ -0,0 +1,94 @@
+//
+//  TerrainRulesTests.cpp
+//  Strategy Game
+//
+
+//Standard library includes
+#include <string>
+#include <exception>
+#include <stdexcept>
+
+//Local includes
+#include "Check.h"
+#include "TerrainRules.hpp"
+#include "Board.hpp"
+
+//Serialized rules, the built-in ones unless others are given, with the value at an index replaced. Values are in the order serialize() writes them, so the movement costs come first, by terrain and then race, and the attack costs start at NUMBER_OF_TERRAINS * NUMBER_OF_RACES
+std::string withValue(unsigned int index, const std::string& value, std::string str = TerrainRules::standard().serialize()) {
+    size_t start = str.find(':') + 1;
+    for (unsigned int a = 0; a < index; a++) {
+        start = str.find(',', start) + 1;
+    }
+    return str.replace(start, str.find(',', start) - start, value);
+}
+
+//Whether deserializing the string throws a range_error
+bool rejected(const std::string& str) {
+    try {
+        TerrainRules::deserialize(str);
+    } catch (std::range_error) {
+        return true;
+    }
+    return false;
+}
+
+//Rules come back from serialize() the same, and the costs that the searches cannot use are rejected
+int deserialize() {
+    TerrainRules rules = TerrainRules::deserialize(TerrainRules::standard().serialize());
+    CHECK(rules.serialize() == TerrainRules::standard().serialize());
+    
+    rules = TerrainRules::deserialize(withValue(0, "3.5"));
+    CHECK(rules.movementCost(OPEN_TERRAIN, Human) == 3.5f);
+    rules = TerrainRules::deserialize(withValue(0, "0"));
+    CHECK(rules.movementCost(OPEN_TERRAIN, Human) == 0.0f);
+    
+    CHECK(rejected(withValue(0, "-1")));
+    CHECK(rejected(withValue(0, "0.25"))); //Not a multiple of 1 / movementCostScale
+    CHECK(rejected(withValue(0, "1.000001")));
+    CHECK(rejected(withValue(0, "100000"))); //Past maximumMovementCost
+    CHECK(rejected(withValue(0, "1" + std::string(45, '0')))); //Too large for a float, so it is read as infinite
+    
+    unsigned int attackCost = NUMBER_OF_TERRAINS * NUMBER_OF_RACES;
+    CHECK(!rejected(withValue(attackCost, "0.25")));
+    CHECK(rejected(withValue(attackCost, "-0.25")));
+    CHECK(rejected(withValue(attackCost, "1" + std::string(45, '0'))));
+    
+    return 0;
+}
+
+//With rules where road is not the cheapest terrain, paths are still the cheapest ones
+int cheapestPath() {
+    std::string rules = TerrainRules::standard().serialize();
+    for (int race = 0; race < NUMBER_OF_RACES; race++) {
+        rules = withValue(FOREST_TERRAIN * NUMBER_OF_RACES + race, "0.5", rules);
+        rules = withValue(ROAD_TERRAIN * NUMBER_OF_RACES + race, "2", rules);
+    }
+    CHECK(TerrainRules::deserialize(rules).cheapestMovementCost(Human) == 0.5f);
+    CHECK(TerrainRules::standard().cheapestMovementCost(Dwarf) == 0.5f);
+    
+    //Straight along the open row costs 4, and around through the forest below it costs 3.5
+    std::vector<std::vector<Tile> > tiles(6);
+    for (unsigned int x = 0; x < 6; x++) {
+        for (unsigned int y = 0; y < 3; y++) {
+            tiles[x].push_back(Tile(y == 1 ? FOREST_TERRAIN : OPEN_TERRAIN, x, y));
+        }
+    }
+    Board board(tiles);
+    board.setTerrainRules(TerrainRules::deserialize(rules));
+    board.setCreature(Creature(0, 0, Human, 4, 4, 3, Melee, 5, 1, EAST, 0));
+    
+    std::vector<unsigned int> path = board.getPath(0, 0, 4, 0);
+    std::vector<unsigned int> around = {SOUTH, WEST, WEST, WEST, WEST, NORTH}; //WEST is towards greater x, see Board::moveCreatureByDirection()
+    CHECK(path == around);
+    
+    return 0;
+}
+
+int main() {
+    if (deserialize() != 0)
+        return 1;
+    if (cheapestPath() != 0)
+        return 1;
+    
+    return 0;
+}